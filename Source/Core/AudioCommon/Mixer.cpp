@@ -15,6 +15,7 @@
 #include "Common/Swap.h"
 #include "Core/Config/MainSettings.h"
 #include "Core/ConfigManager.h"
+#include "Core/Core.h"
 
 static u32 DPL2QualityToFrameBlockSize(AudioCommon::DPL2Quality quality)
 {
@@ -205,6 +206,10 @@ unsigned int Mixer::MixSurround(float* samples, unsigned int num_samples)
 
 void Mixer::MixerFifo::PushSamples(const short* samples, unsigned int num_samples)
 {
+  // Fields that NetPlay's rollback mode emulates again have already been heard once
+  if (Core::IsResimulating())
+    return;
+
   // Cache access in non-volatile variable
   // indexR isn't allowed to cache in the audio throttling loop as it
   // needs to get updates to not deadlock.
@@ -63,6 +63,8 @@ struct CPUInfo
   bool bFP = false;
   bool bASIMD = false;
   bool bCRC32 = false;
+
+  // Also set on x86 when the SHA extensions are supported
   bool bSHA1 = false;
   bool bSHA2 = false;
 
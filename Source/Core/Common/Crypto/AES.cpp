@@ -2,9 +2,17 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iterator>
+#include <memory>
+
 #include <mbedtls/aes.h>
 
+#include "Common/CPUDetect.h"
 #include "Common/Crypto/AES.h"
+#include "Common/Intrinsics.h"
 
 namespace Common::AES
 {
@@ -33,4 +41,206 @@ std::vector<u8> Encrypt(const u8* key, u8* iv, const u8* src, size_t size)
 {
   return DecryptEncrypt(key, iv, src, size, Mode::Encrypt);
 }
+
+void Context::CryptBatch(const Stream* streams, size_t count, size_t size) const
+{
+  for (size_t i = 0; i < count; ++i)
+    Crypt(streams[i].iv, streams[i].src, streams[i].dst, size);
+}
+
+namespace
+{
+class ContextGeneric final : public Context
+{
+public:
+  ContextGeneric(const u8* key, Mode mode) : m_mode(mode)
+  {
+    mbedtls_aes_init(&m_context);
+    if (mode == Mode::Encrypt)
+      mbedtls_aes_setkey_enc(&m_context, key, 128);
+    else
+      mbedtls_aes_setkey_dec(&m_context, key, 128);
+  }
+
+  ~ContextGeneric() override { mbedtls_aes_free(&m_context); }
+
+  void Crypt(const u8* iv, const u8* src, u8* dst, size_t size) const override
+  {
+    // mbedtls updates the IV as it goes.
+    std::array<u8, 16> iv_copy;
+    std::memcpy(iv_copy.data(), iv, iv_copy.size());
+    mbedtls_aes_crypt_cbc(&m_context,
+                          m_mode == Mode::Encrypt ? MBEDTLS_AES_ENCRYPT : MBEDTLS_AES_DECRYPT, size,
+                          iv_copy.data(), src, dst);
+  }
+
+private:
+  // mbedtls takes a non-const context, but only reads it when crypting.
+  mutable mbedtls_aes_context m_context;
+  Mode m_mode;
+};
+
+#ifdef _M_X86
+constexpr size_t NUM_ROUND_KEYS = 11;
+
+template <int rcon>
+FUNCTION_TARGET_AES __m128i ExpandKey(__m128i key)
+{
+  const __m128i assist = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(key, rcon), 0xFF);
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  return _mm_xor_si128(key, assist);
+}
+
+class ContextAESNI final : public Context
+{
+public:
+  FUNCTION_TARGET_AES ContextAESNI(const u8* key, Mode mode) : m_mode(mode)
+  {
+    __m128i keys[NUM_ROUND_KEYS];
+    keys[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key));
+    keys[1] = ExpandKey<0x01>(keys[0]);
+    keys[2] = ExpandKey<0x02>(keys[1]);
+    keys[3] = ExpandKey<0x04>(keys[2]);
+    keys[4] = ExpandKey<0x08>(keys[3]);
+    keys[5] = ExpandKey<0x10>(keys[4]);
+    keys[6] = ExpandKey<0x20>(keys[5]);
+    keys[7] = ExpandKey<0x40>(keys[6]);
+    keys[8] = ExpandKey<0x80>(keys[7]);
+    keys[9] = ExpandKey<0x1B>(keys[8]);
+    keys[10] = ExpandKey<0x36>(keys[9]);
+
+    if (mode == Mode::Encrypt)
+    {
+      std::copy(std::begin(keys), std::end(keys), m_keys);
+      return;
+    }
+
+    // The equivalent inverse cipher uses the round keys in reverse order, with InvMixColumns
+    // applied to all but the first and the last one.
+    m_keys[0] = keys[10];
+    for (size_t i = 1; i < NUM_ROUND_KEYS - 1; ++i)
+      m_keys[i] = _mm_aesimc_si128(keys[NUM_ROUND_KEYS - 1 - i]);
+    m_keys[10] = keys[0];
+  }
+
+  void Crypt(const u8* iv, const u8* src, u8* dst, size_t size) const override
+  {
+    if (m_mode == Mode::Encrypt)
+    {
+      const Stream stream{iv, src, dst};
+      EncryptStreams<1>(&stream, size);
+    }
+    else
+    {
+      Decrypt(iv, src, dst, size);
+    }
+  }
+
+  void CryptBatch(const Stream* streams, size_t count, size_t size) const override
+  {
+    if (m_mode == Mode::Decrypt)
+    {
+      Context::CryptBatch(streams, count, size);
+      return;
+    }
+
+    for (; count >= ENCRYPT_LANES; count -= ENCRYPT_LANES, streams += ENCRYPT_LANES)
+      EncryptStreams<ENCRYPT_LANES>(streams, size);
+    for (; count > 0; --count, ++streams)
+      EncryptStreams<1>(streams, size);
+  }
+
+private:
+  // AES instructions have a latency of several cycles but can be issued every cycle, so work on
+  // this many independent blocks at once to keep the pipeline full.
+  static constexpr size_t ENCRYPT_LANES = 8;
+  static constexpr size_t DECRYPT_BLOCKS = 8;
+
+  // Each stream is its own CBC chain, so the lanes don't depend on each other.
+  template <size_t lanes>
+  FUNCTION_TARGET_AES void EncryptStreams(const Stream* streams, size_t size) const
+  {
+    __m128i state[lanes];
+    for (size_t lane = 0; lane < lanes; ++lane)
+      state[lane] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(streams[lane].iv));
+
+    for (size_t offset = 0; offset < size; offset += 16)
+    {
+      for (size_t lane = 0; lane < lanes; ++lane)
+      {
+        const __m128i block =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(streams[lane].src + offset));
+        state[lane] = _mm_xor_si128(_mm_xor_si128(state[lane], block), m_keys[0]);
+      }
+      for (size_t round = 1; round < NUM_ROUND_KEYS - 1; ++round)
+      {
+        for (size_t lane = 0; lane < lanes; ++lane)
+          state[lane] = _mm_aesenc_si128(state[lane], m_keys[round]);
+      }
+      for (size_t lane = 0; lane < lanes; ++lane)
+      {
+        state[lane] = _mm_aesenclast_si128(state[lane], m_keys[NUM_ROUND_KEYS - 1]);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(streams[lane].dst + offset), state[lane]);
+      }
+    }
+  }
+
+  // Unlike encryption, CBC decryption of each block only depends on ciphertext, so the blocks
+  // of a single stream can be decrypted in parallel.
+  FUNCTION_TARGET_AES void Decrypt(const u8* iv, const u8* src, u8* dst, size_t size) const
+  {
+    __m128i previous = _mm_loadu_si128(reinterpret_cast<const __m128i*>(iv));
+
+    size_t offset = 0;
+    for (; offset + DECRYPT_BLOCKS * 16 <= size; offset += DECRYPT_BLOCKS * 16)
+    {
+      __m128i ciphertext[DECRYPT_BLOCKS];
+      __m128i state[DECRYPT_BLOCKS];
+      for (size_t i = 0; i < DECRYPT_BLOCKS; ++i)
+      {
+        ciphertext[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + offset + i * 16));
+        state[i] = _mm_xor_si128(ciphertext[i], m_keys[0]);
+      }
+      for (size_t round = 1; round < NUM_ROUND_KEYS - 1; ++round)
+      {
+        for (size_t i = 0; i < DECRYPT_BLOCKS; ++i)
+          state[i] = _mm_aesdec_si128(state[i], m_keys[round]);
+      }
+      for (size_t i = 0; i < DECRYPT_BLOCKS; ++i)
+      {
+        state[i] = _mm_aesdeclast_si128(state[i], m_keys[NUM_ROUND_KEYS - 1]);
+        state[i] = _mm_xor_si128(state[i], i == 0 ? previous : ciphertext[i - 1]);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + offset + i * 16), state[i]);
+      }
+      previous = ciphertext[DECRYPT_BLOCKS - 1];
+    }
+
+    for (; offset < size; offset += 16)
+    {
+      const __m128i ciphertext = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + offset));
+      __m128i state = _mm_xor_si128(ciphertext, m_keys[0]);
+      for (size_t round = 1; round < NUM_ROUND_KEYS - 1; ++round)
+        state = _mm_aesdec_si128(state, m_keys[round]);
+      state = _mm_aesdeclast_si128(state, m_keys[NUM_ROUND_KEYS - 1]);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + offset), _mm_xor_si128(state, previous));
+      previous = ciphertext;
+    }
+  }
+
+  __m128i m_keys[NUM_ROUND_KEYS];
+  Mode m_mode;
+};
+#endif
+}  // namespace
+
+std::unique_ptr<Context> CreateContext(const u8* key, Mode mode)
+{
+#ifdef _M_X86
+  if (cpu_info.bAES)
+    return std::make_unique<ContextAESNI>(key, mode);
+#endif
+  return std::make_unique<ContextGeneric>(key, mode);
+}
 }  // namespace Common::AES
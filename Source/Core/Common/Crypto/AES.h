@@ -5,6 +5,7 @@
 #pragma once
 
 #include <cstddef>
+#include <memory>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -21,4 +22,30 @@ std::vector<u8> DecryptEncrypt(const u8* key, u8* iv, const u8* src, size_t size
 // Convenience functions
 std::vector<u8> Decrypt(const u8* key, u8* iv, const u8* src, size_t size);
 std::vector<u8> Encrypt(const u8* key, u8* iv, const u8* src, size_t size);
+
+// One CBC stream of a batch. All streams of a batch have the same size.
+struct Stream
+{
+  const u8* iv;
+  const u8* src;
+  u8* dst;
+};
+
+// AES-128-CBC with a key that is set up once. Uses AES-NI when the CPU supports it.
+// Crypting is thread-safe, as a context is never modified after it has been created.
+class Context
+{
+public:
+  virtual ~Context() = default;
+
+  // size must be a multiple of 16. src and dst may be the same buffer.
+  virtual void Crypt(const u8* iv, const u8* src, u8* dst, size_t size) const = 0;
+
+  // Crypts several independent streams, such as the clusters of a Wii disc, each with its own
+  // IV. CBC encryption can't be parallelized within a stream, so this lets it work on several
+  // streams at once.
+  virtual void CryptBatch(const Stream* streams, size_t count, size_t size) const;
+};
+
+std::unique_ptr<Context> CreateContext(const u8* key, Mode mode);
 }  // namespace Common::AES
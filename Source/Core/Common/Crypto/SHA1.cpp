@@ -0,0 +1,116 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Common/Crypto/SHA1.h"
+
+#include <array>
+#include <cstring>
+
+#include <mbedtls/sha1.h>
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
+#include "Common/Swap.h"
+
+namespace Common::SHA1
+{
+#ifdef _M_X86
+namespace
+{
+constexpr size_t BLOCK_SIZE = 64;
+
+// Each call does four of the 80 rounds. The message schedule is computed four words at a time
+// in msg[], where the words for rounds 4 * i to 4 * i + 3 end up in msg[i % 4].
+template <int group>
+FUNCTION_TARGET_SHA inline void DoRounds(__m128i& abcd, __m128i& abcd_previous, __m128i* msg)
+{
+  if constexpr (group >= 1 && group <= 16)
+    msg[(group + 3) % 4] = _mm_sha1msg1_epu32(msg[(group + 3) % 4], msg[group % 4]);
+  if constexpr (group >= 2 && group <= 17)
+    msg[(group + 2) % 4] = _mm_xor_si128(msg[(group + 2) % 4], msg[group % 4]);
+  if constexpr (group >= 3 && group <= 18)
+    msg[(group + 1) % 4] = _mm_sha1msg2_epu32(msg[(group + 1) % 4], msg[group % 4]);
+
+  if constexpr (group < 19)
+  {
+    const __m128i e = _mm_sha1nexte_epu32(abcd_previous, msg[(group + 1) % 4]);
+    abcd_previous = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e, (group + 1) / 5);
+    DoRounds<group + 1>(abcd, abcd_previous, msg);
+  }
+}
+
+FUNCTION_TARGET_SHA void ProcessBlocks(u32* state, const u8* data, size_t num_blocks)
+{
+  const __m128i byte_swap = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+  __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1B);
+  __m128i e0 = _mm_set_epi32(state[4], 0, 0, 0);
+
+  for (; num_blocks > 0; --num_blocks, data += BLOCK_SIZE)
+  {
+    const __m128i abcd_saved = abcd;
+    const __m128i e0_saved = e0;
+
+    __m128i msg[4];
+    for (size_t i = 0; i < 4; ++i)
+    {
+      msg[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 16)),
+                                byte_swap);
+    }
+
+    // Rounds 0 to 3 take E directly, the others get it from sha1nexte.
+    __m128i abcd_previous = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, _mm_add_epi32(e0, msg[0]), 0);
+    DoRounds<0>(abcd, abcd_previous, msg);
+
+    e0 = _mm_sha1nexte_epu32(abcd_previous, e0_saved);
+    abcd = _mm_add_epi32(abcd, abcd_saved);
+  }
+
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1B));
+  state[4] = _mm_extract_epi32(e0, 3);
+}
+
+Digest CalculateDigestSHANI(const u8* msg, size_t len)
+{
+  u32 state[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+  const size_t full_blocks = len / BLOCK_SIZE;
+  ProcessBlocks(state, msg, full_blocks);
+
+  // Padding: a 1 bit, zeroes, and the length in bits as a big endian u64.
+  std::array<u8, BLOCK_SIZE * 2> tail{};
+  const size_t remaining = len % BLOCK_SIZE;
+  std::memcpy(tail.data(), msg + full_blocks * BLOCK_SIZE, remaining);
+  tail[remaining] = 0x80;
+  const size_t tail_blocks = remaining < BLOCK_SIZE - sizeof(u64) ? 1 : 2;
+  const u64 bit_length = Common::swap64(static_cast<u64>(len) * 8);
+  std::memcpy(tail.data() + tail_blocks * BLOCK_SIZE - sizeof(u64), &bit_length, sizeof(u64));
+  ProcessBlocks(state, tail.data(), tail_blocks);
+
+  Digest digest;
+  for (size_t i = 0; i < 5; ++i)
+  {
+    const u32 word = Common::swap32(state[i]);
+    std::memcpy(digest.data() + i * sizeof(u32), &word, sizeof(u32));
+  }
+  return digest;
+}
+}  // namespace
+#endif
+
+Digest CalculateDigest(const u8* msg, size_t len)
+{
+#ifdef _M_X86
+  if (cpu_info.bSHA1 && cpu_info.bSSE4_1)
+    return CalculateDigestSHANI(msg, len);
+#endif
+
+  Digest digest;
+  mbedtls_sha1_ret(msg, len, digest.data());
+  return digest;
+}
+}  // namespace Common::SHA1
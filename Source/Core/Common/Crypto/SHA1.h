@@ -0,0 +1,18 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "Common/CommonTypes.h"
+
+namespace Common::SHA1
+{
+using Digest = std::array<u8, 20>;
+
+// Uses the x86 SHA extensions when the CPU supports them.
+Digest CalculateDigest(const u8* msg, size_t len);
+}  // namespace Common::SHA1
@@ -5,27 +5,41 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
+#include <cstdio>
 #include <cstring>
-#include <fstream>
+#include <functional>
+#include <iterator>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/File.h"
 #include "Common/FileUtil.h"
+#include "Common/Hash.h"
+#include "Common/MappedFile.h"
 #include "Common/Version.h"
 
 // On disk format:
 // header{
 // u32 'DCAC';
-// u32 version;  // svn_rev
+// u32 format_version;
 // u16 sizeof(key_type);
 // u16 sizeof(value_type);
+// char ver[40];  // scm_rev_git_str
 //}
 
 // key_value_pair{
 // u32 value_size;
 // key_type   key;
+// u32 header_checksum;  // of value_size and key
 // value_type[value_size]   value;
+// u32 value_checksum;  // of value
 //}
 
 template <typename K, typename V>
@@ -40,9 +54,17 @@ public:
 // Keys and values can contain any characters, including \0.
 //
 // Suitable for caching generated shader bytecode between executions.
-// Not tuned for extreme performance but should be reasonably fast.
 // Does not support keys or values larger than 2GB, which should be reasonable.
 // Keys must have non-zero length; values can have zero length.
+//
+// The file is memory mapped and indexed when it is opened. Only the latest entry for each key
+// is passed to the reader, and values are passed straight from the mapping.
+//
+// Indexing only checks the checksum of each entry's size and key, so values that get superseded
+// are never hashed. The value checksum is written last and verified when the value is first
+// read, so an append that got interrupted by a crash, or a corrupted value, is dropped.
+// When more than half of the entries have been superseded, the file is compacted on a worker
+// thread while the cache is in use, and the compacted file replaces the old one on Close().
 
 // K and V are some POD type
 // K : the key type
@@ -51,85 +73,73 @@ template <typename K, typename V>
 class LinearDiskCache
 {
 public:
+  LinearDiskCache() = default;
+  ~LinearDiskCache() { Close(); }
+
+  LinearDiskCache(const LinearDiskCache&) = delete;
+  LinearDiskCache& operator=(const LinearDiskCache&) = delete;
+
   // return number of read entries
   u32 OpenAndRead(const std::string& filename, LinearDiskCacheReader<K, V>& reader)
   {
-    using std::ios_base;
-
-    // Since we're reading/writing directly to the storage of K instances,
-    // K must be trivially copyable.
+    // Since we're reading/writing directly to the storage of K and V instances,
+    // they must be trivially copyable.
     static_assert(std::is_trivially_copyable<K>::value, "K must be a trivially copyable type");
+    static_assert(std::is_trivially_copyable<V>::value, "V must be a trivially copyable type");
 
     // close any currently opened file
     Close();
+    m_filename = filename;
     m_num_entries = 0;
 
-    // try opening for reading/writing
-    File::OpenFStream(m_file, filename, ios_base::in | ios_base::out | ios_base::binary);
-
-    m_file.seekg(0, std::ios::end);
-    std::fstream::pos_type end_pos = m_file.tellg();
-    m_file.seekg(0, std::ios::beg);
-    std::fstream::pos_type start_pos = m_file.tellg();
-    std::streamoff file_size = end_pos - start_pos;
-
     m_header.Init();
-    if (m_file.is_open() && ValidateHeader())
+    if (m_mapping.Open(filename) && ValidateHeader())
     {
-      // good header, read some key/value pairs
-      K key;
-
-      V* value = nullptr;
-      u32 value_size = 0;
-      u32 entry_number = 0;
-
-      std::fstream::pos_type last_pos = m_file.tellg();
+      // good header, index the key/value pairs
+      const u64 valid_end = IndexEntries();
 
-      while (Read(&value_size))
+      // Appends overwrite anything after the last valid entry. The file is opened for that before
+      // any entries are passed to the reader, as it is recreated if that fails.
+      if (m_file.Open(filename, "r+b") && m_file.Seek(valid_end, SEEK_SET))
       {
-        std::streamoff next_extent = (last_pos - start_pos) + sizeof(value_size) + value_size;
-        if (next_extent > file_size)
-          break;
-
-        delete[] value;
-        value = new V[value_size];
-
-        // read key/value and pass to reader
-        if (Read(&key) && Read(value, value_size) && Read(&entry_number) &&
-            entry_number == m_num_entries + 1)
+        m_mapped_end = valid_end;
+        ReadLiveEntries(reader);
+        if (m_num_stale_entries >= MIN_STALE_ENTRIES_FOR_COMPACTION &&
+            m_num_stale_entries > m_num_entries)
         {
-          reader.Read(key, value, value_size);
+          m_compaction_thread = std::thread(&LinearDiskCache::Compact, this);
         }
         else
         {
-          break;
+          m_live_entries.clear();
         }
-
-        m_num_entries++;
-        last_pos = m_file.tellg();
+        return m_num_entries;
       }
-      m_file.seekp(last_pos);
-      m_file.clear();
-
-      delete[] value;
-      return m_num_entries;
     }
 
     // failed to open file for reading or bad header
     // close and recreate file
     Close();
-    File::OpenFStream(m_file, filename, ios_base::out | ios_base::trunc | ios_base::binary);
+    m_num_entries = 0;
+    m_file.Open(filename, "wb");
     WriteHeader();
     return 0;
   }
 
-  void Sync() { m_file.flush(); }
+  void Sync() { m_file.Flush(); }
   void Close()
   {
-    if (m_file.is_open())
-      m_file.close();
-    // clear any error flags
-    m_file.clear();
+    if (m_compaction_thread.joinable())
+    {
+      m_compaction_thread.join();
+      FinishCompaction();
+    }
+
+    m_file.Close();
+    m_mapping.Close();
+    m_live_entries.clear();
+    m_mapped_end = 0;
+    m_num_stale_entries = 0;
   }
 
   // Appends a key-value pair to the store.
@@ -137,33 +147,198 @@ public:
   {
     // TODO: Should do a check that we don't already have "key"? (I think each caller does that
     // already.)
-    Write(&value_size);
-    Write(&key);
-    Write(value, value_size);
+    // The entry is written in one go, checksum last, so a partial write is never mistaken for a
+    // valid entry.
+    const size_t value_bytes = value_size * sizeof(V);
+    m_append_buffer.resize(ENTRY_OVERHEAD + value_bytes);
+
+    u8* ptr = m_append_buffer.data();
+    std::memcpy(ptr, &value_size, sizeof(value_size));
+    std::memcpy(ptr + sizeof(value_size), &key, sizeof(K));
+    const u32 header_checksum = GetChecksum(ptr, HEADER_SIZE);
+    std::memcpy(ptr + HEADER_SIZE, &header_checksum, sizeof(header_checksum));
+
+    u8* const value_ptr = ptr + HEADER_SIZE + sizeof(header_checksum);
+    if (value_bytes != 0)
+      std::memcpy(value_ptr, value, value_bytes);
+    const u32 value_checksum = GetChecksum(value_ptr, value_bytes);
+    std::memcpy(value_ptr + value_bytes, &value_checksum, sizeof(value_checksum));
+
+    m_file.WriteBytes(m_append_buffer.data(), m_append_buffer.size());
     m_num_entries++;
-    Write(&m_num_entries);
   }
 
 private:
-  void WriteHeader() { Write(&m_header); }
-  bool ValidateHeader()
+  static constexpr u32 FORMAT_VERSION = 4;
+  // Size of the value size and the key, which are covered by the header checksum.
+  static constexpr size_t HEADER_SIZE = sizeof(u32) + sizeof(K);
+  static constexpr size_t ENTRY_OVERHEAD = HEADER_SIZE + sizeof(u32) + sizeof(u32);
+  static constexpr u32 MIN_STALE_ENTRIES_FOR_COMPACTION = 256;
+
+  struct KeyHash
+  {
+    size_t operator()(const K& key) const
+    {
+      return std::hash<std::string_view>()(
+          std::string_view(reinterpret_cast<const char*>(&key), sizeof(K)));
+    }
+  };
+
+  struct KeyEqual
+  {
+    bool operator()(const K& a, const K& b) const { return std::memcmp(&a, &b, sizeof(K)) == 0; }
+  };
+
+  // Location of an entry in the mapping, including its size and checksums.
+  struct EntryLocation
   {
-    char file_header[sizeof(Header)];
+    u64 offset;
+    u64 size;
+  };
 
-    return (Read(file_header, sizeof(Header)) &&
-            !memcmp((const char*)&m_header, file_header, sizeof(Header)));
+  static u32 GetChecksum(const u8* data, u64 size)
+  {
+    return Common::HashAdler32(data, static_cast<size_t>(size));
   }
 
-  template <typename D>
-  bool Write(const D* data, u32 count = 1)
+  // Finds the live entries. Returns the offset just past the last entry with a valid header.
+  // Values are not checked here, see ReadLiveEntries.
+  u64 IndexEntries()
   {
-    return m_file.write(reinterpret_cast<const char*>(data), count * sizeof(D)).good();
+    const u8* const data = m_mapping.GetData();
+    const u64 file_size = m_mapping.GetSize();
+
+    // Index all valid entries first. Later entries for a key supersede earlier ones.
+    std::unordered_map<K, size_t, KeyHash, KeyEqual> index;
+    std::vector<EntryLocation> entries;
+    u64 offset = sizeof(Header);
+    while (file_size - offset >= ENTRY_OVERHEAD)
+    {
+      u32 value_size;
+      K key;
+      std::memcpy(&value_size, data + offset, sizeof(value_size));
+      std::memcpy(&key, data + offset + sizeof(value_size), sizeof(K));
+
+      const u64 entry_size = ENTRY_OVERHEAD + u64(value_size) * sizeof(V);
+      if (entry_size > file_size - offset)
+        break;
+
+      u32 header_checksum;
+      std::memcpy(&header_checksum, data + offset + HEADER_SIZE, sizeof(header_checksum));
+      if (header_checksum != GetChecksum(data + offset, HEADER_SIZE))
+        break;
+
+      const auto [it, inserted] = index.try_emplace(key, entries.size());
+      if (!inserted)
+      {
+        entries[it->second].size = 0;
+        it->second = entries.size();
+        m_num_stale_entries++;
+      }
+
+      entries.push_back({offset, entry_size});
+      offset += entry_size;
+    }
+
+    std::copy_if(entries.begin(), entries.end(), std::back_inserter(m_live_entries),
+                 [](const EntryLocation& entry) { return entry.size != 0; });
+    return offset;
+  }
+
+  // Passes the live entries to the reader in file order. Entries with a corrupted value are
+  // skipped, and count as stale so that compaction gets rid of them.
+  void ReadLiveEntries(LinearDiskCacheReader<K, V>& reader)
+  {
+    const u8* const data = m_mapping.GetData();
+    std::vector<V> aligned_value;
+    auto kept_end = m_live_entries.begin();
+    for (const EntryLocation& entry : m_live_entries)
+    {
+      K key;
+      u32 value_size;
+      std::memcpy(&value_size, data + entry.offset, sizeof(value_size));
+      std::memcpy(&key, data + entry.offset + sizeof(value_size), sizeof(K));
+
+      const u8* value_ptr = data + entry.offset + HEADER_SIZE + sizeof(u32);
+      const u64 value_bytes = entry.size - ENTRY_OVERHEAD;
+      u32 value_checksum;
+      std::memcpy(&value_checksum, value_ptr + value_bytes, sizeof(value_checksum));
+      if (value_checksum != GetChecksum(value_ptr, value_bytes))
+      {
+        m_num_stale_entries++;
+        continue;
+      }
+      *kept_end++ = entry;
+
+      const V* value = reinterpret_cast<const V*>(value_ptr);
+      if (reinterpret_cast<uintptr_t>(value_ptr) % alignof(V) != 0)
+      {
+        aligned_value.resize(value_size);
+        std::memcpy(aligned_value.data(), value_ptr, value_size * sizeof(V));
+        value = aligned_value.data();
+      }
+
+      reader.Read(key, value, value_size);
+      m_num_entries++;
+    }
+    m_live_entries.erase(kept_end, m_live_entries.end());
+  }
+
+  // Runs on the compaction thread. Only reads the mapping, which does not change while the
+  // cache is open.
+  void Compact()
+  {
+    m_compaction_succeeded = false;
+
+    File::IOFile compacted(GetCompactionFilename(), "wb");
+    if (!compacted.WriteBytes(&m_header, sizeof(Header)))
+      return;
+
+    const u8* const data = m_mapping.GetData();
+    for (const EntryLocation& entry : m_live_entries)
+    {
+      if (!compacted.WriteBytes(data + entry.offset, entry.size))
+        return;
+    }
+
+    m_compaction_succeeded = compacted.Close();
+  }
+
+  // Adds the entries that were appended while compacting, then replaces the cache file.
+  void FinishCompaction()
+  {
+    const std::string compaction_filename = GetCompactionFilename();
+    bool success = m_compaction_succeeded && m_file.Flush();
+    if (success)
+    {
+      const u64 append_end = m_file.Tell();
+      File::IOFile compacted(compaction_filename, "ab");
+      std::vector<u8> buffer(std::min<u64>(append_end - m_mapped_end, 1 << 20));
+      success = compacted.IsOpen() && m_file.Seek(m_mapped_end, SEEK_SET);
+      for (u64 offset = m_mapped_end; success && offset < append_end; offset += buffer.size())
+      {
+        const size_t chunk_size =
+            static_cast<size_t>(std::min<u64>(buffer.size(), append_end - offset));
+        success = m_file.ReadBytes(buffer.data(), chunk_size) &&
+                  compacted.WriteBytes(buffer.data(), chunk_size);
+      }
+      success = compacted.Close() && success;
+    }
+
+    // The old file has to be closed before it can be replaced on Windows.
+    m_file.Close();
+    m_mapping.Close();
+    if (!success || !File::RenameSync(compaction_filename, m_filename))
+      File::Delete(compaction_filename);
   }
 
-  template <typename D>
-  bool Read(D* data, u32 count = 1)
+  std::string GetCompactionFilename() const { return m_filename + ".compact"; }
+
+  void WriteHeader() { m_file.WriteBytes(&m_header, sizeof(Header)); }
+  bool ValidateHeader()
   {
-    return m_file.read(reinterpret_cast<char*>(data), count * sizeof(D)).good();
+    return m_mapping.GetSize() >= sizeof(Header) &&
+           !std::memcmp(&m_header, m_mapping.GetData(), sizeof(Header));
   }
 
   struct Header
@@ -177,12 +352,23 @@ private:
     }
 
     u32 id;
+    const u32 format_version = FORMAT_VERSION;
     const u16 key_t_size = sizeof(K);
     const u16 value_t_size = sizeof(V);
     char ver[40] = {};
 
   } m_header;
 
-  std::fstream m_file;
-  u32 m_num_entries;
+  std::string m_filename;
+  File::MappedFile m_mapping;
+  File::IOFile m_file;
+  std::vector<u8> m_append_buffer;
+  u32 m_num_entries = 0;
+  u32 m_num_stale_entries = 0;
+
+  // Compaction state. The thread only reads these and the mapping.
+  std::vector<EntryLocation> m_live_entries;
+  u64 m_mapped_end = 0;
+  std::thread m_compaction_thread;
+  bool m_compaction_succeeded = false;
 };
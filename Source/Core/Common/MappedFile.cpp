@@ -0,0 +1,147 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Common/MappedFile.h"
+
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+
+#include "Common/StringUtil.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Common/CommonFuncs.h"
+#include "Common/CommonTypes.h"
+#include "Common/Logging/Log.h"
+
+namespace File
+{
+MappedFile::MappedFile(const std::string& filename)
+{
+  Open(filename);
+}
+
+MappedFile::~MappedFile()
+{
+  Close();
+}
+
+#ifdef _WIN32
+bool MappedFile::Open(const std::string& filename)
+{
+  Close();
+
+  // Allow others (including ourselves) to keep writing to the file while it is mapped.
+  const HANDLE file = CreateFileW(UTF8ToTStr(filename).c_str(), GENERIC_READ,
+                                  FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size))
+  {
+    CloseHandle(file);
+    return false;
+  }
+
+  if (size.QuadPart == 0)
+  {
+    CloseHandle(file);
+    m_is_open = true;
+    return true;
+  }
+
+  // The mapping object keeps its own reference to the file.
+  const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (!mapping)
+  {
+    ERROR_LOG(COMMON, "Failed to map %s: %s", filename.c_str(), GetLastErrorString().c_str());
+    return false;
+  }
+
+  void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!view)
+  {
+    ERROR_LOG(COMMON, "Failed to map %s: %s", filename.c_str(), GetLastErrorString().c_str());
+    CloseHandle(mapping);
+    return false;
+  }
+
+  m_mapping_handle = mapping;
+  m_data = static_cast<const u8*>(view);
+  m_size = static_cast<size_t>(size.QuadPart);
+  m_is_open = true;
+  return true;
+}
+
+void MappedFile::Close()
+{
+  if (m_data)
+    UnmapViewOfFile(m_data);
+  if (m_mapping_handle)
+    CloseHandle(m_mapping_handle);
+
+  m_mapping_handle = nullptr;
+  m_data = nullptr;
+  m_size = 0;
+  m_is_open = false;
+}
+#else
+bool MappedFile::Open(const std::string& filename)
+{
+  Close();
+
+  const int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return false;
+
+  struct stat file_info;
+  if (fstat(fd, &file_info) != 0)
+  {
+    close(fd);
+    return false;
+  }
+
+  if (file_info.st_size == 0)
+  {
+    close(fd);
+    m_is_open = true;
+    return true;
+  }
+
+  const size_t size = static_cast<size_t>(file_info.st_size);
+  void* view = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping stays valid after the descriptor is closed.
+  close(fd);
+  if (view == MAP_FAILED)
+  {
+    ERROR_LOG(COMMON, "Failed to map %s: %s", filename.c_str(), LastStrerrorString().c_str());
+    return false;
+  }
+
+  m_data = static_cast<const u8*>(view);
+  m_size = size;
+  m_is_open = true;
+  return true;
+}
+
+void MappedFile::Close()
+{
+  if (m_data)
+    munmap(const_cast<u8*>(m_data), m_size);
+
+  m_data = nullptr;
+  m_size = 0;
+  m_is_open = false;
+}
+#endif
+}  // namespace File
@@ -0,0 +1,46 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "Common/CommonTypes.h"
+
+namespace File
+{
+// Read-only memory mapping of a whole file. Pages are only read from disk when they are
+// accessed, so large files can be opened cheaply when only parts of them are used.
+//
+// The mapping reflects the file contents at the time it was opened. Appending to the file
+// while it is mapped is fine, but the new data is not visible through the mapping.
+class MappedFile
+{
+public:
+  MappedFile() = default;
+  explicit MappedFile(const std::string& filename);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // Empty files can be opened, but have no data pointer.
+  bool Open(const std::string& filename);
+  void Close();
+
+  bool IsOpen() const { return m_is_open; }
+  const u8* GetData() const { return m_data; }
+  size_t GetSize() const { return m_size; }
+
+private:
+  const u8* m_data = nullptr;
+  size_t m_size = 0;
+  bool m_is_open = false;
+
+#ifdef _WIN32
+  void* m_mapping_handle = nullptr;
+#endif
+};
+}  // namespace File
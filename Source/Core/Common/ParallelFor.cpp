@@ -0,0 +1,136 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Common/ParallelFor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Common/Thread.h"
+
+namespace Common
+{
+namespace
+{
+class WorkerPool
+{
+public:
+  WorkerPool()
+  {
+    // The calling thread does its share of the work as well.
+    const unsigned int num_workers = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    m_workers.reserve(num_workers);
+    for (unsigned int i = 0; i < num_workers; ++i)
+      m_workers.emplace_back(&WorkerPool::WorkerLoop, this);
+  }
+
+  ~WorkerPool()
+  {
+    {
+      std::lock_guard lk(m_mutex);
+      m_shutdown = true;
+    }
+    m_work_available.notify_all();
+
+    for (std::thread& worker : m_workers)
+      worker.join();
+  }
+
+  void Run(size_t count, const std::function<void(size_t)>& func)
+  {
+    Job job{func, count};
+    std::list<Job*>::iterator it;
+    {
+      std::lock_guard lk(m_mutex);
+      it = m_jobs.insert(m_jobs.end(), &job);
+    }
+    m_work_available.notify_all();
+
+    RunItems(&job);
+
+    // All items have been claimed at this point, but workers may still be running some of them.
+    std::unique_lock lk(m_mutex);
+    m_jobs.erase(it);
+    m_job_done.wait(lk, [&job] { return job.active_workers == 0; });
+  }
+
+private:
+  struct Job
+  {
+    const std::function<void(size_t)>& func;
+    size_t count;
+    std::atomic<size_t> next_index{0};
+    size_t active_workers = 0;
+  };
+
+  static void RunItems(Job* job)
+  {
+    for (size_t i = job->next_index++; i < job->count; i = job->next_index++)
+      job->func(i);
+  }
+
+  // Returns the oldest job that still has unclaimed items, or nullptr. m_mutex must be held.
+  Job* FindJob() const
+  {
+    for (Job* job : m_jobs)
+    {
+      if (job->next_index < job->count)
+        return job;
+    }
+    return nullptr;
+  }
+
+  void WorkerLoop()
+  {
+    SetCurrentThreadName("ParallelFor Worker");
+
+    std::unique_lock lk(m_mutex);
+    while (true)
+    {
+      Job* job = nullptr;
+      m_work_available.wait(lk, [this, &job] { return m_shutdown || (job = FindJob()); });
+      if (m_shutdown)
+        return;
+
+      ++job->active_workers;
+      lk.unlock();
+
+      RunItems(job);
+
+      lk.lock();
+      if (--job->active_workers == 0)
+        m_job_done.notify_all();
+    }
+  }
+
+  std::vector<std::thread> m_workers;
+
+  std::mutex m_mutex;
+  std::condition_variable m_work_available;
+  std::condition_variable m_job_done;
+  std::list<Job*> m_jobs;
+  bool m_shutdown = false;
+};
+}  // namespace
+
+void ParallelFor(size_t count, const std::function<void(size_t)>& func)
+{
+  if (count <= 1)
+  {
+    if (count == 1)
+      func(0);
+    return;
+  }
+
+  static WorkerPool s_pool;
+  s_pool.Run(count, func);
+}
+}  // namespace Common
@@ -0,0 +1,20 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace Common
+{
+// Calls func(i) for every i in [0, count) and returns once all calls are done. The calls are
+// spread across a set of worker threads that is started once and shared by every caller, and the
+// calling thread helps out too, so a call always makes progress even while the workers are busy
+// with the jobs of other threads.
+//
+// func must be safe to call from several threads at once. Can be called from any thread,
+// including from several threads at the same time.
+void ParallelFor(size_t count, const std::function<void(size_t)>& func);
+}  // namespace Common
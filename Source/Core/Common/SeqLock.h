@@ -0,0 +1,67 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+// A lock-free snapshot of a small value, written by a single thread and read by any number
+// of threads. Readers never block the writer; they retry if it published while they read.
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+#include "Common/CommonTypes.h"
+
+namespace Common
+{
+template <typename T>
+class SeqLock
+{
+  static_assert(std::is_trivially_copyable_v<T>, "SeqLock values are copied word by word");
+
+public:
+  SeqLock() { Store(T{}); }
+
+  // Must only be called from one thread at a time
+  void Store(const T& value)
+  {
+    std::array<u64, WORD_COUNT> words{};
+    std::memcpy(words.data(), &value, sizeof(T));
+
+    // An odd sequence tells readers that a write is in progress
+    const u32 sequence = m_sequence.load(std::memory_order_relaxed);
+    m_sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_t i = 0; i < WORD_COUNT; ++i)
+      m_words[i].store(words[i], std::memory_order_relaxed);
+
+    m_sequence.store(sequence + 2, std::memory_order_release);
+  }
+
+  T Load() const
+  {
+    std::array<u64, WORD_COUNT> words;
+    u32 sequence;
+    do
+    {
+      sequence = m_sequence.load(std::memory_order_acquire);
+      for (size_t i = 0; i < WORD_COUNT; ++i)
+        words[i] = m_words[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((sequence & 1) != 0 || sequence != m_sequence.load(std::memory_order_relaxed));
+
+    T value;
+    std::memcpy(&value, words.data(), sizeof(T));
+    return value;
+  }
+
+private:
+  static constexpr size_t WORD_COUNT = (sizeof(T) + sizeof(u64) - 1) / sizeof(u64);
+
+  std::atomic<u32> m_sequence{0};
+  std::array<std::atomic<u64>, WORD_COUNT> m_words{};
+};
+}  // namespace Common
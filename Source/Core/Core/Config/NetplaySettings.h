@@ -48,6 +48,7 @@ extern const ConfigInfo<bool> NETPLAY_SYNC_SAVES;
 extern const ConfigInfo<bool> NETPLAY_SYNC_CODES;
 extern const ConfigInfo<bool> NETPLAY_RECORD_INPUTS;
 extern const ConfigInfo<bool> NETPLAY_STRICT_SETTINGS_SYNC;
+extern const ConfigInfo<bool> NETPLAY_DIAGNOSE_DESYNCS;
 extern const ConfigInfo<std::string> NETPLAY_NETWORK_MODE;
 extern const ConfigInfo<bool> NETPLAY_SYNC_ALL_WII_SAVES;
 extern const ConfigInfo<bool> NETPLAY_GOLF_MODE_OVERLAY;
@@ -28,13 +28,14 @@ bool IsSettingSaveable(const Config::ConfigLocation& config_location)
       return true;
   }
 
-  static constexpr std::array<const Config::ConfigLocation*, 93> s_setting_saveable = {
+  static constexpr std::array<const Config::ConfigLocation*, 94> s_setting_saveable = {
       // Main.Core
 
       &Config::MAIN_DEFAULT_ISO.location,
       &Config::MAIN_MEMCARD_A_PATH.location,
       &Config::MAIN_MEMCARD_B_PATH.location,
       &Config::MAIN_AUTO_DISC_CHANGE.location,
+      &Config::MAIN_DISC_READ_CACHE_SIZE.location,
       &Config::MAIN_DPL2_DECODER.location,
       &Config::MAIN_DPL2_QUALITY.location,
 
@@ -104,6 +104,7 @@ static StateChangedCallbackFunc s_on_state_changed_callback;
 static std::thread s_cpu_thread;
 static bool s_request_refresh_info = false;
 static bool s_is_throttler_temp_disabled = false;
+static bool s_is_resimulating = false;
 static bool s_frame_step = false;
 static std::atomic<bool> s_stop_frame_step;
 
@@ -134,6 +135,16 @@ void SetIsThrottlerTempDisabled(bool disable)
   s_is_throttler_temp_disabled = disable;
 }
 
+bool IsResimulating()
+{
+  return s_is_resimulating;
+}
+
+void SetIsResimulating(bool resimulating)
+{
+  s_is_resimulating = resimulating;
+}
+
 void FrameUpdateOnCPUThread()
 {
   if (NetPlay::IsNetPlayRunning())
@@ -25,6 +25,11 @@ namespace Core
 bool GetIsThrottlerTempDisabled();
 void SetIsThrottlerTempDisabled(bool disable);
 
+// While set, emulation runs unthrottled, and finished fields and audio aren't presented.
+// NetPlay's rollback mode uses this to catch up again after loading a state.
+bool IsResimulating();
+void SetIsResimulating(bool resimulating);
+
 void Callback_FramePresented();
 void Callback_NewField();
 
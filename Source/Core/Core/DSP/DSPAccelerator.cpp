@@ -161,6 +161,14 @@ u16 Accelerator::Read(const s16* coefs)
   return val;
 }
 
+void Accelerator::ReadSamples(const s16* coefs, s16* output, u32 count)
+{
+  u32 i = 0;
+  for (; i < count && !m_reads_stopped; ++i)
+    output[i] = static_cast<s16>(Read(coefs));
+  std::fill(output + i, output + count, s16(0));
+}
+
 void Accelerator::DoState(PointerWrap& p)
 {
   p.Do(m_start_address);
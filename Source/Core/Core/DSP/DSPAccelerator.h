@@ -16,6 +16,9 @@ public:
   virtual ~Accelerator() = default;
 
   u16 Read(const s16* coefs);
+  // Reads <count> samples in one go. Once reads are stopped by an end exception that is not
+  // handled by the owner, the remaining samples are all 0.
+  void ReadSamples(const s16* coefs, s16* output, u32 count);
   // Zelda ucode reads ARAM through 0xffd3.
   u16 ReadD3();
   void WriteD3(u16 value);
@@ -9,6 +9,7 @@
 
 #include "Common/Logging/Log.h"
 
+#include "Core/DSP/DSPCore.h"
 #include "Core/DSP/DSPMemoryMap.h"
 #include "Core/DSP/DSPTables.h"
 
@@ -67,6 +68,79 @@ constexpr u16 idle_skip_sigs[NUM_IDLE_SIGS][MAX_IDLE_SIG_SIZE + 1] = {
      0x0295, 0xFFFF,  // JZ    0x????
      0, 0}};
 
+// Besides the signatures above, any short backwards conditional jump whose body
+// only polls a mailbox and tests the result is treated as an idle loop. Such a
+// loop cannot make progress until the CPU side writes or reads a mail, so
+// running it more than once per time slice is wasted work.
+constexpr u16 MAX_IDLE_LOOP_SIZE = 8;
+
+// Returns true if the instruction can be part of a polling loop body: it has no
+// side effect other than writing a register in an idempotent way or setting
+// flags. Sets is_poll if the instruction reads a mailbox high register, which
+// has no side effect unlike the low half.
+bool IsIdleLoopInstruction(UDSPInstruction inst, const DSPOPCTemplate* opcode, u16 addr,
+                           bool* is_poll)
+{
+  // Extended instructions are only allowed with a no-op extension.
+  if (opcode->extended && GetExtOpTemplate(inst)->opcode != 0x0000)
+    return false;
+
+  switch (opcode->opcode)
+  {
+  case 0x00c0:  // LR
+  {
+    const u16 reg = inst & 0x1f;
+    const u16 mem = dsp_imem_read(static_cast<u16>(addr + 1));
+    // Writing to the stacks, SR or CR would not be idempotent.
+    if ((reg >= DSP_REG_ST0 && reg <= DSP_REG_ST3) || reg == DSP_REG_SR || reg == DSP_REG_CR)
+      return false;
+    const bool polls = mem == (0xff00 | DSP_DMBH) || mem == (0xff00 | DSP_CMBH);
+    *is_poll |= polls;
+    // Other hardware registers (e.g. the accelerator) may have read side effects.
+    return mem < 0xff00 || polls;
+  }
+  case 0x2000:  // LRS
+  {
+    // The high byte of the address comes from $cr, which is 0xff in practice.
+    const u8 mem = inst & 0xff;
+    const bool polls = mem == DSP_DMBH || mem == DSP_CMBH;
+    *is_poll |= polls;
+    return polls;
+  }
+  case 0x0000:  // NOP
+  case 0x0240:  // ANDI
+  case 0x0280:  // CMPI
+  case 0x02a0:  // ANDF
+  case 0x02c0:  // ANDCF
+  case 0x0600:  // CMPIS
+  case 0x3400:  // ANDR
+  case 0x8200:  // CMP
+  case 0x8600:  // TSTAXH
+  case 0xb100:  // TST
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Checks whether the code between loop_start and the conditional jump at
+// jump_addr (which branches back to loop_start) is a mailbox polling loop.
+bool IsIdleLoop(u16 loop_start, u16 jump_addr)
+{
+  bool polls_mailbox = false;
+  u16 addr = loop_start;
+  while (addr < jump_addr)
+  {
+    const UDSPInstruction inst = dsp_imem_read(addr);
+    const DSPOPCTemplate* opcode = GetOpTemplate(inst);
+    if (!opcode || !IsIdleLoopInstruction(inst, opcode, addr, &polls_mailbox))
+      return false;
+    addr += opcode->size;
+  }
+  // The body must end exactly on the jump for the decoding to be meaningful.
+  return addr == jump_addr && polls_mailbox;
+}
+
 void Reset()
 {
   code_flags.fill(0);
@@ -115,6 +189,17 @@ void AnalyzeRange(u16 start_addr, u16 end_addr)
     if (opcode->branch && !opcode->uncond_branch)
     {
       code_flags[last_arithmetic] |= CODE_UPDATE_SR;
+
+      // Look for generic idle loops: Jcc back to the start of a polling loop.
+      if ((inst & 0xfff0) == 0x0290)
+      {
+        const u16 dest = dsp_imem_read(static_cast<u16>(addr + 1));
+        if (dest <= addr && addr - dest <= MAX_IDLE_LOOP_SIZE && IsIdleLoop(dest, addr))
+        {
+          INFO_LOG(DSPLLE, "Idle loop found at %04x-%04x", dest, addr);
+          code_flags[dest] |= CODE_IDLE_SKIP;
+        }
+      }
     }
 
     // If an instruction potentially raises exceptions, mark the following
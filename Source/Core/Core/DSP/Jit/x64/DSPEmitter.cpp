@@ -121,6 +121,18 @@ void DSPEmitter::checkExceptions(u32 retval)
   SetJumpTarget(skipCheck);
 }
 
+bool DSPEmitter::IsIdleSkipBlock() const
+{
+  return !Host::OnThread() && (Analyzer::GetCodeFlags(m_start_address) & Analyzer::CODE_IDLE_SKIP);
+}
+
+// Idle loops report a large cycle count when leaving the block, so that the DSP
+// gives up the rest of its time slice instead of spinning on the mailbox.
+u16 DSPEmitter::GetBlockExitCycles() const
+{
+  return IsIdleSkipBlock() ? DSP_IDLE_SKIP_CYCLES : m_block_size[m_start_address];
+}
+
 bool DSPEmitter::FlagsNeeded() const
 {
   const u8 flags = Analyzer::GetCodeFlags(m_compile_pc);
@@ -265,14 +277,7 @@ void DSPEmitter::Compile(u16 start_addr)
       DSPJitRegCache c(m_gpr);
       HandleLoop();
       m_gpr.SaveRegs();
-      if (!Host::OnThread() && Analyzer::GetCodeFlags(start_addr) & Analyzer::CODE_IDLE_SKIP)
-      {
-        MOV(16, R(EAX), Imm16(DSP_IDLE_SKIP_CYCLES));
-      }
-      else
-      {
-        MOV(16, R(EAX), Imm16(m_block_size[start_addr]));
-      }
+      MOV(16, R(EAX), Imm16(GetBlockExitCycles()));
       JMP(m_return_dispatcher, true);
       m_gpr.LoadRegs(false);
       m_gpr.FlushRegs(c, false);
@@ -301,14 +306,7 @@ void DSPEmitter::Compile(u16 start_addr)
         DSPJitRegCache c(m_gpr);
         // don't update g_dsp.pc -- the branch insn already did
         m_gpr.SaveRegs();
-        if (!Host::OnThread() && Analyzer::GetCodeFlags(start_addr) & Analyzer::CODE_IDLE_SKIP)
-        {
-          MOV(16, R(EAX), Imm16(DSP_IDLE_SKIP_CYCLES));
-        }
-        else
-        {
-          MOV(16, R(EAX), Imm16(m_block_size[start_addr]));
-        }
+        MOV(16, R(EAX), Imm16(GetBlockExitCycles()));
         JMP(m_return_dispatcher, true);
         m_gpr.LoadRegs(false);
         m_gpr.FlushRegs(c, false);
@@ -327,6 +325,11 @@ void DSPEmitter::Compile(u16 start_addr)
   if (fixup_pc)
   {
     MOV(16, M_SDSP_pc(), Imm16(m_compile_pc));
+
+    // Link straight into the next block when falling through, unless it is
+    // the block itself (a wrap-around at the end of the address space).
+    if (m_compile_pc != start_addr)
+      WriteBlockLinkUnchecked(m_compile_pc);
   }
 
   m_blocks[start_addr] = (DSPCompiledCode)entryPoint;
@@ -364,14 +367,7 @@ void DSPEmitter::Compile(u16 start_addr)
   }
 
   m_gpr.SaveRegs();
-  if (!Host::OnThread() && Analyzer::GetCodeFlags(start_addr) & Analyzer::CODE_IDLE_SKIP)
-  {
-    MOV(16, R(EAX), Imm16(DSP_IDLE_SKIP_CYCLES));
-  }
-  else
-  {
-    MOV(16, R(EAX), Imm16(m_block_size[start_addr]));
-  }
+  MOV(16, R(EAX), Imm16(GetBlockExitCycles()));
   JMP(m_return_dispatcher, true);
 }
 
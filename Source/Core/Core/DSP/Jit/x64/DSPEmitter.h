@@ -208,8 +208,11 @@ private:
 
   void FallBackToInterpreter(UDSPInstruction inst);
 
+  bool IsIdleSkipBlock() const;
+  u16 GetBlockExitCycles() const;
   void WriteBranchExit();
   void WriteBlockLink(u16 dest);
+  void WriteBlockLinkUnchecked(u16 dest);
 
   void ReJitConditional(UDSPInstruction opc, void (DSPEmitter::*conditional_fn)(UDSPInstruction));
   void r_jcc(UDSPInstruction opc);
@@ -83,14 +83,7 @@ void DSPEmitter::WriteBranchExit()
 {
   DSPJitRegCache c(m_gpr);
   m_gpr.SaveRegs();
-  if (Analyzer::GetCodeFlags(m_start_address) & Analyzer::CODE_IDLE_SKIP)
-  {
-    MOV(16, R(EAX), Imm16(0x1000));
-  }
-  else
-  {
-    MOV(16, R(EAX), Imm16(m_block_size[m_start_address]));
-  }
+  MOV(16, R(EAX), Imm16(GetBlockExitCycles()));
   JMP(m_return_dispatcher, true);
   m_gpr.LoadRegs(false);
   m_gpr.FlushRegs(c, false);
@@ -100,38 +93,44 @@ void DSPEmitter::WriteBlockLink(u16 dest)
 {
   // Jump directly to the called block if it has already been compiled.
   if (!(dest >= m_start_address && dest <= m_compile_pc))
+    WriteBlockLinkUnchecked(dest);
+}
+
+void DSPEmitter::WriteBlockLinkUnchecked(u16 dest)
+{
+  // Idle loops must go through the dispatcher so that they can give up the
+  // time slice.
+  if (IsIdleSkipBlock())
+    return;
+
+  if (m_block_links[dest] != nullptr)
+  {
+    m_gpr.FlushRegs();
+    // Check if we have enough cycles to execute the next block
+    MOV(64, R(RAX), ImmPtr(&m_cycles_left));
+    MOV(16, R(ECX), MatR(RAX));
+    CMP(16, R(ECX), Imm16(m_block_size[m_start_address] + m_block_size[dest]));
+    FixupBranch notEnoughCycles = J_CC(CC_BE);
+
+    SUB(16, R(ECX), Imm16(m_block_size[m_start_address]));
+    MOV(16, MatR(RAX), R(ECX));
+    JMP(m_block_links[dest], true);
+    SetJumpTarget(notEnoughCycles);
+  }
+  else
   {
-    if (m_block_links[dest] != nullptr)
-    {
-      m_gpr.FlushRegs();
-      // Check if we have enough cycles to execute the next block
-      MOV(64, R(RAX), ImmPtr(&m_cycles_left));
-      MOV(16, R(ECX), MatR(RAX));
-      CMP(16, R(ECX), Imm16(m_block_size[m_start_address] + m_block_size[dest]));
-      FixupBranch notEnoughCycles = J_CC(CC_BE);
-
-      SUB(16, R(ECX), Imm16(m_block_size[m_start_address]));
-      MOV(16, MatR(RAX), R(ECX));
-      JMP(m_block_links[dest], true);
-      SetJumpTarget(notEnoughCycles);
-    }
-    else
-    {
-      // The destination has not been compiled yet.  Add it to the list
-      // of blocks that this block is waiting on.
-      m_unresolved_jumps[m_start_address].push_back(dest);
-    }
+    // The destination has not been compiled yet.  Add it to the list
+    // of blocks that this block is waiting on.
+    m_unresolved_jumps[m_start_address].push_back(dest);
   }
 }
 
 void DSPEmitter::r_jcc(const UDSPInstruction opc)
 {
   u16 dest = dsp_imem_read(m_compile_pc + 1);
-  const DSPOPCTemplate* opcode = GetOpTemplate(opc);
 
-  // If the block is unconditional, attempt to link block
-  if (opcode->uncond_branch)
-    WriteBlockLink(dest);
+  // Link both unconditional jumps and the taken path of conditional ones.
+  WriteBlockLink(dest);
   MOV(16, M_SDSP_pc(), Imm16(dest));
   WriteBranchExit();
 }
@@ -173,11 +172,9 @@ void DSPEmitter::r_call(const UDSPInstruction opc)
   MOV(16, R(DX), Imm16(m_compile_pc + 2));
   dsp_reg_store_stack(StackRegister::Call);
   u16 dest = dsp_imem_read(m_compile_pc + 1);
-  const DSPOPCTemplate* opcode = GetOpTemplate(opc);
 
-  // If the block is unconditional, attempt to link block
-  if (opcode->uncond_branch)
-    WriteBlockLink(dest);
+  // Link both unconditional calls and the taken path of conditional ones.
+  WriteBlockLink(dest);
   MOV(16, M_SDSP_pc(), Imm16(dest));
   WriteBranchExit();
 }
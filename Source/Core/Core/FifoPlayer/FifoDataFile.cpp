@@ -10,13 +10,21 @@
 #include <string>
 #include <vector>
 
+#include <zlib.h>
+
+#include "Common/Crypto/SHA1.h"
 #include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
+#include "Common/WorkQueueThread.h"
 
 enum
 {
   FILE_ID = 0x0d01f1f0,
-  VERSION_NUMBER = 4,
+  VERSION_NUMBER = 5,
   MIN_LOADER_VERSION = 1,
+  // Version 5 changed the frame data to compressed chunks, which older versions can't read
+  MIN_STREAMED_LOADER_VERSION = 5,
 };
 
 #pragma pack(push, 1)
@@ -39,7 +47,10 @@ struct FileHeader
   u32 flags;
   u64 texMemOffset;
   u32 texMemSize;
-  u8 reserved[40];
+  // Added in version 5
+  u64 fifoDataSize;
+  u64 memoryUpdatesSize;
+  u8 reserved[24];
 };
 static_assert(sizeof(FileHeader) == 128, "FileHeader should be 128 bytes");
 
@@ -66,8 +77,43 @@ struct FileMemoryUpdate
 };
 static_assert(sizeof(FileMemoryUpdate) == 24, "FileMemoryUpdate should be 24 bytes");
 
+// Version 5 stores each frame and each distinct memory update as a chunk, which is compressed
+// with zlib unless that doesn't make it smaller. The frame list is an array of FileChunk.
+struct FileChunk
+{
+  u64 offset;
+  u32 storedSize;
+  u32 size;
+};
+static_assert(sizeof(FileChunk) == 16, "FileChunk should be 16 bytes");
+
+// A frame chunk starts with this, followed by the FIFO data and numMemoryUpdates
+// FileStreamedMemoryUpdate.
+struct FileStreamedFrame
+{
+  u32 fifoStart;
+  u32 fifoEnd;
+  u32 fifoDataSize;
+  u32 numMemoryUpdates;
+};
+static_assert(sizeof(FileStreamedFrame) == 16, "FileStreamedFrame should be 16 bytes");
+
+struct FileStreamedMemoryUpdate
+{
+  u32 fifoPosition;
+  u32 address;
+  FileChunk data;
+  u8 type;
+  u8 reserved[7];
+};
+static_assert(sizeof(FileStreamedMemoryUpdate) == 32,
+              "FileStreamedMemoryUpdate should be 32 bytes");
+
 #pragma pack(pop)
 
+// Frames that are still waiting to be compressed when recording faster than that
+constexpr size_t MAX_QUEUED_FRAMES = 16;
+
 FifoDataFile::FifoDataFile() = default;
 
 FifoDataFile::~FifoDataFile() = default;
@@ -94,96 +140,67 @@ bool FifoDataFile::GetIsWii() const
 
 void FifoDataFile::AddFrame(const FifoFrameInfo& frameInfo)
 {
-  m_Frames.push_back(frameInfo);
+  m_FifoDataSize += frameInfo.fifoData.size();
+  for (const MemoryUpdate& update : frameInfo.memoryUpdates)
+    m_MemoryUpdatesSize += update.data.size();
+
+  m_Frames.push_back(std::make_shared<const FifoFrameInfo>(frameInfo));
 }
 
-bool FifoDataFile::Save(const std::string& filename)
+std::shared_ptr<const FifoFrameInfo> FifoDataFile::GetFrame(u32 frame) const
 {
-  File::IOFile file;
-  if (!file.Open(filename, "wb"))
-    return false;
-
-  // Add space for header
-  PadFile(sizeof(FileHeader), file);
+  if (!m_StreamFile)
+    return m_Frames[frame];
 
-  // Add space for frame list
-  u64 frameListOffset = file.Tell();
-  PadFile(m_Frames.size() * sizeof(FileFrameInfo), file);
+  std::lock_guard<std::mutex> lk(m_StreamMutex);
 
-  u64 bpMemOffset = file.Tell();
-  file.WriteArray(m_BPMem, BP_MEM_SIZE);
-
-  u64 cpMemOffset = file.Tell();
-  file.WriteArray(m_CPMem, CP_MEM_SIZE);
-
-  u64 xfMemOffset = file.Tell();
-  file.WriteArray(m_XFMem, XF_MEM_SIZE);
-
-  u64 xfRegsOffset = file.Tell();
-  file.WriteArray(m_XFRegs, XF_REGS_SIZE);
-
-  u64 texMemOffset = file.Tell();
-  file.WriteArray(m_TexMem, TEX_MEM_SIZE);
-
-  // Write header
-  FileHeader header;
-  header.fileId = FILE_ID;
-  header.file_version = VERSION_NUMBER;
-  header.min_loader_version = MIN_LOADER_VERSION;
-
-  header.bpMemOffset = bpMemOffset;
-  header.bpMemSize = BP_MEM_SIZE;
-
-  header.cpMemOffset = cpMemOffset;
-  header.cpMemSize = CP_MEM_SIZE;
-
-  header.xfMemOffset = xfMemOffset;
-  header.xfMemSize = XF_MEM_SIZE;
-
-  header.xfRegsOffset = xfRegsOffset;
-  header.xfRegsSize = XF_REGS_SIZE;
+  const auto it = std::find_if(m_FrameCache.begin(), m_FrameCache.end(),
+                               [frame](const auto& entry) { return entry.first == frame; });
+  if (it != m_FrameCache.end())
+  {
+    std::rotate(m_FrameCache.begin(), it, it + 1);
+    return m_FrameCache.front().second;
+  }
 
-  header.texMemOffset = texMemOffset;
-  header.texMemSize = TEX_MEM_SIZE;
+  std::shared_ptr<const FifoFrameInfo> result = ReadStreamedFrame(frame);
+  if (m_FrameCache.size() >= FRAME_CACHE_SIZE)
+    m_FrameCache.pop_back();
+  m_FrameCache.emplace(m_FrameCache.begin(), frame, result);
 
-  header.frameListOffset = frameListOffset;
-  header.frameCount = (u32)m_Frames.size();
+  return result;
+}
 
-  header.flags = m_Flags;
+u32 FifoDataFile::GetFrameCount() const
+{
+  if (m_StreamFile)
+    return static_cast<u32>(m_StreamedFrames.size());
 
-  file.Seek(0, SEEK_SET);
-  file.WriteBytes(&header, sizeof(FileHeader));
+  return static_cast<u32>(m_Frames.size());
+}
 
-  // Write frames list
-  for (unsigned int i = 0; i < m_Frames.size(); ++i)
+bool FifoDataFile::Save(const std::string& filename)
+{
+  // The frames of a streamed file are read from disk while they are written, possibly from the
+  // very file that is being replaced, so write to another file first.
+  const std::string temp_filename = filename + ".tmp";
+  bool success;
   {
-    const FifoFrameInfo& srcFrame = m_Frames[i];
-
-    // Write FIFO data
-    file.Seek(0, SEEK_END);
-    u64 dataOffset = file.Tell();
-    file.WriteBytes(srcFrame.fifoData.data(), srcFrame.fifoData.size());
-
-    u64 memoryUpdatesOffset = WriteMemoryUpdates(srcFrame.memoryUpdates, file);
-
-    FileFrameInfo dstFrame;
-    dstFrame.fifoDataSize = static_cast<u32>(srcFrame.fifoData.size());
-    dstFrame.fifoDataOffset = dataOffset;
-    dstFrame.fifoStart = srcFrame.fifoStart;
-    dstFrame.fifoEnd = srcFrame.fifoEnd;
-    dstFrame.memoryUpdatesOffset = memoryUpdatesOffset;
-    dstFrame.numMemoryUpdates = static_cast<u32>(srcFrame.memoryUpdates.size());
-
-    // Write frame info
-    u64 frameOffset = frameListOffset + (i * sizeof(FileFrameInfo));
-    file.Seek(frameOffset, SEEK_SET);
-    file.WriteBytes(&dstFrame, sizeof(FileFrameInfo));
+    FifoDataFileWriter writer(temp_filename);
+    success = writer.IsOpen();
+    if (success)
+    {
+      for (u32 i = 0; i < GetFrameCount(); ++i)
+        writer.AddFrame(*GetFrame(i));
+
+      success = writer.Finish(*this);
+    }
   }
 
-  if (!file.Close())
-    return false;
+  if (success && File::Rename(temp_filename, filename))
+    return true;
 
-  return true;
+  File::Delete(temp_filename);
+  return false;
 }
 
 std::unique_ptr<FifoDataFile> FifoDataFile::Load(const std::string& filename, bool flagsOnly)
@@ -238,6 +255,24 @@ std::unique_ptr<FifoDataFile> FifoDataFile::Load(const std::string& filename, bo
     file.ReadArray(dataFile->m_TexMem, size);
   }
 
+  // Streamed files only have their frame list read here. The frames are read as they are used.
+  if (dataFile->m_Version >= 5)
+  {
+    std::vector<FileChunk> frameList(header.frameCount);
+    file.Seek(header.frameListOffset, SEEK_SET);
+    if (!file.ReadArray(frameList.data(), frameList.size()))
+      return nullptr;
+
+    dataFile->m_StreamedFrames.reserve(frameList.size());
+    for (const FileChunk& chunk : frameList)
+      dataFile->m_StreamedFrames.push_back({chunk.offset, chunk.storedSize, chunk.size});
+
+    dataFile->m_FifoDataSize = header.fifoDataSize;
+    dataFile->m_MemoryUpdatesSize = header.memoryUpdatesSize;
+    dataFile->m_StreamFile = std::make_unique<File::IOFile>(std::move(file));
+    return dataFile;
+  }
+
   // Read frames
   for (u32 i = 0; i < header.frameCount; ++i)
   {
@@ -265,12 +300,6 @@ std::unique_ptr<FifoDataFile> FifoDataFile::Load(const std::string& filename, bo
   return dataFile;
 }
 
-void FifoDataFile::PadFile(size_t numBytes, File::IOFile& file)
-{
-  for (size_t i = 0; i < numBytes; ++i)
-    fputc(0, file.GetHandle());
-}
-
 void FifoDataFile::SetFlag(u32 flag, bool set)
 {
   if (set)
@@ -284,37 +313,6 @@ bool FifoDataFile::GetFlag(u32 flag) const
   return !!(m_Flags & flag);
 }
 
-u64 FifoDataFile::WriteMemoryUpdates(const std::vector<MemoryUpdate>& memUpdates,
-                                     File::IOFile& file)
-{
-  // Add space for memory update list
-  u64 updateListOffset = file.Tell();
-  PadFile(memUpdates.size() * sizeof(FileMemoryUpdate), file);
-
-  for (unsigned int i = 0; i < memUpdates.size(); ++i)
-  {
-    const MemoryUpdate& srcUpdate = memUpdates[i];
-
-    // Write memory
-    file.Seek(0, SEEK_END);
-    u64 dataOffset = file.Tell();
-    file.WriteBytes(srcUpdate.data.data(), srcUpdate.data.size());
-
-    FileMemoryUpdate dstUpdate;
-    dstUpdate.address = srcUpdate.address;
-    dstUpdate.dataOffset = dataOffset;
-    dstUpdate.dataSize = static_cast<u32>(srcUpdate.data.size());
-    dstUpdate.fifoPosition = srcUpdate.fifoPosition;
-    dstUpdate.type = srcUpdate.type;
-
-    u64 updateOffset = updateListOffset + (i * sizeof(FileMemoryUpdate));
-    file.Seek(updateOffset, SEEK_SET);
-    file.WriteBytes(&dstUpdate, sizeof(FileMemoryUpdate));
-  }
-
-  return updateListOffset;
-}
-
 void FifoDataFile::ReadMemoryUpdates(u64 fileOffset, u32 numUpdates,
                                      std::vector<MemoryUpdate>& memUpdates, File::IOFile& file)
 {
@@ -337,3 +335,265 @@ void FifoDataFile::ReadMemoryUpdates(u64 fileOffset, u32 numUpdates,
     file.ReadBytes(dstUpdate.data.data(), srcUpdate.dataSize);
   }
 }
+
+bool FifoDataFile::ReadChunk(const Chunk& chunk, std::vector<u8>& data, File::IOFile& file)
+{
+  data.resize(chunk.size);
+  if (chunk.size == 0)
+    return true;
+
+  if (!file.Seek(chunk.offset, SEEK_SET))
+    return false;
+
+  if (chunk.storedSize == chunk.size)
+    return file.ReadBytes(data.data(), data.size());
+
+  std::vector<u8> compressed(chunk.storedSize);
+  if (!file.ReadBytes(compressed.data(), compressed.size()))
+    return false;
+
+  uLongf size = static_cast<uLongf>(data.size());
+  return uncompress(data.data(), &size, compressed.data(), static_cast<uLong>(compressed.size())) ==
+             Z_OK &&
+         size == data.size();
+}
+
+std::shared_ptr<const FifoFrameInfo> FifoDataFile::ReadStreamedFrame(u32 frame) const
+{
+  auto result = std::make_shared<FifoFrameInfo>();
+  result->fifoStart = 0;
+  result->fifoEnd = 0;
+
+  std::vector<u8> chunk;
+  if (!ReadChunk(m_StreamedFrames[frame], chunk, *m_StreamFile) ||
+      chunk.size() < sizeof(FileStreamedFrame))
+  {
+    ERROR_LOG(VIDEO, "Failed to read frame %u of the FIFO log", frame);
+    return result;
+  }
+
+  FileStreamedFrame srcFrame;
+  std::memcpy(&srcFrame, chunk.data(), sizeof(srcFrame));
+
+  const size_t fifoDataOffset = sizeof(FileStreamedFrame);
+  const size_t updatesOffset = fifoDataOffset + srcFrame.fifoDataSize;
+  if (chunk.size() < updatesOffset ||
+      (chunk.size() - updatesOffset) / sizeof(FileStreamedMemoryUpdate) <
+          srcFrame.numMemoryUpdates)
+  {
+    ERROR_LOG(VIDEO, "Frame %u of the FIFO log is corrupted", frame);
+    return result;
+  }
+
+  result->fifoStart = srcFrame.fifoStart;
+  result->fifoEnd = srcFrame.fifoEnd;
+  result->fifoData.assign(chunk.begin() + fifoDataOffset, chunk.begin() + updatesOffset);
+
+  result->memoryUpdates.resize(srcFrame.numMemoryUpdates);
+  for (u32 i = 0; i < srcFrame.numMemoryUpdates; ++i)
+  {
+    FileStreamedMemoryUpdate srcUpdate;
+    std::memcpy(&srcUpdate, chunk.data() + updatesOffset + i * sizeof(srcUpdate),
+                sizeof(srcUpdate));
+
+    MemoryUpdate& dstUpdate = result->memoryUpdates[i];
+    dstUpdate.fifoPosition = srcUpdate.fifoPosition;
+    dstUpdate.address = srcUpdate.address;
+    dstUpdate.type = static_cast<MemoryUpdate::Type>(srcUpdate.type);
+
+    const Chunk data{srcUpdate.data.offset, srcUpdate.data.storedSize, srcUpdate.data.size};
+    if (!ReadChunk(data, dstUpdate.data, *m_StreamFile))
+      ERROR_LOG(VIDEO, "Failed to read memory update %u of frame %u of the FIFO log", i, frame);
+  }
+
+  return result;
+}
+
+FifoDataFileWriter::FifoDataFileWriter(const std::string& filename)
+    : m_file(std::make_unique<File::IOFile>(filename, "wb"))
+{
+  if (!m_file->IsOpen())
+    return;
+
+  // Leave space for the header and the register state, which are written by Finish
+  const std::vector<u8> placeholder(sizeof(FileHeader) +
+                                    (FifoDataFile::BP_MEM_SIZE + FifoDataFile::CP_MEM_SIZE +
+                                     FifoDataFile::XF_MEM_SIZE + FifoDataFile::XF_REGS_SIZE) *
+                                        sizeof(u32) +
+                                    FifoDataFile::TEX_MEM_SIZE);
+  m_file->WriteBytes(placeholder.data(), placeholder.size());
+
+  m_worker = std::make_unique<Common::WorkQueueThread<FifoFrameInfo>>(
+      [this](FifoFrameInfo frame) {
+        WriteFrame(frame);
+
+        std::lock_guard<std::mutex> lk(m_queue_mutex);
+        --m_queued_frames;
+        m_queue_changed.notify_one();
+      });
+}
+
+FifoDataFileWriter::~FifoDataFileWriter() = default;
+
+bool FifoDataFileWriter::IsOpen() const
+{
+  return m_file && m_file->IsOpen();
+}
+
+void FifoDataFileWriter::AddFrame(FifoFrameInfo frame)
+{
+  if (!m_worker)
+    return;
+
+  {
+    std::unique_lock<std::mutex> lk(m_queue_mutex);
+    m_queue_changed.wait(lk, [this] { return m_queued_frames < MAX_QUEUED_FRAMES; });
+    ++m_queued_frames;
+  }
+
+  m_worker->EmplaceItem(std::move(frame));
+}
+
+bool FifoDataFileWriter::Finish(const FifoDataFile& state)
+{
+  if (!m_worker)
+    return false;
+
+  // Destroying the worker writes the remaining frames
+  m_worker.reset();
+
+  File::IOFile& file = *m_file;
+  file.Seek(0, SEEK_END);
+
+  const u64 frameListOffset = file.Tell();
+  for (const Chunk& frame : m_frames)
+  {
+    const FileChunk dstFrame{frame.offset, frame.storedSize, frame.size};
+    file.WriteBytes(&dstFrame, sizeof(dstFrame));
+  }
+
+  file.Seek(sizeof(FileHeader), SEEK_SET);
+
+  const u64 bpMemOffset = file.Tell();
+  file.WriteArray(state.m_BPMem, FifoDataFile::BP_MEM_SIZE);
+
+  const u64 cpMemOffset = file.Tell();
+  file.WriteArray(state.m_CPMem, FifoDataFile::CP_MEM_SIZE);
+
+  const u64 xfMemOffset = file.Tell();
+  file.WriteArray(state.m_XFMem, FifoDataFile::XF_MEM_SIZE);
+
+  const u64 xfRegsOffset = file.Tell();
+  file.WriteArray(state.m_XFRegs, FifoDataFile::XF_REGS_SIZE);
+
+  const u64 texMemOffset = file.Tell();
+  file.WriteArray(state.m_TexMem, FifoDataFile::TEX_MEM_SIZE);
+
+  FileHeader header{};
+  header.fileId = FILE_ID;
+  header.file_version = VERSION_NUMBER;
+  header.min_loader_version = MIN_STREAMED_LOADER_VERSION;
+
+  header.bpMemOffset = bpMemOffset;
+  header.bpMemSize = FifoDataFile::BP_MEM_SIZE;
+
+  header.cpMemOffset = cpMemOffset;
+  header.cpMemSize = FifoDataFile::CP_MEM_SIZE;
+
+  header.xfMemOffset = xfMemOffset;
+  header.xfMemSize = FifoDataFile::XF_MEM_SIZE;
+
+  header.xfRegsOffset = xfRegsOffset;
+  header.xfRegsSize = FifoDataFile::XF_REGS_SIZE;
+
+  header.texMemOffset = texMemOffset;
+  header.texMemSize = FifoDataFile::TEX_MEM_SIZE;
+
+  header.frameListOffset = frameListOffset;
+  header.frameCount = static_cast<u32>(m_frames.size());
+
+  header.flags = state.m_Flags;
+
+  header.fifoDataSize = m_fifo_data_size;
+  header.memoryUpdatesSize = m_memory_updates_size;
+
+  file.Seek(0, SEEK_SET);
+  file.WriteBytes(&header, sizeof(FileHeader));
+
+  const bool good = file.IsGood() && !m_write_failed;
+  return file.Close() && good;
+}
+
+void FifoDataFileWriter::WriteFrame(const FifoFrameInfo& frame)
+{
+  // Write the memory updates first so the frame can refer to them
+  std::vector<FileStreamedMemoryUpdate> updates(frame.memoryUpdates.size());
+  for (size_t i = 0; i < updates.size(); ++i)
+  {
+    const MemoryUpdate& srcUpdate = frame.memoryUpdates[i];
+    const Chunk data = WriteMemory(srcUpdate.data);
+
+    FileStreamedMemoryUpdate& dstUpdate = updates[i];
+    dstUpdate = {};
+    dstUpdate.fifoPosition = srcUpdate.fifoPosition;
+    dstUpdate.address = srcUpdate.address;
+    dstUpdate.data = {data.offset, data.storedSize, data.size};
+    dstUpdate.type = static_cast<u8>(srcUpdate.type);
+
+    m_memory_updates_size += srcUpdate.data.size();
+  }
+
+  FileStreamedFrame dstFrame;
+  dstFrame.fifoStart = frame.fifoStart;
+  dstFrame.fifoEnd = frame.fifoEnd;
+  dstFrame.fifoDataSize = static_cast<u32>(frame.fifoData.size());
+  dstFrame.numMemoryUpdates = static_cast<u32>(updates.size());
+
+  m_chunk_buffer.resize(sizeof(dstFrame) + frame.fifoData.size() +
+                        updates.size() * sizeof(FileStreamedMemoryUpdate));
+  u8* dst = m_chunk_buffer.data();
+  std::memcpy(dst, &dstFrame, sizeof(dstFrame));
+  dst += sizeof(dstFrame);
+  std::copy(frame.fifoData.begin(), frame.fifoData.end(), dst);
+  dst += frame.fifoData.size();
+  if (!updates.empty())
+    std::memcpy(dst, updates.data(), updates.size() * sizeof(FileStreamedMemoryUpdate));
+
+  m_frames.push_back(WriteChunk(m_chunk_buffer.data(), m_chunk_buffer.size()));
+  m_fifo_data_size += frame.fifoData.size();
+}
+
+FifoDataFileWriter::Chunk FifoDataFileWriter::WriteMemory(const std::vector<u8>& data)
+{
+  // Games tend to upload the same textures and vertex data over and over again. The digest is
+  // collision resistant, so a match is trusted without comparing against what was written.
+  const MemoryKey key{static_cast<u32>(data.size()),
+                      Common::SHA1::CalculateDigest(data.data(), data.size())};
+  const auto it = m_stored_memory.find(key);
+  if (it != m_stored_memory.end())
+    return it->second;
+
+  const Chunk chunk = WriteChunk(data.data(), data.size());
+  m_stored_memory.emplace(key, chunk);
+  return chunk;
+}
+
+FifoDataFileWriter::Chunk FifoDataFileWriter::WriteChunk(const u8* data, size_t size)
+{
+  Chunk chunk{m_file->Tell(), static_cast<u32>(size), static_cast<u32>(size)};
+
+  m_compress_buffer.resize(compressBound(static_cast<uLong>(size)));
+  uLongf compressedSize = static_cast<uLongf>(m_compress_buffer.size());
+  if (compress2(m_compress_buffer.data(), &compressedSize, data, static_cast<uLong>(size),
+                Z_BEST_SPEED) == Z_OK &&
+      compressedSize < size)
+  {
+    chunk.storedSize = static_cast<u32>(compressedSize);
+    data = m_compress_buffer.data();
+  }
+
+  if (!m_file->WriteBytes(data, chunk.storedSize))
+    m_write_failed = true;
+
+  return chunk;
+}
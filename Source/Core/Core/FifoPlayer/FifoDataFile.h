@@ -4,13 +4,24 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/Crypto/SHA1.h"
 #include "VideoCommon/XFMemory.h"
 
+namespace Common
+{
+template <typename T>
+class WorkQueueThread;
+}
+
 namespace File
 {
 class IOFile;
@@ -70,26 +81,43 @@ public:
   u32* GetXFRegs() { return m_XFRegs; }
   u8* GetTexMem() { return m_TexMem; }
   void AddFrame(const FifoFrameInfo& frameInfo);
-  const FifoFrameInfo& GetFrame(u32 frame) const { return m_Frames[frame]; }
-  u32 GetFrameCount() const { return static_cast<u32>(m_Frames.size()); }
+  // Frames of streamed files are only read from disk when they are needed, so the returned frame
+  // stays valid on its own rather than being owned by the file.
+  std::shared_ptr<const FifoFrameInfo> GetFrame(u32 frame) const;
+  u32 GetFrameCount() const;
+  // Totals over all frames, without reading them
+  u64 GetFifoDataSize() const { return m_FifoDataSize; }
+  u64 GetMemoryUpdatesSize() const { return m_MemoryUpdatesSize; }
   bool Save(const std::string& filename);
 
   static std::unique_ptr<FifoDataFile> Load(const std::string& filename, bool flagsOnly);
 
 private:
+  friend class FifoDataFileWriter;
+
   enum
   {
     FLAG_IS_WII = 1
   };
 
-  void PadFile(size_t numBytes, File::IOFile& file);
+  // Where a (possibly compressed) chunk of a streamed file is stored
+  struct Chunk
+  {
+    u64 offset;
+    u32 storedSize;
+    u32 size;
+  };
+
+  // How many decoded frames of a streamed file to keep around
+  static constexpr size_t FRAME_CACHE_SIZE = 4;
 
   void SetFlag(u32 flag, bool set);
   bool GetFlag(u32 flag) const;
 
-  u64 WriteMemoryUpdates(const std::vector<MemoryUpdate>& memUpdates, File::IOFile& file);
   static void ReadMemoryUpdates(u64 fileOffset, u32 numUpdates,
                                 std::vector<MemoryUpdate>& memUpdates, File::IOFile& file);
+  static bool ReadChunk(const Chunk& chunk, std::vector<u8>& data, File::IOFile& file);
+  std::shared_ptr<const FifoFrameInfo> ReadStreamedFrame(u32 frame) const;
 
   u32 m_BPMem[BP_MEM_SIZE];
   u32 m_CPMem[CP_MEM_SIZE];
@@ -100,5 +128,59 @@ private:
   u32 m_Flags = 0;
   u32 m_Version = 0;
 
-  std::vector<FifoFrameInfo> m_Frames;
+  u64 m_FifoDataSize = 0;
+  u64 m_MemoryUpdatesSize = 0;
+
+  std::vector<std::shared_ptr<const FifoFrameInfo>> m_Frames;
+
+  // Only used for streamed files, which keep the file open to read frames from it
+  std::vector<Chunk> m_StreamedFrames;
+  std::unique_ptr<File::IOFile> m_StreamFile;
+  mutable std::mutex m_StreamMutex;
+  // Most recently used first
+  mutable std::vector<std::pair<u32, std::shared_ptr<const FifoFrameInfo>>> m_FrameCache;
+};
+
+// Writes a FIFO log one frame at a time. Frames are compressed and written to disk on a worker
+// thread, and memory updates that have already been written are only stored once, so long
+// recordings don't have to fit in memory.
+class FifoDataFileWriter
+{
+public:
+  explicit FifoDataFileWriter(const std::string& filename);
+  ~FifoDataFileWriter();
+
+  bool IsOpen() const;
+
+  void AddFrame(FifoFrameInfo frame);
+
+  // Waits for all frames to be written, then writes the frame index and the register state and
+  // flags of state. The writer can't be used afterwards.
+  bool Finish(const FifoDataFile& state);
+
+private:
+  using Chunk = FifoDataFile::Chunk;
+  using MemoryKey = std::pair<u32, Common::SHA1::Digest>;
+
+  // Called on the worker thread
+  void WriteFrame(const FifoFrameInfo& frame);
+  Chunk WriteMemory(const std::vector<u8>& data);
+  Chunk WriteChunk(const u8* data, size_t size);
+
+  std::unique_ptr<File::IOFile> m_file;
+  std::unique_ptr<Common::WorkQueueThread<FifoFrameInfo>> m_worker;
+
+  // Limits how far the worker thread can fall behind
+  std::mutex m_queue_mutex;
+  std::condition_variable m_queue_changed;
+  size_t m_queued_frames = 0;
+
+  // Owned by the worker thread until it has been stopped
+  std::vector<Chunk> m_frames;
+  std::map<MemoryKey, Chunk> m_stored_memory;
+  std::vector<u8> m_chunk_buffer;
+  std::vector<u8> m_compress_buffer;
+  u64 m_fifo_data_size = 0;
+  u64 m_memory_updates_size = 0;
+  bool m_write_failed = false;
 };
@@ -7,6 +7,8 @@
 #include <algorithm>
 #include <cstring>
 
+#include "Common/CommonPaths.h"
+#include "Common/FileUtil.h"
 #include "Common/MsgHandler.h"
 #include "Common/Thread.h"
 #include "Core/ConfigManager.h"
@@ -22,8 +24,20 @@ void FifoRecorder::StartRecording(s32 numFrames, CallbackFunc finishedCb)
 {
   std::lock_guard<std::recursive_mutex> lk(m_mutex);
 
+  // Release the previous recording first, since it is read from the same file
   m_File = std::make_unique<FifoDataFile>();
 
+  const std::string path = GetRecordingPath();
+  File::CreateFullPath(path);
+  m_Writer = std::make_unique<FifoDataFileWriter>(path);
+  if (!m_Writer->IsOpen())
+  {
+    PanicAlertT("Failed to open \"%s\" for writing the FIFO log.", path.c_str());
+    m_Writer.reset();
+    m_File.reset();
+    return;
+  }
+
   // TODO: This, ideally, would be deallocated when done recording.
   //       However, care needs to be taken since global state
   //       and multithreading don't play well nicely together.
@@ -63,7 +77,7 @@ void FifoRecorder::StopRecording()
 
 bool FifoRecorder::IsRecordingDone() const
 {
-  return m_WasRecording && m_File != nullptr;
+  return m_WasRecording && m_File != nullptr && m_Writer == nullptr;
 }
 
 FifoDataFile* FifoRecorder::GetRecordedFile() const
@@ -99,12 +113,20 @@ void FifoRecorder::WriteGPCommand(const u8* data, u32 size)
     {
       std::lock_guard<std::recursive_mutex> lk(m_mutex);
 
-      // Copy frame to file
-      // The file will be responsible for freeing the memory allocated for each frame's fifoData
-      m_File->AddFrame(m_CurrentFrame);
+      // The writer compresses the frame and writes it to disk in the background
+      if (m_Writer)
+      {
+        m_Writer->AddFrame(std::move(m_CurrentFrame));
 
-      if (m_FinishedCb && m_RequestedRecordingEnd)
-        m_FinishedCb();
+        // EndFrame stops the recording once the end has been requested, so this was the last frame
+        if (!m_IsRecording)
+        {
+          FinishRecording();
+
+          if (m_FinishedCb)
+            m_FinishedCb();
+        }
+      }
     }
 
     m_CurrentFrame.memoryUpdates.clear();
@@ -215,6 +237,24 @@ void FifoRecorder::SetVideoMemory(const u32* bpMem, const u32* cpMem, const u32*
   FifoRecordAnalyzer::Initialize(cpMem);
 }
 
+std::string FifoRecorder::GetRecordingPath()
+{
+  return File::GetUserPath(D_CACHE_IDX) + "fiforecording.dff";
+}
+
+void FifoRecorder::FinishRecording()
+{
+  const std::string path = GetRecordingPath();
+  const bool written = m_Writer->Finish(*m_File);
+  m_Writer.reset();
+
+  // Frames are read back from the file as they are needed, so they don't all have to fit in
+  // memory.
+  m_File = written ? FifoDataFile::Load(path, false) : nullptr;
+  if (!m_File)
+    PanicAlertT("Failed to write the FIFO log to \"%s\".", path.c_str());
+}
+
 bool FifoRecorder::IsRecording() const
 {
   return m_IsRecording;
@@ -7,6 +7,7 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <vector>
 
 #include "Core/FifoPlayer/FifoDataFile.h"
@@ -48,6 +49,11 @@ public:
   static FifoRecorder& GetInstance();
 
 private:
+  static std::string GetRecordingPath();
+
+  // Called once the last frame has been written
+  void FinishRecording();
+
   // Accessed from both GUI and video threads
 
   std::recursive_mutex m_mutex;
@@ -58,7 +64,10 @@ private:
   bool m_RequestedRecordingEnd = false;
   s32 m_RecordFramesRemaining = 0;
   CallbackFunc m_FinishedCb;
+  // While recording, this only holds the initial state. Frames go straight to the writer, and
+  // the file is replaced with the written recording once it is finished.
   std::unique_ptr<FifoDataFile> m_File;
+  std::unique_ptr<FifoDataFileWriter> m_Writer;
 
   // Accessed only from video thread
 
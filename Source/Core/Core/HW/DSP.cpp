@@ -229,6 +229,56 @@ void Shutdown()
   s_dsp_emulator.reset();
 }
 
+// The mailbox and control registers are polled in tight loops by most games, so
+// they are plain functions rather than lambdas: this lets the MMIO code and the
+// JITs call them directly.
+static void UpdateDSPSliceForMail()
+{
+  if (s_dsp_slice > DSP_MAIL_SLICE && s_dsp_is_lle)
+  {
+    s_dsp_emulator->DSP_Update(DSP_MAIL_SLICE);
+    s_dsp_slice -= DSP_MAIL_SLICE;
+  }
+}
+
+static u16 ReadMailToDSPHigh(void*, u32)
+{
+  UpdateDSPSliceForMail();
+  return s_dsp_emulator->DSP_ReadMailBoxHigh(true);
+}
+
+static u16 ReadMailToDSPLow(void*, u32)
+{
+  return s_dsp_emulator->DSP_ReadMailBoxLow(true);
+}
+
+static void WriteMailToDSPHigh(void*, u32, u16 val)
+{
+  s_dsp_emulator->DSP_WriteMailBoxHigh(true, val);
+}
+
+static void WriteMailToDSPLow(void*, u32, u16 val)
+{
+  s_dsp_emulator->DSP_WriteMailBoxLow(true, val);
+}
+
+static u16 ReadMailFromDSPHigh(void*, u32)
+{
+  UpdateDSPSliceForMail();
+  return s_dsp_emulator->DSP_ReadMailBoxHigh(false);
+}
+
+static u16 ReadMailFromDSPLow(void*, u32)
+{
+  return s_dsp_emulator->DSP_ReadMailBoxLow(false);
+}
+
+static u16 ReadControlRegister(void*, u32)
+{
+  return (s_dspState.Hex & ~DSP_CONTROL_MASK) |
+         (s_dsp_emulator->DSP_ReadControlRegister() & DSP_CONTROL_MASK);
+}
+
 void RegisterMMIO(MMIO::Mapping* mmio, u32 base)
 {
   // Declare all the boilerplate direct MMIOs.
@@ -258,40 +308,18 @@ void RegisterMMIO(MMIO::Mapping* mmio, u32 base)
   }
 
   // DSP mail MMIOs call DSP emulator functions to get results or write data.
-  mmio->Register(base | DSP_MAIL_TO_DSP_HI, MMIO::ComplexRead<u16>([](u32) {
-                   if (s_dsp_slice > DSP_MAIL_SLICE && s_dsp_is_lle)
-                   {
-                     s_dsp_emulator->DSP_Update(DSP_MAIL_SLICE);
-                     s_dsp_slice -= DSP_MAIL_SLICE;
-                   }
-                   return s_dsp_emulator->DSP_ReadMailBoxHigh(true);
-                 }),
-                 MMIO::ComplexWrite<u16>(
-                     [](u32, u16 val) { s_dsp_emulator->DSP_WriteMailBoxHigh(true, val); }));
-  mmio->Register(base | DSP_MAIL_TO_DSP_LO, MMIO::ComplexRead<u16>([](u32) {
-                   return s_dsp_emulator->DSP_ReadMailBoxLow(true);
-                 }),
-                 MMIO::ComplexWrite<u16>(
-                     [](u32, u16 val) { s_dsp_emulator->DSP_WriteMailBoxLow(true, val); }));
-  mmio->Register(base | DSP_MAIL_FROM_DSP_HI, MMIO::ComplexRead<u16>([](u32) {
-                   if (s_dsp_slice > DSP_MAIL_SLICE && s_dsp_is_lle)
-                   {
-                     s_dsp_emulator->DSP_Update(DSP_MAIL_SLICE);
-                     s_dsp_slice -= DSP_MAIL_SLICE;
-                   }
-                   return s_dsp_emulator->DSP_ReadMailBoxHigh(false);
-                 }),
+  mmio->Register(base | DSP_MAIL_TO_DSP_HI, MMIO::ComplexRead<u16>(&ReadMailToDSPHigh, nullptr),
+                 MMIO::ComplexWrite<u16>(&WriteMailToDSPHigh, nullptr));
+  mmio->Register(base | DSP_MAIL_TO_DSP_LO, MMIO::ComplexRead<u16>(&ReadMailToDSPLow, nullptr),
+                 MMIO::ComplexWrite<u16>(&WriteMailToDSPLow, nullptr));
+  mmio->Register(base | DSP_MAIL_FROM_DSP_HI,
+                 MMIO::ComplexRead<u16>(&ReadMailFromDSPHigh, nullptr),
                  MMIO::InvalidWrite<u16>());
-  mmio->Register(base | DSP_MAIL_FROM_DSP_LO, MMIO::ComplexRead<u16>([](u32) {
-                   return s_dsp_emulator->DSP_ReadMailBoxLow(false);
-                 }),
+  mmio->Register(base | DSP_MAIL_FROM_DSP_LO, MMIO::ComplexRead<u16>(&ReadMailFromDSPLow, nullptr),
                  MMIO::InvalidWrite<u16>());
 
   mmio->Register(
-      base | DSP_CONTROL, MMIO::ComplexRead<u16>([](u32) {
-        return (s_dspState.Hex & ~DSP_CONTROL_MASK) |
-               (s_dsp_emulator->DSP_ReadControlRegister() & DSP_CONTROL_MASK);
-      }),
+      base | DSP_CONTROL, MMIO::ComplexRead<u16>(&ReadControlRegister, nullptr),
       MMIO::ComplexWrite<u16>([](u32, u16 val) {
         UDSPControl tmpControl;
         tmpControl.Hex = (val & ~DSP_CONTROL_MASK) |
@@ -0,0 +1,192 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/HW/DSPHLE/UCodes/AXMixer.h"
+
+#include <algorithm>
+
+#include "Common/CommonTypes.h"
+
+#ifdef _M_X86
+#include <emmintrin.h>
+#endif
+
+namespace DSP::HLE::AXMixer
+{
+namespace
+{
+s16 ScaleSample(s16 sample, u16 volume)
+{
+  return static_cast<s16>(std::clamp((s32(sample) * volume) >> 15, -32767, 32767));
+}
+
+#ifdef _M_X86
+// Returns the volume used for each of the next 8 samples.
+__m128i GetVolumeRamp(u16 volume, u16 delta)
+{
+  const __m128i steps = _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7);
+  return _mm_add_epi16(_mm_set1_epi16(volume), _mm_mullo_epi16(steps, _mm_set1_epi16(delta)));
+}
+
+// Computes clamp((sample * volume) >> 15, -32767, 32767) for 8 signed samples and 8 unsigned
+// volumes. SSE2 only has signed 16-bit multiplies, so the high half of the product is fixed up
+// for volumes >= 0x8000 (which the signed multiply sees as volume - 0x10000).
+__m128i ScaleSamples(__m128i samples, __m128i volumes)
+{
+  const __m128i lo = _mm_mullo_epi16(samples, volumes);
+  __m128i hi = _mm_mulhi_epi16(samples, volumes);
+  hi = _mm_add_epi16(hi, _mm_and_si128(samples, _mm_srai_epi16(volumes, 15)));
+
+  const __m128i product_lo = _mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), 15);
+  const __m128i product_hi = _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), 15);
+  return _mm_max_epi16(_mm_packs_epi32(product_lo, product_hi), _mm_set1_epi16(-32767));
+}
+
+// Computes the full 32-bit product of 8 signed samples and 8 unsigned weights.
+void MultiplyUnsigned(__m128i samples, __m128i weights, __m128i* lo, __m128i* hi)
+{
+  const __m128i product_lo = _mm_mullo_epi16(samples, weights);
+  __m128i product_hi = _mm_mulhi_epi16(samples, weights);
+  product_hi = _mm_add_epi16(product_hi, _mm_and_si128(samples, _mm_srai_epi16(weights, 15)));
+  *lo = _mm_unpacklo_epi16(product_lo, product_hi);
+  *hi = _mm_unpackhi_epi16(product_lo, product_hi);
+}
+#endif
+}  // namespace
+
+void ApplyVolume(s16* samples, u32 count, u16& volume, u16 delta)
+{
+  u32 i = 0;
+
+#ifdef _M_X86
+  __m128i volumes = GetVolumeRamp(volume, delta);
+  const __m128i step = _mm_set1_epi16(static_cast<s16>(delta * 8));
+  for (; i + 8 <= count; i += 8)
+  {
+    __m128i* ptr = reinterpret_cast<__m128i*>(samples + i);
+    _mm_storeu_si128(ptr, ScaleSamples(_mm_loadu_si128(ptr), volumes));
+    volumes = _mm_add_epi16(volumes, step);
+  }
+  volume += static_cast<u16>(delta * i);
+#endif
+
+  for (; i < count; ++i)
+  {
+    samples[i] = ScaleSample(samples[i], volume);
+    volume += delta;
+  }
+}
+
+s16 MixAdd(int* out, const s16* input, u32 count, u16& volume, u16 delta)
+{
+  s16 last_sample = 0;
+  u32 i = 0;
+
+#ifdef _M_X86
+  __m128i volumes = GetVolumeRamp(volume, delta);
+  const __m128i step = _mm_set1_epi16(static_cast<s16>(delta * 8));
+  for (; i + 8 <= count; i += 8)
+  {
+    const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+    const __m128i scaled = ScaleSamples(in, volumes);
+    volumes = _mm_add_epi16(volumes, step);
+
+    // Sign extend to 32 bits and accumulate.
+    __m128i* dst = reinterpret_cast<__m128i*>(out + i);
+    const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(scaled, scaled), 16);
+    const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(scaled, scaled), 16);
+    _mm_storeu_si128(dst, _mm_add_epi32(_mm_loadu_si128(dst), lo));
+    _mm_storeu_si128(dst + 1, _mm_add_epi32(_mm_loadu_si128(dst + 1), hi));
+
+    last_sample = static_cast<s16>(_mm_extract_epi16(scaled, 7));
+  }
+  volume += static_cast<u16>(delta * i);
+#endif
+
+  for (; i < count; ++i)
+  {
+    last_sample = ScaleSample(input[i], volume);
+    out[i] += last_sample;
+    volume += delta;
+  }
+
+  return last_sample;
+}
+
+u32 GetRequiredInputSamples(u32 count, u32 curr_pos, u32 ratio)
+{
+  u32 read_samples = 0;
+  for (u32 i = 0; i < count; ++i)
+  {
+    curr_pos += ratio;
+    read_samples += curr_pos >> 16;
+    curr_pos &= 0xFFFF;
+  }
+  return read_samples;
+}
+
+u32 ResampleLinear(const s16* input, s16* output, u32 count, u32 curr_pos, u32 ratio)
+{
+  // The interpolation always uses the two oldest of the last four samples that were read, which
+  // are input[read_samples] and input[read_samples + 1] once <read_samples> samples were read.
+  u32 read_samples = 0;
+  u32 i = 0;
+
+#ifdef _M_X86
+  for (; i + 8 <= count; i += 8)
+  {
+    alignas(16) s16 s0[8];
+    alignas(16) s16 s1[8];
+    alignas(16) u16 frac[8];
+    for (u32 j = 0; j < 8; ++j)
+    {
+      curr_pos += ratio;
+      read_samples += curr_pos >> 16;
+      curr_pos &= 0xFFFF;
+      s0[j] = input[read_samples];
+      s1[j] = input[read_samples + 1];
+      frac[j] = static_cast<u16>(curr_pos);
+    }
+
+    const __m128i v_s0 = _mm_load_si128(reinterpret_cast<const __m128i*>(s0));
+    const __m128i v_s1 = _mm_load_si128(reinterpret_cast<const __m128i*>(s1));
+    const __m128i v_frac = _mm_load_si128(reinterpret_cast<const __m128i*>(frac));
+    const __m128i v_inv_frac = _mm_sub_epi16(_mm_setzero_si128(), v_frac);
+
+    __m128i a_lo, a_hi, b_lo, b_hi;
+    MultiplyUnsigned(v_s0, v_inv_frac, &a_lo, &a_hi);
+    MultiplyUnsigned(v_s1, v_frac, &b_lo, &b_hi);
+    const __m128i sum_lo = _mm_srai_epi32(_mm_add_epi32(a_lo, b_lo), 16);
+    const __m128i sum_hi = _mm_srai_epi32(_mm_add_epi32(a_hi, b_hi), 16);
+    const __m128i interpolated = _mm_packs_epi32(sum_lo, sum_hi);
+
+    // A fractional position of 0 takes the sample as is.
+    const __m128i exact = _mm_cmpeq_epi16(v_frac, _mm_setzero_si128());
+    const __m128i result =
+        _mm_or_si128(_mm_and_si128(exact, v_s0), _mm_andnot_si128(exact, interpolated));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), result);
+  }
+#endif
+
+  for (; i < count; ++i)
+  {
+    curr_pos += ratio;
+    read_samples += curr_pos >> 16;
+    curr_pos &= 0xFFFF;
+
+    const u16 curr_frac = static_cast<u16>(curr_pos);
+    const u16 inv_curr_frac = -curr_frac;
+    const s32 s0 = input[read_samples];
+    const s32 s1 = input[read_samples + 1];
+
+    // Interpolate! If curr_frac is 0, we can simply take the sample without any multiplying.
+    if (curr_frac)
+      output[i] = static_cast<s16>(((s0 * inv_curr_frac) + (s1 * curr_frac)) >> 16);
+    else
+      output[i] = static_cast<s16>(s0);
+  }
+
+  return curr_pos;
+}
+}  // namespace DSP::HLE::AXMixer
@@ -0,0 +1,31 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// Block processing kernels shared by the GC and Wii versions of AX. These work on whole frames
+// of samples instead of one sample at a time, and use SSE2 when it is available. The results
+// are bit-identical to the per-sample implementations they replace.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+
+namespace DSP::HLE::AXMixer
+{
+// Multiplies <count> samples by a volume that starts at <volume> and increases by <delta> after
+// each sample, clamping the results to [-32767, 32767]. <volume> is updated to its final value.
+void ApplyVolume(s16* samples, u32 count, u16& volume, u16 delta);
+
+// Scales <count> input samples by a ramped volume (see ApplyVolume) and adds them to <out>.
+// Returns the last mixed sample, which is used for the depop value of the voice.
+s16 MixAdd(int* out, const s16* input, u32 count, u16& volume, u16 delta);
+
+// Linearly interpolates <count> output samples from <input>, starting at the fractional
+// position <curr_pos> and advancing by the 16.16 fixed point <ratio> for each output sample.
+// <input> starts with the four samples of history stored in the PB, followed by at least
+// GetRequiredInputSamples() new samples. Returns the fractional position after the last sample.
+u32 ResampleLinear(const s16* input, s16* output, u32 count, u32 curr_pos, u32 ratio);
+
+// Returns the number of new input samples consumed when resampling <count> samples.
+u32 GetRequiredInputSamples(u32 count, u32 curr_pos, u32 ratio);
+}  // namespace DSP::HLE::AXMixer
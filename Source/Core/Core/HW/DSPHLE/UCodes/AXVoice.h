@@ -13,13 +13,15 @@
 #endif
 
 #include <algorithm>
-#include <functional>
+#include <cstring>
 #include <memory>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Core/DSP/DSPAccelerator.h"
 #include "Core/HW/DSP.h"
 #include "Core/HW/DSPHLE/UCodes/AX.h"
+#include "Core/HW/DSPHLE/UCodes/AXMixer.h"
 #include "Core/HW/DSPHLE/UCodes/AXStructs.h"
 #include "Core/HW/Memmap.h"
 
@@ -226,20 +228,29 @@ void AcceleratorSetup(PB_TYPE* pb)
   acc_end_reached = false;
 }
 
-// Reads a sample from the accelerator. Also handles looping and
+// Reads <count> samples from the accelerator. Also handles looping and
 // disabling streams that reached the end (this is done by an exception raised
 // by the accelerator on real hardware).
-u16 AcceleratorGetSample()
+void AcceleratorGetSamples(s16* samples, u32 count)
 {
-  // See below for explanations about acc_end_reached.
+  // See below for explanations about acc_end_reached. When it gets set in the
+  // middle of the block, the accelerator also stops reads, so the rest of the
+  // block is filled with 0 as well.
   if (acc_end_reached)
-    return 0;
+  {
+    std::fill(samples, samples + count, s16(0));
+    return;
+  }
 
-  return s_accelerator->Read(acc_pb->adpcm.coefs);
+  s_accelerator->ReadSamples(acc_pb->adpcm.coefs, samples, count);
 }
 
-// Reads samples from the input callback, resamples them to <count> samples at
-// the wanted sample rate (computed from the ratio, see below).
+// Resamples input samples to <count> samples at the wanted sample rate
+// (computed from the ratio, see below).
+//
+// <input> starts with 4 unused entries, which are filled with the history
+// from <last_samples>, followed by the new input samples. The number of new
+// samples needed is given by GetResampleInputCount.
 //
 // If srctype is SRCTYPE_POLYPHASE, coefficients need to be provided as well
 // (or the srctype will automatically be changed to LINEAR).
@@ -258,132 +269,88 @@ u16 AcceleratorGetSample()
 // We start getting samples not from sample 0, but 0.<curr_pos_frac>. This
 // avoids discontinuities in the audio stream, especially with very low ratios
 // which interpolate a lot of values between two "real" samples.
-u32 ResampleAudio(std::function<s16(u32)> input_callback, s16* output, u32 count, s16* last_samples,
-                  u32 curr_pos, u32 ratio, int srctype, const s16* coeffs)
+u32 ResampleAudio(s16* input, s16* output, u32 count, s16* last_samples, u32 curr_pos, u32 ratio,
+                  int srctype, const s16* coeffs)
 {
-  int read_samples_count = 0;
-
   // TODO(delroth): find out why the polyphase resampling algorithm causes
   // audio glitches in Wii games with non integral ratios.
 
   // If DSP DROM coefficients are available, support polyphase resampling.
   if (0)  // if (coeffs && srctype == SRCTYPE_POLYPHASE)
   {
-    s16 temp[4];
-    u32 idx = 0;
-
-    temp[idx++ & 3] = last_samples[0];
-    temp[idx++ & 3] = last_samples[1];
-    temp[idx++ & 3] = last_samples[2];
-    temp[idx++ & 3] = last_samples[3];
+    memcpy(input, last_samples, 4 * sizeof(s16));
 
+    u32 read_samples_count = 0;
     for (u32 i = 0; i < count; ++i)
     {
       curr_pos += ratio;
-      while (curr_pos >= 0x10000)
-      {
-        temp[idx++ & 3] = input_callback(read_samples_count++);
-        curr_pos -= 0x10000;
-      }
+      read_samples_count += curr_pos >> 16;
+      curr_pos &= 0xFFFF;
 
       u16 curr_pos_frac = ((curr_pos & 0xFFFF) >> 9) << 2;
       const s16* c = &coeffs[curr_pos_frac];
+      const s16* t = &input[read_samples_count];
 
-      s64 t0 = temp[idx++ & 3];
-      s64 t1 = temp[idx++ & 3];
-      s64 t2 = temp[idx++ & 3];
-      s64 t3 = temp[idx++ & 3];
-
-      s64 samp = (t0 * c[0] + t1 * c[1] + t2 * c[2] + t3 * c[3]) >> 15;
+      s64 samp = ((s64)t[0] * c[0] + (s64)t[1] * c[1] + (s64)t[2] * c[2] + (s64)t[3] * c[3]) >> 15;
 
       output[i] = (s16)samp;
     }
 
-    last_samples[3] = temp[--idx & 3];
-    last_samples[2] = temp[--idx & 3];
-    last_samples[1] = temp[--idx & 3];
-    last_samples[0] = temp[--idx & 3];
+    memcpy(last_samples, input + read_samples_count, 4 * sizeof(s16));
   }
   else if (srctype == SRCTYPE_LINEAR || srctype == SRCTYPE_POLYPHASE)
   {
-    // This is the circular buffer containing samples to use for the
-    // interpolation. It is initialized with the values from the PB, and it
-    // will be stored back to the PB at the end.
-    s16 temp[4];
-    u32 idx = 0;
-
-    temp[idx++ & 3] = last_samples[0];
-    temp[idx++ & 3] = last_samples[1];
-    temp[idx++ & 3] = last_samples[2];
-    temp[idx++ & 3] = last_samples[3];
-
-    for (u32 i = 0; i < count; ++i)
-    {
-      curr_pos += ratio;
-
-      // While our current position is >= 1.0, push new samples to the
-      // circular buffer.
-      while (curr_pos >= 0x10000)
-      {
-        temp[idx++ & 3] = input_callback(read_samples_count++);
-        curr_pos -= 0x10000;
-      }
+    // The history is followed by the new samples, so the interpolation can
+    // index a single buffer. The four last samples read are stored back to
+    // the PB at the end.
+    memcpy(input, last_samples, 4 * sizeof(s16));
 
-      // Get our current fractional position, used to know how much of
-      // curr0 and how much of curr1 the output sample should be.
-      u16 curr_frac = curr_pos & 0xFFFF;
-      u16 inv_curr_frac = -curr_frac;
+    const u32 read_samples_count = AXMixer::GetRequiredInputSamples(count, curr_pos, ratio);
+    curr_pos = AXMixer::ResampleLinear(input, output, count, curr_pos, ratio);
 
-      // Interpolate! If curr_frac is 0, we can simply take the last
-      // sample without any multiplying.
-      s16 sample;
-      if (curr_frac)
-      {
-        s32 s0 = temp[idx++ & 3];
-        s32 s1 = temp[idx++ & 3];
-
-        sample = ((s0 * inv_curr_frac) + (s1 * curr_frac)) >> 16;
-        idx += 2;
-      }
-      else
-      {
-        sample = temp[idx++ & 3];
-        idx += 3;
-      }
-
-      output[i] = sample;
-    }
-
-    // Update the four last_samples values.
-    last_samples[3] = temp[--idx & 3];
-    last_samples[2] = temp[--idx & 3];
-    last_samples[1] = temp[--idx & 3];
-    last_samples[0] = temp[--idx & 3];
+    memcpy(last_samples, input + read_samples_count, 4 * sizeof(s16));
   }
   else  // SRCTYPE_NEAREST
   {
-    // No sample rate conversion here: simply read samples from the
-    // accelerator to the output buffer.
-    for (u32 i = 0; i < count; ++i)
-      output[i] = input_callback(i);
-
-    memcpy(last_samples, output + count - 4, 4 * sizeof(u16));
+    // No sample rate conversion here: simply copy the input samples to the
+    // output buffer.
+    memcpy(output, input + 4, count * sizeof(s16));
+    memcpy(last_samples, output + count - 4, 4 * sizeof(s16));
   }
 
   return curr_pos;
 }
 
+// Returns the number of new input samples ResampleAudio needs to produce
+// <count> output samples.
+u32 GetResampleInputCount(u32 count, u32 curr_pos, u32 ratio, int srctype)
+{
+  if (srctype == SRCTYPE_LINEAR || srctype == SRCTYPE_POLYPHASE)
+    return AXMixer::GetRequiredInputSamples(count, curr_pos, ratio);
+  return count;
+}
+
 // Read <count> input samples from ARAM, decoding and converting rate
 // if required.
 void GetInputSamples(PB_TYPE& pb, s16* samples, u16 count, const s16* coeffs)
 {
+  // Samples are decoded in one block before being resampled. High ratios can
+  // require a lot of input samples, so the buffer only grows as needed.
+  static std::vector<s16> s_input_samples;
+
   AcceleratorSetup(&pb);
 
   if (coeffs)
     coeffs += pb.coef_select * 0x200;
-  u32 curr_pos =
-      ResampleAudio([](u32) { return AcceleratorGetSample(); }, samples, count, pb.src.last_samples,
-                    pb.src.cur_addr_frac, HILO_TO_32(pb.src.ratio), pb.src_type, coeffs);
+
+  const u32 ratio = HILO_TO_32(pb.src.ratio);
+  const u32 input_count = GetResampleInputCount(count, pb.src.cur_addr_frac, ratio, pb.src_type);
+  if (s_input_samples.size() < input_count + 4)
+    s_input_samples.resize(input_count + 4);
+
+  AcceleratorGetSamples(s_input_samples.data() + 4, input_count);
+  u32 curr_pos = ResampleAudio(s_input_samples.data(), samples, count, pb.src.last_samples,
+                               pb.src.cur_addr_frac, ratio, pb.src_type, coeffs);
   pb.src.cur_addr_frac = (curr_pos & 0xFFFF);
 
   // Update current position, YN1, YN2 and pred scale in the PB.
@@ -397,27 +364,14 @@ void GetInputSamples(PB_TYPE& pb, s16* samples, u16 count, const s16* coeffs)
 // Add samples to an output buffer, with optional volume ramping.
 void MixAdd(int* out, const s16* input, u32 count, u16* pvol, s16* dpop, bool ramp)
 {
-  u16& volume = pvol[0];
-  u16 volume_delta = pvol[1];
-
   // If volume ramping is disabled, set volume_delta to 0. That way, the
   // mixing loop can avoid testing if volume ramping is enabled at each step,
   // and just add volume_delta.
-  if (!ramp)
-    volume_delta = 0;
-
-  for (u32 i = 0; i < count; ++i)
-  {
-    s64 sample = input[i];
-    sample *= volume;
-    sample >>= 15;
-    sample = std::clamp((s32)sample, -32767, 32767);  // -32768 ?
+  const u16 volume_delta = ramp ? pvol[1] : 0;
 
-    out[i] += (s16)sample;
-    volume += volume_delta;
-
-    *dpop = (s16)sample;
-  }
+  const s16 last_sample = AXMixer::MixAdd(out, input, count, pvol[0], volume_delta);
+  if (count)
+    *dpop = last_sample;
 }
 
 // Execute a low pass filter on the samples using one history value. Returns
@@ -443,12 +397,8 @@ void ProcessVoice(PB_TYPE& pb, const AXBuffers& buffers, u16 count, AXMixControl
   GetInputSamples(pb, samples, count, coeffs);
 
   // Apply a global volume ramp using the volume envelope parameters.
-  for (u32 i = 0; i < count; ++i)
-  {
-    samples[i] = std::clamp(((s32)samples[i] * pb.vol_env.cur_volume) >> 15, -32767,
-                            32767);  // -32768 ?
-    pb.vol_env.cur_volume += pb.vol_env.cur_volume_delta;
-  }
+  AXMixer::ApplyVolume(samples, count, pb.vol_env.cur_volume,
+                       static_cast<u16>(pb.vol_env.cur_volume_delta));
 
   // Optionally, execute a low pass filter
   // TODO: LPF code is currently broken, causing Super Monkey Ball sound
@@ -523,10 +473,12 @@ void ProcessVoice(PB_TYPE& pb, const AXBuffers& buffers, u16 count, AXMixControl
     s16 wm_samples[18];
 
     // We use ratio 0x55555 == (5 * 65536 + 21845) / 65536 == 5.3333 which
-    // is the nearest we can get to 96/18
-    u32 curr_pos = ResampleAudio([&samples](u32 i) { return samples[i]; }, wm_samples, wm_count,
-                                 pb.remote_src.last_samples, pb.remote_src.cur_addr_frac, 0x55555,
-                                 SRCTYPE_POLYPHASE, coeffs);
+    // is the nearest we can get to 96/18. This never needs more than the
+    // <count> samples we have.
+    s16 wm_input[4 + MAX_SAMPLES_PER_FRAME];
+    memcpy(wm_input + 4, samples, count * sizeof(s16));
+    u32 curr_pos = ResampleAudio(wm_input, wm_samples, wm_count, pb.remote_src.last_samples,
+                                 pb.remote_src.cur_addr_frac, 0x55555, SRCTYPE_POLYPHASE, coeffs);
     pb.remote_src.cur_addr_frac = curr_pos & 0xFFFF;
 
 // Mix to main[0-3] and aux[0-3]
@@ -4,6 +4,7 @@
 
 #include "Core/HW/DSPLLE/DSPLLE.h"
 
+#include <algorithm>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -11,11 +12,13 @@
 #include "Common/ChunkFile.h"
 #include "Common/CommonPaths.h"
 #include "Common/CommonTypes.h"
-#include "Common/Event.h"
 #include "Common/FileUtil.h"
 #include "Common/Logging/Log.h"
+#include "Common/MathUtil.h"
 #include "Common/MemoryUtil.h"
+#include "Common/StringUtil.h"
 #include "Common/Thread.h"
+#include "Common/Timer.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/DSP/DSPAccelerator.h"
@@ -32,10 +35,16 @@
 
 namespace DSP::LLE
 {
-static Common::Event s_dsp_event;
-static Common::Event s_ppc_event;
 static bool s_request_disable_thread;
 
+// How many DSP cycles the CPU thread may hand out before it has to wait for
+// the DSP thread to catch up. This bounds how far apart the two can drift.
+constexpr u32 MAX_PENDING_DSP_CYCLES = 8192;
+
+// How many times each side spins before falling back to sleeping on an event.
+constexpr int DSP_THREAD_SPIN_ITERATIONS = 64;
+constexpr int CPU_THREAD_SPIN_ITERATIONS = 256;
+
 DSPLLE::DSPLLE() = default;
 
 DSPLLE::~DSPLLE()
@@ -83,40 +92,83 @@ void DSPLLE::DoState(PointerWrap& p)
   p.DoArray(g_dsp.dram, DSP_DRAM_SIZE);
   p.Do(g_init_hax);
   p.Do(m_cycle_count);
+  if (p.GetMode() == PointerWrap::MODE_READ)
+  {
+    // The pending budget only means something to the DSP thread, and must stay within the bound
+    // DSP_Update relies on regardless of the settings the state was saved with.
+    if (m_is_dsp_on_thread)
+      m_cycle_count.store(std::min(m_cycle_count.load(), MAX_PENDING_DSP_CYCLES));
+    else
+      m_cycle_count.store(0);
+  }
 
   if (g_dsp_jit)
     g_dsp_jit->DoState(p);
 }
 
+void DSPLLE::LatencyHistogram::Add(u64 us)
+{
+  const size_t bucket = us == 0 ? 0 : static_cast<size_t>(IntLog2(us)) + 1;
+  m_buckets[std::min(bucket, NUM_BUCKETS - 1)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void DSPLLE::LatencyHistogram::Log(const char* name) const
+{
+  std::string text;
+  for (size_t i = 0; i < NUM_BUCKETS; ++i)
+  {
+    const u64 count = m_buckets[i].load(std::memory_order_relaxed);
+    if (count == 0)
+      continue;
+    // The last bucket also holds everything above its range.
+    const bool is_last = i == NUM_BUCKETS - 1;
+    text += StringFromFormat(is_last ? " >=%uus:%llu" : " <%uus:%llu", 1u << (is_last ? i - 1 : i),
+                             static_cast<unsigned long long>(count));
+  }
+  INFO_LOG(DSPLLE, "%s latency histogram:%s", name, text.empty() ? " empty" : text.c_str());
+}
+
+void DSPLLE::LatencyHistogram::Reset()
+{
+  for (auto& bucket : m_buckets)
+    bucket.store(0, std::memory_order_relaxed);
+}
+
 // Regular thread
 void DSPLLE::DSPThread(DSPLLE* dsp_lle)
 {
   Common::SetCurrentThreadName("DSP thread");
 
-  while (dsp_lle->m_is_running.IsSet())
+  dsp_lle->m_dsp_loop.Run([dsp_lle] { dsp_lle->RunThreadSlice(); });
+}
+
+// Payload of the DSP thread loop. Runs whatever cycle budget the CPU thread
+// has granted so far, then spins for a while before allowing the loop to
+// sleep until the next Wakeup().
+void DSPLLE::RunThreadSlice()
+{
+  if (m_cycle_count.load(std::memory_order_acquire) == 0)
   {
-    const int cycles = static_cast<int>(dsp_lle->m_cycle_count.load());
-    if (cycles > 0)
-    {
-      std::unique_lock dsp_thread_lock(dsp_lle->m_dsp_thread_mutex, std::try_to_lock);
-      if (dsp_thread_lock)
-      {
-        if (g_dsp_jit)
-        {
-          DSPCore_RunCycles(cycles);
-        }
-        else
-        {
-          DSP::Interpreter::RunCyclesThread(cycles);
-        }
-        dsp_lle->m_cycle_count.store(0);
-        continue;
-      }
-    }
+    if (++m_idle_iterations >= DSP_THREAD_SPIN_ITERATIONS)
+      m_dsp_loop.AllowSleep();
+    return;
+  }
+  m_idle_iterations = 0;
 
-    s_ppc_event.Set();
-    s_dsp_event.Wait();
+  const u64 start = Common::Timer::GetTimeUs();
+  {
+    std::lock_guard<std::mutex> dsp_thread_lock(m_dsp_thread_mutex);
+    // Read the budget under the lock: a state load while we waited for it replaces the budget.
+    const u32 cycles = m_cycle_count.load(std::memory_order_acquire);
+    if (g_dsp_jit)
+      DSPCore_RunCycles(static_cast<int>(cycles));
+    else
+      DSP::Interpreter::RunCyclesThread(static_cast<int>(cycles));
+
+    // Only consume what was run: the CPU thread may have added more meanwhile.
+    m_cycle_count.fetch_sub(cycles, std::memory_order_release);
   }
+  m_dsp_slice_histogram.Add(Common::Timer::GetTimeUs() - start);
 }
 
 static bool LoadDSPRom(u16* rom, const std::string& filename, u32 size_in_bytes)
@@ -196,7 +248,11 @@ bool DSPLLE::Initialize(bool wii, bool dsp_thread)
 
   if (dsp_thread)
   {
-    m_is_running.Set(true);
+    m_cycle_count.store(0);
+    m_idle_iterations = 0;
+    m_cpu_stall_histogram.Reset();
+    m_dsp_slice_histogram.Reset();
+    m_dsp_loop.Prepare();
     m_dsp_thread = std::thread(DSPThread, this);
   }
 
@@ -207,12 +263,19 @@ bool DSPLLE::Initialize(bool wii, bool dsp_thread)
 void DSPLLE::DSP_StopSoundStream()
 {
   if (m_is_dsp_on_thread)
-  {
-    m_is_running.Clear();
-    s_ppc_event.Set();
-    s_dsp_event.Set();
-    m_dsp_thread.join();
-  }
+    StopThread();
+}
+
+void DSPLLE::StopThread()
+{
+  if (!m_dsp_thread.joinable())
+    return;
+
+  m_dsp_loop.Stop();
+  m_dsp_thread.join();
+
+  m_cpu_stall_histogram.Log("CPU stall");
+  m_dsp_slice_histogram.Log("DSP slice");
 }
 
 void DSPLLE::Shutdown()
@@ -310,6 +373,9 @@ void DSPLLE::DSP_Update(int cycles)
       m_is_dsp_on_thread = false;
       s_request_disable_thread = false;
       SConfig::GetInstance().bDSPThread = false;
+
+      // Run the budget the DSP thread did not get to.
+      dsp_cycles += static_cast<int>(m_cycle_count.exchange(0));
     }
   }
 
@@ -321,10 +387,25 @@ void DSPLLE::DSP_Update(int cycles)
   }
   else
   {
-    // Wait for DSP thread to complete its cycle. Note: this logic should be thought through.
-    s_ppc_event.Wait();
-    m_cycle_count.fetch_add(dsp_cycles);
-    s_dsp_event.Set();
+    // Hand the budget to the DSP thread without blocking. Only wait if the
+    // DSP thread has fallen too far behind, spinning first since it usually
+    // catches up quickly.
+    const u32 pending =
+        m_cycle_count.fetch_add(dsp_cycles, std::memory_order_acq_rel) + dsp_cycles;
+    m_dsp_loop.Wakeup();
+    if (pending <= MAX_PENDING_DSP_CYCLES)
+      return;
+
+    const u64 start = Common::Timer::GetTimeUs();
+    for (int i = 0; i < CPU_THREAD_SPIN_ITERATIONS; ++i)
+    {
+      if (m_cycle_count.load(std::memory_order_acquire) <= MAX_PENDING_DSP_CYCLES)
+        break;
+      Common::YieldCPU();
+    }
+    if (m_cycle_count.load(std::memory_order_acquire) > MAX_PENDING_DSP_CYCLES)
+      m_dsp_loop.Wait();
+    m_cpu_stall_histogram.Add(Common::Timer::GetTimeUs() - start);
   }
 }
 
@@ -346,8 +427,7 @@ void DSPLLE::PauseAndLock(bool do_lock, bool unpause_on_unlock)
     if (m_is_dsp_on_thread)
     {
       // Signal the DSP thread so it can perform any outstanding work now (if any)
-      s_ppc_event.Wait();
-      s_dsp_event.Set();
+      m_dsp_loop.Wakeup();
     }
   }
 }
@@ -4,12 +4,13 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <mutex>
 #include <thread>
 
+#include "Common/BlockingLoop.h"
 #include "Common/CommonTypes.h"
-#include "Common/Flag.h"
 #include "Core/DSPEmulator.h"
 
 class PointerWrap;
@@ -39,12 +40,36 @@ public:
   u32 DSP_UpdateRate() override;
 
 private:
+  // Log2 histogram of latencies in microseconds. Used to check how often and
+  // for how long the CPU thread has to wait for the DSP thread.
+  class LatencyHistogram
+  {
+  public:
+    void Add(u64 us);
+    void Log(const char* name) const;
+    void Reset();
+
+  private:
+    static constexpr size_t NUM_BUCKETS = 16;
+    std::array<std::atomic<u64>, NUM_BUCKETS> m_buckets{};
+  };
+
   static void DSPThread(DSPLLE* dsp_lle);
+  void RunThreadSlice();
+  void StopThread();
 
   std::thread m_dsp_thread;
+  // Only contended while the emulation is paused (see PauseAndLock).
   std::mutex m_dsp_thread_mutex;
   bool m_is_dsp_on_thread = false;
-  Common::Flag m_is_running;
+  Common::BlockingLoop m_dsp_loop;
+  int m_idle_iterations = 0;
+
+  // Cycle budget granted by the CPU thread that the DSP thread has not run
+  // yet. Single producer (CPU thread), single consumer (DSP thread).
   std::atomic<u32> m_cycle_count{};
+
+  LatencyHistogram m_cpu_stall_histogram;
+  LatencyHistogram m_dsp_slice_histogram;
 };
 }  // namespace DSP::LLE
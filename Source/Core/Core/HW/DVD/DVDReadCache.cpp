@@ -0,0 +1,202 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/HW/DVD/DVDReadCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "DiscIO/Volume.h"
+
+namespace DVDThread
+{
+// How far ahead of a sequential stream to read, and how much to read at once. Reading ahead
+// in chunks lets new requests get in between.
+constexpr u64 READ_AHEAD_SIZE = 0x100000;
+constexpr u64 READ_AHEAD_CHUNK_BLOCKS = 8;
+
+// A stream is considered sequential after this many reads that each continue the previous one.
+constexpr u32 SEQUENTIAL_READS_FOR_READ_AHEAD = 2;
+
+static u64 BlockCeil(u64 offset)
+{
+  return (offset + ReadCache::BLOCK_SIZE - 1) / ReadCache::BLOCK_SIZE;
+}
+
+ReadCache::ReadCache(ReadFunction read) : m_read(std::move(read))
+{
+}
+
+void ReadCache::SetCapacity(u64 bytes)
+{
+  m_max_blocks = static_cast<size_t>(bytes / BLOCK_SIZE);
+  m_read_ahead_size = std::min(READ_AHEAD_SIZE, m_max_blocks / 4 * BLOCK_SIZE);
+
+  while (m_blocks.size() > m_max_blocks)
+  {
+    m_block_map.erase(m_blocks.back().key);
+    m_blocks.pop_back();
+  }
+
+  StopReadAhead();
+}
+
+void ReadCache::Clear()
+{
+  m_blocks.clear();
+  m_block_map.clear();
+  StopReadAhead();
+}
+
+bool ReadCache::Read(u64 offset, u64 length, u8* buffer, const DiscIO::Partition& partition)
+{
+  if (m_max_blocks == 0 || length == 0)
+    return m_read(offset, length, buffer, partition);
+
+  UpdateStream(offset, length, partition);
+
+  // Reads that don't fit in the cache and reads that include the partial block at the end of
+  // the disc bypass the cache.
+  const u64 first_block = offset / BLOCK_SIZE;
+  const u64 end_block = BlockCeil(offset + length);
+  if (end_block - first_block > m_max_blocks || !FetchBlocks(first_block, end_block, partition))
+    return m_read(offset, length, buffer, partition);
+
+  for (u64 block = first_block; block < end_block; ++block)
+  {
+    const std::vector<u8>* data = FindBlock({partition.offset, block});
+    if (!data)
+      return m_read(offset, length, buffer, partition);
+
+    const u64 block_offset = block * BLOCK_SIZE;
+    const u64 copy_start = std::max(offset, block_offset);
+    const u64 copy_end = std::min(offset + length, block_offset + BLOCK_SIZE);
+    std::memcpy(buffer + (copy_start - offset), data->data() + (copy_start - block_offset),
+                static_cast<size_t>(copy_end - copy_start));
+  }
+
+  return true;
+}
+
+void ReadCache::Fetch(u64 offset, u64 length, const DiscIO::Partition& partition)
+{
+  if (m_max_blocks == 0 || length == 0)
+    return;
+
+  const u64 first_block = offset / BLOCK_SIZE;
+  const u64 end_block = std::min<u64>(BlockCeil(offset + length), first_block + m_max_blocks);
+  FetchBlocks(first_block, end_block, partition);
+}
+
+bool ReadCache::ReadAhead()
+{
+  if (m_read_ahead_offset >= m_read_ahead_end)
+    return false;
+
+  const u64 first_block = m_read_ahead_offset / BLOCK_SIZE;
+  const u64 end_block =
+      std::min(first_block + READ_AHEAD_CHUNK_BLOCKS, BlockCeil(m_read_ahead_end));
+  if (!FetchBlocks(first_block, end_block, m_stream_partition))
+  {
+    // Most likely the end of the disc
+    StopReadAhead();
+    return false;
+  }
+
+  m_read_ahead_offset = end_block * BLOCK_SIZE;
+  return true;
+}
+
+void ReadCache::StopReadAhead()
+{
+  m_sequential_reads = 0;
+  m_read_ahead_offset = 0;
+  m_read_ahead_end = 0;
+}
+
+const std::vector<u8>* ReadCache::FindBlock(const BlockKey& key)
+{
+  const auto it = m_block_map.find(key);
+  if (it == m_block_map.end())
+    return nullptr;
+
+  m_blocks.splice(m_blocks.begin(), m_blocks, it->second);
+  return &it->second->data;
+}
+
+void ReadCache::InsertBlock(const BlockKey& key, const u8* data)
+{
+  // Reuse the storage of the least recently used block when the cache is full.
+  if (m_blocks.size() >= m_max_blocks)
+  {
+    m_block_map.erase(m_blocks.back().key);
+    m_blocks.splice(m_blocks.begin(), m_blocks, std::prev(m_blocks.end()));
+  }
+  else
+  {
+    m_blocks.emplace_front();
+  }
+
+  Block& block = m_blocks.front();
+  block.key = key;
+  block.data.assign(data, data + BLOCK_SIZE);
+  m_block_map[key] = m_blocks.begin();
+}
+
+bool ReadCache::FetchBlocks(u64 first_block, u64 end_block, const DiscIO::Partition& partition)
+{
+  std::vector<u8> buffer;
+  u64 block = first_block;
+  while (block < end_block)
+  {
+    if (FindBlock({partition.offset, block}))
+    {
+      ++block;
+      continue;
+    }
+
+    // Read each run of missing blocks in one go.
+    u64 run_end = block + 1;
+    while (run_end < end_block && m_block_map.count({partition.offset, run_end}) == 0)
+      ++run_end;
+
+    buffer.resize(static_cast<size_t>((run_end - block) * BLOCK_SIZE));
+    if (!m_read(block * BLOCK_SIZE, buffer.size(), buffer.data(), partition))
+      return false;
+
+    for (u64 i = block; i < run_end; ++i)
+      InsertBlock({partition.offset, i}, buffer.data() + (i - block) * BLOCK_SIZE);
+
+    block = run_end;
+  }
+
+  return true;
+}
+
+void ReadCache::UpdateStream(u64 offset, u64 length, const DiscIO::Partition& partition)
+{
+  // Small gaps and overlaps still count as sequential.
+  const bool sequential = partition == m_stream_partition &&
+                          offset <= m_stream_end + BLOCK_SIZE &&
+                          offset + BLOCK_SIZE >= m_stream_end;
+  m_stream_partition = partition;
+  m_stream_end = offset + length;
+
+  if (!sequential)
+  {
+    StopReadAhead();
+    return;
+  }
+
+  if (++m_sequential_reads < SEQUENTIAL_READS_FOR_READ_AHEAD)
+    return;
+
+  m_read_ahead_offset = std::max(m_read_ahead_offset, BlockCeil(m_stream_end) * BLOCK_SIZE);
+  m_read_ahead_end = m_stream_end + m_read_ahead_size;
+}
+}  // namespace DVDThread
@@ -0,0 +1,80 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "DiscIO/Volume.h"
+
+namespace DVDThread
+{
+// Caches disc data in fixed size blocks on behalf of the DVD thread. Missing blocks are read
+// from the disc in as few reads as possible, and when the emulated software reads the disc
+// sequentially, the data after the last read is prefetched while the DVD thread is idle. This
+// keeps games that stream audio or video from the disc from waiting on compressed or slow disc
+// images.
+//
+// Only used by the DVD thread, so it isn't thread-safe.
+class ReadCache
+{
+public:
+  using ReadFunction =
+      std::function<bool(u64 offset, u64 length, u8* buffer, const DiscIO::Partition& partition)>;
+
+  static constexpr u64 BLOCK_SIZE = 0x8000;
+
+  explicit ReadCache(ReadFunction read);
+
+  // A capacity of 0 disables both the cache and read-ahead.
+  void SetCapacity(u64 bytes);
+  void Clear();
+
+  bool Read(u64 offset, u64 length, u8* buffer, const DiscIO::Partition& partition);
+
+  // Makes sure that the given range is cached, so that several requests for nearby data can be
+  // served by a single disc read.
+  void Fetch(u64 offset, u64 length, const DiscIO::Partition& partition);
+
+  // Prefetches the next chunk of the current sequential stream. Returns false if there is
+  // nothing left to prefetch.
+  bool ReadAhead();
+  void StopReadAhead();
+
+private:
+  // Partition offset and block index
+  using BlockKey = std::pair<u64, u64>;
+
+  struct Block
+  {
+    BlockKey key;
+    std::vector<u8> data;
+  };
+
+  const std::vector<u8>* FindBlock(const BlockKey& key);
+  void InsertBlock(const BlockKey& key, const u8* data);
+  bool FetchBlocks(u64 first_block, u64 end_block, const DiscIO::Partition& partition);
+  void UpdateStream(u64 offset, u64 length, const DiscIO::Partition& partition);
+
+  ReadFunction m_read;
+  size_t m_max_blocks = 0;
+  u64 m_read_ahead_size = 0;
+
+  // Most recently used first
+  std::list<Block> m_blocks;
+  std::map<BlockKey, std::list<Block>::iterator> m_block_map;
+
+  DiscIO::Partition m_stream_partition;
+  u64 m_stream_end = 0;
+  u32 m_sequential_reads = 0;
+  u64 m_read_ahead_offset = 0;
+  u64 m_read_ahead_end = 0;
+};
+}  // namespace DVDThread
@@ -4,12 +4,14 @@
 
 #include "Core/HW/DVD/DVDThread.h"
 
+#include <algorithm>
 #include <cinttypes>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <thread>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -23,10 +25,12 @@
 #include "Common/Thread.h"
 #include "Common/Timer.h"
 
+#include "Core/Config/MainSettings.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
 #include "Core/HW/DVD/DVDInterface.h"
+#include "Core/HW/DVD/DVDReadCache.h"
 #include "Core/HW/DVD/FileMonitor.h"
 #include "Core/HW/Memmap.h"
 #include "Core/HW/SystemTimers.h"
@@ -89,6 +93,17 @@ static std::map<u64, ReadResult> s_result_map;
 
 static std::unique_ptr<DiscIO::Volume> s_disc;
 
+// Only used by the DVD thread, or while it is idle.
+static ReadCache s_read_cache([](u64 offset, u64 length, u8* buffer,
+                                 const DiscIO::Partition& partition) {
+  return s_disc->Read(offset, length, buffer, partition);
+});
+
+// Requests that are queued at the same time and are at most this far apart get merged into
+// one disc read, up to MAX_MERGED_READ_SIZE bytes.
+constexpr u64 MAX_MERGE_GAP = ReadCache::BLOCK_SIZE;
+constexpr u64 MAX_MERGED_READ_SIZE = 0x400000;
+
 void Start()
 {
   s_finish_read = CoreTiming::RegisterEvent("FinishReadDVDThread", FinishRead);
@@ -102,6 +117,9 @@ void Start()
   // much, because this will never get exposed to the emulated game.
   s_next_id = 0;
 
+  s_read_cache.SetCapacity(u64(std::max(Config::Get(Config::MAIN_DISC_READ_CACHE_SIZE), 0))
+                           << 20);
+
   StartDVDThread();
 }
 
@@ -116,6 +134,7 @@ void Stop()
 {
   StopDVDThread();
   s_disc.reset();
+  s_read_cache.Clear();
 }
 
 static void StopDVDThread()
@@ -129,6 +148,9 @@ static void StopDVDThread()
   s_request_queue_expanded.Set();
 
   s_dvd_thread.join();
+
+  // Don't let a new DVD thread continue reading ahead while the caller changes things.
+  s_read_cache.StopReadAhead();
 }
 
 void DoState(PointerWrap& p)
@@ -179,6 +201,7 @@ void SetDisc(std::unique_ptr<DiscIO::Volume> disc)
 {
   WaitUntilIdle();
   s_disc = std::move(disc);
+  s_read_cache.Clear();
 }
 
 bool HasDisc()
@@ -363,10 +386,43 @@ static void FinishRead(u64 id, s64 cycles_late)
   DVDInterface::FinishExecutingCommand(request.reply_type, interrupt, cycles_late, buffer);
 }
 
+// Reads ranges that are covered by more than one request into the cache in one go.
+static void FetchMergedRanges(const std::vector<ReadRequest>& requests)
+{
+  std::vector<const ReadRequest*> sorted(requests.size());
+  for (size_t i = 0; i < requests.size(); ++i)
+    sorted[i] = &requests[i];
+  std::sort(sorted.begin(), sorted.end(), [](const ReadRequest* a, const ReadRequest* b) {
+    return std::tie(a->partition, a->dvd_offset) < std::tie(b->partition, b->dvd_offset);
+  });
+
+  size_t i = 0;
+  while (i < sorted.size())
+  {
+    const DiscIO::Partition& partition = sorted[i]->partition;
+    const u64 start = sorted[i]->dvd_offset;
+    u64 end = start + sorted[i]->length;
+    size_t j = i + 1;
+    while (j < sorted.size() && sorted[j]->partition == partition &&
+           sorted[j]->dvd_offset <= end + MAX_MERGE_GAP &&
+           sorted[j]->dvd_offset + sorted[j]->length - start <= MAX_MERGED_READ_SIZE)
+    {
+      end = std::max(end, sorted[j]->dvd_offset + sorted[j]->length);
+      ++j;
+    }
+
+    if (j - i > 1)
+      s_read_cache.Fetch(start, end - start, partition);
+
+    i = j;
+  }
+}
+
 static void DVDThread()
 {
   Common::SetCurrentThreadName("DVD thread");
 
+  std::vector<ReadRequest> requests;
   while (true)
   {
     s_request_queue_expanded.Wait();
@@ -374,23 +430,41 @@ static void DVDThread()
     if (s_dvd_thread_exiting.IsSet())
       return;
 
-    ReadRequest request;
-    while (s_request_queue.Pop(request))
+    // Take every request that is already waiting, so that reads of nearby data can be merged.
+    // WaitUntilIdle only waits for the request queue to be empty before stopping this thread,
+    // so all requests that have been taken must be finished before checking for exit.
+    ReadRequest new_request;
+    while (s_request_queue.Pop(new_request))
+      requests.push_back(std::move(new_request));
+
+    if (requests.size() > 1)
+      FetchMergedRanges(requests);
+
+    for (ReadRequest& request : requests)
     {
       FileMonitor::Log(*s_disc, request.partition, request.dvd_offset);
 
       std::vector<u8> buffer(request.length);
-      if (!s_disc->Read(request.dvd_offset, request.length, buffer.data(), request.partition))
+      if (!s_read_cache.Read(request.dvd_offset, request.length, buffer.data(),
+                             request.partition))
+      {
         buffer.resize(0);
+      }
 
       request.realtime_done_us = Common::Timer::GetTimeUs();
 
       s_result_queue.Push(ReadResult(std::move(request), std::move(buffer)));
       s_result_queue_expanded.Set();
+    }
+    requests.clear();
 
-      if (s_dvd_thread_exiting.IsSet())
-        return;
+    // Read ahead of sequential streams until the next request comes in.
+    while (!s_dvd_thread_exiting.IsSet() && s_request_queue.Empty() && s_read_cache.ReadAhead())
+    {
     }
+
+    if (s_dvd_thread_exiting.IsSet())
+      return;
   }
 }
 }  // namespace DVDThread
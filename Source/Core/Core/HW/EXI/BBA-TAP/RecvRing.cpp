@@ -0,0 +1,65 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/HW/EXI/BBA-TAP/RecvRing.h"
+
+#include <algorithm>
+
+#include "Common/Timer.h"
+
+namespace ExpansionInterface
+{
+u8* BBARecvRing::BeginWrite()
+{
+  const u32 write = m_write.load(std::memory_order_relaxed);
+  if (write - m_read.load(std::memory_order_acquire) == BBA_RECV_RING_FRAMES)
+    return nullptr;
+
+  return m_frames[write % BBA_RECV_RING_FRAMES].data.data();
+}
+
+void BBARecvRing::EndWrite(u32 length)
+{
+  const u32 write = m_write.load(std::memory_order_relaxed);
+  Frame& frame = m_frames[write % BBA_RECV_RING_FRAMES];
+  frame.length = std::min<u32>(length, BBA_RECV_SIZE);
+  frame.timestamp_us = Common::Timer::GetTimeUs();
+  m_write.store(write + 1, std::memory_order_release);
+}
+
+void BBARecvRing::Drop()
+{
+  m_dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+const BBARecvRing::Frame* BBARecvRing::Front() const
+{
+  const u32 read = m_read.load(std::memory_order_relaxed);
+  if (read == m_write.load(std::memory_order_acquire))
+    return nullptr;
+
+  return &m_frames[read % BBA_RECV_RING_FRAMES];
+}
+
+void BBARecvRing::Pop()
+{
+  const u32 read = m_read.load(std::memory_order_relaxed);
+  const u64 now = Common::Timer::GetTimeUs();
+  const u64 timestamp = m_frames[read % BBA_RECV_RING_FRAMES].timestamp_us;
+  const u64 latency = now > timestamp ? now - timestamp : 0;
+
+  ++m_stats.frames;
+  m_stats.total_latency_us += latency;
+  m_stats.max_latency_us = std::max(m_stats.max_latency_us, latency);
+
+  m_read.store(read + 1, std::memory_order_release);
+}
+
+BBARecvStats BBARecvRing::GetStats() const
+{
+  BBARecvStats stats = m_stats;
+  stats.dropped = m_dropped.load(std::memory_order_relaxed);
+  return stats;
+}
+}  // namespace ExpansionInterface
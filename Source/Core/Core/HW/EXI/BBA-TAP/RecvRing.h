@@ -0,0 +1,61 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+
+#include "Common/CommonTypes.h"
+
+#define BBA_RECV_SIZE 0x800
+
+namespace ExpansionInterface
+{
+// How many frames the TAP read thread can queue before the emulated BBA takes them
+constexpr u32 BBA_RECV_RING_FRAMES = 64;
+
+struct BBARecvStats
+{
+  u64 frames = 0;
+  // Frames that were read while the ring was full
+  u64 dropped = 0;
+  // Time between reading a frame from the TAP device and handing it to the BBA
+  u64 total_latency_us = 0;
+  u64 max_latency_us = 0;
+};
+
+// Lock-free queue of received frames, written by the TAP read thread and read by the CPU thread.
+// There must only be one thread on each side.
+class BBARecvRing
+{
+public:
+  struct Frame
+  {
+    std::array<u8, BBA_RECV_SIZE> data;
+    u32 length;
+    u64 timestamp_us;
+  };
+
+  // Returns the buffer to read the next frame into, or nullptr if the ring is full
+  u8* BeginWrite();
+  void EndWrite(u32 length);
+  void Drop();
+
+  // Returns nullptr if the ring is empty
+  const Frame* Front() const;
+  void Pop();
+
+  BBARecvStats GetStats() const;
+
+private:
+  std::array<Frame, BBA_RECV_RING_FRAMES> m_frames;
+  std::atomic<u32> m_read{0};
+  std::atomic<u32> m_write{0};
+  std::atomic<u64> m_dropped{0};
+
+  // Only accessed by the reading side
+  BBARecvStats m_stats;
+};
+}  // namespace ExpansionInterface
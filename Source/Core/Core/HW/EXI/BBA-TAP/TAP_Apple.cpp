@@ -77,17 +77,28 @@ void CEXIETHERNET::ReadThreadHandler(CEXIETHERNET* self)
     if (select(self->fd + 1, &rfds, nullptr, nullptr, &timeout) <= 0)
       continue;
 
-    int readBytes = read(self->fd, self->mRecvBuffer.get(), BBA_RECV_SIZE);
+    u8* buffer = self->mRecvRing.BeginWrite();
+    const bool full = buffer == nullptr;
+    if (full)
+    {
+      static u8 discarded[BBA_RECV_SIZE];
+      buffer = discarded;
+    }
+
+    int readBytes = read(self->fd, buffer, BBA_RECV_SIZE);
     if (readBytes < 0)
     {
       ERROR_LOG(SP1, "Failed to read from BBA, err=%d", readBytes);
     }
-    else if (self->readEnabled.IsSet())
+    else if (full)
+    {
+      self->mRecvRing.Drop();
+    }
+    else
     {
-      INFO_LOG(SP1, "Read data: %s",
-               ArrayToString(self->mRecvBuffer.get(), readBytes, 0x10).c_str());
-      self->mRecvBufferLength = readBytes;
-      self->RecvHandlePacket();
+      INFO_LOG(SP1, "Read data: %s", ArrayToString(buffer, readBytes, 0x10).c_str());
+      self->mRecvRing.EndWrite(readBytes);
+      self->RecvNotify();
     }
   }
 }
@@ -2,6 +2,7 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <cerrno>
 #include <cstring>
 
 #ifndef _WIN32
@@ -70,6 +71,9 @@ bool CEXIETHERNET::Activate()
   }
   ioctl(fd, TUNSETNOCSUM, 1);
 
+  // The read thread reads frames until none are left
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
   INFO_LOG(SP1, "BBA initialized with associated tap %s", ifr.ifr_name);
   return RecvInit();
 #else
@@ -139,18 +143,39 @@ void CEXIETHERNET::ReadThreadHandler(CEXIETHERNET* self)
     if (select(self->fd + 1, &rfds, nullptr, nullptr, &timeout) <= 0)
       continue;
 
-    int readBytes = read(self->fd, self->mRecvBuffer.get(), BBA_RECV_SIZE);
-    if (readBytes < 0)
-    {
-      ERROR_LOG(SP1, "Failed to read from BBA, err=%d", readBytes);
-    }
-    else if (self->readEnabled.IsSet())
+    // Read the whole burst, so the CPU thread can take all of it at once
+    bool queued = false;
+    while (true)
     {
-      DEBUG_LOG(SP1, "Read data: %s",
-                ArrayToString(self->mRecvBuffer.get(), readBytes, 0x10).c_str());
-      self->mRecvBufferLength = readBytes;
-      self->RecvHandlePacket();
+      u8* buffer = self->mRecvRing.BeginWrite();
+      const bool full = buffer == nullptr;
+      if (full)
+      {
+        static u8 discarded[BBA_RECV_SIZE];
+        buffer = discarded;
+      }
+
+      const int readBytes = read(self->fd, buffer, BBA_RECV_SIZE);
+      if (readBytes <= 0)
+      {
+        if (readBytes < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+          ERROR_LOG(SP1, "Failed to read from BBA, err=%d", errno);
+        break;
+      }
+
+      if (full)
+      {
+        self->mRecvRing.Drop();
+        continue;
+      }
+
+      DEBUG_LOG(SP1, "Read data: %s", ArrayToString(buffer, readBytes, 0x10).c_str());
+      self->mRecvRing.EndWrite(readBytes);
+      queued = true;
     }
+
+    if (queued)
+      self->RecvNotify();
   }
 }
 #endif
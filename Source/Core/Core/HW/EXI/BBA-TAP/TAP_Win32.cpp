@@ -269,9 +269,16 @@ void CEXIETHERNET::ReadThreadHandler(CEXIETHERNET* self)
   {
     DWORD transferred;
 
-    // Read from TAP into internal buffer.
-    if (ReadFile(self->mHAdapter, self->mRecvBuffer.get(), BBA_RECV_SIZE, &transferred,
-                 &self->mReadOverlapped))
+    // Read from TAP into the receive ring, or discard the frame if it is full.
+    u8* buffer = self->mRecvRing.BeginWrite();
+    const bool full = buffer == nullptr;
+    if (full)
+    {
+      static u8 discarded[BBA_RECV_SIZE];
+      buffer = discarded;
+    }
+
+    if (ReadFile(self->mHAdapter, buffer, BBA_RECV_SIZE, &transferred, &self->mReadOverlapped))
     {
       // Returning immediately is not likely to happen, but if so, reset the event state manually.
       ResetEvent(self->mReadOverlapped.hEvent);
@@ -298,13 +305,17 @@ void CEXIETHERNET::ReadThreadHandler(CEXIETHERNET* self)
       }
     }
 
-    // Copy to BBA buffer, and fire interrupt if enabled.
+    // Queue the frame for the BBA, which takes it on the CPU thread.
     DEBUG_LOG(SP1, "Received %u bytes:\n %s", transferred,
-              ArrayToString(self->mRecvBuffer.get(), transferred, 0x10).c_str());
-    if (self->readEnabled.IsSet())
+              ArrayToString(buffer, transferred, 0x10).c_str());
+    if (full)
+    {
+      self->mRecvRing.Drop();
+    }
+    else
     {
-      self->mRecvBufferLength = transferred;
-      self->RecvHandlePacket();
+      self->mRecvRing.EndWrite(transferred);
+      self->RecvNotify();
     }
   }
 }
@@ -4,6 +4,8 @@
 
 #include "Core/HW/EXI/EXI_DeviceEthernet.h"
 
+#include <algorithm>
+#include <cinttypes>
 #include <memory>
 #include <optional>
 #include <string>
@@ -16,6 +18,7 @@
 #include "Core/CoreTiming.h"
 #include "Core/HW/EXI/EXI.h"
 #include "Core/HW/Memmap.h"
+#include "Core/HW/SystemTimers.h"
 
 namespace ExpansionInterface
 {
@@ -23,6 +26,25 @@ namespace ExpansionInterface
 // Multiple parts of this implementation depend on Dolphin
 // being compiled for a little endian host.
 
+static CoreTiming::EventType* s_et_recv_frames;
+
+void CEXIETHERNET::RecvFramesCallback(u64 userdata, s64 cycles_late)
+{
+  auto* const bba = static_cast<CEXIETHERNET*>(ExpansionInterface::FindDevice(EXIDEVICE_ETH));
+  if (bba)
+    bba->RecvFrames();
+}
+
+void CEXIETHERNET::Init()
+{
+  s_et_recv_frames = CoreTiming::RegisterEvent("BBARecvFrames", RecvFramesCallback);
+}
+
+void CEXIETHERNET::Shutdown()
+{
+  s_et_recv_frames = nullptr;
+}
+
 CEXIETHERNET::CEXIETHERNET()
 {
   tx_fifo = std::make_unique<u8[]>(BBA_TXFIFO_SIZE);
@@ -53,6 +75,15 @@ CEXIETHERNET::CEXIETHERNET()
 CEXIETHERNET::~CEXIETHERNET()
 {
   Deactivate();
+
+  const BBARecvStats stats = mRecvRing.GetStats();
+  if (stats.frames != 0 || stats.dropped != 0)
+  {
+    INFO_LOG(SP1, "Received %" PRIu64 " frames, dropped %" PRIu64
+                  ", average latency %" PRIu64 " us, max latency %" PRIu64 " us",
+             stats.frames, stats.dropped,
+             stats.frames != 0 ? stats.total_latency_us / stats.frames : 0, stats.max_latency_us);
+  }
 }
 
 void CEXIETHERNET::SetCS(int cs)
@@ -195,6 +226,10 @@ void CEXIETHERNET::DoState(PointerWrap& p)
 {
   p.DoArray(tx_fifo.get(), BBA_TXFIFO_SIZE);
   p.DoArray(mBbaMem.get(), BBA_MEM_SIZE);
+
+  // Any pending event was replaced by the ones of the state, so let the next frame schedule one
+  if (p.GetMode() == PointerWrap::MODE_READ)
+    mRecvScheduled.Clear();
 }
 
 bool CEXIETHERNET::IsMXCommand(u32 const data)
@@ -569,7 +604,7 @@ bool CEXIETHERNET::RecvHandlePacket()
     mBbaMem[BBA_IR] |= INT_R;
 
     exi_status.interrupt |= exi_status.TRANSFER;
-    ExpansionInterface::ScheduleUpdateInterrupts(CoreTiming::FromThread::NON_CPU, 0);
+    ExpansionInterface::ScheduleUpdateInterrupts(CoreTiming::FromThread::CPU, 0);
   }
   else
   {
@@ -583,4 +618,58 @@ wait_for_next:
 
   return true;
 }
+
+bool CEXIETHERNET::RecvHasRoom(u32 length) const
+{
+  const u16 bp = page_ptr(BBA_BP);
+  const u16 rhbp = page_ptr(BBA_RHBP);
+  const u16 rrp = page_ptr(BBA_RRP);
+  const u16 rwp = page_ptr(BBA_RWP);
+  const u32 total_pages = rhbp > bp ? rhbp - bp : 0;
+  const u32 free_pages = rrp > rwp ? rrp - rwp : (rhbp - rwp) + (rrp - bp);
+
+  // The descriptor and the frame must not reach the read pointer. Frames that can never fit are
+  // handed over anyway, which overflows the buffer like on hardware.
+  const u32 needed_pages = (length + 4 + 0xff) / 0x100;
+  return needed_pages >= total_pages || needed_pages < free_pages;
+}
+
+// Called by the read thread after it queued frames
+void CEXIETHERNET::RecvNotify()
+{
+  if (!mRecvScheduled.TestAndSet())
+    return;
+
+  CoreTiming::ScheduleEvent(0, s_et_recv_frames, 0, CoreTiming::FromThread::NON_CPU);
+}
+
+void CEXIETHERNET::RecvFrames()
+{
+  // Frames queued from now on need another event
+  mRecvScheduled.Clear();
+
+  while (const BBARecvRing::Frame* frame = mRecvRing.Front())
+  {
+    // Frames that arrive while receiving is stopped are discarded, like on hardware
+    if (readEnabled.IsSet())
+    {
+      // Keep the frame until the game has made room for it, instead of dropping it
+      if (!RecvHasRoom(frame->length))
+      {
+        mRecvScheduled.Set();
+        CoreTiming::ScheduleEvent(SystemTimers::GetTicksPerSecond() / 2000, s_et_recv_frames);
+        return;
+      }
+
+      std::copy_n(frame->data.begin(), frame->length, mRecvBuffer.get());
+      mRecvBufferLength = frame->length;
+      mRecvRing.Pop();
+      RecvHandlePacket();
+    }
+    else
+    {
+      mRecvRing.Pop();
+    }
+  }
+}
 }  // namespace ExpansionInterface
@@ -13,6 +13,7 @@
 #endif
 
 #include "Common/Flag.h"
+#include "Core/HW/EXI/BBA-TAP/RecvRing.h"
 #include "Core/HW/EXI/EXI_Device.h"
 
 class PointerWrap;
@@ -194,13 +195,15 @@ enum RecvStatus
   DESC_RERR = 0x80
 };
 
-#define BBA_RECV_SIZE 0x800
-
 class CEXIETHERNET : public IEXIDevice
 {
 public:
   CEXIETHERNET();
   virtual ~CEXIETHERNET();
+
+  static void Init();
+  static void Shutdown();
+
   void SetCS(int cs) override;
   bool IsPresent() const override;
   bool IsInterruptSet() override;
@@ -211,6 +214,9 @@ public:
   void DoState(PointerWrap& p) override;
 
 private:
+  // Hands frames to the receive buffer in tests, without a TAP device
+  friend class BBARecvTest;
+
   struct
   {
     enum
@@ -293,6 +299,10 @@ private:
   bool RecvMACFilter();
   void inc_rwp();
   bool RecvHandlePacket();
+  bool RecvHasRoom(u32 length) const;
+  void RecvNotify();
+  void RecvFrames();
+  static void RecvFramesCallback(u64 userdata, s64 cycles_late);
 
   std::unique_ptr<u8[]> mBbaMem;
   std::unique_ptr<u8[]> tx_fifo;
@@ -309,6 +319,10 @@ private:
 
   std::unique_ptr<u8[]> mRecvBuffer;
   u32 mRecvBufferLength = 0;
+  // Frames are read by the read thread and handed to the BBA on the CPU thread
+  BBARecvRing mRecvRing;
+  Common::Flag mRecvScheduled;
+  Common::Flag readEnabled;
 
 #if defined(_WIN32)
   HANDLE mHAdapter = INVALID_HANDLE_VALUE;
@@ -323,7 +337,6 @@ private:
 #if defined(WIN32) || defined(__linux__) || defined(__APPLE__) || defined(__FreeBSD__) ||          \
     defined(__OpenBSD__)
   std::thread readThread;
-  Common::Flag readEnabled;
   Common::Flag readThreadShutdown;
 #endif
 };
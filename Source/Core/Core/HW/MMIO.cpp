@@ -178,6 +178,52 @@ WriteHandlingMethod<T>* ComplexWrite(std::function<void(u32, T)> lambda)
   return new ComplexHandlingMethod<T>(lambda);
 }
 
+// ComplexFunction: same as Complex, but holds a plain function pointer and an
+// opaque context instead of a lambda. Calls through these do not need to go
+// through std::function, and JITs can emit them as direct calls.
+template <typename T>
+class ComplexFunctionHandlingMethod : public ReadHandlingMethod<T>, public WriteHandlingMethod<T>
+{
+public:
+  ComplexFunctionHandlingMethod(ReadFunction<T> read_function, void* context)
+      : read_function_(read_function), context_(context)
+  {
+  }
+
+  ComplexFunctionHandlingMethod(WriteFunction<T> write_function, void* context)
+      : write_function_(write_function), context_(context)
+  {
+  }
+
+  virtual ~ComplexFunctionHandlingMethod() = default;
+  void AcceptReadVisitor(ReadHandlingMethodVisitor<T>& v) const override
+  {
+    DEBUG_ASSERT_MSG(MEMMAP, read_function_, "Visited a write complex handler as a read handler.");
+    v.VisitComplexFunction(read_function_, context_);
+  }
+
+  void AcceptWriteVisitor(WriteHandlingMethodVisitor<T>& v) const override
+  {
+    DEBUG_ASSERT_MSG(MEMMAP, write_function_, "Visited a read complex handler as a write handler.");
+    v.VisitComplexFunction(write_function_, context_);
+  }
+
+private:
+  ReadFunction<T> read_function_ = nullptr;
+  WriteFunction<T> write_function_ = nullptr;
+  void* context_;
+};
+template <typename T>
+ReadHandlingMethod<T>* ComplexRead(ReadFunction<T> function, void* context)
+{
+  return new ComplexFunctionHandlingMethod<T>(function, context);
+}
+template <typename T>
+WriteHandlingMethod<T>* ComplexWrite(WriteFunction<T> function, void* context)
+{
+  return new ComplexFunctionHandlingMethod<T>(function, context);
+}
+
 // Invalid: specialization of the complex handling type with lambdas that
 // display error messages.
 template <typename T>
@@ -300,6 +346,25 @@ void ReadHandler<T>::Visit(ReadHandlingMethodVisitor<T>& visitor)
   m_Method->AcceptReadVisitor(visitor);
 }
 
+template <typename T>
+T ReadHandler<T>::ReadConstant(void* context, u32)
+{
+  return static_cast<T>(static_cast<ReadHandler<T>*>(context)->m_Value);
+}
+
+template <typename T>
+T ReadHandler<T>::ReadDirect(void* context, u32)
+{
+  const ReadHandler<T>* handler = static_cast<ReadHandler<T>*>(context);
+  return *handler->m_DirectAddr & handler->m_Value;
+}
+
+template <typename T>
+T ReadHandler<T>::ReadLambda(void* context, u32 addr)
+{
+  return (*static_cast<const std::function<T(u32)>*>(context))(addr);
+}
+
 template <typename T>
 void ReadHandler<T>::ResetMethod(ReadHandlingMethod<T>* method)
 {
@@ -307,26 +372,41 @@ void ReadHandler<T>::ResetMethod(ReadHandlingMethod<T>* method)
 
   struct FuncCreatorVisitor : public ReadHandlingMethodVisitor<T>
   {
+    explicit FuncCreatorVisitor(ReadHandler<T>* handler) : h(handler) {}
     virtual ~FuncCreatorVisitor() = default;
 
-    std::function<T(u32)> ret;
+    ReadHandler<T>* h;
 
     void VisitConstant(T value) override
     {
-      ret = [value](u32) { return value; };
+      h->m_Value = value;
+      h->m_ReadFunc = &ReadHandler<T>::ReadConstant;
+      h->m_ReadContext = h;
     }
 
     void VisitDirect(const T* addr, u32 mask) override
     {
-      ret = [addr, mask](u32) { return *addr & mask; };
+      h->m_DirectAddr = addr;
+      h->m_Value = mask;
+      h->m_ReadFunc = &ReadHandler<T>::ReadDirect;
+      h->m_ReadContext = h;
     }
 
-    void VisitComplex(const std::function<T(u32)>* lambda) override { ret = *lambda; }
+    void VisitComplex(const std::function<T(u32)>* lambda) override
+    {
+      h->m_ReadFunc = &ReadHandler<T>::ReadLambda;
+      h->m_ReadContext = const_cast<std::function<T(u32)>*>(lambda);
+    }
+
+    void VisitComplexFunction(ReadFunction<T> function, void* context) override
+    {
+      h->m_ReadFunc = function;
+      h->m_ReadContext = context;
+    }
   };
 
-  FuncCreatorVisitor v;
+  FuncCreatorVisitor v(this);
   Visit(v);
-  m_ReadFunc = v.ret;
 }
 
 template <typename T>
@@ -354,6 +434,24 @@ void WriteHandler<T>::Visit(WriteHandlingMethodVisitor<T>& visitor)
   m_Method->AcceptWriteVisitor(visitor);
 }
 
+template <typename T>
+void WriteHandler<T>::WriteNop(void*, u32, T)
+{
+}
+
+template <typename T>
+void WriteHandler<T>::WriteDirect(void* context, u32, T val)
+{
+  const WriteHandler<T>* handler = static_cast<WriteHandler<T>*>(context);
+  *handler->m_DirectAddr = val & handler->m_Mask;
+}
+
+template <typename T>
+void WriteHandler<T>::WriteLambda(void* context, u32 addr, T val)
+{
+  (*static_cast<const std::function<void(u32, T)>*>(context))(addr, val);
+}
+
 template <typename T>
 void WriteHandler<T>::ResetMethod(WriteHandlingMethod<T>* method)
 {
@@ -361,26 +459,40 @@ void WriteHandler<T>::ResetMethod(WriteHandlingMethod<T>* method)
 
   struct FuncCreatorVisitor : public WriteHandlingMethodVisitor<T>
   {
+    explicit FuncCreatorVisitor(WriteHandler<T>* handler) : h(handler) {}
     virtual ~FuncCreatorVisitor() = default;
 
-    std::function<void(u32, T)> ret;
+    WriteHandler<T>* h;
 
     void VisitNop() override
     {
-      ret = [](u32, T) {};
+      h->m_WriteFunc = &WriteHandler<T>::WriteNop;
+      h->m_WriteContext = nullptr;
     }
 
     void VisitDirect(T* ptr, u32 mask) override
     {
-      ret = [ptr, mask](u32, T val) { *ptr = val & mask; };
+      h->m_DirectAddr = ptr;
+      h->m_Mask = mask;
+      h->m_WriteFunc = &WriteHandler<T>::WriteDirect;
+      h->m_WriteContext = h;
     }
 
-    void VisitComplex(const std::function<void(u32, T)>* lambda) override { ret = *lambda; }
+    void VisitComplex(const std::function<void(u32, T)>* lambda) override
+    {
+      h->m_WriteFunc = &WriteHandler<T>::WriteLambda;
+      h->m_WriteContext = const_cast<std::function<void(u32, T)>*>(lambda);
+    }
+
+    void VisitComplexFunction(WriteFunction<T> function, void* context) override
+    {
+      h->m_WriteFunc = function;
+      h->m_WriteContext = context;
+    }
   };
 
-  FuncCreatorVisitor v;
+  FuncCreatorVisitor v(this);
   Visit(v);
-  m_WriteFunc = v.ret;
 }
 
 // Define all the public specializations that are exported in MMIOHandlers.h.
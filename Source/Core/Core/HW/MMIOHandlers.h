@@ -55,10 +55,23 @@ WriteHandlingMethod<T>* DirectWrite(volatile T* addr, u32 mask = 0xFFFFFFFF);
 // Complex: use when no other handling method fits your needs. These allow you
 // to directly provide a function that will be called when a read/write needs
 // to be done.
+//
+// The plain function pointer + context variants should be preferred for hot
+// registers: they are dispatched without going through std::function, and the
+// JITs can emit a direct call to them.
+template <typename T>
+using ReadFunction = T (*)(void* context, u32 addr);
+template <typename T>
+using WriteFunction = void (*)(void* context, u32 addr, T val);
+
 template <typename T>
 ReadHandlingMethod<T>* ComplexRead(std::function<T(u32)>);
 template <typename T>
+ReadHandlingMethod<T>* ComplexRead(ReadFunction<T> function, void* context);
+template <typename T>
 WriteHandlingMethod<T>* ComplexWrite(std::function<void(u32, T)>);
+template <typename T>
+WriteHandlingMethod<T>* ComplexWrite(WriteFunction<T> function, void* context);
 
 // Invalid: log an error and return -1 in case of a read. These are the default
 // handlers set for all MMIO types.
@@ -103,6 +116,7 @@ public:
   virtual void VisitConstant(T value) = 0;
   virtual void VisitDirect(const T* addr, u32 mask) = 0;
   virtual void VisitComplex(const std::function<T(u32)>* lambda) = 0;
+  virtual void VisitComplexFunction(ReadFunction<T> function, void* context) = 0;
 };
 template <typename T>
 class WriteHandlingMethodVisitor
@@ -111,6 +125,7 @@ public:
   virtual void VisitNop() = 0;
   virtual void VisitDirect(T* addr, u32 mask) = 0;
   virtual void VisitComplex(const std::function<void(u32, T)>* lambda) = 0;
+  virtual void VisitComplexFunction(WriteFunction<T> function, void* context) = 0;
 };
 
 // These classes are INTERNAL. Do not use outside of the MMIO implementation
@@ -139,7 +154,7 @@ public:
     if (!m_Method)
       InitializeInvalid();
 
-    return m_ReadFunc(addr);
+    return m_ReadFunc(m_ReadContext, addr);
   }
 
   // Internal method called when changing the internal method object. Its
@@ -150,8 +165,21 @@ private:
   // Initialize this handler to an invalid handler. Done lazily to avoid
   // useless initialization of thousands of unused handler objects.
   void InitializeInvalid() { ResetMethod(InvalidRead<T>()); }
+
+  // Thunks used for the handling methods that do not directly provide a
+  // function. The context passed to them is the handler itself, except for
+  // ReadLambda which gets the std::function owned by the method object.
+  static T ReadConstant(void* context, u32 addr);
+  static T ReadDirect(void* context, u32 addr);
+  static T ReadLambda(void* context, u32 addr);
+
   std::unique_ptr<ReadHandlingMethod<T>> m_Method;
-  std::function<T(u32)> m_ReadFunc;
+  ReadFunction<T> m_ReadFunc = nullptr;
+  void* m_ReadContext = nullptr;
+
+  // Data used by the Constant and Direct thunks.
+  const T* m_DirectAddr = nullptr;
+  u32 m_Value = 0;
 };
 template <typename T>
 class WriteHandler
@@ -175,7 +203,7 @@ public:
     if (!m_Method)
       InitializeInvalid();
 
-    m_WriteFunc(addr, val);
+    m_WriteFunc(m_WriteContext, addr, val);
   }
 
   // Internal method called when changing the internal method object. Its
@@ -187,8 +215,20 @@ private:
   // Initialize this handler to an invalid handler. Done lazily to avoid
   // useless initialization of thousands of unused handler objects.
   void InitializeInvalid() { ResetMethod(InvalidWrite<T>()); }
+
+  // Thunks used for the handling methods that do not directly provide a
+  // function. See ReadHandler for the meaning of the context.
+  static void WriteNop(void* context, u32 addr, T val);
+  static void WriteDirect(void* context, u32 addr, T val);
+  static void WriteLambda(void* context, u32 addr, T val);
+
   std::unique_ptr<WriteHandlingMethod<T>> m_Method;
-  std::function<void(u32, T)> m_WriteFunc;
+  WriteFunction<T> m_WriteFunc = nullptr;
+  void* m_WriteContext = nullptr;
+
+  // Data used by the Direct thunk.
+  T* m_DirectAddr = nullptr;
+  u32 m_Mask = 0;
 };
 
 // Boilerplate boilerplate boilerplate.
@@ -208,7 +248,9 @@ private:
   MaybeExtern template WriteHandlingMethod<T>* DirectWrite(T* addr, u32 mask);                     \
   MaybeExtern template WriteHandlingMethod<T>* DirectWrite(volatile T* addr, u32 mask);            \
   MaybeExtern template ReadHandlingMethod<T>* ComplexRead<T>(std::function<T(u32)>);               \
+  MaybeExtern template ReadHandlingMethod<T>* ComplexRead<T>(ReadFunction<T>, void*);              \
   MaybeExtern template WriteHandlingMethod<T>* ComplexWrite<T>(std::function<void(u32, T)>);       \
+  MaybeExtern template WriteHandlingMethod<T>* ComplexWrite<T>(WriteFunction<T>, void*);           \
   MaybeExtern template ReadHandlingMethod<T>* InvalidRead<T>();                                    \
   MaybeExtern template WriteHandlingMethod<T>* InvalidWrite<T>();                                  \
   MaybeExtern template class ReadHandler<T>;                                                       \
@@ -84,19 +84,25 @@ void Init()
       CoreTiming::RegisterEvent("IOSNotifyPowerButton", IOSNotifyPowerButtonCallback);
 }
 
+static void WriteInterruptCause(void*, u32, u32 val)
+{
+  m_InterruptCause &= ~val;
+  UpdateException();
+}
+
+static void WriteInterruptMask(void*, u32, u32 val)
+{
+  m_InterruptMask = val;
+  UpdateException();
+}
+
 void RegisterMMIO(MMIO::Mapping* mmio, u32 base)
 {
   mmio->Register(base | PI_INTERRUPT_CAUSE, MMIO::DirectRead<u32>(&m_InterruptCause),
-                 MMIO::ComplexWrite<u32>([](u32, u32 val) {
-                   m_InterruptCause &= ~val;
-                   UpdateException();
-                 }));
+                 MMIO::ComplexWrite<u32>(&WriteInterruptCause, nullptr));
 
   mmio->Register(base | PI_INTERRUPT_MASK, MMIO::DirectRead<u32>(&m_InterruptMask),
-                 MMIO::ComplexWrite<u32>([](u32, u32 val) {
-                   m_InterruptMask = val;
-                   UpdateException();
-                 }));
+                 MMIO::ComplexWrite<u32>(&WriteInterruptMask, nullptr));
 
   mmio->Register(base | PI_FIFO_BASE, MMIO::DirectRead<u32>(&Fifo_CPUBase),
                  MMIO::DirectWrite<u32>(&Fifo_CPUBase, 0xFFFFFFE0));
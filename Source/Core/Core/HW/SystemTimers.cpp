@@ -64,6 +64,7 @@ IPC_HLE_PERIOD: For the Wii Remote this is the call schedule:
 #include "Core/HW/EXI/EXI_DeviceIPL.h"
 #include "Core/HW/VideoInterface.h"
 #include "Core/IOS/IOS.h"
+#include "Core/NetPlayProto.h"
 #include "Core/PatchEngine.h"
 #include "Core/PowerPC/PowerPC.h"
 #include "VideoCommon/Fifo.h"
@@ -132,8 +133,15 @@ void IPC_HLE_UpdateCallback(u64 userdata, s64 cyclesLate)
 
 void VICallback(u64 userdata, s64 cyclesLate)
 {
+  const bool field_start = VideoInterface::IsAtFieldStart();
   VideoInterface::Update(CoreTiming::GetTicks() - cyclesLate);
   CoreTiming::ScheduleEvent(VideoInterface::GetTicksPerHalfLine() - cyclesLate, et_VI);
+
+  // NetPlay's rollback mode saves and loads states here. Nothing else is being processed at this
+  // point, and the next VI event is already scheduled, so a loaded state continues from the
+  // same place as the saved one did.
+  if (field_start && NetPlay::IsNetPlayRunning())
+    NetPlay::OnFieldStart();
 }
 
 void DecrementerCallback(u64 userdata, s64 cyclesLate)
@@ -176,7 +184,8 @@ void ThrottleCallback(u64 last_time, s64 cyclesLate)
 
   s64 diff = last_time - time;
   const SConfig& config = SConfig::GetInstance();
-  bool frame_limiter = config.m_EmulationSpeed > 0.0f && !Core::GetIsThrottlerTempDisabled();
+  bool frame_limiter = config.m_EmulationSpeed > 0.0f && !Core::GetIsThrottlerTempDisabled() &&
+                       !Core::IsResimulating();
   u32 next_event = GetTicksPerSecond() / 1000;
 
   {
@@ -200,6 +200,21 @@ void Init()
   Preset(true);
 }
 
+// Beam position registers are polled by games waiting for a given line, so
+// they are registered as plain functions that can be called directly.
+static u16 ReadVerticalBeamPosition(void*, u32)
+{
+  return 1 + (s_half_line_count) / 2;
+}
+
+static u16 ReadHorizontalBeamPosition(void*, u32)
+{
+  u16 value = static_cast<u16>(1 + m_HTiming0.HLW *
+                                       (CoreTiming::GetTicks() - s_ticks_last_line_start) /
+                                       (GetTicksPerHalfLine()));
+  return std::clamp<u16>(value, 1, m_HTiming0.HLW * 2);
+}
+
 void RegisterMMIO(MMIO::Mapping* mmio, u32 base)
 {
   struct MappedVar
@@ -313,20 +328,15 @@ void RegisterMMIO(MMIO::Mapping* mmio, u32 base)
 
   // MMIOs with unimplemented writes that trigger warnings.
   mmio->Register(
-      base | VI_VERTICAL_BEAM_POSITION,
-      MMIO::ComplexRead<u16>([](u32) { return 1 + (s_half_line_count) / 2; }),
+      base | VI_VERTICAL_BEAM_POSITION, MMIO::ComplexRead<u16>(&ReadVerticalBeamPosition, nullptr),
       MMIO::ComplexWrite<u16>([](u32, u16 val) {
         WARN_LOG(VIDEOINTERFACE,
                  "Changing vertical beam position to 0x%04x - not documented or implemented yet",
                  val);
       }));
   mmio->Register(
-      base | VI_HORIZONTAL_BEAM_POSITION, MMIO::ComplexRead<u16>([](u32) {
-        u16 value = static_cast<u16>(1 + m_HTiming0.HLW *
-                                             (CoreTiming::GetTicks() - s_ticks_last_line_start) /
-                                             (GetTicksPerHalfLine()));
-        return std::clamp<u16>(value, 1, m_HTiming0.HLW * 2);
-      }),
+      base | VI_HORIZONTAL_BEAM_POSITION,
+      MMIO::ComplexRead<u16>(&ReadHorizontalBeamPosition, nullptr),
       MMIO::ComplexWrite<u16>([](u32, u16 val) {
         WARN_LOG(VIDEOINTERFACE,
                  "Changing horizontal beam position to 0x%04x - not documented or implemented yet",
@@ -745,6 +755,11 @@ static void LogField(FieldType field, u32 xfb_address)
             m_FBWidth.Hex, GetTicksPerEvenField(), GetTicksPerOddField());
 }
 
+bool IsAtFieldStart()
+{
+  return s_half_line_count == 0 || s_half_line_count == GetHalfLinesPerEvenField();
+}
+
 static void BeginField(FieldType field, u64 ticks)
 {
   // Could we fit a second line of data in the stride?
@@ -803,7 +818,7 @@ static void BeginField(FieldType field, u64 ticks)
   // frame is scanning out.
   // To correctly handle that case we would need to collate all changes
   // to VI during scanout and delay outputting the frame till then.
-  if (xfbAddr)
+  if (xfbAddr && !Core::IsResimulating())
     g_video_backend->Video_BeginField(xfbAddr, fbWidth, fbStride, fbHeight, ticks);
 }
 
@@ -846,7 +861,7 @@ void Update(u64 ticks)
   // If this half-line is at a field boundary, deal with updating movie state before potentially
   // dealing with SI polls, but after potentially sending a swap request to the GPU thread
 
-  if (s_half_line_count == 0 || s_half_line_count == GetHalfLinesPerEvenField())
+  if (IsAtFieldStart())
     Core::Callback_NewField();
 
   // If an SI poll is scheduled to happen on this half-line, do it!
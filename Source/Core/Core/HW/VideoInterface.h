@@ -368,6 +368,9 @@ u32 GetTicksPerSample();
 u32 GetTicksPerHalfLine();
 u32 GetTicksPerField();
 
+// Whether the next half-line that is processed is the first one of a field
+bool IsAtFieldStart();
+
 // Get the aspect ratio of VI's active area.
 // This function only deals with standard aspect ratios. For widescreen aspect ratios, multiply the
 // result by 1.33333..
@@ -13,6 +13,7 @@
 #include "Common/Assert.h"
 #include "Common/ChunkFile.h"
 #include "Common/FileUtil.h"
+#include "Common/Hash.h"
 #include "Common/Logging/Log.h"
 #include "Common/NandPaths.h"
 #include "Common/StringUtil.h"
@@ -83,6 +84,53 @@ auto GetMetadataFields(T& obj)
   return std::tie(obj.uid, obj.gid, obj.is_file, obj.modes, obj.attribute);
 }
 
+/// The FST journal starts with this header, followed by the records in the order in which the
+/// changes were made. Both are in host byte order, the journal is never used on another system.
+struct FstJournalHeader
+{
+  u32 magic;
+  /// Size and checksum of the FST file that the changes apply to
+  u32 fst_size;
+  u32 fst_checksum;
+};
+static_assert(sizeof(FstJournalHeader) == 12);
+
+/// Followed by path_length bytes of path and new_path_length bytes of new path.
+struct FstJournalRecord
+{
+  Uid uid;
+  Gid gid;
+  u16 path_length;
+  u16 new_path_length;
+  u8 op;
+  bool is_file;
+  FileAttribute attribute;
+  Modes modes;
+};
+static_assert(sizeof(FstJournalRecord) == 16);
+
+constexpr u32 FST_JOURNAL_MAGIC = 0x4A545346;  // "FSTJ"
+/// How many changes can be journaled before the FST file is rewritten.
+constexpr u32 MAX_FST_JOURNAL_RECORDS = 1024;
+
+u32 GetFstChecksum(const void* data, size_t size)
+{
+  return Common::HashAdler32(static_cast<const u8*>(data), size);
+}
+
+/// Calls f for every parent directory of a path, starting with the closest one.
+template <typename F>
+void ForEachParent(const std::string& path, F f)
+{
+  for (size_t pos = path.rfind('/'); pos != std::string::npos && path != "/";
+       pos = path.rfind('/', pos - 1))
+  {
+    f(pos == 0 ? std::string("/") : path.substr(0, pos));
+    if (pos == 0)
+      break;
+  }
+}
+
 auto GetNamePredicate(const std::string& name)
 {
   return [&name](const auto& entry) { return entry.name == name; };
@@ -109,13 +157,30 @@ HostFileSystem::HostFileSystem(const std::string& root_path) : m_root_path{root_
   LoadFst();
 }
 
-HostFileSystem::~HostFileSystem() = default;
+HostFileSystem::~HostFileSystem()
+{
+  if (m_fst_journal_records != 0)
+    SaveFst();
+}
+
+enum class HostFileSystem::JournalOp : u8
+{
+  CreateEntry = 1,
+  SetMetadata = 2,
+  Delete = 3,
+  Rename = 4,
+};
 
 std::string HostFileSystem::GetFstFilePath() const
 {
   return fmt::format("{}/fst.bin", m_root_path);
 }
 
+std::string HostFileSystem::GetFstJournalFilePath() const
+{
+  return fmt::format("{}/fst.journal", m_root_path);
+}
+
 void HostFileSystem::ResetFst()
 {
   m_root_entry = {};
@@ -126,20 +191,34 @@ void HostFileSystem::ResetFst()
 
 void HostFileSystem::LoadFst()
 {
+  m_fst_file_size = 0;
+  m_fst_file_checksum = GetFstChecksum(nullptr, 0);
+
   File::IOFile file{GetFstFilePath(), "rb"};
   // Existing filesystems will not have a FST. This is not a problem,
   // as the rest of HostFileSystem will use sane defaults.
   if (!file)
+  {
+    ReplayFstJournal();
     return;
+  }
 
-  const auto parse_entry = [&file](const auto& parse, size_t depth) -> std::optional<FstEntry> {
-    if (depth > MaxPathDepth)
-      return std::nullopt;
+  std::vector<SerializedFstEntry> entries(file.GetSize() / sizeof(SerializedFstEntry));
+  if (!file.ReadArray(entries.data(), entries.size()))
+  {
+    ERROR_LOG(IOS_FS, "Failed to read FST");
+    return;
+  }
+  m_fst_file_size = u32(entries.size() * sizeof(SerializedFstEntry));
+  m_fst_file_checksum = GetFstChecksum(entries.data(), m_fst_file_size);
 
-    SerializedFstEntry entry;
-    if (!file.ReadArray(&entry, 1))
+  size_t index = 0;
+  const auto parse_entry = [&entries, &index](const auto& parse,
+                                              size_t depth) -> std::optional<FstEntry> {
+    if (depth > MaxPathDepth || index >= entries.size())
       return std::nullopt;
 
+    const SerializedFstEntry& entry = entries[index++];
     FstEntry result;
     result.name = entry.GetName();
     GetMetadataFields(result.data) = GetMetadataFields(entry);
@@ -160,6 +239,49 @@ void HostFileSystem::LoadFst()
     return;
   }
   m_root_entry = *root_entry;
+  ReplayFstJournal();
+}
+
+void HostFileSystem::ReplayFstJournal()
+{
+  const std::string journal_path = GetFstJournalFilePath();
+  File::IOFile journal{journal_path, "rb"};
+  if (!journal)
+    return;
+
+  FstJournalHeader header;
+  if (!journal.ReadArray(&header, 1) || header.magic != FST_JOURNAL_MAGIC ||
+      header.fst_size != m_fst_file_size || header.fst_checksum != m_fst_file_checksum)
+  {
+    // Either the journal is broken, or the changes in it already made it into the FST file
+    // before the journal could be deleted.
+    journal.Close();
+    File::Delete(journal_path);
+    return;
+  }
+
+  u32 num_records = 0;
+  FstJournalRecord record;
+  while (journal.ReadArray(&record, 1))
+  {
+    std::string path(record.path_length, '\0');
+    std::string new_path(record.new_path_length, '\0');
+    // The last record may be incomplete if Dolphin didn't shut down properly.
+    if (!journal.ReadBytes(path.data(), path.size()) ||
+        !journal.ReadBytes(new_path.data(), new_path.size()) || !IsValidPath(path))
+    {
+      break;
+    }
+
+    Metadata metadata{};
+    GetMetadataFields(metadata) = GetMetadataFields(record);
+    ApplyFstChange(static_cast<JournalOp>(record.op), path, metadata, new_path);
+    ++num_records;
+  }
+  journal.Close();
+
+  INFO_LOG(IOS_FS, "Replayed %u FST changes from the journal", num_records);
+  SaveFst();
 }
 
 void HostFileSystem::SaveFst()
@@ -187,7 +309,123 @@ void HostFileSystem::SaveFst()
     }
   }
   if (!File::Rename(temp_path, dest_path))
+  {
     PanicAlert("IOS_FS: Failed to rename temporary FST file");
+    return;
+  }
+
+  m_fst_file_size = u32(to_write.size() * sizeof(SerializedFstEntry));
+  m_fst_file_checksum = GetFstChecksum(to_write.data(), m_fst_file_size);
+
+  // The journal doesn't apply to the new FST file anymore. If this doesn't get to run,
+  // the journal is ignored on the next load because the checksum doesn't match.
+  m_fst_journal.Close();
+  m_fst_journal_records = 0;
+  const std::string journal_path = GetFstJournalFilePath();
+  if (File::Exists(journal_path))
+    File::Delete(journal_path);
+}
+
+void HostFileSystem::UpdateFst(JournalOp op, const std::string& path, const Metadata& metadata,
+                               const std::string& new_path)
+{
+  ApplyFstChange(op, path, metadata, new_path);
+
+  if (!m_fst_journal.IsOpen())
+  {
+    // Another instance may have started a journal for the same FST file already.
+    m_fst_journal.Open(GetFstJournalFilePath(), "ab");
+    if (m_fst_journal.GetSize() == 0)
+    {
+      const FstJournalHeader header{FST_JOURNAL_MAGIC, m_fst_file_size, m_fst_file_checksum};
+      m_fst_journal.WriteArray(&header, 1);
+    }
+  }
+
+  FstJournalRecord record{};
+  GetMetadataFields(record) = GetMetadataFields(metadata);
+  record.op = static_cast<u8>(op);
+  record.path_length = u16(path.size());
+  record.new_path_length = u16(new_path.size());
+
+  // Flushing hands the record to the OS, so that it survives Dolphin crashing.
+  const bool journaled = m_fst_journal.WriteArray(&record, 1) &&
+                         m_fst_journal.WriteBytes(path.data(), path.size()) &&
+                         m_fst_journal.WriteBytes(new_path.data(), new_path.size()) &&
+                         m_fst_journal.Flush();
+  if (!journaled)
+    ERROR_LOG(IOS_FS, "Failed to write to the FST journal");
+
+  if (!journaled || ++m_fst_journal_records >= MAX_FST_JOURNAL_RECORDS)
+    SaveFst();
+}
+
+void HostFileSystem::ApplyFstChange(JournalOp op, const std::string& path,
+                                    const Metadata& metadata, const std::string& new_path)
+{
+  switch (op)
+  {
+  case JournalOp::CreateEntry:
+  {
+    FstEntry* entry = GetOrCreateFstEntry(path);
+    if (!entry)
+      return;
+    *entry = {};
+    entry->name = SplitPathAndBasename(path).file_name;
+    GetMetadataFields(entry->data) = GetMetadataFields(metadata);
+    break;
+  }
+  case JournalOp::SetMetadata:
+  {
+    FstEntry* entry = GetOrCreateFstEntry(path);
+    if (!entry)
+      return;
+    entry->data.gid = metadata.gid;
+    entry->data.uid = metadata.uid;
+    entry->data.attribute = metadata.attribute;
+    entry->data.modes = metadata.modes;
+    break;
+  }
+  case JournalOp::Delete:
+  {
+    const auto split_path = SplitPathAndBasename(path);
+    FstEntry* parent = GetOrCreateFstEntry(split_path.parent);
+    if (!parent)
+      return;
+    const auto it = std::find_if(parent->children.begin(), parent->children.end(),
+                                 GetNamePredicate(split_path.file_name));
+    if (it != parent->children.end())
+      parent->children.erase(it);
+    break;
+  }
+  case JournalOp::Rename:
+  {
+    if (!IsValidNonRootPath(new_path))
+      return;
+    // Remove the child from the old parent and move it to the new parent.
+    const auto split_old_path = SplitPathAndBasename(path);
+    FstEntry* old_parent = GetOrCreateFstEntry(split_old_path.parent);
+    if (!old_parent)
+      return;
+    std::optional<FstEntry> moved_entry;
+    const auto it = std::find_if(old_parent->children.begin(), old_parent->children.end(),
+                                 GetNamePredicate(split_old_path.file_name));
+    if (it != old_parent->children.end())
+    {
+      moved_entry = std::move(*it);
+      old_parent->children.erase(it);
+    }
+
+    FstEntry* new_entry = GetOrCreateFstEntry(new_path);
+    if (moved_entry)
+      *new_entry = std::move(*moved_entry);
+    new_entry->name = SplitPathAndBasename(new_path).file_name;
+    break;
+  }
+  default:
+    ERROR_LOG(IOS_FS, "Unknown FST journal operation %u", static_cast<u32>(op));
+    break;
+  }
 }
 
 HostFileSystem::FstEntry* HostFileSystem::GetFstEntryForPath(const std::string& path)
@@ -202,6 +440,25 @@ HostFileSystem::FstEntry* HostFileSystem::GetFstEntryForPath(const std::string&
   if (!host_file_info.Exists())
     return nullptr;
 
+  FstEntry* entry = GetOrCreateFstEntry(path);
+  entry->data.is_file = host_file_info.IsFile();
+  if (entry->data.is_file && !entry->children.empty())
+  {
+    WARN_LOG(IOS_FS, "%s is a file but also has children; clearing children", path.c_str());
+    entry->children.clear();
+  }
+
+  return entry;
+}
+
+HostFileSystem::FstEntry* HostFileSystem::GetOrCreateFstEntry(const std::string& path)
+{
+  if (path == "/")
+    return &m_root_entry;
+
+  if (!IsValidNonRootPath(path))
+    return nullptr;
+
   FstEntry* entry = &m_root_entry;
   std::string complete_path = "";
   for (const std::string& component : SplitString(std::string(path.substr(1)), '/'))
@@ -225,14 +482,68 @@ HostFileSystem::FstEntry* HostFileSystem::GetFstEntryForPath(const std::string&
     }
   }
 
-  entry->data.is_file = host_file_info.IsFile();
-  if (entry->data.is_file && !entry->children.empty())
+  return entry;
+}
+
+bool HostFileSystem::IsUsageTracked(const std::string& path) const
+{
+  if (m_directory_usage.empty())
+    return false;
+
+  bool tracked = false;
+  ForEachParent(path, [this, &tracked](const std::string& parent) {
+    tracked = tracked || m_directory_usage.count(parent) != 0;
+  });
+  return tracked;
+}
+
+HostFileSystem::DirectoryUsage HostFileSystem::GetUsage(const std::string& path,
+                                                        bool include_self) const
+{
+  const std::string host_path = BuildFilename(path);
+  const File::FileInfo host_file_info{host_path};
+
+  DirectoryUsage usage;
+  if (!host_file_info.Exists())
+    return usage;
+
+  if (host_file_info.IsDirectory())
   {
-    WARN_LOG(IOS_FS, "%s is a file but also has children; clearing children", path.c_str());
-    entry->children.clear();
+    const File::FSTEntry tree = File::ScanDirectoryTree(host_path, true);
+    usage.inodes = s64(tree.size);
+    usage.bytes = s64(ComputeTotalFileSize(tree));
+  }
+  else
+  {
+    usage.bytes = s64(host_file_info.GetSize());
   }
 
-  return entry;
+  if (include_self)
+    ++usage.inodes;
+  return usage;
+}
+
+void HostFileSystem::UpdateUsage(const std::string& path, const DirectoryUsage& delta, s64 sign)
+{
+  ForEachParent(path, [&](const std::string& parent) {
+    const auto it = m_directory_usage.find(parent);
+    if (it == m_directory_usage.end())
+      return;
+    it->second.inodes += sign * delta.inodes;
+    it->second.bytes += sign * delta.bytes;
+  });
+}
+
+void HostFileSystem::ForgetUsage(const std::string& path)
+{
+  for (auto it = m_directory_usage.begin(); it != m_directory_usage.end();)
+  {
+    const std::string& tracked_path = it->first;
+    if (path == "/" || tracked_path == path || StringBeginsWith(tracked_path, path + '/'))
+      it = m_directory_usage.erase(it);
+    else
+      ++it;
+  }
 }
 
 void HostFileSystem::DoState(PointerWrap& p)
@@ -247,6 +558,7 @@ void HostFileSystem::DoState(PointerWrap& p)
   {
     File::DeleteDirRecursively(Path);
     File::CreateDir(Path);
+    m_directory_usage.clear();
 
     // now restore from the stream
     while (1)
@@ -352,6 +664,7 @@ ResultCode HostFileSystem::Format(Uid uid)
     return ResultCode::UnknownError;
   ResetFst();
   SaveFst();
+  m_directory_usage.clear();
   // Reset and close all handles.
   m_handles = {};
   return ResultCode::Success;
@@ -386,15 +699,14 @@ ResultCode HostFileSystem::CreateFileOrDirectory(Uid uid, Gid gid, const std::st
     return ResultCode::UnknownError;
   }
 
-  FstEntry* child = GetFstEntryForPath(path);
-  *child = {};
-  child->name = split_path.file_name;
-  child->data.is_file = is_file;
-  child->data.modes = modes;
-  child->data.uid = uid;
-  child->data.gid = gid;
-  child->data.attribute = attr;
-  SaveFst();
+  Metadata metadata{};
+  metadata.is_file = is_file;
+  metadata.modes = modes;
+  metadata.uid = uid;
+  metadata.gid = gid;
+  metadata.attribute = attr;
+  UpdateFst(JournalOp::CreateEntry, path, metadata);
+  UpdateUsage(path, {1, 0}, 1);
   return ResultCode::Success;
 }
 
@@ -442,6 +754,8 @@ ResultCode HostFileSystem::Delete(Uid uid, Gid gid, const std::string& path)
   if (!File::Exists(host_path))
     return ResultCode::NotFound;
 
+  const DirectoryUsage usage = IsUsageTracked(path) ? GetUsage(path, true) : DirectoryUsage{};
+
   if (File::IsFile(host_path) && !IsFileOpened(path))
     File::Delete(host_path);
   else if (File::IsDirectory(host_path) && !IsDirectoryInUse(path))
@@ -449,11 +763,9 @@ ResultCode HostFileSystem::Delete(Uid uid, Gid gid, const std::string& path)
   else
     return ResultCode::InUse;
 
-  const auto it = std::find_if(parent->children.begin(), parent->children.end(),
-                               GetNamePredicate(split_path.file_name));
-  if (it != parent->children.end())
-    parent->children.erase(it);
-  SaveFst();
+  UpdateFst(JournalOp::Delete, path);
+  UpdateUsage(path, usage, -1);
+  ForgetUsage(path);
 
   return ResultCode::Success;
 }
@@ -495,6 +807,13 @@ ResultCode HostFileSystem::Rename(Uid uid, Gid gid, const std::string& old_path,
   const std::string host_old_path = BuildFilename(old_path);
   const std::string host_new_path = BuildFilename(new_path);
 
+  DirectoryUsage moved_usage, replaced_usage;
+  if (IsUsageTracked(old_path) || IsUsageTracked(new_path))
+  {
+    moved_usage = GetUsage(old_path, true);
+    replaced_usage = GetUsage(new_path, true);
+  }
+
   // If there is already something of the same type at the new path, delete it.
   if (File::Exists(host_new_path))
   {
@@ -514,17 +833,12 @@ ResultCode HostFileSystem::Rename(Uid uid, Gid gid, const std::string& old_path,
     return ResultCode::NotFound;
   }
 
-  // Finally, remove the child from the old parent and move it to the new parent.
-  const auto it = std::find_if(old_parent->children.begin(), old_parent->children.end(),
-                               GetNamePredicate(split_old_path.file_name));
-  FstEntry* new_entry = GetFstEntryForPath(new_path);
-  if (it != old_parent->children.end())
-  {
-    *new_entry = *it;
-    old_parent->children.erase(it);
-  }
-  new_entry->name = split_new_path.file_name;
-  SaveFst();
+  UpdateFst(JournalOp::Rename, old_path, {}, new_path);
+  UpdateUsage(old_path, moved_usage, -1);
+  UpdateUsage(new_path, replaced_usage, -1);
+  UpdateUsage(new_path, moved_usage, 1);
+  ForgetUsage(old_path);
+  ForgetUsage(new_path);
 
   return ResultCode::Success;
 }
@@ -636,11 +950,12 @@ ResultCode HostFileSystem::SetMetadata(Uid caller_uid, const std::string& path,
   if (entry->data.uid != uid && entry->data.is_file && !is_empty)
     return ResultCode::FileNotEmpty;
 
-  entry->data.gid = gid;
-  entry->data.uid = uid;
-  entry->data.attribute = attr;
-  entry->data.modes = modes;
-  SaveFst();
+  Metadata metadata{};
+  metadata.gid = gid;
+  metadata.uid = uid;
+  metadata.attribute = attr;
+  metadata.modes = modes;
+  UpdateFst(JournalOp::SetMetadata, path, metadata);
 
   return ResultCode::Success;
 }
@@ -669,15 +984,20 @@ Result<DirectoryStats> HostFileSystem::GetDirectoryStats(const std::string& wii_
 
   DirectoryStats stats{};
   std::string path(BuildFilename(wii_path));
-  if (File::IsDirectory(path))
+  auto it = m_directory_usage.find(wii_path);
+  if (it == m_directory_usage.end() && File::IsDirectory(path))
   {
-    File::FSTEntry parent_dir = File::ScanDirectoryTree(path, true);
-    // add one for the folder itself
-    stats.used_inodes = 1 + (u32)parent_dir.size;
-
-    u64 total_size = ComputeTotalFileSize(parent_dir);  // "Real" size to convert to nand blocks
+    // Scan the directory once, and keep the usage up to date as the emulated software
+    // changes it from then on.
+    it = m_directory_usage.emplace(wii_path, GetUsage(wii_path, false)).first;
+  }
 
-    stats.used_clusters = (u32)(total_size / (16 * 1024));  // one block is 16kb
+  if (it != m_directory_usage.end())
+  {
+    // add one for the folder itself
+    stats.used_inodes = 1 + (u32)it->second.inodes;
+    // "Real" size to convert to nand blocks. One block is 16kb
+    stats.used_clusters = (u32)(it->second.bytes / (16 * 1024));
   }
   else
   {
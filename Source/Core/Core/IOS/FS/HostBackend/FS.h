@@ -72,6 +72,13 @@ private:
     std::vector<FstEntry> children;
   };
 
+  /// Usage of everything below a directory (not including the directory itself).
+  struct DirectoryUsage
+  {
+    s64 inodes = 0;
+    s64 bytes = 0;
+  };
+
   struct Handle
   {
     bool opened = false;
@@ -92,14 +99,35 @@ private:
   bool IsFileOpened(const std::string& path) const;
   bool IsDirectoryInUse(const std::string& path) const;
 
+  enum class JournalOp : u8;
+
   std::string GetFstFilePath() const;
+  std::string GetFstJournalFilePath() const;
   void ResetFst();
   void LoadFst();
   void SaveFst();
+  /// Applies a change to the FST and records it in the journal. The whole FST is only written
+  /// out once enough changes have piled up, which is a lot cheaper than rewriting it every time
+  /// a game creates or deletes a file.
+  void UpdateFst(JournalOp op, const std::string& path, const Metadata& metadata = {},
+                 const std::string& new_path = {});
+  void ApplyFstChange(JournalOp op, const std::string& path, const Metadata& metadata,
+                      const std::string& new_path);
+  void ReplayFstJournal();
   /// Get the FST entry for a file (or directory).
   /// Automatically creates fallback entries for parents if they do not exist.
   /// Returns nullptr if the path is invalid or the file does not exist.
   FstEntry* GetFstEntryForPath(const std::string& path);
+  /// Same as GetFstEntryForPath, but doesn't check whether the file exists on the host.
+  FstEntry* GetOrCreateFstEntry(const std::string& path);
+
+  /// Returns whether the usage of any parent directory of path is being tracked.
+  bool IsUsageTracked(const std::string& path) const;
+  DirectoryUsage GetUsage(const std::string& path, bool include_self) const;
+  /// Adds the given amounts to the usage of all tracked parents of path.
+  void UpdateUsage(const std::string& path, const DirectoryUsage& delta, s64 sign);
+  /// Stops tracking path and everything below it.
+  void ForgetUsage(const std::string& path);
 
   /// FST entry for the filesystem root.
   ///
@@ -111,6 +139,17 @@ private:
   /// filesystem root manually.
   FstEntry m_root_entry{};
   std::string m_root_path;
+
+  /// The size and checksum of the FST file on disk. The journal only applies to this version.
+  u32 m_fst_file_size = 0;
+  u32 m_fst_file_checksum = 0;
+  File::IOFile m_fst_journal;
+  u32 m_fst_journal_records = 0;
+
+  /// Directories whose usage was requested, and which are kept up to date from then on.
+  /// Changes that are made to the NAND directory behind the emulated FS's back won't show up.
+  std::map<std::string, DirectoryUsage> m_directory_usage;
+
   std::map<std::string, std::weak_ptr<File::IOFile>> m_open_files;
   std::array<Handle, 16> m_handles{};
 };
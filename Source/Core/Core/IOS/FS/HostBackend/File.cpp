@@ -149,12 +149,17 @@ Result<u32> HostFileSystem::WriteBytesToFile(Fd fd, const u8* ptr, u32 count)
   if ((u8(handle->mode) & u8(Mode::Write)) == 0)
     return ResultCode::AccessDenied;
 
+  const bool usage_tracked = IsUsageTracked(handle->wii_path);
+  const u64 old_size = usage_tracked ? handle->host_file->GetSize() : 0;
+
   // File might be opened twice, need to seek before we read
   handle->host_file->Seek(handle->file_offset, SEEK_SET);
   if (!handle->host_file->WriteBytes(ptr, count))
     return ResultCode::AccessDenied;
 
   handle->file_offset += count;
+  if (usage_tracked && handle->file_offset > old_size)
+    UpdateUsage(handle->wii_path, {0, s64(handle->file_offset - old_size)}, 1);
   return count;
 }
 
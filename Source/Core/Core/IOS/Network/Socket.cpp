@@ -11,8 +11,9 @@
 #include <arpa/inet.h>
 #include <unistd.h>
 #endif
-#ifdef __HAIKU__
-#include <sys/select.h>
+#ifdef __linux__
+#include <array>
+#include <sys/epoll.h>
 #endif
 
 #include "Common/File.h"
@@ -205,7 +206,7 @@ s32 WiiSocket::FCntl(u32 cmd, u32 arg)
   return ret;
 }
 
-void WiiSocket::Update(bool read, bool write, bool except)
+void WiiSocket::Update()
 {
   auto it = pending_sockops.begin();
   while (it != pending_sockops.end())
@@ -646,6 +647,7 @@ s32 WiiSockMan::AddSocket(s32 fd, bool is_rw)
     WiiSocket& sock = WiiSockets[wii_fd];
     sock.SetFd(fd);
     sock.SetWiiFd(wii_fd);
+    RegisterSocket(sock);
   }
 
   SetLastNetError(wii_fd);
@@ -679,56 +681,87 @@ s32 WiiSockMan::DeleteSocket(s32 s)
   {
     ReturnValue = socket_entry->second.CloseFd();
     WiiSockets.erase(socket_entry);
+    ready_sockets.erase(s);
   }
   return ReturnValue;
 }
 
-void WiiSockMan::Update()
+WiiSockMan::~WiiSockMan()
 {
-  s32 nfds = 0;
-  fd_set read_fds, write_fds, except_fds;
-  struct timeval t = {0, 0};
-  FD_ZERO(&read_fds);
-  FD_ZERO(&write_fds);
-  FD_ZERO(&except_fds);
-
-  auto socket_iter = WiiSockets.begin();
-  auto end_socks = WiiSockets.end();
+#ifdef __linux__
+  if (epoll_fd >= 0)
+    close(epoll_fd);
+#endif
+}
 
-  while (socket_iter != end_socks)
+void WiiSockMan::RegisterSocket(WiiSocket& sock)
+{
+#ifdef __linux__
+  if (epoll_fd < 0)
   {
-    WiiSocket& sock = socket_iter->second;
-    if (sock.IsValid())
-    {
-      FD_SET(sock.fd, &read_fds);
-      FD_SET(sock.fd, &write_fds);
-      FD_SET(sock.fd, &except_fds);
-      nfds = std::max(nfds, sock.fd + 1);
-      ++socket_iter;
-    }
-    else
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0)
     {
-      // Good time to clean up invalid sockets.
-      socket_iter = WiiSockets.erase(socket_iter);
+      ERROR_LOG(IOS_NET, "epoll_create1 failed: %s", DecodeError(errno));
+      return;
     }
   }
-  s32 ret = select(nfds, &read_fds, &write_fds, &except_fds, &t);
 
-  if (ret >= 0)
+  // Edge-triggered, so a socket is only reported again once its state changes. The pending
+  // operations are always tried once when they are queued, which consumes the current state.
+  epoll_event event{};
+  event.events = EPOLLIN | EPOLLOUT | EPOLLPRI | EPOLLRDHUP | EPOLLET;
+  event.data.u32 = static_cast<u32>(sock.wii_fd);
+  if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sock.fd, &event) < 0)
   {
-    for (auto& pair : WiiSockets)
-    {
-      WiiSocket& sock = pair.second;
-      sock.Update(FD_ISSET(sock.fd, &read_fds) != 0, FD_ISSET(sock.fd, &write_fds) != 0,
-                  FD_ISSET(sock.fd, &except_fds) != 0);
-    }
+    ERROR_LOG(IOS_NET, "epoll_ctl failed for socket %d: %s", sock.wii_fd, DecodeError(errno));
+    return;
   }
-  else
+
+  sock.edge_triggered = true;
+#endif
+}
+
+void WiiSockMan::PollSockets()
+{
+#ifdef __linux__
+  if (epoll_fd < 0)
+    return;
+
+  // Every socket is reported at most once, so this drains all the events
+  std::array<epoll_event, WII_SOCKET_FD_MAX> events;
+  const int count = epoll_wait(epoll_fd, events.data(), static_cast<int>(events.size()), 0);
+  for (int i = 0; i < count; ++i)
   {
-    for (auto& elem : WiiSockets)
-    {
-      elem.second.Update(false, false, false);
-    }
+    const s32 wii_fd = static_cast<s32>(events[i].data.u32);
+    const auto socket_entry = WiiSockets.find(wii_fd);
+    if (socket_entry != WiiSockets.end() && !socket_entry->second.pending_sockops.empty())
+      ready_sockets.insert(wii_fd);
+  }
+#endif
+}
+
+void WiiSockMan::Update()
+{
+  PollSockets();
+  if (ready_sockets.empty())
+    return;
+
+  // Accepting a connection adds a socket, so don't update the set while iterating over it
+  std::unordered_set<s32> sockets;
+  std::swap(sockets, ready_sockets);
+  for (const s32 wii_fd : sockets)
+  {
+    const auto socket_entry = WiiSockets.find(wii_fd);
+    if (socket_entry == WiiSockets.end())
+      continue;
+
+    WiiSocket& sock = socket_entry->second;
+    sock.Update();
+
+    // Edge-triggered sockets are tried again once they become ready
+    if (!sock.pending_sockops.empty() && !sock.edge_triggered)
+      ready_sockets.insert(wii_fd);
   }
 }
 
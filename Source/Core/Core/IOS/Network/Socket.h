@@ -46,6 +46,7 @@ typedef struct pollfd pollfd_t;
 #include <list>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 
 #include "Common/CommonTypes.h"
@@ -201,11 +202,13 @@ private:
 
   void DoSock(Request request, NET_IOCTL type);
   void DoSock(Request request, SSL_IOCTL type);
-  void Update(bool read, bool write, bool except);
-  bool IsValid() const { return fd >= 0; }
+  void Update();
   s32 fd = -1;
   s32 wii_fd = -1;
   bool nonBlock = false;
+  // Whether WiiSockMan is notified when the socket becomes ready, instead of retrying the
+  // pending operations on every update
+  bool edge_triggered = false;
   std::list<sockop> pending_sockops;
 };
 
@@ -230,7 +233,11 @@ public:
   s32 DeleteSocket(s32 s);
   s32 GetLastNetError() const { return errno_last; }
   void SetLastNetError(s32 error) { errno_last = error; }
-  void Clean() { WiiSockets.clear(); }
+  void Clean()
+  {
+    WiiSockets.clear();
+    ready_sockets.clear();
+  }
   template <typename T>
   void DoSock(s32 sock, const Request& request, T type)
   {
@@ -244,6 +251,7 @@ public:
     else
     {
       socket_entry->second.DoSock(request, type);
+      ready_sockets.insert(sock);
     }
   }
 
@@ -251,12 +259,21 @@ public:
 
 private:
   WiiSockMan() = default;
+  ~WiiSockMan();
   WiiSockMan(const WiiSockMan&) = delete;
   WiiSockMan& operator=(const WiiSockMan&) = delete;
   WiiSockMan(WiiSockMan&&) = delete;
   WiiSockMan& operator=(WiiSockMan&&) = delete;
 
+  void RegisterSocket(WiiSocket& sock);
+  void PollSockets();
+
   std::unordered_map<s32, WiiSocket> WiiSockets;
+  // Sockets whose pending operations are tried on the next update
+  std::unordered_set<s32> ready_sockets;
   s32 errno_last;
+#ifdef __linux__
+  int epoll_fd = -1;
+#endif
 };
 }  // namespace IOS::HLE
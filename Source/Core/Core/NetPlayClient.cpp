@@ -16,13 +16,13 @@
 #include <vector>
 
 #include <fmt/format.h>
-#include <lzo/lzo1x.h>
 #include <mbedtls/md5.h>
 
 #include "Common/Assert.h"
 #include "Common/CommonPaths.h"
 #include "Common/CommonTypes.h"
 #include "Common/ENetUtil.h"
+#include "Common/FileSearch.h"
 #include "Common/File.h"
 #include "Common/FileUtil.h"
 #include "Common/Logging/Log.h"
@@ -37,8 +37,11 @@
 #include "Core/ActionReplay.h"
 #include "Core/Config/NetplaySettings.h"
 #include "Core/ConfigManager.h"
+#include "Core/Core.h"
 #include "Core/GeckoCode.h"
+#include "Core/HW/DSP.h"
 #include "Core/HW/EXI/EXI_DeviceIPL.h"
+#include "Core/HW/Memmap.h"
 #include "Core/HW/SI/SI.h"
 #include "Core/HW/SI/SI_Device.h"
 #include "Core/HW/SI/SI_DeviceGCController.h"
@@ -51,13 +54,20 @@
 #include "Core/IOS/FS/HostBackend/FS.h"
 #include "Core/IOS/USB/Bluetooth/BTEmu.h"
 #include "Core/IOS/Uids.h"
+#include "Core/NetPlaySaveTransfer.h"
 #include "Core/Movie.h"
 #include "Core/PowerPC/PowerPC.h"
+#include "Core/State.h"
+#include "DiscIO/Enums.h"
 #include "InputCommon/ControllerEmu/ControlGroup/Attachments.h"
 #include "InputCommon/GCAdapter.h"
 #include "InputCommon/InputConfig.h"
+#include "UICommon/GameFile.h"
+#include "VideoCommon/BPMemory.h"
 #include "VideoCommon/OnScreenDisplay.h"
+#include "VideoCommon/TextureDecoder.h"
 #include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/XFMemory.h"
 
 namespace NetPlay
 {
@@ -690,6 +700,7 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
       packet >> m_net_settings.m_EFBAccessTileSize;
       packet >> m_net_settings.m_EFBAccessDeferInvalidation;
       packet >> m_net_settings.m_StrictSettingsSync;
+      packet >> m_net_settings.m_DiagnoseDesyncs;
 
       m_initial_rtc = Common::PacketReadU64(packet);
 
@@ -702,11 +713,18 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
         packet >> extension;
 
       packet >> m_net_settings.m_GolfMode;
+      packet >> m_net_settings.m_Rollback;
 
       m_net_settings.m_IsHosting = m_local_player->IsHost();
       m_net_settings.m_HostInputAuthority = m_host_input_authority;
     }
 
+    {
+      std::lock_guard<std::mutex> lk(m_hash_trees_lock);
+      m_hash_trees.clear();
+    }
+    m_diagnosed_hash_tree.reset();
+
     m_dialog->OnMsgStartGame();
   }
   break;
@@ -777,6 +795,61 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
   }
   break;
 
+  case NP_MSG_HASH_TREE_REQUEST:
+  {
+    u32 frame;
+    u32 level;
+    u32 count;
+    packet >> frame >> level >> count;
+
+    const MemoryHashTree* tree = FindDiagnosedHashTree(frame);
+
+    sf::Packet response;
+    response << static_cast<MessageId>(NP_MSG_HASH_TREE_NODES);
+    response << frame << level << (tree != nullptr);
+
+    for (u32 i = 0; i < count && tree; ++i)
+    {
+      u32 index;
+      packet >> index;
+
+      const std::vector<u64> children =
+          tree->GetChildren(level, index).value_or(std::vector<u64>{});
+      response << static_cast<u32>(children.size());
+      for (const u64 hash : children)
+        response << sf::Uint64{hash};
+    }
+
+    Send(response);
+  }
+  break;
+
+  case NP_MSG_HASH_TREE_RESULT:
+  {
+    u32 frame;
+    u32 count;
+    packet >> frame >> count;
+
+    std::vector<u32> leaves;
+    for (u32 i = 0; i < count && !packet.endOfPacket(); ++i)
+    {
+      u32 leaf;
+      packet >> leaf;
+      leaves.push_back(leaf);
+    }
+
+    std::vector<std::string> regions;
+    if (const MemoryHashTree* tree = FindDiagnosedHashTree(frame))
+      regions = tree->DescribeLeaves(std::move(leaves));
+    m_diagnosed_hash_tree.reset();
+
+    for (const std::string& region : regions)
+      ERROR_LOG(NETPLAY, "Memory differed at frame %u in %s", frame, region.c_str());
+
+    m_dialog->OnDesyncDiagnosed(frame, regions);
+  }
+  break;
+
   case NP_MSG_SYNC_GC_SRAM:
   {
     const size_t sram_settings_len = sizeof(g_SRAM) - offsetof(Sram, settings);
@@ -810,9 +883,14 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
       m_sync_save_data_success_count = 0;
 
       if (m_sync_save_data_count == 0)
+      {
         SyncSaveDataResponse(true);
+      }
       else
+      {
         m_dialog->AppendChat(Common::GetStringT("Synchronizing save data..."));
+        SendSaveDataManifest();
+      }
     }
     break;
 
@@ -835,7 +913,7 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
         return 0;
       }
 
-      const bool success = DecompressPacketIntoFile(packet, path);
+      const bool success = DecompressPacketIntoFile(packet, path, m_save_block_store);
       SyncSaveDataResponse(success);
     }
     break;
@@ -865,7 +943,7 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
         std::string file_name;
         packet >> file_name;
 
-        if (!DecompressPacketIntoFile(packet, path + DIR_SEP + file_name))
+        if (!DecompressPacketIntoFile(packet, path + DIR_SEP + file_name, m_save_block_store))
         {
           SyncSaveDataResponse(false);
           return 0;
@@ -902,7 +980,7 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
       packet >> mii_data;
       if (mii_data)
       {
-        auto buffer = DecompressPacketIntoBuffer(packet);
+        auto buffer = DecompressPacketIntoBuffer(packet, m_save_block_store);
 
         temp_fs->CreateFullPath(IOS::PID_KERNEL, IOS::PID_KERNEL, "/shared2/menu/FaceLib/", 0,
                                 fs_modes);
@@ -976,7 +1054,7 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
 
           if (file.type == WiiSave::Storage::SaveFile::Type::File)
           {
-            auto buffer = DecompressPacketIntoBuffer(packet);
+            auto buffer = DecompressPacketIntoBuffer(packet, m_save_block_store);
             if (!buffer)
             {
               SyncSaveDataResponse(false);
@@ -1490,6 +1568,7 @@ bool NetPlayClient::StartGame(const std::string& path)
   NetPlay_Enable(this);
 
   ClearBuffers();
+  StartRollback();
 
   m_first_pad_status_received.fill(false);
 
@@ -1523,6 +1602,69 @@ bool NetPlayClient::StartGame(const std::string& path)
   return true;
 }
 
+// Tells the server which save data this player already holds, so that the saves it sends only
+// contain the blocks that differ
+void NetPlayClient::SendSaveDataManifest()
+{
+  m_save_block_store.Clear();
+
+  // The NetPlay memory cards and GCI folders of the last session are often identical or close to
+  // what the host sends this time
+  const std::string gc_path = File::GetUserPath(D_GCUSER_IDX);
+  for (const std::string& path : Common::DoFileSearch({gc_path}, {".raw"}))
+  {
+    std::string file_name;
+    SplitPath(path, nullptr, &file_name, nullptr);
+    if (StringBeginsWith(file_name, GC_MEMCARD_NETPLAY))
+      m_save_block_store.AddFile(path);
+  }
+  m_save_block_store.AddDirectory(gc_path + GC_MEMCARD_NETPLAY);
+
+  // The NetPlay NAND is deleted after every session, but this player's own Wii save of the game
+  // is likely to be similar to the host's
+  const auto game = m_dialog->FindGameFile(m_selected_game);
+  if (game && (game->GetPlatform() == DiscIO::Platform::WiiDisc ||
+               game->GetPlatform() == DiscIO::Platform::WiiWAD))
+  {
+    const auto configured_fs = IOS::HLE::FS::MakeFileSystem(IOS::HLE::FS::Location::Configured);
+
+    auto file = configured_fs->OpenFile(IOS::PID_KERNEL, IOS::PID_KERNEL,
+                                        Common::GetMiiDatabasePath(), IOS::HLE::FS::Mode::Read);
+    if (file)
+    {
+      std::vector<u8> file_data(file->GetStatus()->size);
+      if (file->Read(file_data.data(), file_data.size()))
+        m_save_block_store.AddBuffer(std::move(file_data));
+    }
+
+    const auto save = WiiSave::MakeNandStorage(configured_fs.get(), game->GetTitleID());
+    const auto files = save->SaveExists() ? save->ReadFiles() : std::nullopt;
+    if (files)
+    {
+      for (const WiiSave::Storage::SaveFile& save_file : *files)
+      {
+        if (save_file.type != WiiSave::Storage::SaveFile::Type::File)
+          continue;
+
+        const std::optional<std::vector<u8>>& data = *save_file.data;
+        if (data)
+          m_save_block_store.AddBuffer(*data);
+      }
+    }
+  }
+
+  const SaveBlockHashes hashes = m_save_block_store.GetHashes();
+
+  sf::Packet packet;
+  packet << static_cast<MessageId>(NP_MSG_SYNC_SAVE_DATA);
+  packet << static_cast<MessageId>(SYNC_SAVE_DATA_MANIFEST);
+  packet << static_cast<u32>(hashes.size());
+  for (const u64 hash : hashes)
+    packet << sf::Uint64{hash};
+
+  Send(packet);
+}
+
 void NetPlayClient::SyncSaveDataResponse(const bool success)
 {
   m_dialog->AppendChat(success ? Common::GetStringT("Data received!") :
@@ -1532,6 +1674,8 @@ void NetPlayClient::SyncSaveDataResponse(const bool success)
   {
     if (++m_sync_save_data_success_count >= m_sync_save_data_count)
     {
+      m_save_block_store.Clear();
+
       sf::Packet response_packet;
       response_packet << static_cast<MessageId>(NP_MSG_SYNC_SAVE_DATA);
       response_packet << static_cast<MessageId>(SYNC_SAVE_DATA_SUCCESS);
@@ -1541,6 +1685,8 @@ void NetPlayClient::SyncSaveDataResponse(const bool success)
   }
   else
   {
+    m_save_block_store.Clear();
+
     sf::Packet response_packet;
     response_packet << static_cast<MessageId>(NP_MSG_SYNC_SAVE_DATA);
     response_packet << static_cast<MessageId>(SYNC_SAVE_DATA_FAILURE);
@@ -1577,92 +1723,6 @@ void NetPlayClient::SyncCodeResponse(const bool success)
   }
 }
 
-bool NetPlayClient::DecompressPacketIntoFile(sf::Packet& packet, const std::string& file_path)
-{
-  u64 file_size = Common::PacketReadU64(packet);
-
-  if (file_size == 0)
-    return true;
-
-  File::IOFile file(file_path, "wb");
-  if (!file)
-  {
-    PanicAlertT("Failed to open file \"%s\". Verify your write permissions.", file_path.c_str());
-    return false;
-  }
-
-  std::vector<u8> in_buffer(NETPLAY_LZO_OUT_LEN);
-  std::vector<u8> out_buffer(NETPLAY_LZO_IN_LEN);
-
-  while (true)
-  {
-    u32 cur_len = 0;       // number of bytes to read
-    lzo_uint new_len = 0;  // number of bytes to write
-
-    packet >> cur_len;
-    if (!cur_len)
-      break;  // We reached the end of the data stream
-
-    for (size_t j = 0; j < cur_len; j++)
-    {
-      packet >> in_buffer[j];
-    }
-
-    if (lzo1x_decompress(in_buffer.data(), cur_len, out_buffer.data(), &new_len, nullptr) !=
-        LZO_E_OK)
-    {
-      PanicAlertT("Internal LZO Error - decompression failed");
-      return false;
-    }
-
-    if (!file.WriteBytes(out_buffer.data(), new_len))
-    {
-      PanicAlertT("Error writing file: %s", file_path.c_str());
-      return false;
-    }
-  }
-
-  return true;
-}
-
-std::optional<std::vector<u8>> NetPlayClient::DecompressPacketIntoBuffer(sf::Packet& packet)
-{
-  u64 size = Common::PacketReadU64(packet);
-
-  std::vector<u8> out_buffer(size);
-
-  if (size == 0)
-    return out_buffer;
-
-  std::vector<u8> in_buffer(NETPLAY_LZO_OUT_LEN);
-
-  lzo_uint i = 0;
-  while (true)
-  {
-    u32 cur_len = 0;       // number of bytes to read
-    lzo_uint new_len = 0;  // number of bytes to write
-
-    packet >> cur_len;
-    if (!cur_len)
-      break;  // We reached the end of the data stream
-
-    for (size_t j = 0; j < cur_len; j++)
-    {
-      packet >> in_buffer[j];
-    }
-
-    if (lzo1x_decompress(in_buffer.data(), cur_len, &out_buffer[i], &new_len, nullptr) != LZO_E_OK)
-    {
-      PanicAlertT("Internal LZO Error - decompression failed");
-      return {};
-    }
-
-    i += new_len;
-  }
-
-  return out_buffer;
-}
-
 // called from ---GUI--- thread
 bool NetPlayClient::ChangeGame(const std::string&)
 {
@@ -1825,6 +1885,15 @@ bool NetPlayClient::GetNetPads(const int pad_nb, const bool batching, GCPadStatu
     m_wait_on_input_event.Wait();
   }
 
+  if (m_rollback)
+  {
+    if (!GetRollbackPad(pad_nb, batching, pad_status))
+      return false;
+
+    Movie::CheckPadStatus(pad_status, pad_nb);
+    return true;
+  }
+
   if (IsFirstInGamePad(pad_nb) && batching)
   {
     sf::Packet packet;
@@ -1992,20 +2061,21 @@ bool NetPlayClient::WiimoteUpdate(int _number, u8* data, const u8 size, u8 repor
   return true;
 }
 
-bool NetPlayClient::PollLocalPad(const int local_pad, sf::Packet& packet)
+static GCPadStatus ReadLocalPad(const int local_pad)
 {
-  GCPadStatus pad_status;
-
   switch (SConfig::GetInstance().m_SIDevice[local_pad])
   {
   case SerialInterface::SIDEVICE_WIIU_ADAPTER:
-    pad_status = GCAdapter::Input(local_pad);
-    break;
+    return GCAdapter::Input(local_pad);
   case SerialInterface::SIDEVICE_GC_CONTROLLER:
   default:
-    pad_status = Pad::GetStatus(local_pad);
-    break;
+    return Pad::GetStatus(local_pad);
   }
+}
+
+bool NetPlayClient::PollLocalPad(const int local_pad, sf::Packet& packet)
+{
+  const GCPadStatus pad_status = ReadLocalPad(local_pad);
 
   const int ingame_pad = LocalPadToInGamePad(local_pad);
   bool data_added = false;
@@ -2043,6 +2113,63 @@ bool NetPlayClient::PollLocalPad(const int local_pad, sf::Packet& packet)
   return data_added;
 }
 
+// called from ---CPU--- thread
+bool NetPlayClient::GetRollbackPad(const int pad_nb, const bool batching, GCPadStatus* pad_status)
+{
+  // Local inputs are used as soon as they are polled. Polls that are re-simulated after a rollback
+  // use the inputs that were read the first time around.
+  sf::Packet packet;
+  packet << static_cast<MessageId>(NP_MSG_PAD_DATA);
+
+  bool send_packet = false;
+  if (IsFirstInGamePad(pad_nb) && batching)
+  {
+    const int num_local_pads = NumLocalPads();
+    for (int local_pad = 0; local_pad < num_local_pads; local_pad++)
+      send_packet = PollRollbackLocalPad(local_pad, packet) || send_packet;
+  }
+
+  const int local_pad = InGamePadToLocalPad(pad_nb);
+  if (local_pad < 4)
+    send_packet = PollRollbackLocalPad(local_pad, packet) || send_packet;
+
+  if (send_packet)
+    SendAsync(std::move(packet));
+
+  ReceiveRollbackInputs();
+
+  // Nothing can be rolled back before the first state is saved, so the inputs of other players
+  // are only predicted from then on
+  while (m_rollback_snapshots.empty() && !m_rollback_history[pad_nb].HasInput())
+  {
+    if (!m_is_running.IsSet())
+      return false;
+
+    m_gc_pad_event.Wait();
+    ReceiveRollbackInputs();
+  }
+
+  bool predicted;
+  *pad_status = m_rollback_history[pad_nb].Consume(&predicted);
+  if (predicted)
+    ++m_rollback_stats.predicted_inputs;
+
+  return true;
+}
+
+bool NetPlayClient::PollRollbackLocalPad(const int local_pad, sf::Packet& packet)
+{
+  const int ingame_pad = LocalPadToInGamePad(local_pad);
+  RollbackPadHistory& history = m_rollback_history[ingame_pad];
+  if (history.HasInput())
+    return false;
+
+  const GCPadStatus pad_status = ReadLocalPad(local_pad);
+  history.AddInput(pad_status);
+  AddPadStateToPacket(ingame_pad, pad_status, packet);
+  return true;
+}
+
 void NetPlayClient::SendPadHostPoll(const PadIndex pad_num)
 {
   // Here we handle polling for the Host Input Authority and Golf modes. Pad data is "polled" from
@@ -2264,6 +2391,9 @@ void NetPlayClient::SendTimeBase()
 {
   std::lock_guard<std::mutex> lk(crit_netplay_client);
 
+  if (netplay_client->m_net_settings.m_DiagnoseDesyncs)
+    netplay_client->SendHashTreeRoot();
+
   if (netplay_client->m_timebase_frame % 60 == 0)
   {
     const sf::Uint64 timebase = SystemTimers::GetFakeTimeBase();
@@ -2273,12 +2403,353 @@ void NetPlayClient::SendTimeBase()
     packet << timebase;
     packet << netplay_client->m_timebase_frame;
 
-    netplay_client->SendAsync(std::move(packet));
+    netplay_client->SendFrameReport(std::move(packet));
   }
 
   netplay_client->m_timebase_frame++;
 }
 
+// called from ---CPU--- thread
+void NetPlayClient::SendFrameReport(sf::Packet&& packet)
+{
+  if (m_rollback)
+  {
+    m_pending_frame_reports.push_back(
+        {std::move(packet), m_timebase_frame, GetRollbackPollCounts()});
+  }
+  else
+  {
+    SendAsync(std::move(packet));
+  }
+}
+
+// called from ---CPU--- thread
+void NetPlayClient::SendHashTreeRoot()
+{
+  FrameHashTree entry;
+  {
+    std::lock_guard<std::mutex> lk(m_hash_trees_lock);
+
+    // Frames that are emulated again after a rollback replace their earlier trees
+    while (!m_hash_trees.empty() && m_hash_trees.back().frame >= m_timebase_frame)
+    {
+      entry = std::move(m_hash_trees.back());
+      m_hash_trees.pop_back();
+    }
+
+    if (m_hash_trees.size() >= HASH_TREE_HISTORY)
+    {
+      entry = std::move(m_hash_trees.front());
+      m_hash_trees.pop_front();
+    }
+  }
+
+  entry.frame = m_timebase_frame;
+  entry.tree.Build(GetHashTreeRegions());
+
+  sf::Packet packet;
+  packet << static_cast<MessageId>(NP_MSG_HASH_TREE_ROOT);
+  packet << entry.frame;
+  packet << static_cast<u32>(entry.tree.GetLevelCount());
+  packet << sf::Uint64{entry.tree.GetRoot()};
+
+  {
+    std::lock_guard<std::mutex> lk(m_hash_trees_lock);
+    m_hash_trees.push_back(std::move(entry));
+  }
+
+  SendFrameReport(std::move(packet));
+}
+
+// called from ---CPU--- thread
+std::vector<HashTreeRegion> NetPlayClient::GetHashTreeRegions()
+{
+  const PowerPC::PowerPCState& state = PowerPC::ppcState;
+  const auto append = [this](const void* data, size_t size) {
+    const u8* bytes = static_cast<const u8*>(data);
+    m_hash_tree_registers.insert(m_hash_tree_registers.end(), bytes, bytes + size);
+  };
+
+  const u32 cr = state.cr.Get();
+  const u32 xer = PowerPC::GetXER().Hex;
+  m_hash_tree_registers.clear();
+  append(state.gpr, sizeof(state.gpr));
+  append(&state.pc, sizeof(state.pc));
+  append(&cr, sizeof(cr));
+  append(&state.msr.Hex, sizeof(state.msr.Hex));
+  append(&state.fpscr.Hex, sizeof(state.fpscr.Hex));
+  append(&xer, sizeof(xer));
+  append(state.ps, sizeof(state.ps));
+  append(state.sr, sizeof(state.sr));
+
+  std::vector<HashTreeRegion> regions;
+  regions.push_back(
+      {"CPU registers", 0, m_hash_tree_registers.data(), m_hash_tree_registers.size()});
+  regions.push_back({"SPRs", 0, reinterpret_cast<const u8*>(state.spr), sizeof(state.spr)});
+  regions.push_back({"MEM1", 0x80000000, Memory::m_pRAM, Memory::REALRAM_SIZE});
+  if (SConfig::GetInstance().bWii)
+    regions.push_back({"MEM2", 0x90000000, Memory::m_pEXRAM, Memory::EXRAM_SIZE});
+  else
+    regions.push_back({"ARAM", 0, DSP::GetARAMPtr(), DSP::ARAM_SIZE});
+
+  // With dual core, the GPU thread can still be processing the frame at this point
+  if (!SConfig::GetInstance().bCPUThread)
+  {
+    regions.push_back({"BP registers", 0, reinterpret_cast<const u8*>(&bpmem), sizeof(bpmem)});
+    regions.push_back({"XF registers", 0, reinterpret_cast<const u8*>(&xfmem), sizeof(xfmem)});
+    regions.push_back({"TMEM", 0, texMem, TMEM_SIZE});
+  }
+
+  return regions;
+}
+
+// called from ---NETPLAY--- thread
+const MemoryHashTree* NetPlayClient::FindDiagnosedHashTree(u32 frame)
+{
+  if (!m_diagnosed_hash_tree || m_diagnosed_hash_tree->frame != frame)
+  {
+    std::lock_guard<std::mutex> lk(m_hash_trees_lock);
+
+    const auto it =
+        std::find_if(m_hash_trees.begin(), m_hash_trees.end(),
+                     [frame](const FrameHashTree& entry) { return entry.frame == frame; });
+    if (it == m_hash_trees.end())
+      m_diagnosed_hash_tree.reset();
+    else
+      m_diagnosed_hash_tree = *it;
+  }
+
+  return m_diagnosed_hash_tree ? &m_diagnosed_hash_tree->tree : nullptr;
+}
+
+// called from ---GUI--- thread
+void NetPlayClient::StartRollback()
+{
+  for (RollbackPadHistory& history : m_rollback_history)
+    history.Clear();
+  m_mispredicted_poll.fill(std::nullopt);
+  m_rollback_snapshots.clear();
+  m_pending_frame_reports.clear();
+  m_rollback_field = 0;
+  m_resimulate_until = 0;
+  m_rollback_stats = {};
+  Core::SetIsResimulating(false);
+
+  m_rollback = m_net_settings.m_Rollback;
+  if (!m_rollback)
+    return;
+
+  // Only GameCube controller inputs are predicted, and input recordings can't be rolled back
+  const bool wiimotes_mapped =
+      std::any_of(m_wiimote_map.begin(), m_wiimote_map.end(), [](PlayerId pid) { return pid > 0; });
+  if (m_host_input_authority || wiimotes_mapped || m_dialog->IsRecording())
+  {
+    WARN_LOG(NETPLAY, "Rollback isn't supported with Wii Remotes or input recording, "
+                      "using fair input delay instead");
+    m_rollback = false;
+  }
+}
+
+// called from ---CPU--- thread
+void NetPlayClient::OnFieldStart()
+{
+  if (!m_rollback)
+    return;
+
+  ReceiveRollbackInputs();
+
+  const auto is_mispredicted = [this] {
+    return std::any_of(m_mispredicted_poll.begin(), m_mispredicted_poll.end(),
+                       [](const std::optional<u64>& poll) { return poll.has_value(); });
+  };
+
+  // Only ROLLBACK_MAX_FIELDS states are kept. The oldest one can only be dropped once all inputs
+  // that were polled before the next one are known, as mispredicting them couldn't be undone.
+  if (!is_mispredicted() && m_rollback_snapshots.size() == ROLLBACK_MAX_FIELDS &&
+      !AreRollbackInputsConfirmed(m_rollback_snapshots[1].poll_counts))
+  {
+    const auto stall_start = std::chrono::steady_clock::now();
+    do
+    {
+      if (!m_is_running.IsSet())
+        return;
+
+      m_gc_pad_event.Wait();
+      ReceiveRollbackInputs();
+    } while (!is_mispredicted() &&
+             !AreRollbackInputsConfirmed(m_rollback_snapshots[1].poll_counts));
+    m_rollback_stats.stall_time += std::chrono::steady_clock::now() - stall_start;
+  }
+
+  if (is_mispredicted())
+  {
+    Rollback();
+    return;
+  }
+
+  if (Core::IsResimulating() && m_rollback_field >= m_resimulate_until)
+  {
+    Core::SetIsResimulating(false);
+    m_rollback_stats.resimulation_time += std::chrono::steady_clock::now() - m_resimulation_start;
+  }
+
+  SaveRollbackSnapshot();
+  SendConfirmedFrameReports();
+
+  if (Core::IsResimulating())
+  {
+    ++m_rollback_stats.resimulated_fields;
+  }
+  else if (++m_rollback_stats.fields % 600 == 0)
+  {
+    LogRollbackStats();
+  }
+}
+
+// called from ---CPU--- thread
+void NetPlayClient::ReceiveRollbackInputs()
+{
+  for (size_t pad = 0; pad < m_pad_buffer.size(); ++pad)
+  {
+    GCPadStatus pad_status;
+    while (m_pad_buffer[pad].Pop(pad_status))
+    {
+      const u64 poll = m_rollback_history[pad].GetConfirmedCount();
+      if (m_rollback_history[pad].AddInput(pad_status))
+      {
+        ++m_rollback_stats.mispredicted_inputs;
+        if (!m_mispredicted_poll[pad])
+          m_mispredicted_poll[pad] = poll;
+      }
+    }
+  }
+}
+
+bool NetPlayClient::AreRollbackInputsConfirmed(const std::array<u64, 4>& poll_counts) const
+{
+  for (size_t pad = 0; pad < m_rollback_history.size(); ++pad)
+  {
+    if (m_rollback_history[pad].GetConfirmedCount() < poll_counts[pad])
+      return false;
+  }
+
+  return true;
+}
+
+std::array<u64, 4> NetPlayClient::GetRollbackPollCounts() const
+{
+  std::array<u64, 4> poll_counts;
+  for (size_t pad = 0; pad < m_rollback_history.size(); ++pad)
+    poll_counts[pad] = m_rollback_history[pad].GetConsumedCount();
+  return poll_counts;
+}
+
+// called from ---CPU--- thread
+void NetPlayClient::Rollback()
+{
+  // Load the newest state from before every mispredicted poll
+  const auto snapshot = std::find_if(
+      m_rollback_snapshots.rbegin(), m_rollback_snapshots.rend(),
+      [this](const RollbackSnapshot& candidate) {
+        for (size_t pad = 0; pad < m_mispredicted_poll.size(); ++pad)
+        {
+          if (m_mispredicted_poll[pad] && candidate.poll_counts[pad] > *m_mispredicted_poll[pad])
+            return false;
+        }
+        return true;
+      });
+
+  m_mispredicted_poll.fill(std::nullopt);
+
+  if (snapshot == m_rollback_snapshots.rend())
+  {
+    PanicAlertT("Netplay has desynced. There is no way to recover from this.");
+    return;
+  }
+
+  const auto load_start = std::chrono::steady_clock::now();
+  State::LoadFromBufferForRollback(snapshot->state);
+  m_rollback_stats.load_time += std::chrono::steady_clock::now() - load_start;
+
+  for (size_t pad = 0; pad < m_rollback_history.size(); ++pad)
+    m_rollback_history[pad].Rewind(snapshot->poll_counts[pad]);
+
+  // A rollback while re-simulating still has to catch up with the field that started the first one
+  if (!Core::IsResimulating())
+  {
+    m_resimulate_until = m_rollback_field;
+    m_resimulation_start = load_start;
+    Core::SetIsResimulating(true);
+  }
+
+  m_rollback_field = snapshot->field + 1;
+  m_timebase_frame = snapshot->timebase_frame;
+  while (!m_pending_frame_reports.empty() &&
+         m_pending_frame_reports.back().frame >= m_timebase_frame)
+  {
+    m_pending_frame_reports.pop_back();
+  }
+
+  // The states after the loaded one are saved again while re-simulating
+  m_rollback_snapshots.erase(snapshot.base(), m_rollback_snapshots.end());
+
+  ++m_rollback_stats.rollbacks;
+}
+
+// called from ---CPU--- thread
+void NetPlayClient::SaveRollbackSnapshot()
+{
+  RollbackSnapshot snapshot;
+  if (m_rollback_snapshots.size() == ROLLBACK_MAX_FIELDS)
+  {
+    // Reuse the buffer of the oldest state
+    snapshot.state = std::move(m_rollback_snapshots.front().state);
+    m_rollback_snapshots.pop_front();
+  }
+
+  const auto save_start = std::chrono::steady_clock::now();
+  State::SaveToBufferForRollback(snapshot.state);
+  m_rollback_stats.save_time += std::chrono::steady_clock::now() - save_start;
+
+  snapshot.poll_counts = GetRollbackPollCounts();
+  snapshot.field = m_rollback_field++;
+  snapshot.timebase_frame = m_timebase_frame;
+  m_rollback_snapshots.push_back(std::move(snapshot));
+
+  // The polls before the oldest state can't be rolled back anymore
+  for (size_t pad = 0; pad < m_rollback_history.size(); ++pad)
+    m_rollback_history[pad].Forget(m_rollback_snapshots.front().poll_counts[pad]);
+}
+
+// called from ---CPU--- thread
+void NetPlayClient::SendConfirmedFrameReports()
+{
+  while (!m_pending_frame_reports.empty() &&
+         AreRollbackInputsConfirmed(m_pending_frame_reports.front().poll_counts))
+  {
+    SendAsync(std::move(m_pending_frame_reports.front().packet));
+    m_pending_frame_reports.pop_front();
+  }
+}
+
+void NetPlayClient::LogRollbackStats() const
+{
+  using Milliseconds = std::chrono::duration<double, std::milli>;
+  const RollbackStats& stats = m_rollback_stats;
+
+  INFO_LOG(NETPLAY, "%s",
+           fmt::format("Rollback: {} fields, {} of {} predicted inputs wrong, {} rollbacks, "
+                       "{} fields re-simulated in {:.1f} ms, saving {:.1f} ms, loading {:.1f} ms, "
+                       "waiting for inputs {:.1f} ms",
+                       stats.fields, stats.mispredicted_inputs, stats.predicted_inputs,
+                       stats.rollbacks, stats.resimulated_fields,
+                       Milliseconds(stats.resimulation_time).count(),
+                       Milliseconds(stats.save_time).count(),
+                       Milliseconds(stats.load_time).count(),
+                       Milliseconds(stats.stall_time).count())
+               .c_str());
+}
+
 bool NetPlayClient::DoAllPlayersHaveGame()
 {
   std::lock_guard<std::recursive_mutex> lkp(m_crit.players);
@@ -2421,6 +2892,14 @@ void SetupWiimotes()
   }
 }
 
+void OnFieldStart()
+{
+  std::lock_guard<std::mutex> lk(crit_netplay_client);
+
+  if (netplay_client)
+    netplay_client->OnFieldStart();
+}
+
 void NetPlay_Enable(NetPlayClient* const np)
 {
   std::lock_guard<std::mutex> lk(crit_netplay_client);
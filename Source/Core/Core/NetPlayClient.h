@@ -7,6 +7,7 @@
 #include <SFML/Network/Packet.hpp>
 #include <array>
 #include <chrono>
+#include <deque>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -21,7 +22,10 @@
 #include "Common/Event.h"
 #include "Common/SPSCQueue.h"
 #include "Common/TraversalClient.h"
+#include "Core/NetPlayHashTree.h"
 #include "Core/NetPlayProto.h"
+#include "Core/NetPlayRollback.h"
+#include "Core/NetPlaySaveTransfer.h"
 #include "InputCommon/GCPadStatus.h"
 
 namespace UICommon
@@ -51,6 +55,8 @@ public:
   virtual void OnPadBufferChanged(u32 buffer) = 0;
   virtual void OnHostInputAuthorityChanged(bool enabled) = 0;
   virtual void OnDesync(u32 frame, const std::string& player) = 0;
+  // regions describes the memory that differed between the players
+  virtual void OnDesyncDiagnosed(u32 frame, const std::vector<std::string>& regions) = 0;
   virtual void OnConnectionLost() = 0;
   virtual void OnConnectionError(const std::string& message) = 0;
   virtual void OnTraversalError(TraversalClient::FailureReason error) = 0;
@@ -142,6 +148,7 @@ public:
   bool IsLocalPlayer(PlayerId pid) const;
 
   static void SendTimeBase();
+  void OnFieldStart();
   bool DoAllPlayersHaveGame();
 
   const PadMappingArray& GetPadMapping() const;
@@ -222,12 +229,13 @@ private:
   void SendStartGamePacket();
   void SendStopGamePacket();
 
+  void SendSaveDataManifest();
   void SyncSaveDataResponse(bool success);
   void SyncCodeResponse(bool success);
-  bool DecompressPacketIntoFile(sf::Packet& packet, const std::string& file_path);
-  std::optional<std::vector<u8>> DecompressPacketIntoBuffer(sf::Packet& packet);
 
   bool PollLocalPad(int local_pad, sf::Packet& packet);
+  bool GetRollbackPad(int pad_nb, bool batching, GCPadStatus* pad_status);
+  bool PollRollbackLocalPad(int local_pad, sf::Packet& packet);
   void SendPadHostPoll(PadIndex pad_num);
 
   void UpdateDevices();
@@ -259,6 +267,7 @@ private:
   Common::Event m_wait_on_input_event;
   u8 m_sync_save_data_count = 0;
   u8 m_sync_save_data_success_count = 0;
+  SaveBlockStore m_save_block_store;
   u16 m_sync_gecko_codes_count = 0;
   u16 m_sync_gecko_codes_success_count = 0;
   bool m_sync_gecko_codes_complete = false;
@@ -269,6 +278,62 @@ private:
 
   u64 m_initial_rtc = 0;
   u32 m_timebase_frame = 0;
+
+  struct RollbackSnapshot
+  {
+    std::vector<u8> state;
+    std::array<u64, 4> poll_counts;
+    u64 field;
+    u32 timebase_frame;
+  };
+
+  // In rollback mode, reports about a frame are only sent once all inputs it depends on are
+  // known, as it could still be rolled back otherwise
+  struct PendingFrameReport
+  {
+    sf::Packet packet;
+    u32 frame;
+    std::array<u64, 4> poll_counts;
+  };
+
+  struct FrameHashTree
+  {
+    u32 frame = 0;
+    MemoryHashTree tree;
+  };
+
+  void SendFrameReport(sf::Packet&& packet);
+  void SendHashTreeRoot();
+  std::vector<HashTreeRegion> GetHashTreeRegions();
+  const MemoryHashTree* FindDiagnosedHashTree(u32 frame);
+
+  void StartRollback();
+  void ReceiveRollbackInputs();
+  bool AreRollbackInputsConfirmed(const std::array<u64, 4>& poll_counts) const;
+  std::array<u64, 4> GetRollbackPollCounts() const;
+  void Rollback();
+  void SaveRollbackSnapshot();
+  void SendConfirmedFrameReports();
+  void LogRollbackStats() const;
+
+  bool m_rollback = false;
+  std::array<RollbackPadHistory, 4> m_rollback_history;
+  // The first poll of each pad whose input was mispredicted
+  std::array<std::optional<u64>, 4> m_mispredicted_poll;
+  std::deque<RollbackSnapshot> m_rollback_snapshots;
+  std::deque<PendingFrameReport> m_pending_frame_reports;
+  u64 m_rollback_field = 0;
+  // Fields before this one are re-simulated without being presented
+  u64 m_resimulate_until = 0;
+  std::chrono::steady_clock::time_point m_resimulation_start;
+  RollbackStats m_rollback_stats;
+
+  // The hash trees of the last HASH_TREE_HISTORY frames, when diagnosing desyncs
+  std::mutex m_hash_trees_lock;
+  std::deque<FrameHashTree> m_hash_trees;
+  std::vector<u8> m_hash_tree_registers;
+  // A copy of the tree that the server is comparing, as it would leave the history otherwise
+  std::optional<FrameHashTree> m_diagnosed_hash_tree;
 };
 
 void NetPlay_Enable(NetPlayClient* const np);
@@ -0,0 +1,114 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/NetPlayHashTree.h"
+
+#include <algorithm>
+
+#include <fmt/format.h>
+#include <xxhash.h>
+
+namespace NetPlay
+{
+void MemoryHashTree::Build(const std::vector<HashTreeRegion>& regions)
+{
+  m_regions.clear();
+  m_levels.resize(1);
+
+  std::vector<u64>& leaves = m_levels[0];
+  leaves.clear();
+  for (const HashTreeRegion& region : regions)
+  {
+    m_regions.push_back({region.name, region.address, region.size, leaves.size(), 0});
+    for (size_t offset = 0; offset < region.size; offset += HASH_TREE_PAGE_SIZE)
+    {
+      const size_t size = std::min(HASH_TREE_PAGE_SIZE, region.size - offset);
+      leaves.push_back(XXH64(region.data + offset, size, 0));
+    }
+    m_regions.back().leaf_count = leaves.size() - m_regions.back().first_leaf;
+  }
+
+  size_t level = 0;
+  while (m_levels[level].size() > 1)
+  {
+    if (m_levels.size() == level + 1)
+      m_levels.emplace_back();
+
+    const std::vector<u64>& children = m_levels[level];
+    std::vector<u64>& parents = m_levels[level + 1];
+    parents.clear();
+    for (size_t first = 0; first < children.size(); first += HASH_TREE_FANOUT)
+    {
+      const size_t count = std::min(HASH_TREE_FANOUT, children.size() - first);
+      parents.push_back(XXH64(children.data() + first, count * sizeof(u64), 0));
+    }
+
+    ++level;
+  }
+
+  m_levels.resize(level + 1);
+}
+
+u64 MemoryHashTree::GetRoot() const
+{
+  if (m_levels.empty() || m_levels.back().empty())
+    return 0;
+
+  return m_levels.back()[0];
+}
+
+std::optional<std::vector<u64>> MemoryHashTree::GetChildren(size_t level, size_t index) const
+{
+  if (level == 0 || level >= m_levels.size() || index >= m_levels[level].size())
+    return std::nullopt;
+
+  const std::vector<u64>& children = m_levels[level - 1];
+  const size_t first = index * HASH_TREE_FANOUT;
+  const size_t last = std::min(first + HASH_TREE_FANOUT, children.size());
+  return std::vector<u64>(children.begin() + first, children.begin() + last);
+}
+
+std::vector<std::string> MemoryHashTree::DescribeLeaves(std::vector<u32> leaves) const
+{
+  std::sort(leaves.begin(), leaves.end());
+  leaves.erase(std::unique(leaves.begin(), leaves.end()), leaves.end());
+
+  std::vector<std::string> descriptions;
+  for (auto it = leaves.begin(); it != leaves.end();)
+  {
+    const auto region =
+        std::find_if(m_regions.begin(), m_regions.end(), [leaf = *it](const RegionLayout& r) {
+          return leaf >= r.first_leaf && leaf < r.first_leaf + r.leaf_count;
+        });
+    if (region == m_regions.end())
+    {
+      ++it;
+      continue;
+    }
+
+    // Merge the following leaves of the same region
+    const size_t first = *it - region->first_leaf;
+    size_t last = first;
+    for (++it; it != leaves.end() && *it - region->first_leaf == last + 1 &&
+               last + 1 < region->leaf_count;
+         ++it)
+    {
+      ++last;
+    }
+
+    if (region->leaf_count == 1)
+    {
+      descriptions.push_back(region->name);
+      continue;
+    }
+
+    const size_t start = first * HASH_TREE_PAGE_SIZE;
+    const size_t end = std::min((last + 1) * HASH_TREE_PAGE_SIZE, region->size) - 1;
+    descriptions.push_back(fmt::format("{} {:08x}-{:08x}", region->name,
+                                       region->address + start, region->address + end));
+  }
+
+  return descriptions;
+}
+}  // namespace NetPlay
@@ -0,0 +1,65 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+namespace NetPlay
+{
+// Every leaf of a hash tree covers a page of this size
+constexpr size_t HASH_TREE_PAGE_SIZE = 0x1000;
+constexpr size_t HASH_TREE_FANOUT = 16;
+// Clients keep the trees of this many frames, which the server can compare once it has received
+// the roots of every player
+constexpr size_t HASH_TREE_HISTORY = 60;
+// The server follows at most this many differing nodes on every level
+constexpr size_t HASH_TREE_MAX_DIFFERING_NODES = 64;
+
+struct HashTreeRegion
+{
+  std::string name;
+  // The address of the first byte, as shown in descriptions
+  u32 address;
+  const u8* data;
+  size_t size;
+};
+
+// A Merkle tree over the pages of several memory regions. If the roots of two trees differ, the
+// pages that differ can be found by comparing the children of the nodes that differ, level by
+// level, without comparing the memory itself.
+class MemoryHashTree
+{
+public:
+  // Rebuilds the tree, reusing the memory of the previous one
+  void Build(const std::vector<HashTreeRegion>& regions);
+
+  // Level 0 consists of the leaves, and the last level of the root alone
+  size_t GetLevelCount() const { return m_levels.size(); }
+  u64 GetRoot() const;
+  // Returns nothing if there is no such node, or if it is a leaf
+  std::optional<std::vector<u64>> GetChildren(size_t level, size_t index) const;
+
+  // Describes the memory of the leaves, merging adjacent ones, e.g. "MEM1 80003000-80004fff"
+  std::vector<std::string> DescribeLeaves(std::vector<u32> leaves) const;
+
+private:
+  struct RegionLayout
+  {
+    std::string name;
+    u32 address;
+    size_t size;
+    size_t first_leaf;
+    size_t leaf_count;
+  };
+
+  std::vector<RegionLayout> m_regions;
+  std::vector<std::vector<u64>> m_levels;
+};
+}  // namespace NetPlay
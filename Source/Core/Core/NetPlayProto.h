@@ -77,12 +77,14 @@ struct NetSettings
   bool m_EFBAccessTileSize;
   bool m_EFBAccessDeferInvalidation;
   bool m_StrictSettingsSync;
+  bool m_DiagnoseDesyncs;
   bool m_SyncSaveData;
   bool m_SyncCodes;
   std::string m_SaveDataRegion;
   bool m_SyncAllWiiSaves;
   std::array<int, 4> m_WiimoteExtension;
   bool m_GolfMode;
+  bool m_Rollback;
 
   // These aren't sent over the network directly
   bool m_IsHosting;
@@ -148,6 +150,10 @@ enum
 
   NP_MSG_TIMEBASE = 0xB0,
   NP_MSG_DESYNC_DETECTED = 0xB1,
+  NP_MSG_HASH_TREE_ROOT = 0xB2,
+  NP_MSG_HASH_TREE_REQUEST = 0xB3,
+  NP_MSG_HASH_TREE_NODES = 0xB4,
+  NP_MSG_HASH_TREE_RESULT = 0xB5,
 
   NP_MSG_COMPUTE_MD5 = 0xC0,
   NP_MSG_MD5_PROGRESS = 0xC1,
@@ -181,7 +187,8 @@ enum
   SYNC_SAVE_DATA_FAILURE = 2,
   SYNC_SAVE_DATA_RAW = 3,
   SYNC_SAVE_DATA_GCI = 4,
-  SYNC_SAVE_DATA_WII = 5
+  SYNC_SAVE_DATA_WII = 5,
+  SYNC_SAVE_DATA_MANIFEST = 6
 };
 
 enum
@@ -195,8 +202,6 @@ enum
   SYNC_CODES_FAILURE = 6,
 };
 
-constexpr u32 NETPLAY_LZO_IN_LEN = 1024 * 64;
-constexpr u32 NETPLAY_LZO_OUT_LEN = NETPLAY_LZO_IN_LEN + (NETPLAY_LZO_IN_LEN / 16) + 64 + 3;
 constexpr size_t CHUNKED_DATA_UNIT_SIZE = 16384;
 constexpr u8 CHANNEL_COUNT = 2;
 constexpr u8 DEFAULT_CHANNEL = 0;
@@ -221,4 +226,6 @@ void SetSIPollBatching(bool state);
 void SendPowerButtonEvent();
 bool IsSyncingAllWiiSaves();
 void SetupWiimotes();
+// Called from the CPU thread when a new field starts
+void OnFieldStart();
 }  // namespace NetPlay
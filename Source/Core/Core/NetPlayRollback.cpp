@@ -0,0 +1,78 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/NetPlayRollback.h"
+
+#include <algorithm>
+
+namespace NetPlay
+{
+static bool IsSamePadStatus(const GCPadStatus& a, const GCPadStatus& b)
+{
+  return a.button == b.button && a.stickX == b.stickX && a.stickY == b.stickY &&
+         a.substickX == b.substickX && a.substickY == b.substickY &&
+         a.triggerLeft == b.triggerLeft && a.triggerRight == b.triggerRight &&
+         a.analogA == b.analogA && a.analogB == b.analogB && a.isConnected == b.isConnected;
+}
+
+RollbackPadHistory::RollbackPadHistory()
+{
+  // Until the first input is known, nothing is predicted to be pressed
+  m_last_input.stickX = GCPadStatus::MAIN_STICK_CENTER_X;
+  m_last_input.stickY = GCPadStatus::MAIN_STICK_CENTER_Y;
+  m_last_input.substickX = GCPadStatus::C_STICK_CENTER_X;
+  m_last_input.substickY = GCPadStatus::C_STICK_CENTER_Y;
+}
+
+bool RollbackPadHistory::AddInput(const GCPadStatus& status)
+{
+  bool mispredicted = false;
+  if (!m_predictions.empty())
+  {
+    mispredicted = !IsSamePadStatus(m_predictions.front(), status);
+    m_predictions.pop_front();
+  }
+
+  m_inputs.push_back(status);
+  m_last_input = status;
+  return mispredicted;
+}
+
+bool RollbackPadHistory::HasInput() const
+{
+  return m_consumed < GetConfirmedCount();
+}
+
+GCPadStatus RollbackPadHistory::Consume(bool* predicted)
+{
+  const u64 poll = m_consumed++;
+
+  *predicted = poll >= GetConfirmedCount();
+  if (!*predicted)
+    return m_inputs[poll - m_first];
+
+  m_predictions.push_back(m_last_input);
+  return m_last_input;
+}
+
+void RollbackPadHistory::Rewind(u64 poll_count)
+{
+  m_consumed = poll_count;
+
+  const u64 confirmed = GetConfirmedCount();
+  m_predictions.resize(poll_count > confirmed ? poll_count - confirmed : 0);
+}
+
+void RollbackPadHistory::Forget(u64 poll_count)
+{
+  const u64 count = std::min(poll_count, GetConfirmedCount()) - std::min(poll_count, m_first);
+  m_inputs.erase(m_inputs.begin(), m_inputs.begin() + count);
+  m_first += count;
+}
+
+void RollbackPadHistory::Clear()
+{
+  *this = RollbackPadHistory{};
+}
+}  // namespace NetPlay
@@ -0,0 +1,70 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+
+#include "Common/CommonTypes.h"
+#include "InputCommon/GCPadStatus.h"
+
+namespace NetPlay
+{
+// At most this many fields can be rolled back. Emulation waits for remote inputs instead of
+// predicting them any further ahead.
+constexpr size_t ROLLBACK_MAX_FIELDS = 8;
+
+// The inputs of one GameCube controller in rollback mode, indexed by the number of the poll they
+// are used for. Polls for which the actual input isn't known yet are predicted to repeat the
+// last known input.
+class RollbackPadHistory
+{
+public:
+  RollbackPadHistory();
+
+  // Adds the actual input for the first poll whose input wasn't known yet. Returns true if that
+  // poll was already predicted with a different input, in which case the emulation has to be
+  // rolled back to before it.
+  bool AddInput(const GCPadStatus& status);
+  // Whether the actual input for the next poll is known
+  bool HasInput() const;
+  // Returns the input for the next poll, predicting it if the actual input isn't known yet
+  GCPadStatus Consume(bool* predicted);
+
+  // Continues polling from poll_count, after the state from before that poll was loaded
+  void Rewind(u64 poll_count);
+  // Drops the inputs of the polls before poll_count, which can't be rolled back anymore
+  void Forget(u64 poll_count);
+  void Clear();
+
+  u64 GetConsumedCount() const { return m_consumed; }
+  u64 GetConfirmedCount() const { return m_first + m_inputs.size(); }
+
+private:
+  // The actual inputs of the polls from m_first on
+  std::deque<GCPadStatus> m_inputs;
+  // The inputs that were used for the polls from GetConfirmedCount() up to m_consumed
+  std::deque<GCPadStatus> m_predictions;
+  GCPadStatus m_last_input{};
+  u64 m_first = 0;
+  u64 m_consumed = 0;
+};
+
+struct RollbackStats
+{
+  u64 fields = 0;
+  u64 predicted_inputs = 0;
+  u64 mispredicted_inputs = 0;
+  u64 rollbacks = 0;
+  u64 resimulated_fields = 0;
+  // Time spent saving and loading states, and re-simulating fields after loading them
+  std::chrono::steady_clock::duration save_time{};
+  std::chrono::steady_clock::duration load_time{};
+  std::chrono::steady_clock::duration resimulation_time{};
+  // Time spent waiting for remote inputs because the rollback window was full
+  std::chrono::steady_clock::duration stall_time{};
+};
+}  // namespace NetPlay
@@ -0,0 +1,343 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/NetPlaySaveTransfer.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+
+#include <xxhash.h>
+#include <zlib.h>
+
+#include "Common/File.h"
+#include "Common/FileSearch.h"
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
+#include "Common/MsgHandler.h"
+#include "Common/SFMLHelper.h"
+
+namespace NetPlay
+{
+namespace
+{
+enum class SaveChunkType : u8
+{
+  Literal = 0,
+  Reference = 1,
+};
+
+struct XXH64StateDeleter
+{
+  void operator()(XXH64_state_t* state) const { XXH64_freeState(state); }
+};
+
+std::optional<std::vector<u8>> ReadFile(const std::string& path)
+{
+  File::IOFile file(path, "rb");
+  if (!file)
+    return std::nullopt;
+
+  std::vector<u8> data(file.GetSize());
+  if (!file.ReadBytes(data.data(), data.size()))
+    return std::nullopt;
+
+  return data;
+}
+
+void WriteReference(sf::Packet& packet, u64 hash, size_t size)
+{
+  packet << static_cast<u8>(SaveChunkType::Reference);
+  packet << sf::Uint64{hash} << static_cast<u32>(size);
+}
+
+void WriteLiteral(sf::Packet& packet, const u8* data, size_t size)
+{
+  if (size == 0)
+    return;
+
+  std::vector<u8> compressed(compressBound(static_cast<uLong>(size)));
+  uLongf compressed_size = static_cast<uLongf>(compressed.size());
+  compress2(compressed.data(), &compressed_size, data, static_cast<uLong>(size),
+            Z_DEFAULT_COMPRESSION);
+
+  packet << static_cast<u8>(SaveChunkType::Literal);
+  packet << static_cast<u32>(size) << static_cast<u32>(compressed_size);
+  packet.append(compressed.data(), compressed_size);
+}
+
+// Passes the save data in packet to write in pieces, and checks it against the hash that the
+// server sent along with it
+bool DecompressPacket(sf::Packet& packet, u64 size, const SaveBlockStore& local_blocks,
+                      const std::function<bool(const u8*, size_t)>& write)
+{
+  const u64 expected_hash = Common::PacketReadU64(packet);
+
+  std::unique_ptr<XXH64_state_t, XXH64StateDeleter> state(XXH64_createState());
+  XXH64_reset(state.get(), 0);
+
+  std::vector<u8> in_buffer;
+  std::vector<u8> out_buffer(SAVE_BLOCK_SIZE * SAVE_BLOCKS_PER_RUN);
+
+  u64 position = 0;
+  while (position < size)
+  {
+    u8 type;
+    packet >> type;
+    if (!packet)
+      break;
+
+    const u8* data;
+    u32 data_size;
+    if (type == static_cast<u8>(SaveChunkType::Reference))
+    {
+      const u64 hash = Common::PacketReadU64(packet);
+      packet >> data_size;
+
+      data = local_blocks.Find(hash, data_size);
+      if (!data)
+      {
+        ERROR_LOG(NETPLAY, "Save data references a block that isn't held locally");
+        break;
+      }
+    }
+    else if (type == static_cast<u8>(SaveChunkType::Literal))
+    {
+      u32 compressed_size;
+      packet >> data_size >> compressed_size;
+      if (data_size > out_buffer.size() || compressed_size > compressBound(data_size))
+        break;
+
+      in_buffer.resize(compressed_size);
+      for (u8& byte : in_buffer)
+        packet >> byte;
+
+      if (!packet)
+        break;
+
+      uLongf out_size = data_size;
+      const int result =
+          uncompress(out_buffer.data(), &out_size, in_buffer.data(), compressed_size);
+      if (result != Z_OK || out_size != data_size)
+      {
+        PanicAlertT("Internal zlib Error - decompression failed");
+        return false;
+      }
+
+      data = out_buffer.data();
+    }
+    else
+    {
+      break;
+    }
+
+    if (!packet || data_size == 0 || data_size > size - position)
+      break;
+
+    XXH64_update(state.get(), data, data_size);
+    if (!write(data, data_size))
+      return false;
+
+    position += data_size;
+  }
+
+  if (position != size || XXH64_digest(state.get()) != expected_hash)
+  {
+    PanicAlertT("Received save data is corrupted.");
+    return false;
+  }
+
+  return true;
+}
+}  // namespace
+
+u64 HashSaveData(const u8* data, size_t size)
+{
+  return XXH64(data, size, 0);
+}
+
+void SaveBlockStore::AddBuffer(std::vector<u8> buffer)
+{
+  if (buffer.empty())
+    return;
+
+  const size_t index = m_buffers.size();
+  for (size_t offset = 0; offset < buffer.size(); offset += SAVE_BLOCK_SIZE)
+  {
+    const size_t size = std::min(SAVE_BLOCK_SIZE, buffer.size() - offset);
+    Add(HashSaveData(buffer.data() + offset, size), index, offset, size);
+  }
+
+  // Identical saves can be sent as a single reference
+  if (buffer.size() > SAVE_BLOCK_SIZE)
+    Add(HashSaveData(buffer.data(), buffer.size()), index, 0, buffer.size());
+
+  m_buffers.push_back(std::move(buffer));
+}
+
+bool SaveBlockStore::AddFile(const std::string& path)
+{
+  std::optional<std::vector<u8>> data = ReadFile(path);
+  if (!data)
+    return false;
+
+  AddBuffer(std::move(*data));
+  return true;
+}
+
+void SaveBlockStore::AddDirectory(const std::string& path)
+{
+  for (const std::string& file : Common::DoFileSearch({path}, {}, true))
+  {
+    if (!File::IsDirectory(file))
+      AddFile(file);
+  }
+}
+
+void SaveBlockStore::Clear()
+{
+  m_buffers.clear();
+  m_locations.clear();
+}
+
+void SaveBlockStore::Add(u64 hash, size_t buffer, size_t offset, size_t size)
+{
+  m_locations.emplace(hash, Location{buffer, offset, size});
+}
+
+SaveBlockHashes SaveBlockStore::GetHashes() const
+{
+  SaveBlockHashes hashes;
+  for (const auto& location : m_locations)
+    hashes.insert(location.first);
+  return hashes;
+}
+
+const u8* SaveBlockStore::Find(u64 hash, size_t size) const
+{
+  const auto it = m_locations.find(hash);
+  if (it == m_locations.end() || it->second.size != size)
+    return nullptr;
+
+  return m_buffers[it->second.buffer].data() + it->second.offset;
+}
+
+void CompressBufferIntoPacket(const std::vector<u8>& data, sf::Packet& packet,
+                              const SaveBlockHashes& client_hashes)
+{
+  const size_t size = data.size();
+  packet << sf::Uint64{size};
+  if (size == 0)
+    return;
+
+  const u64 hash = HashSaveData(data.data(), size);
+  packet << sf::Uint64{hash};
+
+  if (client_hashes.count(hash))
+  {
+    WriteReference(packet, hash, size);
+    return;
+  }
+
+  // Blocks the client doesn't hold are gathered into runs, which compress better than single
+  // blocks and still keep the memory needed for decompressing them small
+  size_t run_start = 0;
+  for (size_t offset = 0; offset < size; offset += SAVE_BLOCK_SIZE)
+  {
+    const size_t block_size = std::min(SAVE_BLOCK_SIZE, size - offset);
+    const u64 block_hash = HashSaveData(data.data() + offset, block_size);
+    if (client_hashes.count(block_hash))
+    {
+      WriteLiteral(packet, data.data() + run_start, offset - run_start);
+      WriteReference(packet, block_hash, block_size);
+      run_start = offset + block_size;
+    }
+    else if (offset + block_size - run_start == SAVE_BLOCK_SIZE * SAVE_BLOCKS_PER_RUN)
+    {
+      WriteLiteral(packet, data.data() + run_start, offset + block_size - run_start);
+      run_start = offset + block_size;
+    }
+  }
+
+  WriteLiteral(packet, data.data() + run_start, size - run_start);
+}
+
+bool DecompressPacketIntoFile(sf::Packet& packet, const std::string& file_path,
+                              const SaveBlockStore& local_blocks)
+{
+  const u64 file_size = Common::PacketReadU64(packet);
+
+  if (file_size == 0)
+    return true;
+
+  File::IOFile file(file_path, "wb");
+  if (!file)
+  {
+    PanicAlertT("Failed to open file \"%s\". Verify your write permissions.", file_path.c_str());
+    return false;
+  }
+
+  return DecompressPacket(packet, file_size, local_blocks, [&](const u8* data, size_t size) {
+    if (file.WriteBytes(data, size))
+      return true;
+
+    PanicAlertT("Error writing file: %s", file_path.c_str());
+    return false;
+  });
+}
+
+std::optional<std::vector<u8>> DecompressPacketIntoBuffer(sf::Packet& packet,
+                                                          const SaveBlockStore& local_blocks)
+{
+  const u64 size = Common::PacketReadU64(packet);
+
+  std::vector<u8> out_buffer;
+  if (size == 0)
+    return out_buffer;
+
+  out_buffer.reserve(size);
+  const bool success =
+      DecompressPacket(packet, size, local_blocks, [&](const u8* data, size_t data_size) {
+        out_buffer.insert(out_buffer.end(), data, data + data_size);
+        return true;
+      });
+
+  if (!success)
+    return std::nullopt;
+
+  return out_buffer;
+}
+
+SaveDataPacket::SaveDataPacket() : m_parts(1)
+{
+}
+
+void SaveDataPacket::AddBuffer(std::vector<u8> data)
+{
+  m_parts.back().data = std::move(data);
+  m_parts.emplace_back();
+}
+
+bool SaveDataPacket::AddFile(const std::string& path)
+{
+  std::optional<std::vector<u8>> data = ReadFile(path);
+  if (!data)
+    return false;
+
+  AddBuffer(std::move(*data));
+  return true;
+}
+
+sf::Packet SaveDataPacket::Encode(const SaveBlockHashes& client_hashes) const
+{
+  sf::Packet packet;
+  for (const Part& part : m_parts)
+  {
+    packet.append(part.header.getData(), part.header.getDataSize());
+    if (part.data)
+      CompressBufferIntoPacket(*part.data, packet, client_hashes);
+  }
+  return packet;
+}
+}  // namespace NetPlay
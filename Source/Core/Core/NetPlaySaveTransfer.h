@@ -0,0 +1,99 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <SFML/Network/Packet.hpp>
+
+#include "Common/CommonTypes.h"
+
+namespace NetPlay
+{
+// Save data is sent in blocks of this size. A block that the client already holds, in any of the
+// saves it has locally, is sent as a reference to its hash instead of its contents.
+constexpr size_t SAVE_BLOCK_SIZE = 0x1000;
+
+// Literal blocks are compressed in runs of up to this many blocks.
+constexpr size_t SAVE_BLOCKS_PER_RUN = 64;
+
+// Hashes of the save data a client holds, which it sends to the server before a save sync
+using SaveBlockHashes = std::unordered_set<u64>;
+
+u64 HashSaveData(const u8* data, size_t size);
+
+// The save data a client holds locally, indexed by the hash of every block and of every whole
+// buffer, so that transferred saves can be rebuilt from it.
+class SaveBlockStore
+{
+public:
+  void AddBuffer(std::vector<u8> buffer);
+  bool AddFile(const std::string& path);
+  // Adds every file in the directory and its subdirectories
+  void AddDirectory(const std::string& path);
+  void Clear();
+
+  SaveBlockHashes GetHashes() const;
+  // Returns nullptr if no data with this hash and size is held
+  const u8* Find(u64 hash, size_t size) const;
+
+private:
+  struct Location
+  {
+    size_t buffer;
+    size_t offset;
+    size_t size;
+  };
+
+  void Add(u64 hash, size_t buffer, size_t offset, size_t size);
+
+  std::vector<std::vector<u8>> m_buffers;
+  std::unordered_map<u64, Location> m_locations;
+};
+
+// Compresses data into packet. Data that the client already holds, according to client_hashes,
+// is only referenced.
+void CompressBufferIntoPacket(const std::vector<u8>& data, sf::Packet& packet,
+                              const SaveBlockHashes& client_hashes = {});
+// Doesn't create the file if the size of the data is 0
+bool DecompressPacketIntoFile(sf::Packet& packet, const std::string& file_path,
+                              const SaveBlockStore& local_blocks);
+std::optional<std::vector<u8>> DecompressPacketIntoBuffer(sf::Packet& packet,
+                                                          const SaveBlockStore& local_blocks);
+
+// A save data message that is encoded separately for every client, so that each client only
+// receives the parts of the saves it doesn't hold already.
+class SaveDataPacket
+{
+public:
+  SaveDataPacket();
+
+  template <typename T>
+  SaveDataPacket& operator<<(const T& value)
+  {
+    m_parts.back().header << value;
+    return *this;
+  }
+
+  void AddBuffer(std::vector<u8> data);
+  bool AddFile(const std::string& path);
+
+  sf::Packet Encode(const SaveBlockHashes& client_hashes) const;
+
+private:
+  struct Part
+  {
+    sf::Packet header;
+    std::optional<std::vector<u8>> data;
+  };
+
+  std::vector<Part> m_parts;
+};
+}  // namespace NetPlay
@@ -19,7 +19,6 @@
 #include <vector>
 
 #include <fmt/format.h>
-#include <lzo/lzo1x.h>
 
 #include "Common/CommonPaths.h"
 #include "Common/ENetUtil.h"
@@ -28,6 +27,7 @@
 #include "Common/HttpRequest.h"
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
+#include "Common/ParallelFor.h"
 #include "Common/SFMLHelper.h"
 #include "Common/StringUtil.h"
 #include "Common/UPnP.h"
@@ -50,6 +50,7 @@
 #include "Core/IOS/FS/FileSystem.h"
 #include "Core/IOS/IOS.h"
 #include "Core/IOS/Uids.h"
+#include "Core/NetPlaySaveTransfer.h"
 #include "Core/NetPlayClient.h"  //for NetPlayUI
 #include "DiscIO/Enums.h"
 #include "InputCommon/ControllerEmu/ControlGroup/Attachments.h"
@@ -653,6 +654,21 @@ void NetPlayServer::SendChunkedToClients(sf::Packet&& packet, const PlayerId ski
   m_chunked_data_event.Set();
 }
 
+void NetPlayServer::SendSaveDataChunked(const SaveDataQueueEntry& entry,
+                                        std::shared_ptr<const SaveDataManifests> client_hashes)
+{
+  {
+    std::lock_guard<std::recursive_mutex> lkq(m_crit.chunked_data_queue_write);
+    m_chunked_data_queue.Push(ChunkedDataQueueEntry{{},
+                                                    1,
+                                                    TargetMode::AllExcept,
+                                                    entry.title,
+                                                    entry.packet,
+                                                    std::move(client_hashes)});
+  }
+  m_chunked_data_event.Set();
+}
+
 // called from ---NETPLAY--- thread
 unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
 {
@@ -687,6 +703,16 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
     packet >> cid;
     u64 progress = Common::PacketReadU64(packet);
 
+    {
+      std::lock_guard<std::mutex> lk(m_chunked_data_progress_lock);
+      const auto it = m_chunked_data_progress_sizes.find(player.pid);
+      if (cid == m_chunked_data_progress_id && it != m_chunked_data_progress_sizes.end() &&
+          it->second != 0)
+      {
+        progress = progress * m_chunked_data_progress_total / it->second;
+      }
+    }
+
     m_dialog->SetChunkedProgress(player.pid, progress);
   }
   break;
@@ -984,6 +1010,84 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
   }
   break;
 
+  case NP_MSG_HASH_TREE_ROOT:
+  {
+    u32 frame;
+    u32 level_count;
+    packet >> frame >> level_count;
+    const u64 root = Common::PacketReadU64(packet);
+
+    if (m_hash_tree_desync_detected)
+      break;
+
+    std::vector<HashTreeRoot>& roots = m_hash_tree_roots_by_frame[frame];
+    roots.push_back({player.pid, level_count, root});
+    if (roots.size() < m_players.size())
+      break;
+
+    const bool same_shape = std::all_of(roots.begin(), roots.end(), [&](const HashTreeRoot& other) {
+      return other.level_count == roots[0].level_count;
+    });
+    const bool same_root = std::all_of(roots.begin(), roots.end(), [&](const HashTreeRoot& other) {
+      return other.root == roots[0].root;
+    });
+
+    if (!same_shape || !same_root)
+    {
+      m_hash_tree_desync_detected = true;
+      m_hash_tree_diagnosis = HashTreeDiagnosis{frame};
+
+      // Trees of different shapes, e.g. because one player emulates a Wii and another one a
+      // GameCube, can't be compared
+      if (!same_shape)
+        FinishHashTreeDiagnosis({});
+      else if (level_count <= 1)
+        FinishHashTreeDiagnosis({0});
+      else
+        RequestHashTreeNodes(level_count - 1, {0});
+
+      m_hash_tree_roots_by_frame.clear();
+      break;
+    }
+
+    m_hash_tree_roots_by_frame.erase(frame);
+  }
+  break;
+
+  case NP_MSG_HASH_TREE_NODES:
+  {
+    u32 frame;
+    u32 level;
+    bool available;
+    packet >> frame >> level >> available;
+
+    if (!m_hash_tree_diagnosis || m_hash_tree_diagnosis->frame != frame ||
+        m_hash_tree_diagnosis->level != level)
+    {
+      break;
+    }
+
+    std::optional<std::vector<std::vector<u64>>> children;
+    if (available)
+    {
+      children.emplace();
+      for (size_t i = 0; i < m_hash_tree_diagnosis->nodes.size(); ++i)
+      {
+        u32 count;
+        packet >> count;
+
+        std::vector<u64>& hashes = children->emplace_back();
+        for (u32 j = 0; j < count && j < HASH_TREE_FANOUT; ++j)
+          hashes.push_back(Common::PacketReadU64(packet));
+      }
+    }
+
+    m_hash_tree_diagnosis->children[player.pid] = std::move(children);
+    if (m_hash_tree_diagnosis->children.size() >= m_players.size())
+      CompareHashTreeNodes();
+  }
+  break;
+
   case NP_MSG_MD5_PROGRESS:
   {
     int progress;
@@ -1033,6 +1137,33 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
 
     switch (sub_id)
     {
+    case SYNC_SAVE_DATA_MANIFEST:
+    {
+      u32 hash_count;
+      packet >> hash_count;
+
+      SaveBlockHashes hashes;
+      for (u32 i = 0; i < hash_count && packet; i++)
+        hashes.insert(Common::PacketReadU64(packet));
+
+      std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
+      if (m_start_pending)
+      {
+        // Every save is sent to all clients in one transfer, so wait for all manifests. The
+        // encoding happens on the chunked data thread.
+        m_save_data_manifests[player.pid] = std::move(hashes);
+        if (m_save_data_manifests.size() >= m_players.size() - 1)
+        {
+          const auto client_hashes =
+              std::make_shared<const SaveDataManifests>(std::move(m_save_data_manifests));
+          m_save_data_manifests.clear();
+          for (const SaveDataQueueEntry& entry : m_save_data_packets)
+            SendSaveDataChunked(entry, client_hashes);
+        }
+      }
+    }
+    break;
+
     case SYNC_SAVE_DATA_SUCCESS:
     {
       if (m_start_pending)
@@ -1041,6 +1172,11 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
         if (m_save_data_synced_players >= m_players.size() - 1)
         {
           m_dialog->AppendChat(Common::GetStringT("All players' saves synchronized."));
+          {
+            std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
+            m_save_data_packets.clear();
+            m_save_data_manifests.clear();
+          }
 
           // Saves are synced, check if codes are as well and attempt to start the game
           m_saves_synced = true;
@@ -1057,6 +1193,10 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
       m_dialog->OnGameStartAborted();
       ChunkedDataAbort();
       m_start_pending = false;
+
+      std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
+      m_save_data_packets.clear();
+      m_save_data_manifests.clear();
     }
     break;
 
@@ -1244,6 +1384,9 @@ bool NetPlayServer::StartGame()
 {
   m_timebase_by_frame.clear();
   m_desync_detected = false;
+  m_hash_tree_roots_by_frame.clear();
+  m_hash_tree_diagnosis.reset();
+  m_hash_tree_desync_detected = false;
   std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
   m_current_game = Common::Timer::GetTimeMs();
 
@@ -1336,6 +1479,7 @@ bool NetPlayServer::StartGame()
   spac << m_settings.m_EFBAccessTileSize;
   spac << m_settings.m_EFBAccessDeferInvalidation;
   spac << m_settings.m_StrictSettingsSync;
+  spac << m_settings.m_DiagnoseDesyncs;
   spac << initial_rtc;
   spac << m_settings.m_SyncSaveData;
   spac << region;
@@ -1353,6 +1497,7 @@ bool NetPlayServer::StartGame()
   }
 
   spac << m_settings.m_GolfMode;
+  spac << m_settings.m_Rollback;
 
   SendAsyncToClients(std::move(spac));
 
@@ -1408,18 +1553,9 @@ bool NetPlayServer::SyncSaveData()
     save_count++;
   }
 
-  {
-    sf::Packet pac;
-    pac << static_cast<MessageId>(NP_MSG_SYNC_SAVE_DATA);
-    pac << static_cast<MessageId>(SYNC_SAVE_DATA_NOTIFY);
-    pac << save_count;
-
-    // send this on the chunked data channel to ensure it's sequenced properly
-    SendAsyncToClients(std::move(pac), 0, CHUNKED_DATA_CHANNEL);
-  }
-
-  if (save_count == 0)
-    return true;
+  // The saves are only sent once a client has replied to the notification with the hashes of the
+  // save data it already holds, as every client gets its own delta
+  std::vector<SaveDataQueueEntry> save_data_packets;
 
   const std::string region =
       SConfig::GetDirectoryForRegion(SConfig::ToGameCubeRegion(game->GetRegion()));
@@ -1442,24 +1578,25 @@ bool NetPlayServer::SyncSaveData()
       if (mc251)
         path.insert(path.find_last_of('.'), ".251");
 
-      sf::Packet pac;
+      SaveDataPacket pac;
       pac << static_cast<MessageId>(NP_MSG_SYNC_SAVE_DATA);
       pac << static_cast<MessageId>(SYNC_SAVE_DATA_RAW);
       pac << is_slot_a << region << mc251;
 
       if (File::Exists(path))
       {
-        if (!CompressFileIntoPacket(path, pac))
+        if (!pac.AddFile(path))
           return false;
       }
       else
       {
         // No file, so we'll say the size is 0
-        pac << sf::Uint64{0};
+        pac.AddBuffer({});
       }
 
-      SendChunkedToClients(std::move(pac), 1,
-                           fmt::format("Memory Card {} Synchronization", is_slot_a ? 'A' : 'B'));
+      save_data_packets.push_back(
+          {std::make_shared<SaveDataPacket>(std::move(pac)),
+           fmt::format("Memory Card {} Synchronization", is_slot_a ? 'A' : 'B')});
     }
     else if (SConfig::GetInstance().m_EXIDevice[i] ==
              ExpansionInterface::EXIDEVICE_MEMORYCARDFOLDER)
@@ -1467,7 +1604,7 @@ bool NetPlayServer::SyncSaveData()
       const std::string path = File::GetUserPath(D_GCUSER_IDX) + region + DIR_SEP +
                                fmt::format("Card {}", is_slot_a ? 'A' : 'B');
 
-      sf::Packet pac;
+      SaveDataPacket pac;
       pac << static_cast<MessageId>(NP_MSG_SYNC_SAVE_DATA);
       pac << static_cast<MessageId>(SYNC_SAVE_DATA_GCI);
       pac << is_slot_a;
@@ -1482,7 +1619,7 @@ bool NetPlayServer::SyncSaveData()
         for (const std::string& file : files)
         {
           pac << file.substr(file.find_last_of('/') + 1);
-          if (!CompressFileIntoPacket(file, pac))
+          if (!pac.AddFile(file))
             return false;
         }
       }
@@ -1491,8 +1628,9 @@ bool NetPlayServer::SyncSaveData()
         pac << static_cast<u8>(0);
       }
 
-      SendChunkedToClients(std::move(pac), 1,
-                           fmt::format("GCI Folder {} Synchronization", is_slot_a ? 'A' : 'B'));
+      save_data_packets.push_back(
+          {std::make_shared<SaveDataPacket>(std::move(pac)),
+           fmt::format("GCI Folder {} Synchronization", is_slot_a ? 'A' : 'B')});
     }
   }
 
@@ -1519,7 +1657,7 @@ bool NetPlayServer::SyncSaveData()
 
     std::vector<u64> titles;
 
-    sf::Packet pac;
+    SaveDataPacket pac;
     pac << static_cast<MessageId>(NP_MSG_SYNC_SAVE_DATA);
     pac << static_cast<MessageId>(SYNC_SAVE_DATA_WII);
 
@@ -1534,8 +1672,7 @@ bool NetPlayServer::SyncSaveData()
         std::vector<u8> file_data(file->GetStatus()->size);
         if (!file->Read(file_data.data(), file_data.size()))
           return false;
-        if (!CompressBufferIntoPacket(file_data, pac))
-          return false;
+        pac.AddBuffer(std::move(file_data));
       }
       else
       {
@@ -1589,8 +1726,9 @@ bool NetPlayServer::SyncSaveData()
           if (file.type == WiiSave::Storage::SaveFile::Type::File)
           {
             const std::optional<std::vector<u8>>& data = *file.data;
-            if (!data || !CompressBufferIntoPacket(*data, pac))
+            if (!data)
               return false;
+            pac.AddBuffer(*data);
           }
         }
       }
@@ -1603,9 +1741,24 @@ bool NetPlayServer::SyncSaveData()
     // Set titles for host-side loading in WiiRoot
     SetWiiSyncData(nullptr, titles);
 
-    SendChunkedToClients(std::move(pac), 1, "Wii Save Synchronization");
+    save_data_packets.push_back(
+        {std::make_shared<SaveDataPacket>(std::move(pac)), "Wii Save Synchronization"});
   }
 
+  {
+    std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
+    m_save_data_packets = std::move(save_data_packets);
+    m_save_data_manifests.clear();
+  }
+
+  sf::Packet pac;
+  pac << static_cast<MessageId>(NP_MSG_SYNC_SAVE_DATA);
+  pac << static_cast<MessageId>(SYNC_SAVE_DATA_NOTIFY);
+  pac << save_count;
+
+  // send this on the chunked data channel to ensure it's sequenced properly
+  SendAsyncToClients(std::move(pac), 0, CHUNKED_DATA_CHANNEL);
+
   return true;
 }
 
@@ -1753,128 +1906,74 @@ void NetPlayServer::CheckSyncAndStartGame()
   }
 }
 
-bool NetPlayServer::CompressFileIntoPacket(const std::string& file_path, sf::Packet& packet)
+// called from ---NETPLAY--- thread
+void NetPlayServer::RequestHashTreeNodes(u32 level, std::vector<u32> nodes)
 {
-  File::IOFile file(file_path, "rb");
-  if (!file)
+  if (nodes.empty())
   {
-    PanicAlertT("Failed to open file \"%s\".", file_path.c_str());
-    return false;
+    FinishHashTreeDiagnosis({});
+    return;
   }
 
-  const sf::Uint64 size = file.GetSize();
-  packet << size;
+  sf::Packet spac;
+  spac << static_cast<MessageId>(NP_MSG_HASH_TREE_REQUEST);
+  spac << m_hash_tree_diagnosis->frame << level << static_cast<u32>(nodes.size());
+  for (const u32 node : nodes)
+    spac << node;
 
-  if (size == 0)
-    return true;
+  m_hash_tree_diagnosis->level = level;
+  m_hash_tree_diagnosis->nodes = std::move(nodes);
+  m_hash_tree_diagnosis->children.clear();
 
-  std::vector<u8> in_buffer(NETPLAY_LZO_IN_LEN);
-  std::vector<u8> out_buffer(NETPLAY_LZO_OUT_LEN);
-  std::vector<u8> wrkmem(LZO1X_1_MEM_COMPRESS);
+  SendToClients(spac);
+}
 
-  lzo_uint i = 0;
-  while (true)
+// called from ---NETPLAY--- thread
+void NetPlayServer::CompareHashTreeNodes()
+{
+  const HashTreeDiagnosis& diagnosis = *m_hash_tree_diagnosis;
+  if (std::any_of(diagnosis.children.begin(), diagnosis.children.end(),
+                  [](const auto& entry) { return !entry.second; }))
   {
-    lzo_uint32 cur_len = 0;  // number of bytes to read
-    lzo_uint out_len = 0;    // number of bytes to write
-
-    if ((i + NETPLAY_LZO_IN_LEN) >= size)
-    {
-      cur_len = static_cast<lzo_uint32>(size - i);
-    }
-    else
-    {
-      cur_len = NETPLAY_LZO_IN_LEN;
-    }
-
-    if (cur_len <= 0)
-      break;  // EOF
-
-    if (!file.ReadBytes(in_buffer.data(), cur_len))
-    {
-      PanicAlertT("Error reading file: %s", file_path.c_str());
-      return false;
-    }
+    FinishHashTreeDiagnosis({});
+    return;
+  }
 
-    if (lzo1x_1_compress(in_buffer.data(), cur_len, out_buffer.data(), &out_len, wrkmem.data()) !=
-        LZO_E_OK)
-    {
-      PanicAlertT("Internal LZO Error - compression failed");
-      return false;
-    }
+  const std::vector<std::vector<u64>>& reference = *diagnosis.children.begin()->second;
 
-    // The size of the data to write is 'out_len'
-    packet << static_cast<u32>(out_len);
-    for (size_t j = 0; j < out_len; j++)
+  std::vector<u32> differing;
+  for (size_t i = 0; i < diagnosis.nodes.size(); ++i)
+  {
+    for (size_t j = 0; j < reference[i].size(); ++j)
     {
-      packet << out_buffer[j];
+      const bool same = std::all_of(
+          diagnosis.children.begin(), diagnosis.children.end(), [&](const auto& entry) {
+            const std::vector<u64>& hashes = (*entry.second)[i];
+            return j < hashes.size() && hashes[j] == reference[i][j];
+          });
+
+      if (!same && differing.size() < HASH_TREE_MAX_DIFFERING_NODES)
+        differing.push_back(static_cast<u32>(diagnosis.nodes[i] * HASH_TREE_FANOUT + j));
     }
-
-    if (cur_len != NETPLAY_LZO_IN_LEN)
-      break;
-
-    i += cur_len;
   }
 
-  // Mark end of data
-  packet << static_cast<u32>(0);
-
-  return true;
+  if (diagnosis.level == 1)
+    FinishHashTreeDiagnosis(differing);
+  else
+    RequestHashTreeNodes(diagnosis.level - 1, std::move(differing));
 }
 
-bool NetPlayServer::CompressBufferIntoPacket(const std::vector<u8>& in_buffer, sf::Packet& packet)
+// called from ---NETPLAY--- thread
+void NetPlayServer::FinishHashTreeDiagnosis(const std::vector<u32>& leaves)
 {
-  const sf::Uint64 size = in_buffer.size();
-  packet << size;
-
-  if (size == 0)
-    return true;
-
-  std::vector<u8> out_buffer(NETPLAY_LZO_OUT_LEN);
-  std::vector<u8> wrkmem(LZO1X_1_MEM_COMPRESS);
-
-  lzo_uint i = 0;
-  while (true)
-  {
-    lzo_uint32 cur_len = 0;  // number of bytes to read
-    lzo_uint out_len = 0;    // number of bytes to write
-
-    if ((i + NETPLAY_LZO_IN_LEN) >= size)
-    {
-      cur_len = static_cast<lzo_uint32>(size - i);
-    }
-    else
-    {
-      cur_len = NETPLAY_LZO_IN_LEN;
-    }
-
-    if (cur_len <= 0)
-      break;  // end of buffer
-
-    if (lzo1x_1_compress(&in_buffer[i], cur_len, out_buffer.data(), &out_len, wrkmem.data()) !=
-        LZO_E_OK)
-    {
-      PanicAlertT("Internal LZO Error - compression failed");
-      return false;
-    }
-
-    // The size of the data to write is 'out_len'
-    packet << static_cast<u32>(out_len);
-    for (size_t j = 0; j < out_len; j++)
-    {
-      packet << out_buffer[j];
-    }
-
-    if (cur_len != NETPLAY_LZO_IN_LEN)
-      break;
-
-    i += cur_len;
-  }
-
-  // Mark end of data
-  packet << static_cast<u32>(0);
+  sf::Packet spac;
+  spac << static_cast<MessageId>(NP_MSG_HASH_TREE_RESULT);
+  spac << m_hash_tree_diagnosis->frame << static_cast<u32>(leaves.size());
+  for (const u32 leaf : leaves)
+    spac << leaf;
 
-  return true;
+  SendToClients(spac);
+  m_hash_tree_diagnosis.reset();
 }
 
 u64 NetPlayServer::GetInitialNetPlayRTC() const
@@ -2022,9 +2121,23 @@ void NetPlayServer::ChunkedDataThreadFunc()
       const u32 id = m_next_chunked_data_id++;
 
       m_chunked_data_complete_count[id] = 0;
-      size_t player_count;
+      std::vector<ChunkedDataTarget> targets;
+      std::vector<int> players;
+      if (e.save_data)
+      {
+        for (const auto& manifest : *e.client_hashes)
+        {
+          targets.push_back(ChunkedDataTarget{manifest.first, TargetMode::Only, {}});
+          players.push_back(manifest.first);
+        }
+
+        // Every client gets the saves compressed against the blocks it already holds
+        Common::ParallelFor(targets.size(), [&e, &targets](size_t i) {
+          targets[i].packet = e.save_data->Encode(e.client_hashes->at(targets[i].pid));
+        });
+      }
+      else
       {
-        std::vector<int> players;
         if (e.target_mode == TargetMode::Only)
         {
           players.push_back(e.target_pid);
@@ -2037,23 +2150,40 @@ void NetPlayServer::ChunkedDataThreadFunc()
               players.push_back(pl.second.pid);
           }
         }
-        player_count = players.size();
+        targets.push_back(ChunkedDataTarget{e.target_pid, e.target_mode, std::move(e.packet)});
+      }
+      size_t player_count = players.size();
 
+      size_t data_size = 0;
+      for (const ChunkedDataTarget& target : targets)
+        data_size = std::max(data_size, target.packet.getDataSize());
+
+      if (e.save_data)
+      {
+        std::lock_guard<std::mutex> lk(m_chunked_data_progress_lock);
+        m_chunked_data_progress_id = id;
+        m_chunked_data_progress_total = data_size;
+        for (const ChunkedDataTarget& target : targets)
+          m_chunked_data_progress_sizes[target.pid] = target.packet.getDataSize();
+      }
+
+      for (const ChunkedDataTarget& target : targets)
+      {
         sf::Packet pac;
         pac << static_cast<MessageId>(NP_MSG_CHUNKED_DATA_START);
-        pac << id << e.title << sf::Uint64{e.packet.getDataSize()};
-
-        ChunkedDataSend(std::move(pac), e.target_pid, e.target_mode);
+        pac << id << e.title << sf::Uint64{target.packet.getDataSize()};
 
-        if (e.target_mode == TargetMode::AllExcept && e.target_pid == 1)
-          m_dialog->ShowChunkedProgressDialog(e.title, e.packet.getDataSize(), players);
+        ChunkedDataSend(std::move(pac), target.pid, target.mode);
       }
 
+      // Shown once for the whole transfer, even when every client gets different data
+      if (e.target_mode == TargetMode::AllExcept && e.target_pid == 1)
+        m_dialog->ShowChunkedProgressDialog(e.title, data_size, players);
+
       const bool enable_limit = Config::Get(Config::NETPLAY_ENABLE_CHUNKED_UPLOAD_LIMIT);
       const float bytes_per_second =
           (std::max(Config::Get(Config::NETPLAY_CHUNKED_UPLOAD_LIMIT), 1u) / 8.0f) * 1024.0f;
       const std::chrono::duration<double> send_interval(CHUNKED_DATA_UNIT_SIZE / bytes_per_second);
-      bool skip_wait = false;
       size_t index = 0;
       do
       {
@@ -2061,30 +2191,43 @@ void NetPlayServer::ChunkedDataThreadFunc()
           return;
         if (m_abort_chunked_data)
         {
-          sf::Packet pac;
-          pac << static_cast<MessageId>(NP_MSG_CHUNKED_DATA_ABORT);
-          pac << id;
-          ChunkedDataSend(std::move(pac), e.target_pid, e.target_mode);
-          break;
-        }
-        if (e.target_mode == TargetMode::Only)
-        {
-          if (m_players.find(e.target_pid) == m_players.end())
+          for (const ChunkedDataTarget& target : targets)
           {
-            skip_wait = true;
-            break;
+            sf::Packet pac;
+            pac << static_cast<MessageId>(NP_MSG_CHUNKED_DATA_ABORT);
+            pac << id;
+            ChunkedDataSend(std::move(pac), target.pid, target.mode);
           }
+          break;
         }
 
         auto start = std::chrono::steady_clock::now();
 
-        sf::Packet pac;
-        pac << static_cast<MessageId>(NP_MSG_CHUNKED_DATA_PAYLOAD);
-        pac << id;
-        size_t len = std::min(CHUNKED_DATA_UNIT_SIZE, e.packet.getDataSize() - index);
-        pac.append(static_cast<const u8*>(e.packet.getData()) + index, len);
+        for (auto it = targets.begin(); it != targets.end();)
+        {
+          // Don't wait for a player that has left
+          if (it->mode == TargetMode::Only && m_players.find(it->pid) == m_players.end())
+          {
+            it = targets.erase(it);
+            --player_count;
+            continue;
+          }
 
-        ChunkedDataSend(std::move(pac), e.target_pid, e.target_mode);
+          const size_t size = it->packet.getDataSize();
+          if (index < size || index == 0)
+          {
+            sf::Packet pac;
+            pac << static_cast<MessageId>(NP_MSG_CHUNKED_DATA_PAYLOAD);
+            pac << id;
+            size_t len = std::min(CHUNKED_DATA_UNIT_SIZE, size - index);
+            pac.append(static_cast<const u8*>(it->packet.getData()) + index, len);
+
+            ChunkedDataSend(std::move(pac), it->pid, it->mode);
+          }
+          ++it;
+        }
+        if (targets.empty())
+          break;
         index += CHUNKED_DATA_UNIT_SIZE;
 
         if (enable_limit)
@@ -2092,22 +2235,30 @@ void NetPlayServer::ChunkedDataThreadFunc()
           std::chrono::duration<double> delta = std::chrono::steady_clock::now() - start;
           std::this_thread::sleep_for(send_interval - delta);
         }
-      } while (index < e.packet.getDataSize());
+      } while (index < data_size);
 
       if (!m_abort_chunked_data)
       {
-        sf::Packet pac;
-        pac << static_cast<MessageId>(NP_MSG_CHUNKED_DATA_END);
-        pac << id;
-        ChunkedDataSend(std::move(pac), e.target_pid, e.target_mode);
+        for (const ChunkedDataTarget& target : targets)
+        {
+          sf::Packet pac;
+          pac << static_cast<MessageId>(NP_MSG_CHUNKED_DATA_END);
+          pac << id;
+          ChunkedDataSend(std::move(pac), target.pid, target.mode);
+        }
       }
 
       while (m_chunked_data_complete_count[id] < player_count && m_do_loop &&
-             !m_abort_chunked_data && !skip_wait)
+             !m_abort_chunked_data)
         m_chunked_data_complete_event.Wait();
       m_chunked_data_complete_count.erase(id);
       m_dialog->HideChunkedProgressDialog();
 
+      {
+        std::lock_guard<std::mutex> lk(m_chunked_data_progress_lock);
+        m_chunked_data_progress_sizes.clear();
+      }
+
       m_chunked_data_queue.Pop();
     }
   }
@@ -8,18 +8,22 @@
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <queue>
 #include <sstream>
 #include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 #include "Common/Event.h"
 #include "Common/QoSSession.h"
 #include "Common/SPSCQueue.h"
 #include "Common/Timer.h"
 #include "Common/TraversalClient.h"
+#include "Core/NetPlayHashTree.h"
 #include "Core/NetPlayProto.h"
+#include "Core/NetPlaySaveTransfer.h"
 #include "InputCommon/GCPadStatus.h"
 #include "UICommon/NetPlayIndex.h"
 
@@ -107,19 +111,62 @@ private:
     u8 channel_id;
   };
 
+  // Hashes of the save data held by every client that has sent its manifest
+  using SaveDataManifests = std::map<PlayerId, SaveBlockHashes>;
+
   struct ChunkedDataQueueEntry
   {
     sf::Packet packet;
     PlayerId target_pid;
     TargetMode target_mode;
     std::string title;
+    // If set, the data is encoded for every client in client_hashes on the chunked data thread,
+    // and packet is unused
+    std::shared_ptr<const SaveDataPacket> save_data;
+    std::shared_ptr<const SaveDataManifests> client_hashes;
+  };
+
+  struct SaveDataQueueEntry
+  {
+    std::shared_ptr<const SaveDataPacket> packet;
+    std::string title;
+  };
+
+  // The data one chunked data transfer sends to one target
+  struct ChunkedDataTarget
+  {
+    PlayerId pid;
+    TargetMode mode;
+    sf::Packet packet;
+  };
+
+  struct HashTreeRoot
+  {
+    PlayerId pid;
+    u32 level_count;
+    u64 root;
+  };
+
+  // A desync that is being narrowed down by walking down the hash trees of all players, starting
+  // at their roots
+  struct HashTreeDiagnosis
+  {
+    u32 frame;
+    u32 level;
+    // The nodes of this level whose children were requested
+    std::vector<u32> nodes;
+    // The children of those nodes for every player that has replied, or nothing if the player
+    // didn't have the tree anymore
+    std::map<PlayerId, std::optional<std::vector<std::vector<u64>>>> children;
   };
 
   bool SyncSaveData();
   bool SyncCodes();
   void CheckSyncAndStartGame();
-  bool CompressFileIntoPacket(const std::string& file_path, sf::Packet& packet);
-  bool CompressBufferIntoPacket(const std::vector<u8>& in_buffer, sf::Packet& packet);
+
+  void RequestHashTreeNodes(u32 level, std::vector<u32> nodes);
+  void CompareHashTreeNodes();
+  void FinishHashTreeDiagnosis(const std::vector<u32>& leaves);
 
   u64 GetInitialNetPlayRTC() const;
 
@@ -136,6 +183,8 @@ private:
   void UpdatePadMapping();
   void UpdateWiimoteMapping();
   std::vector<std::pair<std::string, std::string>> GetInterfaceListInternal() const;
+  void SendSaveDataChunked(const SaveDataQueueEntry& entry,
+                           std::shared_ptr<const SaveDataManifests> client_hashes);
   void ChunkedDataThreadFunc();
   void ChunkedDataSend(sf::Packet&& packet, PlayerId pid, const TargetMode target_mode);
   void ChunkedDataAbort();
@@ -155,6 +204,8 @@ private:
   PadMappingArray m_pad_map;
   PadMappingArray m_wiimote_map;
   unsigned int m_save_data_synced_players = 0;
+  std::vector<SaveDataQueueEntry> m_save_data_packets;
+  SaveDataManifests m_save_data_manifests;
   unsigned int m_codes_synced_players = 0;
   bool m_saves_synced = true;
   bool m_codes_synced = true;
@@ -167,6 +218,9 @@ private:
 
   std::unordered_map<u32, std::vector<std::pair<PlayerId, u64>>> m_timebase_by_frame;
   bool m_desync_detected;
+  std::unordered_map<u32, std::vector<HashTreeRoot>> m_hash_tree_roots_by_frame;
+  std::optional<HashTreeDiagnosis> m_hash_tree_diagnosis;
+  bool m_hash_tree_desync_detected = false;
 
   struct
   {
@@ -188,6 +242,12 @@ private:
   u32 m_next_chunked_data_id;
   std::unordered_map<u32, unsigned int> m_chunked_data_complete_count;
   bool m_abort_chunked_data = false;
+  // When a transfer sends data of a different size to every player, the progress dialog shows
+  // the largest size, and the progress of every player is scaled to it
+  std::mutex m_chunked_data_progress_lock;
+  u32 m_chunked_data_progress_id = 0;
+  u64 m_chunked_data_progress_total = 0;
+  std::map<PlayerId, u64> m_chunked_data_progress_sizes;
 
   ENetHost* m_server = nullptr;
   TraversalClient* m_traversal_client = nullptr;
@@ -751,6 +751,8 @@ void Jit64::Jit(u32 em_address)
     // We can link blocks as long as we are not single stepping and there are no breakpoints here
     EnableBlockLink();
     EnableOptimization();
+    // Breakpoints have to be able to stop on every instruction.
+    analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_DEAD_CODE_ELIMINATION);
 
     // Comment out the following to disable breakpoints (speed-up)
     if (!jo.profile_blocks)
@@ -1073,6 +1075,10 @@ u8* Jit64::DoJit(u32 em_address, JitBlock* b, u32 nextPC)
       if (opinfo->flags & FL_USE_FPU)
         ++js.numFloatingPointInst;
     }
+    else if (op.isDead)
+    {
+      ++m_dead_code_stats.instructions;
+    }
 
 #if defined(_DEBUG) || defined(DEBUGFAST)
     if (!gpr.SanityCheck() || !fpr.SanityCheck())
@@ -1127,6 +1133,7 @@ void Jit64::EnableOptimization()
   analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CROR_MERGE);
   analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CARRY_MERGE);
   analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_FOLLOW);
+  analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_DEAD_CODE_ELIMINATION);
 }
 
 void Jit64::IntializeSpeculativeConstants()
@@ -34,8 +34,13 @@ void Jit64::SetFPRFIfNeeded(X64Reg xmm)
   // As far as we know, the games that use this flag only need FPRF for fmul and fmadd, but
   // FPRF is fast enough in JIT that we might as well just enable it for every float instruction
   // if the FPRF flag is set.
-  if (SConfig::GetInstance().bFPRF && js.op->wantsFPRF)
+  if (!SConfig::GetInstance().bFPRF)
+    return;
+
+  if (js.op->wantsFPRF)
     SetFPRF(xmm);
+  else
+    ++m_dead_code_stats.fprf_updates;
 }
 
 void Jit64::HandleNaNs(UGeckoInstruction inst, X64Reg xmm_out, X64Reg xmm, X64Reg clobber)
@@ -65,7 +65,11 @@ void Jit64::FinalizeCarry(CCFlags cond)
 {
   js.carryFlagSet = false;
   js.carryFlagInverted = false;
-  if (js.op->wantsCA)
+  if (!js.op->wantsCA)
+  {
+    ++m_dead_code_stats.ca_updates;
+  }
+  else
   {
     // Not actually merging instructions, but the effect is equivalent (we can't have
     // breakpoints/etc in between).
@@ -96,7 +100,11 @@ void Jit64::FinalizeCarry(bool ca)
 {
   js.carryFlagSet = false;
   js.carryFlagInverted = false;
-  if (js.op->wantsCA)
+  if (!js.op->wantsCA)
+  {
+    ++m_dead_code_stats.ca_updates;
+  }
+  else
   {
     if (CanMergeNextInstructions(1) && js.op[1].wantsCAInFlags)
     {
@@ -144,6 +152,12 @@ void Jit64::FinalizeCarryOverflow(bool oe, bool inv)
 // LT/GT either.
 void Jit64::ComputeRC(preg_t preg, bool needs_test, bool needs_sext)
 {
+  if (!js.op->wantsCR[0])
+  {
+    ++m_dead_code_stats.cr_updates;
+    return;
+  }
+
   RCOpArg arg = gpr.Use(preg, RCMode::Read);
   RegCache::Realize(arg);
 
@@ -230,7 +244,11 @@ void Jit64::regimmop(int d, int a, bool binary, u32 value, Operation doop,
   // Be careful; addic treats r0 as r0, but addi treats r0 as zero.
   if (a || binary || carry)
   {
-    carry &= js.op->wantsCA;
+    if (carry && !js.op->wantsCA)
+    {
+      ++m_dead_code_stats.ca_updates;
+      carry = false;
+    }
     if (gpr.IsImm(a) && !carry)
     {
       gpr.SetImmediate32(d, doop(gpr.Imm32(a), value));
@@ -489,6 +507,13 @@ void Jit64::cmpXX(UGeckoInstruction inst)
   int a = inst.RA;
   int b = inst.RB;
   u32 crf = inst.CRFD;
+
+  if (!js.op->wantsCR[crf])
+  {
+    ++m_dead_code_stats.cr_updates;
+    return;
+  }
+
   bool merge_branch = CheckMergedBranch(crf);
 
   bool signedCompare;
@@ -228,6 +228,10 @@ public:
   {
     CallLambda(8 * sizeof(T), lambda);
   }
+  void VisitComplexFunction(MMIO::ReadFunction<T> function, void* context) override
+  {
+    CallFunction(8 * sizeof(T), function, context);
+  }
 
 private:
   // Generates code to load a constant to the destination register. In
@@ -281,6 +285,14 @@ private:
     MoveOpArgToReg(sbits, R(ABI_RETURN));
   }
 
+  void CallFunction(int sbits, MMIO::ReadFunction<T> function, void* context)
+  {
+    m_code->ABI_PushRegistersAndAdjustStack(m_registers_in_use, 0);
+    m_code->ABI_CallFunctionPC(function, context, m_address);
+    m_code->ABI_PopRegistersAndAdjustStack(m_registers_in_use, 0);
+    MoveOpArgToReg(sbits, R(ABI_RETURN));
+  }
+
   Gen::X64CodeBlock* m_code;
   BitSet32 m_registers_in_use;
   Gen::X64Reg m_dst_reg;
@@ -315,6 +327,96 @@ void EmuCodeBlock::MMIOLoadToReg(MMIO::Mapping* mmio, Gen::X64Reg reg_value,
   }
 }
 
+// Visitor that generates code to write a MMIO value.
+template <typename T>
+class MMIOWriteCodeGenerator : public MMIO::WriteHandlingMethodVisitor<T>
+{
+public:
+  MMIOWriteCodeGenerator(Gen::X64CodeBlock* code, BitSet32 registers_in_use,
+                         const Gen::OpArg& value, u32 address)
+      : m_code(code), m_registers_in_use(registers_in_use), m_value(value), m_address(address)
+  {
+  }
+
+  void VisitNop() override
+  {
+    // Do nothing
+  }
+  void VisitDirect(T* addr, u32 mask) override { WriteRegToAddr(8 * sizeof(T), addr, mask); }
+  void VisitComplex(const std::function<void(u32, T)>* lambda) override
+  {
+    auto trampoline = &XEmitter::CallLambdaTrampoline<void, u32, T>;
+    CallFunction(8 * sizeof(T), trampoline, lambda);
+  }
+  void VisitComplexFunction(MMIO::WriteFunction<T> function, void* context) override
+  {
+    CallFunction(8 * sizeof(T), function, context);
+  }
+
+private:
+  void WriteRegToAddr(int sbits, const void* ptr, u32 mask)
+  {
+    if (!m_value.IsSimpleReg(RSCRATCH))
+      m_code->MOV(sbits, R(RSCRATCH), m_value);
+
+    u32 all_ones = (1ULL << sbits) - 1;
+    if ((all_ones & mask) != all_ones)
+      m_code->AND(32, R(RSCRATCH), Imm32(mask));
+
+    m_code->MOV(64, R(RSCRATCH2), ImmPtr(ptr));
+    m_code->MOV(sbits, MatR(RSCRATCH2), R(RSCRATCH));
+  }
+
+  template <typename FunctionPointer>
+  void CallFunction(int sbits, FunctionPointer function, const void* context)
+  {
+    m_code->ABI_PushRegistersAndAdjustStack(m_registers_in_use, 0);
+    // The value has to be moved first since it might live in one of the
+    // other parameter registers.
+    if (m_value.IsImm())
+      m_code->MOV(32, R(ABI_PARAM3), Imm32(static_cast<T>(m_value.AsImm32().Imm32())));
+    else if (sbits == 32)
+      m_code->MOV(32, R(ABI_PARAM3), m_value);
+    else
+      m_code->MOVZX(32, sbits, ABI_PARAM3, m_value);
+    m_code->MOV(64, R(ABI_PARAM1), Imm64(reinterpret_cast<u64>(context)));
+    m_code->MOV(32, R(ABI_PARAM2), Imm32(m_address));
+    m_code->ABI_CallFunction(function);
+    m_code->ABI_PopRegistersAndAdjustStack(m_registers_in_use, 0);
+  }
+
+  Gen::X64CodeBlock* m_code;
+  BitSet32 m_registers_in_use;
+  Gen::OpArg m_value;
+  u32 m_address;
+};
+
+void EmuCodeBlock::MMIOWriteRegToAddr(MMIO::Mapping* mmio, const Gen::OpArg& value,
+                                      BitSet32 registers_in_use, u32 address, int access_size)
+{
+  switch (access_size)
+  {
+  case 8:
+  {
+    MMIOWriteCodeGenerator<u8> gen(this, registers_in_use, value, address);
+    mmio->GetHandlerForWrite<u8>(address).Visit(gen);
+    break;
+  }
+  case 16:
+  {
+    MMIOWriteCodeGenerator<u16> gen(this, registers_in_use, value, address);
+    mmio->GetHandlerForWrite<u16>(address).Visit(gen);
+    break;
+  }
+  case 32:
+  {
+    MMIOWriteCodeGenerator<u32> gen(this, registers_in_use, value, address);
+    mmio->GetHandlerForWrite<u32>(address).Visit(gen);
+    break;
+  }
+  }
+}
+
 void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg& opAddress, int accessSize,
                                  s32 offset, BitSet32 registersInUse, bool signExtend, int flags)
 {
@@ -619,6 +721,13 @@ bool EmuCodeBlock::WriteToConstAddress(int accessSize, OpArg arg, u32 address,
 {
   arg = FixImmediate(accessSize, arg);
 
+  // If the address maps to an MMIO register, inline MMIO write code. Writes
+  // anywhere in the gather pipe page are routed to the FIFO by the slow path,
+  // so leave those alone.
+  u32 mmioAddress = accessSize <= 32 ? PowerPC::IsOptimizableMMIOAccess(address, accessSize) : 0;
+  if ((mmioAddress & 0xFFFFF000) == 0x0C008000)
+    mmioAddress = 0;
+
   // If we already know the address through constant folding, we can do some
   // fun tricks...
   if (m_jit.jo.optimizeGatherPipe && PowerPC::IsOptimizableGatherPipeWrite(address))
@@ -646,6 +755,11 @@ bool EmuCodeBlock::WriteToConstAddress(int accessSize, OpArg arg, u32 address,
     WriteToConstRamAddress(accessSize, arg, address);
     return false;
   }
+  else if (mmioAddress)
+  {
+    MMIOWriteRegToAddr(Memory::mmio_mapping.get(), arg, registersInUse, mmioAddress, accessSize);
+    return false;
+  }
   else
   {
     // Helps external systems know which instruction triggered the write
@@ -64,6 +64,9 @@ void JitArm64::Init()
   analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CONDITIONAL_CONTINUE);
   analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CARRY_MERGE);
   analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_FOLLOW);
+  // Breakpoints have to be able to stop on every instruction.
+  if (!SConfig::GetInstance().bEnableDebugging)
+    analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_DEAD_CODE_ELIMINATION);
 
   m_enable_blr_optimization = jo.enableBlocklink && SConfig::GetInstance().bFastmem &&
                               !SConfig::GetInstance().bEnableDebugging;
@@ -794,6 +797,14 @@ void JitArm64::DoJit(u32 em_address, JitBlock* b, u32 nextPC)
       gpr.StoreRegisters(~op.gprInUse);
       fpr.StoreRegisters(~op.fprInUse);
     }
+    else if (op.isDead)
+    {
+      ++m_dead_code_stats.instructions;
+
+      // The previous instruction may have left the carry in the host flags for this one.
+      if (!CanMergeNextInstructions(1) || js.op[1].opinfo->type != ::OpType::Integer)
+        FlushCarry();
+    }
 
     i += js.skipInstructions;
     js.skipInstructions = 0;
@@ -18,12 +18,24 @@ using namespace Arm64Gen;
 
 void JitArm64::ComputeRC0(ARM64Reg reg)
 {
+  if (!js.op->wantsCR[0])
+  {
+    ++m_dead_code_stats.cr_updates;
+    return;
+  }
+
   gpr.BindCRToRegister(0, false);
   SXTW(gpr.CR(0), reg);
 }
 
 void JitArm64::ComputeRC0(u64 imm)
 {
+  if (!js.op->wantsCR[0])
+  {
+    ++m_dead_code_stats.cr_updates;
+    return;
+  }
+
   gpr.BindCRToRegister(0, false);
   MOVI2R(gpr.CR(0), imm);
   if (imm & 0x80000000)
@@ -35,7 +47,10 @@ void JitArm64::ComputeCarry(bool Carry)
   js.carryFlagSet = false;
 
   if (!js.op->wantsCA)
+  {
+    ++m_dead_code_stats.ca_updates;
     return;
+  }
 
   if (Carry)
   {
@@ -54,7 +69,10 @@ void JitArm64::ComputeCarry()
   js.carryFlagSet = false;
 
   if (!js.op->wantsCA)
+  {
+    ++m_dead_code_stats.ca_updates;
     return;
+  }
 
   js.carryFlagSet = true;
   if (CanMergeNextInstructions(1) && js.op[1].opinfo->type == ::OpType::Integer)
@@ -417,6 +435,12 @@ void JitArm64::cmp(UGeckoInstruction inst)
   int crf = inst.CRFD;
   u32 a = inst.RA, b = inst.RB;
 
+  if (!js.op->wantsCR[crf])
+  {
+    ++m_dead_code_stats.cr_updates;
+    return;
+  }
+
   gpr.BindCRToRegister(crf, false);
   ARM64Reg CR = gpr.CR(crf);
 
@@ -454,6 +478,12 @@ void JitArm64::cmpl(UGeckoInstruction inst)
   int crf = inst.CRFD;
   u32 a = inst.RA, b = inst.RB;
 
+  if (!js.op->wantsCR[crf])
+  {
+    ++m_dead_code_stats.cr_updates;
+    return;
+  }
+
   gpr.BindCRToRegister(crf, false);
   ARM64Reg CR = gpr.CR(crf);
 
@@ -483,6 +513,12 @@ void JitArm64::cmpi(UGeckoInstruction inst)
   s64 B = inst.SIMM_16;
   int crf = inst.CRFD;
 
+  if (!js.op->wantsCR[crf])
+  {
+    ++m_dead_code_stats.cr_updates;
+    return;
+  }
+
   gpr.BindCRToRegister(crf, false);
   ARM64Reg CR = gpr.CR(crf);
 
@@ -511,6 +547,12 @@ void JitArm64::cmpli(UGeckoInstruction inst)
   u64 B = inst.UIMM;
   int crf = inst.CRFD;
 
+  if (!js.op->wantsCR[crf])
+  {
+    ++m_dead_code_stats.cr_updates;
+    return;
+  }
+
   gpr.BindCRToRegister(crf, false);
   ARM64Reg CR = gpr.CR(crf);
 
@@ -32,6 +32,10 @@ public:
   {
     CallLambda(8 * sizeof(T), lambda);
   }
+  void VisitComplexFunction(MMIO::WriteFunction<T> function, void* context) override
+  {
+    CallFunction(8 * sizeof(T), function, context);
+  }
 
 private:
   void StoreFromRegister(int sbits, ARM64Reg reg)
@@ -85,6 +89,21 @@ private:
     m_emit->ABI_PopRegisters(m_gprs_in_use);
   }
 
+  void CallFunction(int sbits, MMIO::WriteFunction<T> function, void* context)
+  {
+    ARM64FloatEmitter float_emit(m_emit);
+
+    m_emit->ABI_PushRegisters(m_gprs_in_use);
+    float_emit.ABI_PushRegisters(m_fprs_in_use, X1);
+    m_emit->MOV(W2, m_src_reg);
+    m_emit->MOVP2R(X0, context);
+    m_emit->MOVI2R(W1, m_address);
+    m_emit->MOVP2R(X30, function);
+    m_emit->BLR(X30);
+    float_emit.ABI_PopRegisters(m_fprs_in_use, X1);
+    m_emit->ABI_PopRegisters(m_gprs_in_use);
+  }
+
   ARM64XEmitter* m_emit;
   BitSet32 m_gprs_in_use;
   BitSet32 m_fprs_in_use;
@@ -112,6 +131,10 @@ public:
   {
     CallLambda(8 * sizeof(T), lambda);
   }
+  void VisitComplexFunction(MMIO::ReadFunction<T> function, void* context) override
+  {
+    CallFunction(8 * sizeof(T), function, context);
+  }
 
 private:
   void LoadConstantToReg(int sbits, u32 value)
@@ -184,6 +207,25 @@ private:
       m_emit->UBFM(m_dst_reg, W0, 0, sbits - 1);
   }
 
+  void CallFunction(int sbits, MMIO::ReadFunction<T> function, void* context)
+  {
+    ARM64FloatEmitter float_emit(m_emit);
+
+    m_emit->ABI_PushRegisters(m_gprs_in_use);
+    float_emit.ABI_PushRegisters(m_fprs_in_use, X1);
+    m_emit->MOVP2R(X0, context);
+    m_emit->MOVI2R(W1, m_address);
+    m_emit->MOVP2R(X30, function);
+    m_emit->BLR(X30);
+    float_emit.ABI_PopRegisters(m_fprs_in_use, X1);
+    m_emit->ABI_PopRegisters(m_gprs_in_use);
+
+    if (m_sign_extend)
+      m_emit->SBFM(m_dst_reg, W0, 0, sbits - 1);
+    else
+      m_emit->UBFM(m_dst_reg, W0, 0, sbits - 1);
+  }
+
   ARM64XEmitter* m_emit;
   BitSet32 m_gprs_in_use;
   BitSet32 m_fprs_in_use;
@@ -115,6 +115,13 @@ void WriteProfileResults(const std::string& filename)
             name.c_str(), stat.run_count, stat.cost, stat.tick_counter, percent, timePercent,
             (double)stat.tick_counter * 1000.0 / (double)prof_stats.countsPerSec, stat.block_size);
   }
+
+  const Profiler::DeadCodeStats& dead_code = prof_stats.dead_code;
+  fprintf(f.GetHandle(),
+          "\nskippedCRUpdates\tskippedCAUpdates\tskippedFPRFUpdates\tskippedInstructions\n");
+  fprintf(f.GetHandle(), "%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\n",
+          dead_code.cr_updates, dead_code.ca_updates, dead_code.fprf_updates,
+          dead_code.instructions);
 }
 
 void GetProfileResults(Profiler::ProfileStats* prof_stats)
@@ -145,6 +152,7 @@ void GetProfileResults(Profiler::ProfileStats* prof_stats)
   });
 
   sort(prof_stats->block_stats.begin(), prof_stats->block_stats.end());
+  prof_stats->dead_code = g_jit->GetDeadCodeStats();
   if (old_state == Core::State::Running)
     Core::SetState(Core::State::Running);
 }
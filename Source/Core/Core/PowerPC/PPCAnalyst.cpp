@@ -17,6 +17,7 @@
 #include "Common/Logging/Log.h"
 #include "Common/StringUtil.h"
 #include "Core/ConfigManager.h"
+#include "Core/HLE/HLE.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
 #include "Core/PowerPC/MMU.h"
 #include "Core/PowerPC/PPCSymbolDB.h"
@@ -449,6 +450,26 @@ static bool isCror(const CodeOp& a)
   return a.inst.OPCD == 19 && a.inst.SUBOP10 == 449;
 }
 
+// Whether an integer instruction can be left out because everything it writes is overwritten
+// before being read. op.wantsCR and op.wantsCA must already describe what is wanted after it.
+static bool IsDeadInstruction(const CodeOp& op, BitSet32 gpr_discardable)
+{
+  if (op.opinfo->type != OpType::Integer)
+    return false;
+
+  // Carry-in instructions may get their input straight from the host flags of the previous
+  // instruction, and XER[SO] is sticky, so it is never overwritten.
+  const int flags = op.opinfo->flags;
+  if ((flags & (FL_READ_CA | FL_EVIL)) || ((flags & FL_SET_OE) && op.inst.OE))
+    return false;
+
+  if (!op.regsOut && !op.crOut && !op.outputCA)
+    return false;
+
+  return !(op.regsOut & ~gpr_discardable) && !(op.crOut & op.wantsCR) &&
+         !(op.outputCA && op.wantsCA);
+}
+
 void PPCAnalyzer::ReorderInstructionsCore(u32 instructions, CodeOp* code, bool reverse,
                                           ReorderType type)
 {
@@ -522,34 +543,70 @@ void PPCAnalyzer::ReorderInstructions(u32 instructions, CodeOp* code)
 void PPCAnalyzer::SetInstructionStats(CodeBlock* block, CodeOp* code, const GekkoOPInfo* opinfo,
                                       u32 index)
 {
-  code->wantsCR0 = false;
-  code->wantsCR1 = false;
-
   if (opinfo->flags & FL_USE_FPU)
     block->m_fpa->any = true;
 
   if (opinfo->flags & FL_TIMER)
     block->m_gpa->anyTimer = true;
 
-  // Does the instruction output CR0?
+  // Which CR fields does the instruction write?
+  code->crOut = BitSet8(0);
   if (opinfo->flags & FL_RC_BIT)
-    code->outputCR0 = code->inst.hex & 1;  // todo fix
-  else if ((opinfo->flags & FL_SET_CRn) && code->inst.CRFD == 0)
-    code->outputCR0 = true;
-  else
-    code->outputCR0 = (opinfo->flags & FL_SET_CR0) != 0;
-
-  // Does the instruction output CR1?
+    code->crOut[0] = code->inst.Rc;
   if (opinfo->flags & FL_RC_BIT_F)
-    code->outputCR1 = code->inst.hex & 1;  // todo fix
-  else if ((opinfo->flags & FL_SET_CRn) && code->inst.CRFD == 1)
-    code->outputCR1 = true;
-  else
-    code->outputCR1 = (opinfo->flags & FL_SET_CR1) != 0;
+    code->crOut[1] = code->inst.Rc;
+  if (opinfo->flags & FL_SET_CR0)
+    code->crOut[0] = true;
+  if (opinfo->flags & FL_SET_CR1)
+    code->crOut[1] = true;
+  if (code->inst.OPCD == 31 && code->inst.SUBOP10 == 144)  // mtcrf
+  {
+    for (int field = 0; field < 8; ++field)
+      code->crOut[field] = (code->inst.CRM & (0x80 >> field)) != 0;
+  }
+  else if (opinfo->flags & FL_SET_CRn)
+  {
+    code->crOut[code->inst.CRFD] = true;
+  }
+
+  // Which CR fields does the instruction read?
+  code->crIn = BitSet8(0);
+  if ((code->inst.OPCD == 16 || (code->inst.OPCD == 19 && code->inst.SUBOP10 == 16)) &&
+      (code->inst.BO & BO_DONT_CHECK_CONDITION) == 0)  // bcx, bclrx
+  {
+    code->crIn[code->inst.BI >> 2] = true;
+  }
+  else if (code->inst.OPCD == 19 && code->inst.SUBOP10 == 528 &&
+           (code->inst.BO_2 & BO_DONT_CHECK_CONDITION) == 0)  // bcctrx
+  {
+    code->crIn[code->inst.BI_2 >> 2] = true;
+  }
+  else if (opinfo->type == OpType::CR)  // crand, cror, crxor...
+  {
+    // These only write a single bit, so the rest of the destination field is an input too.
+    code->crIn[code->inst.CRBA >> 2] = true;
+    code->crIn[code->inst.CRBB >> 2] = true;
+    code->crIn[code->inst.CRBD >> 2] = true;
+    code->crOut[code->inst.CRBD >> 2] = true;
+  }
+  else if (code->inst.OPCD == 19 && code->inst.SUBOP10 == 0)  // mcrf
+  {
+    code->crIn[code->inst.CRFS] = true;
+  }
+  else if (code->inst.OPCD == 31 && code->inst.SUBOP10 == 19)  // mfcr
+  {
+    code->crIn = BitSet8(0xFF);
+  }
+
+  code->outputCR0 = code->crOut[0];
+  code->outputCR1 = code->crOut[1];
 
   code->wantsFPRF = (opinfo->flags & FL_READ_FPRF) != 0;
   code->outputFPRF = (opinfo->flags & FL_SET_FPRF) != 0;
   code->canEndBlock = (opinfo->flags & FL_ENDBLOCK) != 0;
+  // Without the MMU, loads and stores can't raise DSIs. The first floating point instruction of
+  // a block can raise an FPU unavailable exception; Analyze() takes care of that one.
+  code->canCauseException = SConfig::GetInstance().bMMU && (opinfo->flags & FL_LOADSTORE) != 0;
 
   code->wantsCA = (opinfo->flags & FL_READ_CA) != 0;
   code->outputCA = (opinfo->flags & FL_SET_CA) != 0;
@@ -753,6 +810,7 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, std:
 
   bool found_exit = false;
   bool found_call = false;
+  bool found_fpu = false;
   size_t caller = 0;
   u32 numFollows = 0;
   u32 num_inst = 0;
@@ -783,6 +841,13 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, std:
 
     SetInstructionStats(block, &code[i], opinfo, static_cast<u32>(i));
 
+    // The JIT checks whether the FPU is enabled before the first FPU instruction of a block.
+    if ((opinfo->flags & FL_USE_FPU) && !found_fpu)
+    {
+      code[i].canCauseException = true;
+      found_fpu = true;
+    }
+
     bool follow = false;
 
     bool conditional_continue = false;
@@ -914,33 +979,60 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, std:
   }
 
   // Scan for flag dependencies; assume the next block (or any branch that can leave the block)
-  // wants flags, to be safe.
-  bool wantsCR0 = true, wantsCR1 = true, wantsFPRF = true, wantsCA = true;
+  // wants flags, to be safe. An instruction that can raise an exception leaves the block before
+  // writing its results, so everything is wanted right before it, too. The same goes for
+  // instructions with an HLE hook, which may read any register.
+  bool wantsFPRF = true, wantsCA = true;
+  BitSet8 wantsCR(0xFF);
+  // GPRs that are overwritten later in the block before anything reads them.
+  BitSet32 gprDiscardable;
   BitSet32 fprInUse, gprInUse, gprInReg, fprInXmm;
   for (int i = block->m_num_instructions - 1; i >= 0; i--)
   {
     CodeOp& op = code[i];
 
-    const bool opWantsCR0 = op.wantsCR0;
-    const bool opWantsCR1 = op.wantsCR1;
+    const bool hle = HLE::ReplaceFunctionIfPossible(
+        op.address, [](u32, HLE::HookType) { return true; });
+    const bool exception = op.canCauseException || hle;
+
     const bool opWantsFPRF = op.wantsFPRF;
     const bool opWantsCA = op.wantsCA;
-    op.wantsCR0 = wantsCR0 || op.canEndBlock;
-    op.wantsCR1 = wantsCR1 || op.canEndBlock;
+    op.wantsCR = op.canEndBlock ? BitSet8(0xFF) : wantsCR;
     op.wantsFPRF = wantsFPRF || op.canEndBlock;
     op.wantsCA = wantsCA || op.canEndBlock;
-    wantsCR0 |= opWantsCR0 || op.canEndBlock;
-    wantsCR1 |= opWantsCR1 || op.canEndBlock;
-    wantsFPRF |= opWantsFPRF || op.canEndBlock;
-    wantsCA |= opWantsCA || op.canEndBlock;
-    wantsCR0 &= !op.outputCR0 || opWantsCR0;
-    wantsCR1 &= !op.outputCR1 || opWantsCR1;
-    wantsFPRF &= !op.outputFPRF || opWantsFPRF;
-    wantsCA &= !op.outputCA || opWantsCA;
+    if (op.canEndBlock)
+      gprDiscardable = BitSet32(0);
+
     op.gprInUse = gprInUse;
     op.fprInUse = fprInUse;
     op.gprInReg = gprInReg;
     op.fprInXmm = fprInXmm;
+
+    op.isDead = HasOption(OPTION_DEAD_CODE_ELIMINATION) && !op.skip && !exception &&
+                IsDeadInstruction(op, gprDiscardable);
+    if (op.isDead)
+    {
+      // Nothing reads the inputs of an instruction that isn't compiled, and its outputs are
+      // exactly as dead before it as after it.
+      op.skip = true;
+      continue;
+    }
+
+    if (exception)
+    {
+      wantsCR = BitSet8(0xFF);
+      wantsFPRF = true;
+      wantsCA = true;
+      gprDiscardable = BitSet32(0);
+    }
+    else
+    {
+      wantsCR = (op.wantsCR & ~op.crOut) | op.crIn;
+      wantsFPRF = opWantsFPRF || (op.wantsFPRF && !op.outputFPRF);
+      wantsCA = opWantsCA || (op.wantsCA && !op.outputCA);
+      gprDiscardable = (gprDiscardable | op.regsOut) & ~op.regsIn;
+    }
+
     // TODO: if there's no possible endblocks or exceptions in between, tell the regcache
     // we can throw away a register if it's going to be overwritten later.
     gprInUse |= op.regsIn;
@@ -35,8 +35,6 @@ struct CodeOp  // 16B
   bool isBranchTarget;
   bool branchUsesCtr;
   bool branchIsIdleLoop;
-  bool wantsCR0;
-  bool wantsCR1;
   bool wantsFPRF;
   bool wantsCA;
   bool wantsCAInFlags;
@@ -45,8 +43,16 @@ struct CodeOp  // 16B
   bool outputFPRF;
   bool outputCA;
   bool canEndBlock;
+  bool canCauseException;
   bool skipLRStack;
   bool skip;  // followed BL-s for example
+  // whether skip was set because every result of this instruction is overwritten before use
+  bool isDead;
+  // which CR fields this instruction reads and writes
+  BitSet8 crIn;
+  BitSet8 crOut;
+  // which CR fields may still be read after this instruction, in this block or after leaving it
+  BitSet8 wantsCR;
   // which registers are still needed after this instruction in this block
   BitSet32 fprInUse;
   BitSet32 gprInUse;
@@ -195,6 +201,10 @@ public:
 
     // Reorder cror instructions next to their associated fcmp.
     OPTION_CROR_MERGE = (1 << 6),
+
+    // Mark integer instructions whose results are all overwritten before being read as skipped.
+    // Must be off when breakpoints need to be able to stop on every instruction.
+    OPTION_DEAD_CODE_ELIMINATION = (1 << 7),
   };
 
   // Option setting/getting
@@ -26,12 +26,23 @@ struct BlockStat
 
   bool operator<(const BlockStat& other) const { return cost > other.cost; }
 };
+// How often the JIT left out a flag update or a whole instruction because block analysis showed
+// that its result is overwritten before anything reads it. These are counted when a block is
+// compiled, not when it runs.
+struct DeadCodeStats
+{
+  u64 cr_updates = 0;
+  u64 ca_updates = 0;
+  u64 fprf_updates = 0;
+  u64 instructions = 0;
+};
 struct ProfileStats
 {
   std::vector<BlockStat> block_stats;
   u64 cost_sum;
   u64 timecost_sum;
   u64 countsPerSec;
+  DeadCodeStats dead_code;
 };
 
 }  // namespace Profiler
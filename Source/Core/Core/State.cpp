@@ -36,6 +36,7 @@
 #include "Core/NetPlayClient.h"
 #include "Core/PowerPC/PowerPC.h"
 
+#include "VideoCommon/Fifo.h"
 #include "VideoCommon/FrameDump.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/VideoBackendBase.h"
@@ -200,14 +201,8 @@ static void DoState(PointerWrap& p)
 #endif
 }
 
-void LoadFromBuffer(std::vector<u8>& buffer)
+static void DoLoadFromBuffer(std::vector<u8>& buffer)
 {
-  if (NetPlay::IsNetPlayRunning())
-  {
-    OSD::AddMessage("Loading savestates is disabled in Netplay to prevent desyncs");
-    return;
-  }
-
   Core::RunOnCPUThread(
       [&] {
         u8* ptr = &buffer[0];
@@ -217,6 +212,33 @@ void LoadFromBuffer(std::vector<u8>& buffer)
       true);
 }
 
+void LoadFromBuffer(std::vector<u8>& buffer)
+{
+  if (NetPlay::IsNetPlayRunning())
+  {
+    OSD::AddMessage("Loading savestates is disabled in Netplay to prevent desyncs");
+    return;
+  }
+
+  DoLoadFromBuffer(buffer);
+}
+
+// NetPlay's rollback mode saves and loads states on the CPU thread, where Core::RunOnCPUThread
+// doesn't pause anything, so the GPU thread has to be kept off the FIFO here
+void LoadFromBufferForRollback(std::vector<u8>& buffer)
+{
+  Fifo::PauseGpu(true);
+  DoLoadFromBuffer(buffer);
+  Fifo::PauseGpu(false);
+}
+
+void SaveToBufferForRollback(std::vector<u8>& buffer)
+{
+  Fifo::PauseGpu(true);
+  SaveToBuffer(buffer);
+  Fifo::PauseGpu(false);
+}
+
 void SaveToBuffer(std::vector<u8>& buffer)
 {
   Core::RunOnCPUThread(
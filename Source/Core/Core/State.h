@@ -49,6 +49,11 @@ void LoadAs(const std::string& filename);
 
 void SaveToBuffer(std::vector<u8>& buffer);
 void LoadFromBuffer(std::vector<u8>& buffer);
+// Unlike LoadFromBuffer, this also works during NetPlay. Only meant for NetPlay's rollback mode,
+// which loads states that it saved itself earlier in the same session. Both must be called on
+// the CPU thread, and pause the GPU thread while the state is saved or loaded.
+void LoadFromBufferForRollback(std::vector<u8>& buffer);
+void SaveToBufferForRollback(std::vector<u8>& buffer);
 
 void LoadLastSaved(int i = 1);
 void SaveFirstSaved();
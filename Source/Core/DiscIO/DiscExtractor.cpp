@@ -6,13 +6,20 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <condition_variable>
 #include <locale>
+#include <mutex>
 #include <optional>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/File.h"
 #include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
 #include "Common/StringUtil.h"
+#include "Common/WorkQueueThread.h"
 #include "DiscIO/Enums.h"
 #include "DiscIO/Filesystem.h"
 #include "DiscIO/Volume.h"
@@ -127,10 +134,82 @@ bool ExportFile(const Volume& volume, const Partition& partition, std::string_vi
   return ExportFile(volume, partition, file_system->FindFileInfo(path).get(), export_filename);
 }
 
-void ExportDirectory(const Volume& volume, const Partition& partition, const FileInfo& directory,
+namespace
+{
+// Writes exported files on a separate thread, so that reading (and for Wii discs, decrypting)
+// the next file can happen while the previous one is being written.
+class FileWriter
+{
+public:
+  FileWriter() : m_thread([this](Chunk chunk) { WriteChunk(std::move(chunk)); }) {}
+
+  // Blocks while too much data is waiting to be written.
+  void AddChunk(std::string path, std::vector<u8> data, bool first, bool last)
+  {
+    {
+      std::unique_lock lk(m_mutex);
+      m_space_available.wait(lk, [this] { return m_pending_bytes < MAX_PENDING_BYTES; });
+      m_pending_bytes += data.size();
+    }
+    m_thread.EmplaceItem(Chunk{std::move(path), std::move(data), first, last});
+  }
+
+  static constexpr u64 MAX_CHUNK_SIZE = 0x1000000;
+
+private:
+  static constexpr u64 MAX_PENDING_BYTES = 4 * MAX_CHUNK_SIZE;
+
+  struct Chunk
+  {
+    std::string path;
+    std::vector<u8> data;
+    bool first;
+    bool last;
+  };
+
+  void WriteChunk(Chunk chunk)
+  {
+    // The chunks of a file arrive in order and aren't interleaved with other files.
+    if (chunk.first)
+    {
+      m_file.Open(chunk.path, "wb");
+      m_failed = !m_file;
+    }
+
+    if (!m_failed && !m_file.WriteBytes(chunk.data.data(), chunk.data.size()))
+      m_failed = true;
+
+    if (chunk.last)
+    {
+      if (!m_file.Close())
+        m_failed = true;
+      if (m_failed)
+        ERROR_LOG(DISCIO, "Could not export %s", chunk.path.c_str());
+    }
+
+    {
+      std::lock_guard lk(m_mutex);
+      m_pending_bytes -= chunk.data.size();
+    }
+    m_space_available.notify_one();
+  }
+
+  File::IOFile m_file;
+  bool m_failed = false;
+
+  std::mutex m_mutex;
+  std::condition_variable m_space_available;
+  u64 m_pending_bytes = 0;
+
+  // Declared last, so that the thread is done before the members it uses are destroyed.
+  Common::WorkQueueThread<Chunk> m_thread;
+};
+
+bool ExportDirectory(const Volume& volume, const Partition& partition, const FileInfo& directory,
                      bool recursive, const std::string& filesystem_path,
                      const std::string& export_folder,
-                     const std::function<bool(const std::string& path)>& update_progress)
+                     const std::function<bool(const std::string& path)>& update_progress,
+                     FileWriter* writer)
 {
   File::CreateFullPath(export_folder + '/');
 
@@ -141,22 +220,60 @@ void ExportDirectory(const Volume& volume, const Partition& partition, const Fil
     const std::string export_path = export_folder + '/' + name;
 
     if (update_progress(path))
-      return;
+      return false;
 
     DEBUG_LOG(DISCIO, "%s", export_path.c_str());
 
     if (!file_info.IsDirectory())
     {
       if (File::Exists(export_path))
+      {
         NOTICE_LOG(DISCIO, "%s already exists", export_path.c_str());
-      else if (!ExportFile(volume, partition, &file_info, export_path))
-        ERROR_LOG(DISCIO, "Could not export %s", export_path.c_str());
+        continue;
+      }
+
+      u64 offset = file_info.GetOffset();
+      u64 size = file_info.GetSize();
+      bool first = true;
+      do
+      {
+        std::vector<u8> buffer(static_cast<size_t>(std::min(size, FileWriter::MAX_CHUNK_SIZE)));
+        if (!volume.Read(offset, buffer.size(), buffer.data(), partition))
+        {
+          ERROR_LOG(DISCIO, "Could not export %s", export_path.c_str());
+          if (!first)
+            writer->AddChunk(export_path, {}, false, true);
+          break;
+        }
+
+        offset += buffer.size();
+        size -= buffer.size();
+        writer->AddChunk(export_path, std::move(buffer), first, size == 0);
+        first = false;
+      } while (size != 0);
     }
     else if (recursive)
     {
-      ExportDirectory(volume, partition, file_info, recursive, path, export_path, update_progress);
+      if (!ExportDirectory(volume, partition, file_info, recursive, path, export_path,
+                           update_progress, writer))
+      {
+        return false;
+      }
     }
   }
+
+  return true;
+}
+}  // namespace
+
+void ExportDirectory(const Volume& volume, const Partition& partition, const FileInfo& directory,
+                     bool recursive, const std::string& filesystem_path,
+                     const std::string& export_folder,
+                     const std::function<bool(const std::string& path)>& update_progress)
+{
+  FileWriter writer;
+  ExportDirectory(volume, partition, directory, recursive, filesystem_path, export_folder,
+                  update_progress, &writer);
 }
 
 bool ExportWiiUnencryptedHeader(const Volume& volume, const std::string& export_filename)
@@ -8,23 +8,21 @@
 #include <array>
 #include <cstddef>
 #include <cstring>
-#include <future>
 #include <map>
 #include <memory>
 #include <optional>
 #include <string>
-#include <thread>
 #include <utility>
 #include <vector>
 
-#include <mbedtls/aes.h>
-#include <mbedtls/sha1.h>
-
 #include "Common/Align.h"
 #include "Common/Assert.h"
 #include "Common/CommonTypes.h"
+#include "Common/Crypto/AES.h"
+#include "Common/Crypto/SHA1.h"
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
+#include "Common/ParallelFor.h"
 #include "Common/Swap.h"
 
 #include "DiscIO/Blob.h"
@@ -38,8 +36,7 @@
 namespace DiscIO
 {
 VolumeWii::VolumeWii(std::unique_ptr<BlobReader> reader)
-    : m_reader(std::move(reader)), m_game_partition(PARTITION_NONE),
-      m_last_decrypted_block(UINT64_MAX)
+    : m_reader(std::move(reader)), m_game_partition(PARTITION_NONE)
 {
   ASSERT(m_reader);
 
@@ -126,14 +123,12 @@ VolumeWii::VolumeWii(std::unique_ptr<BlobReader> reader)
         return h3_table;
       };
 
-      auto get_key = [this, partition]() -> std::unique_ptr<mbedtls_aes_context> {
+      auto get_key = [this, partition]() -> std::unique_ptr<Common::AES::Context> {
         const IOS::ES::TicketReader& ticket = *m_partitions[partition].ticket;
         if (!ticket.IsValid())
           return nullptr;
         const std::array<u8, AES_KEY_SIZE> key = ticket.GetTitleKey();
-        std::unique_ptr<mbedtls_aes_context> aes_context = std::make_unique<mbedtls_aes_context>();
-        mbedtls_aes_setkey_dec(aes_context.get(), key.data(), 128);
-        return aes_context;
+        return Common::AES::CreateContext(key.data(), Common::AES::Mode::Decrypt);
       };
 
       auto get_file_system = [this, partition]() -> std::unique_ptr<FileSystem> {
@@ -146,7 +141,7 @@ VolumeWii::VolumeWii(std::unique_ptr<BlobReader> reader)
       };
 
       m_partitions.emplace(
-          partition, PartitionDetails{Common::Lazy<std::unique_ptr<mbedtls_aes_context>>(get_key),
+          partition, PartitionDetails{Common::Lazy<std::unique_ptr<Common::AES::Context>>(get_key),
                                       Common::Lazy<IOS::ES::TicketReader>(get_ticket),
                                       Common::Lazy<IOS::ES::TMDReader>(get_tmd),
                                       Common::Lazy<std::vector<u8>>(get_cert_chain),
@@ -183,42 +178,33 @@ bool VolumeWii::Read(u64 offset, u64 length, u8* buffer, const Partition& partit
                           buffer);
   }
 
-  mbedtls_aes_context* aes_context = partition_details.key->get();
+  const Common::AES::Context* aes_context = partition_details.key->get();
   if (!aes_context)
     return false;
 
-  std::vector<u8> read_buffer(BLOCK_TOTAL_SIZE);
   while (length > 0)
   {
     // Calculate offsets
-    u64 block_offset_on_disc = partition.offset + *partition_details.data_offset +
-                               offset / BLOCK_DATA_SIZE * BLOCK_TOTAL_SIZE;
-    u64 data_offset_in_block = offset % BLOCK_DATA_SIZE;
+    const u64 block_offset_on_disc = partition.offset + *partition_details.data_offset +
+                                     offset / BLOCK_DATA_SIZE * BLOCK_TOTAL_SIZE;
+    const u64 data_offset_in_block = offset % BLOCK_DATA_SIZE;
 
-    if (m_last_decrypted_block != block_offset_on_disc)
+    const u8* block_data = FindDecryptedBlock(block_offset_on_disc);
+    if (!block_data)
     {
-      // Read the current block
-      if (!m_reader->Read(block_offset_on_disc, BLOCK_TOTAL_SIZE, read_buffer.data()))
+      // Read and decrypt all the blocks that are left of this read in one go
+      const u64 blocks_left = Common::AlignUp(data_offset_in_block + length, BLOCK_DATA_SIZE) /
+                              BLOCK_DATA_SIZE;
+      block_data = DecryptBlocks(block_offset_on_disc,
+                                 std::min<u64>(blocks_left, DECRYPTED_BLOCK_CACHE_SIZE),
+                                 *aes_context);
+      if (!block_data)
         return false;
-
-      // Decrypt the block's data.
-      // 0x3D0 - 0x3DF in read_buffer will be overwritten,
-      // but that won't affect anything, because we won't
-      // use the content of read_buffer anymore after this
-      mbedtls_aes_crypt_cbc(aes_context, MBEDTLS_AES_DECRYPT, BLOCK_DATA_SIZE, &read_buffer[0x3D0],
-                            &read_buffer[BLOCK_HEADER_SIZE], m_last_decrypted_block_data);
-      m_last_decrypted_block = block_offset_on_disc;
-
-      // The only thing we currently use from the 0x000 - 0x3FF part
-      // of the block is the IV (at 0x3D0), but it also contains SHA-1
-      // hashes that IOS uses to check that discs aren't tampered with.
-      // http://wiibrew.org/wiki/Wii_Disc#Encrypted
     }
 
     // Copy the decrypted data
-    u64 copy_size = std::min(length, BLOCK_DATA_SIZE - data_offset_in_block);
-    memcpy(buffer, &m_last_decrypted_block_data[data_offset_in_block],
-           static_cast<size_t>(copy_size));
+    const u64 copy_size = std::min(length, BLOCK_DATA_SIZE - data_offset_in_block);
+    std::memcpy(buffer, block_data + data_offset_in_block, static_cast<size_t>(copy_size));
 
     // Update offsets
     length -= copy_size;
@@ -229,6 +215,67 @@ bool VolumeWii::Read(u64 offset, u64 length, u8* buffer, const Partition& partit
   return true;
 }
 
+const u8* VolumeWii::FindDecryptedBlock(u64 block_offset_on_disc) const
+{
+  const auto it = m_decrypted_block_map.find(block_offset_on_disc);
+  if (it == m_decrypted_block_map.end())
+    return nullptr;
+
+  it->second->last_used = ++m_decrypted_block_counter;
+  return it->second->data.data();
+}
+
+const u8* VolumeWii::DecryptBlocks(u64 block_offset_on_disc, u64 count,
+                                   const Common::AES::Context& aes_context) const
+{
+  m_read_buffer.resize(static_cast<size_t>(count * BLOCK_TOTAL_SIZE));
+  if (!m_reader->Read(block_offset_on_disc, m_read_buffer.size(), m_read_buffer.data()))
+    return nullptr;
+
+  std::vector<DecryptedBlock*> blocks(static_cast<size_t>(count));
+  for (u64 i = 0; i < count; ++i)
+  {
+    const u64 offset_on_disc = block_offset_on_disc + i * BLOCK_TOTAL_SIZE;
+
+    DecryptedBlock* block;
+    const auto it = m_decrypted_block_map.find(offset_on_disc);
+    if (it != m_decrypted_block_map.end())
+    {
+      block = it->second;
+    }
+    else if (m_decrypted_blocks.size() < DECRYPTED_BLOCK_CACHE_SIZE)
+    {
+      block = m_decrypted_blocks.emplace_back(std::make_unique<DecryptedBlock>()).get();
+    }
+    else
+    {
+      block = std::min_element(m_decrypted_blocks.begin(), m_decrypted_blocks.end(),
+                               [](const auto& a, const auto& b) {
+                                 return a->last_used < b->last_used;
+                               })
+                  ->get();
+      m_decrypted_block_map.erase(block->offset_on_disc);
+    }
+
+    block->offset_on_disc = offset_on_disc;
+    block->last_used = ++m_decrypted_block_counter;
+    m_decrypted_block_map[offset_on_disc] = block;
+    blocks[i] = block;
+  }
+
+  // The only thing we currently use from the 0x000 - 0x3FF part
+  // of the block is the IV (at 0x3D0), but it also contains SHA-1
+  // hashes that IOS uses to check that discs aren't tampered with.
+  // http://wiibrew.org/wiki/Wii_Disc#Encrypted
+  Common::ParallelFor(blocks.size(), [&](size_t i) {
+    const u8* encrypted_block = m_read_buffer.data() + i * BLOCK_TOTAL_SIZE;
+    aes_context.Crypt(encrypted_block + 0x3D0, encrypted_block + BLOCK_HEADER_SIZE,
+                      blocks[i]->data.data(), BLOCK_DATA_SIZE);
+  });
+
+  return blocks[0]->data.data();
+}
+
 bool VolumeWii::IsEncryptedAndHashed() const
 {
   return m_encrypted;
@@ -453,9 +500,7 @@ bool VolumeWii::CheckH3TableIntegrity(const Partition& partition) const
   if (contents.size() != 1)
     return false;
 
-  std::array<u8, 20> h3_table_sha1;
-  mbedtls_sha1_ret(h3_table.data(), h3_table.size(), h3_table_sha1.data());
-  return h3_table_sha1 == contents[0].sha1;
+  return Common::SHA1::CalculateDigest(h3_table.data(), h3_table.size()) == contents[0].sha1;
 }
 
 bool VolumeWii::CheckBlockIntegrity(u64 block_index, const std::vector<u8>& encrypted_data,
@@ -472,42 +517,43 @@ bool VolumeWii::CheckBlockIntegrity(u64 block_index, const std::vector<u8>& encr
   if (block_index / BLOCKS_PER_GROUP * SHA1_SIZE >= partition_details.h3_table->size())
     return false;
 
-  mbedtls_aes_context* aes_context = partition_details.key->get();
+  const Common::AES::Context* aes_context = partition_details.key->get();
   if (!aes_context)
     return false;
 
   HashBlock hashes;
-  u8 iv[16] = {0};
-  mbedtls_aes_crypt_cbc(aes_context, MBEDTLS_AES_DECRYPT, sizeof(HashBlock), iv,
-                        encrypted_data.data(), reinterpret_cast<u8*>(&hashes));
+  const u8 iv[16] = {0};
+  aes_context->Crypt(iv, encrypted_data.data(), reinterpret_cast<u8*>(&hashes), sizeof(HashBlock));
 
   u8 cluster_data[BLOCK_DATA_SIZE];
-  std::memcpy(iv, encrypted_data.data() + 0x3D0, 16);
-  mbedtls_aes_crypt_cbc(aes_context, MBEDTLS_AES_DECRYPT, sizeof(cluster_data), iv,
-                        encrypted_data.data() + sizeof(HashBlock), cluster_data);
+  aes_context->Crypt(encrypted_data.data() + 0x3D0, encrypted_data.data() + sizeof(HashBlock),
+                     cluster_data, sizeof(cluster_data));
 
   for (u32 hash_index = 0; hash_index < 31; ++hash_index)
   {
-    u8 h0_hash[SHA1_SIZE];
-    mbedtls_sha1_ret(cluster_data + hash_index * 0x400, 0x400, h0_hash);
-    if (memcmp(h0_hash, hashes.h0[hash_index], SHA1_SIZE))
+    const Common::SHA1::Digest h0_hash =
+        Common::SHA1::CalculateDigest(cluster_data + hash_index * 0x400, 0x400);
+    if (memcmp(h0_hash.data(), hashes.h0[hash_index], SHA1_SIZE))
       return false;
   }
 
-  u8 h1_hash[SHA1_SIZE];
-  mbedtls_sha1_ret(reinterpret_cast<u8*>(hashes.h0), sizeof(hashes.h0), h1_hash);
-  if (memcmp(h1_hash, hashes.h1[block_index % 8], SHA1_SIZE))
+  const Common::SHA1::Digest h1_hash =
+      Common::SHA1::CalculateDigest(reinterpret_cast<u8*>(hashes.h0), sizeof(hashes.h0));
+  if (memcmp(h1_hash.data(), hashes.h1[block_index % 8], SHA1_SIZE))
     return false;
 
-  u8 h2_hash[SHA1_SIZE];
-  mbedtls_sha1_ret(reinterpret_cast<u8*>(hashes.h1), sizeof(hashes.h1), h2_hash);
-  if (memcmp(h2_hash, hashes.h2[block_index / 8 % 8], SHA1_SIZE))
+  const Common::SHA1::Digest h2_hash =
+      Common::SHA1::CalculateDigest(reinterpret_cast<u8*>(hashes.h1), sizeof(hashes.h1));
+  if (memcmp(h2_hash.data(), hashes.h2[block_index / 8 % 8], SHA1_SIZE))
     return false;
 
-  u8 h3_hash[SHA1_SIZE];
-  mbedtls_sha1_ret(reinterpret_cast<u8*>(hashes.h2), sizeof(hashes.h2), h3_hash);
-  if (memcmp(h3_hash, partition_details.h3_table->data() + block_index / 64 * SHA1_SIZE, SHA1_SIZE))
+  const Common::SHA1::Digest h3_hash =
+      Common::SHA1::CalculateDigest(reinterpret_cast<u8*>(hashes.h2), sizeof(hashes.h2));
+  if (memcmp(h3_hash.data(), partition_details.h3_table->data() + block_index / 64 * SHA1_SIZE,
+             SHA1_SIZE))
+  {
     return false;
+  }
 
   return true;
 }
@@ -527,137 +573,122 @@ bool VolumeWii::CheckBlockIntegrity(u64 block_index, const Partition& partition)
   return CheckBlockIntegrity(block_index, cluster, partition);
 }
 
+static void CalculateSHA1(const u8* data, size_t size, u8* out)
+{
+  const Common::SHA1::Digest digest = Common::SHA1::CalculateDigest(data, size);
+  std::memcpy(out, digest.data(), digest.size());
+}
+
 bool VolumeWii::EncryptGroup(u64 offset, u64 partition_data_offset,
                              u64 partition_data_decrypted_size,
                              const std::array<u8, AES_KEY_SIZE>& key, BlobReader* blob,
                              std::array<u8, GROUP_TOTAL_SIZE>* out)
 {
-  std::vector<std::array<u8, BLOCK_DATA_SIZE>> unencrypted_data(BLOCKS_PER_GROUP);
-  std::vector<HashBlock> unencrypted_hashes(BLOCKS_PER_GROUP);
+  u8* const out_ptr = out->data();
+  return EncryptGroups(offset, 1, partition_data_offset, partition_data_decrypted_size, key, blob,
+                       &out_ptr);
+}
+
+bool VolumeWii::EncryptGroups(u64 offset, u64 count, u64 partition_data_offset,
+                              u64 partition_data_decrypted_size,
+                              const std::array<u8, AES_KEY_SIZE>& key, BlobReader* blob,
+                              u8* const* out)
+{
+  // The work is split into subgroups of 8 blocks, which is what one H1 hash covers
+  constexpr size_t BLOCKS_PER_SUBGROUP = 8;
+  constexpr size_t SUBGROUPS_PER_GROUP = BLOCKS_PER_GROUP / BLOCKS_PER_SUBGROUP;
+
+  const size_t blocks = static_cast<size_t>(count * BLOCKS_PER_GROUP);
+  std::vector<std::array<u8, BLOCK_DATA_SIZE>> unencrypted_data(blocks);
+  std::vector<HashBlock> unencrypted_hashes(blocks);
+
+  // Blocks that are only partially inside the partition data are left as zeroes
+  const size_t blocks_to_read =
+      offset >= partition_data_decrypted_size ?
+          0 :
+          static_cast<size_t>(
+              std::min<u64>(blocks, (partition_data_decrypted_size - offset) / BLOCK_DATA_SIZE));
+  if (blocks_to_read != 0 &&
+      !blob->ReadWiiDecrypted(offset, blocks_to_read * BLOCK_DATA_SIZE,
+                              unencrypted_data[0].data(), partition_data_offset))
+  {
+    return false;
+  }
+  for (size_t i = blocks_to_read; i < blocks; ++i)
+    unencrypted_data[i].fill(0);
 
-  std::array<std::future<void>, BLOCKS_PER_GROUP> hash_futures;
-  bool error_occurred = false;
+  Common::ParallelFor(blocks / BLOCKS_PER_SUBGROUP, [&](size_t subgroup) {
+    const size_t h1_base = subgroup * BLOCKS_PER_SUBGROUP;
 
-  for (size_t i = 0; i < BLOCKS_PER_GROUP; ++i)
-  {
-    if (!error_occurred)
+    for (size_t i = h1_base; i < h1_base + BLOCKS_PER_SUBGROUP; ++i)
     {
-      if (offset + (i + 1) * BLOCK_DATA_SIZE <= partition_data_decrypted_size)
-      {
-        if (!blob->ReadWiiDecrypted(offset + i * BLOCK_DATA_SIZE, BLOCK_DATA_SIZE,
-                                    unencrypted_data[i].data(), partition_data_offset))
-        {
-          error_occurred = true;
-        }
-      }
-      else
-      {
-        unencrypted_data[i].fill(0);
-      }
-    }
+      // H0 hashes
+      for (size_t j = 0; j < 31; ++j)
+        CalculateSHA1(unencrypted_data[i].data() + j * 0x400, 0x400, unencrypted_hashes[i].h0[j]);
 
-    hash_futures[i] = std::async(std::launch::async, [&unencrypted_data, &unencrypted_hashes,
-                                                      &hash_futures, error_occurred, i]() {
-      const size_t h1_base = Common::AlignDown(i, 8);
+      // H0 padding
+      std::memset(unencrypted_hashes[i].padding_0, 0, sizeof(HashBlock::padding_0));
 
-      if (!error_occurred)
-      {
-        // H0 hashes
-        for (size_t j = 0; j < 31; ++j)
-        {
-          mbedtls_sha1_ret(unencrypted_data[i].data() + j * 0x400, 0x400,
-                           unencrypted_hashes[i].h0[j]);
-        }
+      // H1 hash
+      CalculateSHA1(reinterpret_cast<u8*>(unencrypted_hashes[i].h0), sizeof(HashBlock::h0),
+                    unencrypted_hashes[h1_base].h1[i - h1_base]);
+    }
 
-        // H0 padding
-        std::memset(unencrypted_hashes[i].padding_0, 0, sizeof(HashBlock::padding_0));
+    // H1 padding
+    std::memset(unencrypted_hashes[h1_base].padding_1, 0, sizeof(HashBlock::padding_1));
 
-        // H1 hash
-        mbedtls_sha1_ret(reinterpret_cast<u8*>(unencrypted_hashes[i].h0), sizeof(HashBlock::h0),
-                         unencrypted_hashes[h1_base].h1[i - h1_base]);
-      }
+    // H1 copies
+    for (size_t j = 1; j < BLOCKS_PER_SUBGROUP; ++j)
+    {
+      std::memcpy(unencrypted_hashes[h1_base + j].h1, unencrypted_hashes[h1_base].h1,
+                  sizeof(HashBlock::h1));
+    }
 
-      if (i % 8 == 7)
-      {
-        for (size_t j = 0; j < 7; ++j)
-          hash_futures[h1_base + j].get();
+    // H2 hash
+    const size_t group_base = Common::AlignDown(h1_base, BLOCKS_PER_GROUP);
+    CalculateSHA1(reinterpret_cast<u8*>(unencrypted_hashes[h1_base].h1), sizeof(HashBlock::h1),
+                  unencrypted_hashes[group_base].h2[subgroup % SUBGROUPS_PER_GROUP]);
+  });
 
-        if (!error_occurred)
-        {
-          // H1 padding
-          std::memset(unencrypted_hashes[h1_base].padding_1, 0, sizeof(HashBlock::padding_1));
-
-          // H1 copies
-          for (size_t j = 1; j < 8; ++j)
-          {
-            std::memcpy(unencrypted_hashes[h1_base + j].h1, unencrypted_hashes[h1_base].h1,
-                        sizeof(HashBlock::h1));
-          }
-
-          // H2 hash
-          mbedtls_sha1_ret(reinterpret_cast<u8*>(unencrypted_hashes[i].h1), sizeof(HashBlock::h1),
-                           unencrypted_hashes[0].h2[h1_base / 8]);
-        }
+  for (size_t group_base = 0; group_base < blocks; group_base += BLOCKS_PER_GROUP)
+  {
+    // H2 padding
+    std::memset(unencrypted_hashes[group_base].padding_2, 0, sizeof(HashBlock::padding_2));
 
-        if (i == BLOCKS_PER_GROUP - 1)
-        {
-          for (size_t j = 0; j < 7; ++j)
-            hash_futures[j * 8 + 7].get();
-
-          if (!error_occurred)
-          {
-            // H2 padding
-            std::memset(unencrypted_hashes[0].padding_2, 0, sizeof(HashBlock::padding_2));
-
-            // H2 copies
-            for (size_t j = 1; j < BLOCKS_PER_GROUP; ++j)
-            {
-              std::memcpy(unencrypted_hashes[j].h2, unencrypted_hashes[0].h2,
-                          sizeof(HashBlock::h2));
-            }
-          }
-        }
-      }
-    });
+    // H2 copies
+    for (size_t j = 1; j < BLOCKS_PER_GROUP; ++j)
+    {
+      std::memcpy(unencrypted_hashes[group_base + j].h2, unencrypted_hashes[group_base].h2,
+                  sizeof(HashBlock::h2));
+    }
   }
 
-  // Wait for all the async tasks to finish
-  hash_futures.back().get();
-
-  if (error_occurred)
-    return false;
-
-  const unsigned int threads =
-      std::min(BLOCKS_PER_GROUP, std::max<unsigned int>(1, std::thread::hardware_concurrency()));
+  const std::unique_ptr<Common::AES::Context> aes_context =
+      Common::AES::CreateContext(key.data(), Common::AES::Mode::Encrypt);
 
-  std::vector<std::future<void>> encryption_futures(threads);
+  Common::ParallelFor(blocks / BLOCKS_PER_SUBGROUP, [&](size_t subgroup) {
+    const size_t start = subgroup * BLOCKS_PER_SUBGROUP;
 
-  mbedtls_aes_context aes_context;
-  mbedtls_aes_setkey_enc(&aes_context, key.data(), 128);
-
-  for (size_t i = 0; i < threads; ++i)
-  {
-    encryption_futures[i] = std::async(
-        std::launch::async,
-        [&unencrypted_data, &unencrypted_hashes, &aes_context, &out](size_t start, size_t end) {
-          for (size_t i = start; i < end; ++i)
-          {
-            u8* out_ptr = out->data() + i * BLOCK_TOTAL_SIZE;
-
-            u8 iv[16] = {};
-            mbedtls_aes_crypt_cbc(&aes_context, MBEDTLS_AES_ENCRYPT, BLOCK_HEADER_SIZE, iv,
-                                  reinterpret_cast<u8*>(&unencrypted_hashes[i]), out_ptr);
-
-            std::memcpy(iv, out_ptr + 0x3D0, sizeof(iv));
-            mbedtls_aes_crypt_cbc(&aes_context, MBEDTLS_AES_ENCRYPT, BLOCK_DATA_SIZE, iv,
-                                  unencrypted_data[i].data(), out_ptr + BLOCK_HEADER_SIZE);
-          }
-        },
-        i * BLOCKS_PER_GROUP / threads, (i + 1) * BLOCKS_PER_GROUP / threads);
-  }
+    // Every block is its own CBC chain, so the blocks of a subgroup are encrypted as one batch.
+    // The hashes have to come first, as the IV of the data is in the encrypted hashes.
+    const u8 zero_iv[16] = {};
+    std::array<Common::AES::Stream, BLOCKS_PER_SUBGROUP> streams;
+    for (size_t j = 0; j < BLOCKS_PER_SUBGROUP; ++j)
+    {
+      const size_t i = start + j;
+      u8* out_ptr = out[i / BLOCKS_PER_GROUP] + i % BLOCKS_PER_GROUP * BLOCK_TOTAL_SIZE;
+      streams[j] = {zero_iv, reinterpret_cast<u8*>(&unencrypted_hashes[i]), out_ptr};
+    }
+    aes_context->CryptBatch(streams.data(), streams.size(), BLOCK_HEADER_SIZE);
 
-  for (std::future<void>& future : encryption_futures)
-    future.get();
+    for (size_t j = 0; j < BLOCKS_PER_SUBGROUP; ++j)
+    {
+      u8* out_ptr = streams[j].dst;
+      streams[j] = {out_ptr + 0x3D0, unencrypted_data[start + j].data(),
+                    out_ptr + BLOCK_HEADER_SIZE};
+    }
+    aes_context->CryptBatch(streams.data(), streams.size(), BLOCK_DATA_SIZE);
+  });
 
   return true;
 }
@@ -5,15 +5,15 @@
 #pragma once
 
 #include <array>
+#include <limits>
 #include <map>
 #include <memory>
 #include <optional>
 #include <string>
 #include <vector>
 
-#include <mbedtls/aes.h>
-
 #include "Common/CommonTypes.h"
+#include "Common/Crypto/AES.h"
 #include "Common/Lazy.h"
 #include "Core/IOS/ES/Formats.h"
 #include "DiscIO/Filesystem.h"
@@ -100,13 +100,20 @@ public:
                            const std::array<u8, AES_KEY_SIZE>& key, BlobReader* blob,
                            std::array<u8, GROUP_TOTAL_SIZE>* out);
 
+  // Builds the hash tree for and encrypts count consecutive groups starting at offset, using all
+  // cores. out has one pointer per group, each pointing to GROUP_TOTAL_SIZE bytes.
+  static bool EncryptGroups(u64 offset, u64 count, u64 partition_data_offset,
+                            u64 partition_data_decrypted_size,
+                            const std::array<u8, AES_KEY_SIZE>& key, BlobReader* blob,
+                            u8* const* out);
+
 protected:
   u32 GetOffsetShift() const override { return 2; }
 
 private:
   struct PartitionDetails
   {
-    Common::Lazy<std::unique_ptr<mbedtls_aes_context>> key;
+    Common::Lazy<std::unique_ptr<Common::AES::Context>> key;
     Common::Lazy<IOS::ES::TicketReader> ticket;
     Common::Lazy<IOS::ES::TMDReader> tmd;
     Common::Lazy<std::vector<u8>> cert_chain;
@@ -116,13 +123,30 @@ private:
     u32 type;
   };
 
+  struct DecryptedBlock
+  {
+    u64 offset_on_disc = std::numeric_limits<u64>::max();
+    u64 last_used = 0;
+    std::array<u8, BLOCK_DATA_SIZE> data;
+  };
+
+  // How many decrypted blocks to keep around, which is enough for one whole group
+  static constexpr size_t DECRYPTED_BLOCK_CACHE_SIZE = BLOCKS_PER_GROUP;
+
+  const u8* FindDecryptedBlock(u64 block_offset_on_disc) const;
+  const u8* DecryptBlocks(u64 block_offset_on_disc, u64 count,
+                          const Common::AES::Context& aes_context) const;
+
   std::unique_ptr<BlobReader> m_reader;
   std::map<Partition, PartitionDetails> m_partitions;
   Partition m_game_partition;
   bool m_encrypted;
 
-  mutable u64 m_last_decrypted_block;
-  mutable u8 m_last_decrypted_block_data[BLOCK_DATA_SIZE];
+  // Least recently used blocks get replaced first. Allocated as needed.
+  mutable std::vector<std::unique_ptr<DecryptedBlock>> m_decrypted_blocks;
+  mutable std::map<u64, DecryptedBlock*> m_decrypted_block_map;
+  mutable u64 m_decrypted_block_counter = 0;
+  mutable std::vector<u8> m_read_buffer;
 };
 
 }  // namespace DiscIO
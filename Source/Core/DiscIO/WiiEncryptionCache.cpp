@@ -4,10 +4,13 @@
 
 #include "DiscIO/WiiEncryptionCache.h"
 
+#include <algorithm>
 #include <array>
 #include <cstring>
 #include <limits>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "Common/Align.h"
 #include "Common/CommonTypes.h"
@@ -22,35 +25,67 @@ WiiEncryptionCache::WiiEncryptionCache(BlobReader* blob) : m_blob(blob)
 
 WiiEncryptionCache::~WiiEncryptionCache() = default;
 
-const std::array<u8, VolumeWii::GROUP_TOTAL_SIZE>*
-WiiEncryptionCache::EncryptGroup(u64 offset, u64 partition_data_offset,
-                                 u64 partition_data_decrypted_size, const Key& key)
+WiiEncryptionCache::CachedGroup* WiiEncryptionCache::FindGroup(u64 group_offset_on_disc)
+{
+  const auto it = std::find_if(m_cache.begin(), m_cache.end(), [&](const CachedGroup& group) {
+    return group.offset == group_offset_on_disc;
+  });
+  if (it == m_cache.end())
+    return nullptr;
+
+  it->last_used = ++m_use_counter;
+  return &*it;
+}
+
+WiiEncryptionCache::CachedGroup& WiiEncryptionCache::ReplaceGroup(u64 group_offset_on_disc)
 {
   // Only allocate memory if this function actually ends up getting called
-  if (!m_cache)
+  if (m_cache.empty())
   {
-    m_cache = std::make_unique<std::array<u8, VolumeWii::GROUP_TOTAL_SIZE>>();
+    m_cache.resize(CACHED_GROUPS);
     ASSERT(m_blob->SupportsReadWiiDecrypted());
   }
 
+  // Replace the least recently used group
+  CachedGroup& group = *std::min_element(
+      m_cache.begin(), m_cache.end(),
+      [](const CachedGroup& a, const CachedGroup& b) { return a.last_used < b.last_used; });
+  if (!group.data)
+    group.data = std::make_unique<std::array<u8, VolumeWii::GROUP_TOTAL_SIZE>>();
+
+  group.offset = group_offset_on_disc;
+  group.last_used = ++m_use_counter;
+  return group;
+}
+
+void WiiEncryptionCache::Invalidate(const CachedGroup* group)
+{
+  CachedGroup& entry = m_cache[group - m_cache.data()];
+  entry.offset = std::numeric_limits<u64>::max();
+  entry.last_used = 0;
+}
+
+const std::array<u8, VolumeWii::GROUP_TOTAL_SIZE>*
+WiiEncryptionCache::EncryptGroup(u64 offset, u64 partition_data_offset,
+                                 u64 partition_data_decrypted_size, const Key& key)
+{
   ASSERT(offset % VolumeWii::GROUP_TOTAL_SIZE == 0);
   const u64 group_offset_in_partition =
       offset / VolumeWii::GROUP_TOTAL_SIZE * VolumeWii::GROUP_DATA_SIZE;
   const u64 group_offset_on_disc = partition_data_offset + offset;
 
-  if (m_cached_offset != group_offset_on_disc)
-  {
-    if (!VolumeWii::EncryptGroup(group_offset_in_partition, partition_data_offset,
-                                 partition_data_decrypted_size, key, m_blob, m_cache.get()))
-    {
-      m_cached_offset = std::numeric_limits<u64>::max();  // Invalidate the cache
-      return nullptr;
-    }
+  if (CachedGroup* group = FindGroup(group_offset_on_disc))
+    return group->data.get();
 
-    m_cached_offset = group_offset_on_disc;
+  CachedGroup& group = ReplaceGroup(group_offset_on_disc);
+  if (!VolumeWii::EncryptGroup(group_offset_in_partition, partition_data_offset,
+                               partition_data_decrypted_size, key, m_blob, group.data.get()))
+  {
+    Invalidate(&group);
+    return nullptr;
   }
 
-  return m_cache.get();
+  return group.data.get();
 }
 
 bool WiiEncryptionCache::EncryptGroups(u64 offset, u64 size, u8* out_ptr, u64 partition_data_offset,
@@ -58,20 +93,71 @@ bool WiiEncryptionCache::EncryptGroups(u64 offset, u64 size, u8* out_ptr, u64 pa
 {
   while (size > 0)
   {
-    const std::array<u8, VolumeWii::GROUP_TOTAL_SIZE>* group =
-        EncryptGroup(Common::AlignDown(offset, VolumeWii::GROUP_TOTAL_SIZE), partition_data_offset,
-                     partition_data_decrypted_size, key);
+    const u64 group_offset = Common::AlignDown(offset, VolumeWii::GROUP_TOTAL_SIZE);
+    const u64 offset_in_group = offset % VolumeWii::GROUP_TOTAL_SIZE;
+
+    if (const CachedGroup* group = FindGroup(partition_data_offset + group_offset))
+    {
+      const u64 bytes_to_read = std::min(VolumeWii::GROUP_TOTAL_SIZE - offset_in_group, size);
+      std::memcpy(out_ptr, group->data->data() + offset_in_group, bytes_to_read);
+
+      offset += bytes_to_read;
+      size -= bytes_to_read;
+      out_ptr += bytes_to_read;
+      continue;
+    }
 
-    if (!group)
+    // Encrypt this group and the uncached groups after it that are part of this read all at
+    // once, so that the work can be spread across all cores. Groups that are read in full are
+    // encrypted straight into the output buffer, the others go through the cache.
+    const u64 end_offset = offset + size;
+    std::vector<u8*> group_ptrs;
+    std::vector<std::pair<u64, const CachedGroup*>> partial_groups;
+    for (u64 i = group_offset; i < end_offset && group_ptrs.size() < MAX_GROUPS_PER_BATCH;
+         i += VolumeWii::GROUP_TOTAL_SIZE)
+    {
+      if (i != group_offset && FindGroup(partition_data_offset + i))
+        break;
+
+      if (i >= offset && i + VolumeWii::GROUP_TOTAL_SIZE <= end_offset)
+      {
+        group_ptrs.push_back(out_ptr + (i - offset));
+      }
+      else
+      {
+        CachedGroup& group = ReplaceGroup(partition_data_offset + i);
+        group_ptrs.push_back(group.data->data());
+        partial_groups.emplace_back(i, &group);
+      }
+    }
+
+    const u64 group_offset_in_partition =
+        group_offset / VolumeWii::GROUP_TOTAL_SIZE * VolumeWii::GROUP_DATA_SIZE;
+    if (!VolumeWii::EncryptGroups(group_offset_in_partition, group_ptrs.size(),
+                                  partition_data_offset, partition_data_decrypted_size, key, m_blob,
+                                  group_ptrs.data()))
+    {
+      for (const auto& partial_group : partial_groups)
+        Invalidate(partial_group.second);
       return false;
+    }
 
-    const u64 offset_in_group = offset % VolumeWii::GROUP_TOTAL_SIZE;
-    const u64 bytes_to_read = std::min(VolumeWii::GROUP_TOTAL_SIZE - offset_in_group, size);
-    std::memcpy(out_ptr, group->data() + offset_in_group, bytes_to_read);
+    const u64 batch_end_offset =
+        std::min(group_offset + group_ptrs.size() * VolumeWii::GROUP_TOTAL_SIZE, end_offset);
+    for (const auto& [partial_group_offset, group] : partial_groups)
+    {
+      const u64 copy_start = std::max(partial_group_offset, offset);
+      const u64 copy_end =
+          std::min(partial_group_offset + VolumeWii::GROUP_TOTAL_SIZE, batch_end_offset);
+      std::memcpy(out_ptr + (copy_start - offset),
+                  group->data->data() + (copy_start - partial_group_offset),
+                  copy_end - copy_start);
+    }
 
-    offset += bytes_to_read;
-    size -= bytes_to_read;
-    out_ptr += bytes_to_read;
+    const u64 batch_size = batch_end_offset - offset;
+    offset += batch_size;
+    size -= batch_size;
+    out_ptr += batch_size;
   }
 
   return true;
@@ -7,6 +7,7 @@
 #include <array>
 #include <limits>
 #include <memory>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "DiscIO/VolumeWii.h"
@@ -28,20 +29,39 @@ public:
   // If the returned pointer is nullptr, reading from the blob failed.
   // If the returned pointer is not nullptr, it is guaranteed to be valid until
   // the next call of this function or the destruction of this object.
+  // The last few groups are kept, so that reads that jump back and forth between
+  // nearby groups don't have to encrypt the same group over and over.
   const std::array<u8, VolumeWii::GROUP_TOTAL_SIZE>* EncryptGroup(u64 offset,
                                                                   u64 partition_data_offset,
                                                                   u64 partition_data_decrypted_size,
                                                                   const Key& key);
 
   // Encrypts a variable number of groups, as determined by the offset and size parameters.
-  // Supports reading groups partially.
+  // Supports reading groups partially. Consecutive groups that aren't cached are encrypted
+  // in parallel.
   bool EncryptGroups(u64 offset, u64 size, u8* out_ptr, u64 partition_data_offset,
                      u64 partition_data_decrypted_size, const Key& key);
 
 private:
+  static constexpr size_t CACHED_GROUPS = 4;
+
+  // How many groups EncryptGroups encrypts at once when reading large amounts of data
+  static constexpr size_t MAX_GROUPS_PER_BATCH = 16;
+
+  struct CachedGroup
+  {
+    u64 offset = std::numeric_limits<u64>::max();
+    u64 last_used = 0;
+    std::unique_ptr<std::array<u8, VolumeWii::GROUP_TOTAL_SIZE>> data;
+  };
+
+  CachedGroup* FindGroup(u64 group_offset_on_disc);
+  CachedGroup& ReplaceGroup(u64 group_offset_on_disc);
+  void Invalidate(const CachedGroup* group);
+
   BlobReader* m_blob;
-  std::unique_ptr<std::array<u8, VolumeWii::GROUP_TOTAL_SIZE>> m_cache;
-  u64 m_cached_offset = std::numeric_limits<u64>::max();
+  std::vector<CachedGroup> m_cache;
+  u64 m_use_counter = 0;
 };
 
 }  // namespace DiscIO
@@ -268,18 +268,10 @@ void FIFOPlayerWindow::UpdateInfo()
   if (FifoRecorder::GetInstance().IsRecordingDone())
   {
     FifoDataFile* file = FifoRecorder::GetInstance().GetRecordedFile();
-    size_t fifo_bytes = 0;
-    size_t mem_bytes = 0;
-
-    for (u32 i = 0; i < file->GetFrameCount(); ++i)
-    {
-      fifo_bytes += file->GetFrame(i).fifoData.size();
-      for (const auto& mem_update : file->GetFrame(i).memoryUpdates)
-        mem_bytes += mem_update.data.size();
-    }
 
     m_info_label->setText(tr("%1 FIFO bytes\n%2 memory bytes\n%3 frames")
-                              .arg(QString::number(fifo_bytes), QString::number(mem_bytes),
+                              .arg(QString::number(file->GetFifoDataSize()),
+                                   QString::number(file->GetMemoryUpdatesSize()),
                                    QString::number(file->GetFrameCount())));
     return;
   }
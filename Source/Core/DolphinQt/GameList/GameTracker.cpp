@@ -4,6 +4,10 @@
 
 #include "DolphinQt/GameList/GameTracker.h"
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include <QDir>
 #include <QDirIterator>
 #include <QFile>
@@ -251,6 +255,7 @@ void GameTracker::RemoveDirectoryInternal(const QString& dir)
 
 void GameTracker::UpdateDirectoryInternal(const QString& dir)
 {
+  QStringList new_paths;
   auto it = GetIterator(dir);
   while (it->hasNext())
   {
@@ -266,10 +271,12 @@ void GameTracker::UpdateDirectoryInternal(const QString& dir)
     {
       AddPath(path);
       m_tracked_files[path] = QSet<QString>{dir};
-      LoadGame(path);
+      new_paths.push_back(path);
     }
   }
 
+  LoadGames(new_paths);
+
   for (const auto& missing : FindMissingFiles(dir))
   {
     auto& tracked_file = m_tracked_files[missing];
@@ -324,20 +331,36 @@ QSet<QString> GameTracker::FindMissingFiles(const QString& dir)
 }
 
 void GameTracker::LoadGame(const QString& path)
+{
+  LoadGames(QStringList{path});
+}
+
+void GameTracker::LoadGames(const QStringList& paths)
 {
   if (!m_started)
     return;
 
-  const std::string converted_path = path.toStdString();
-  if (!DiscIO::ShouldHideFromGameList(converted_path))
+  std::vector<std::string> converted_paths;
+  converted_paths.reserve(paths.size());
+  for (const QString& path : paths)
+  {
+    std::string converted_path = path.toStdString();
+    if (!DiscIO::ShouldHideFromGameList(converted_path))
+      converted_paths.push_back(std::move(converted_path));
+  }
+
+  if (converted_paths.empty())
+    return;
+
+  // Files that aren't cached yet are loaded in parallel, and the cache is only saved once.
+  bool cache_changed = false;
+  for (auto& game : m_cache.AddOrGet(converted_paths, &cache_changed))
   {
-    bool cache_changed = false;
-    auto game = m_cache.AddOrGet(converted_path, &cache_changed);
     if (game)
       emit GameLoaded(std::move(game));
-    if (cache_changed)
-      m_cache.Save();
   }
+  if (cache_changed)
+    m_cache.Save();
 }
 
 void GameTracker::PurgeCache()
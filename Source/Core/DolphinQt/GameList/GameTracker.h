@@ -11,6 +11,7 @@
 #include <QMap>
 #include <QSet>
 #include <QString>
+#include <QStringList>
 #include <QVector>
 
 #include "Common/Event.h"
@@ -59,6 +60,7 @@ private:
   void UpdateFileInternal(const QString& path);
   QSet<QString> FindMissingFiles(const QString& dir);
   void LoadGame(const QString& path);
+  void LoadGames(const QStringList& paths);
 
   bool AddPath(const QString& path);
   bool RemovePath(const QString& path);
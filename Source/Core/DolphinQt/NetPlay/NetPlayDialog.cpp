@@ -18,6 +18,7 @@
 #include <QSignalBlocker>
 #include <QSpinBox>
 #include <QSplitter>
+#include <QStringList>
 #include <QTableWidget>
 #include <QTextBrowser>
 
@@ -120,6 +121,11 @@ void NetPlayDialog::CreateMainLayout()
          "resolution.\nMay prevent desync in some games that use EFB reads. Please ensure everyone "
          "uses the same video backend."));
   m_strict_settings_sync_action->setCheckable(true);
+  m_diagnose_desyncs_action = m_data_menu->addAction(tr("Diagnose Desyncs"));
+  m_diagnose_desyncs_action->setToolTip(
+      tr("Every player hashes the emulated memory after each frame, so that the memory which "
+         "differs can be narrowed down when a desync is detected.\nSlows down emulation."));
+  m_diagnose_desyncs_action->setCheckable(true);
 
   m_network_menu = m_menu_bar->addMenu(tr("Network"));
   m_network_menu->setToolTipsVisible(true);
@@ -141,12 +147,19 @@ void NetPlayDialog::CreateMainLayout()
          "switched at any time.\nSuitable for turn-based games with timing-sensitive controls, "
          "such as golf."));
   m_golf_mode_action->setCheckable(true);
+  m_rollback_action = m_network_menu->addAction(tr("Rollback"));
+  m_rollback_action->setToolTip(
+      tr("Each player's inputs take effect immediately, and the inputs of other players are "
+         "predicted until they arrive, rolling the game back when a prediction was wrong."
+         "\nSuitable for fast-paced games using only GameCube controllers, on fast computers."));
+  m_rollback_action->setCheckable(true);
 
   m_network_mode_group = new QActionGroup(this);
   m_network_mode_group->setExclusive(true);
   m_network_mode_group->addAction(m_fixed_delay_action);
   m_network_mode_group->addAction(m_host_input_authority_action);
   m_network_mode_group->addAction(m_golf_mode_action);
+  m_network_mode_group->addAction(m_rollback_action);
   m_fixed_delay_action->setChecked(true);
 
   m_md5_menu = m_menu_bar->addMenu(tr("Checksum"));
@@ -312,6 +325,7 @@ void NetPlayDialog::ConnectWidgets()
           [hia_function] { hia_function(true); });
   connect(m_golf_mode_action, &QAction::toggled, this, [hia_function] { hia_function(true); });
   connect(m_fixed_delay_action, &QAction::toggled, this, [hia_function] { hia_function(false); });
+  connect(m_rollback_action, &QAction::toggled, this, [hia_function] { hia_function(false); });
 
   connect(m_start_button, &QPushButton::clicked, this, &NetPlayDialog::OnStart);
   connect(m_quit_button, &QPushButton::clicked, this, &NetPlayDialog::reject);
@@ -353,9 +367,11 @@ void NetPlayDialog::ConnectWidgets()
   connect(m_sync_codes_action, &QAction::toggled, this, &NetPlayDialog::SaveSettings);
   connect(m_record_input_action, &QAction::toggled, this, &NetPlayDialog::SaveSettings);
   connect(m_strict_settings_sync_action, &QAction::toggled, this, &NetPlayDialog::SaveSettings);
+  connect(m_diagnose_desyncs_action, &QAction::toggled, this, &NetPlayDialog::SaveSettings);
   connect(m_host_input_authority_action, &QAction::toggled, this, &NetPlayDialog::SaveSettings);
   connect(m_sync_all_wii_saves_action, &QAction::toggled, this, &NetPlayDialog::SaveSettings);
   connect(m_golf_mode_action, &QAction::toggled, this, &NetPlayDialog::SaveSettings);
+  connect(m_rollback_action, &QAction::toggled, this, &NetPlayDialog::SaveSettings);
   connect(m_golf_mode_overlay_action, &QAction::toggled, this, &NetPlayDialog::SaveSettings);
   connect(m_fixed_delay_action, &QAction::toggled, this, &NetPlayDialog::SaveSettings);
 }
@@ -495,11 +511,13 @@ void NetPlayDialog::OnStart()
   settings.m_EFBAccessTileSize = Config::Get(Config::GFX_HACK_EFB_ACCESS_TILE_SIZE);
   settings.m_EFBAccessDeferInvalidation = Config::Get(Config::GFX_HACK_EFB_DEFER_INVALIDATION);
   settings.m_StrictSettingsSync = m_strict_settings_sync_action->isChecked();
+  settings.m_DiagnoseDesyncs = m_diagnose_desyncs_action->isChecked();
   settings.m_SyncSaveData = m_sync_save_data_action->isChecked();
   settings.m_SyncCodes = m_sync_codes_action->isChecked();
   settings.m_SyncAllWiiSaves =
       m_sync_all_wii_saves_action->isChecked() && m_sync_save_data_action->isChecked();
   settings.m_GolfMode = m_golf_mode_action->isChecked();
+  settings.m_Rollback = m_rollback_action->isChecked();
 
   // Unload GameINI to restore things to normal
   Config::RemoveLayer(Config::LayerType::GlobalGame);
@@ -832,9 +850,11 @@ void NetPlayDialog::SetOptionsEnabled(bool enabled)
     m_sync_codes_action->setEnabled(enabled);
     m_assign_ports_button->setEnabled(enabled);
     m_strict_settings_sync_action->setEnabled(enabled);
+    m_diagnose_desyncs_action->setEnabled(enabled);
     m_host_input_authority_action->setEnabled(enabled);
     m_sync_all_wii_saves_action->setEnabled(enabled && m_sync_save_data_action->isChecked());
     m_golf_mode_action->setEnabled(enabled);
+    m_rollback_action->setEnabled(enabled);
     m_fixed_delay_action->setEnabled(enabled);
   }
 
@@ -941,6 +961,27 @@ void NetPlayDialog::OnDesync(u32 frame, const std::string& player)
                  "red", OSD::Duration::VERY_LONG);
 }
 
+void NetPlayDialog::OnDesyncDiagnosed(u32 frame, const std::vector<std::string>& regions)
+{
+  if (regions.empty())
+  {
+    DisplayMessage(tr("Memory first differed at frame %1, but the differences couldn't be "
+                      "narrowed down")
+                       .arg(frame),
+                   "red", OSD::Duration::VERY_LONG);
+    return;
+  }
+
+  QStringList region_list;
+  for (const std::string& region : regions)
+    region_list.append(QString::fromStdString(region));
+
+  DisplayMessage(tr("Memory first differed at frame %1 in: %2")
+                     .arg(frame)
+                     .arg(region_list.join(QStringLiteral(", "))),
+                 "red", OSD::Duration::VERY_LONG);
+}
+
 void NetPlayDialog::OnConnectionLost()
 {
   DisplayMessage(tr("Lost connection to NetPlay server..."), "red");
@@ -1056,6 +1097,7 @@ void NetPlayDialog::LoadSettings()
   const bool sync_codes = Config::Get(Config::NETPLAY_SYNC_CODES);
   const bool record_inputs = Config::Get(Config::NETPLAY_RECORD_INPUTS);
   const bool strict_settings_sync = Config::Get(Config::NETPLAY_STRICT_SETTINGS_SYNC);
+  const bool diagnose_desyncs = Config::Get(Config::NETPLAY_DIAGNOSE_DESYNCS);
   const bool sync_all_wii_saves = Config::Get(Config::NETPLAY_SYNC_ALL_WII_SAVES);
   const bool golf_mode_overlay = Config::Get(Config::NETPLAY_GOLF_MODE_OVERLAY);
 
@@ -1066,6 +1108,7 @@ void NetPlayDialog::LoadSettings()
   m_sync_codes_action->setChecked(sync_codes);
   m_record_input_action->setChecked(record_inputs);
   m_strict_settings_sync_action->setChecked(strict_settings_sync);
+  m_diagnose_desyncs_action->setChecked(diagnose_desyncs);
   m_sync_all_wii_saves_action->setChecked(sync_all_wii_saves);
   m_golf_mode_overlay_action->setChecked(golf_mode_overlay);
 
@@ -1083,6 +1126,10 @@ void NetPlayDialog::LoadSettings()
   {
     m_golf_mode_action->setChecked(true);
   }
+  else if (network_mode == "rollback")
+  {
+    m_rollback_action->setChecked(true);
+  }
   else
   {
     WARN_LOG(NETPLAY, "Unknown network mode '%s', using 'fixeddelay'", network_mode.c_str());
@@ -1105,6 +1152,7 @@ void NetPlayDialog::SaveSettings()
   Config::SetBase(Config::NETPLAY_SYNC_CODES, m_sync_codes_action->isChecked());
   Config::SetBase(Config::NETPLAY_RECORD_INPUTS, m_record_input_action->isChecked());
   Config::SetBase(Config::NETPLAY_STRICT_SETTINGS_SYNC, m_strict_settings_sync_action->isChecked());
+  Config::SetBase(Config::NETPLAY_DIAGNOSE_DESYNCS, m_diagnose_desyncs_action->isChecked());
   Config::SetBase(Config::NETPLAY_SYNC_ALL_WII_SAVES, m_sync_all_wii_saves_action->isChecked());
   Config::SetBase(Config::NETPLAY_GOLF_MODE_OVERLAY, m_golf_mode_overlay_action->isChecked());
 
@@ -1121,6 +1169,10 @@ void NetPlayDialog::SaveSettings()
   {
     network_mode = "golf";
   }
+  else if (m_rollback_action->isChecked())
+  {
+    network_mode = "rollback";
+  }
 
   Config::SetBase(Config::NETPLAY_NETWORK_MODE, network_mode);
 }
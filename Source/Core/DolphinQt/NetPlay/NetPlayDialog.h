@@ -54,6 +54,7 @@ public:
   void OnPadBufferChanged(u32 buffer) override;
   void OnHostInputAuthorityChanged(bool enabled) override;
   void OnDesync(u32 frame, const std::string& player) override;
+  void OnDesyncDiagnosed(u32 frame, const std::vector<std::string>& regions) override;
   void OnConnectionLost() override;
   void OnConnectionError(const std::string& message) override;
   void OnTraversalError(TraversalClient::FailureReason error) override;
@@ -132,10 +133,12 @@ private:
   QAction* m_sync_codes_action;
   QAction* m_record_input_action;
   QAction* m_strict_settings_sync_action;
+  QAction* m_diagnose_desyncs_action;
   QAction* m_host_input_authority_action;
   QAction* m_sync_all_wii_saves_action;
   QAction* m_golf_mode_action;
   QAction* m_golf_mode_overlay_action;
+  QAction* m_rollback_action;
   QAction* m_fixed_delay_action;
   QPushButton* m_quit_button;
   QSplitter* m_splitter;
@@ -0,0 +1,212 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "InputCommon/ControlReference/CompiledExpression.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+
+#include "InputCommon/ControlReference/ExpressionParser.h"
+#include "InputCommon/ControlReference/FunctionExpression.h"
+
+namespace ciface::ExpressionParser
+{
+// Enough for all but the most complex expressions
+constexpr u32 STACK_REGISTER_COUNT = 32;
+
+static u32 GetArgCount(Opcode op)
+{
+  switch (op)
+  {
+  case Opcode::Input:
+  case Opcode::Variable:
+  case Opcode::Call:
+    return 0;
+  case Opcode::Not:
+  case Opcode::Minus:
+  case Opcode::Sin:
+    return 1;
+  case Opcode::Select:
+    return 3;
+  default:
+    return 2;
+  }
+}
+
+// Must match the GetValue of the corresponding expressions
+static ControlState Evaluate(Opcode op, ControlState a, ControlState b, ControlState c)
+{
+  switch (op)
+  {
+  case Opcode::Not:
+    return 1.0 - a;
+  case Opcode::Minus:
+    return 0.0 - a;
+  case Opcode::Sin:
+    return std::sin(a);
+  case Opcode::Deadzone:
+    return std::copysign(std::max(0.0, std::abs(a) - b) / (1.0 - b), a);
+  case Opcode::Select:
+    return a > CONDITION_THRESHOLD ? b : c;
+  case Opcode::And:
+    return std::min(a, b);
+  case Opcode::Or:
+    return std::max(a, b);
+  case Opcode::Add:
+    return a + b;
+  case Opcode::Sub:
+    return a - b;
+  case Opcode::Mul:
+    return a * b;
+  case Opcode::Div:
+  {
+    const ControlState result = a / b;
+    return std::isinf(result) ? 0.0 : result;
+  }
+  case Opcode::Mod:
+  {
+    const ControlState result = std::fmod(a, b);
+    return std::isnan(result) ? 0.0 : result;
+  }
+  case Opcode::LessThan:
+    return a < b;
+  case Opcode::GreaterThan:
+    return a > b;
+  case Opcode::Xor:
+    return std::max(std::min(1 - a, b), std::min(a, 1 - b));
+  default:
+    assert(false);
+    return 0.0;
+  }
+}
+
+ControlState CompiledExpression::GetValue() const
+{
+  // The UI polls controls while the emulation does, so the registers live on the stack
+  std::array<ControlState, STACK_REGISTER_COUNT> stack_registers;
+  std::vector<ControlState> heap_registers;
+  ControlState* registers = stack_registers.data();
+  if (m_register_count > STACK_REGISTER_COUNT)
+  {
+    heap_registers.resize(m_register_count);
+    registers = heap_registers.data();
+  }
+  std::copy(m_constants.begin(), m_constants.end(), registers);
+
+  for (const Instruction& instruction : m_program)
+  {
+    ControlState& dest = registers[instruction.dest];
+    switch (instruction.op)
+    {
+    case Opcode::Input:
+      dest = std::max(0.0, instruction.input->GetState());
+      break;
+    case Opcode::Variable:
+      dest = *instruction.variable;
+      break;
+    case Opcode::Call:
+      dest = instruction.expression->GetValue();
+      break;
+    default:
+      dest = Evaluate(instruction.op, registers[instruction.args[0]],
+                      registers[instruction.args[1]], registers[instruction.args[2]]);
+      break;
+    }
+  }
+
+  return registers[m_result];
+}
+
+CompiledExpression ExpressionCompiler::Compile(const Expression& expression)
+{
+  ExpressionCompiler compiler;
+  compiler.m_result.m_result = expression.Compile(compiler);
+  return std::move(compiler.m_result);
+}
+
+u32 ExpressionCompiler::NewRegister(bool is_constant, ControlState value)
+{
+  const u32 reg = m_result.m_register_count++;
+  m_result.m_constants.push_back(value);
+  m_is_constant.push_back(is_constant);
+  return reg;
+}
+
+u32 ExpressionCompiler::Constant(ControlState value)
+{
+  return NewRegister(true, value);
+}
+
+u32 ExpressionCompiler::Input(const Core::Device::Input* input)
+{
+  if (!input)
+    return Constant(0.0);
+
+  CompiledExpression::Instruction instruction{Opcode::Input, NewRegister(false, 0.0)};
+  instruction.input = input;
+  m_result.m_program.push_back(instruction);
+  return instruction.dest;
+}
+
+u32 ExpressionCompiler::Variable(const ControlState* variable)
+{
+  CompiledExpression::Instruction instruction{Opcode::Variable, NewRegister(false, 0.0)};
+  instruction.variable = variable;
+  m_result.m_program.push_back(instruction);
+  return instruction.dest;
+}
+
+u32 ExpressionCompiler::Call(const Expression& expression)
+{
+  CompiledExpression::Instruction instruction{Opcode::Call, NewRegister(false, 0.0)};
+  instruction.expression = &expression;
+  m_result.m_program.push_back(instruction);
+  ++m_call_count;
+  return instruction.dest;
+}
+
+u32 ExpressionCompiler::Op(Opcode op, u32 arg0, u32 arg1, u32 arg2)
+{
+  const u32 arg_count = GetArgCount(op);
+  const u32 args[3] = {arg0, arg1, arg2};
+
+  // Only the selected branch is needed if the condition is known
+  if (op == Opcode::Select && IsConstant(arg0))
+    return GetConstant(arg0) > CONDITION_THRESHOLD ? arg1 : arg2;
+
+  if (std::all_of(args, args + arg_count, [this](u32 arg) { return IsConstant(arg); }))
+  {
+    return Constant(Evaluate(op, arg_count > 0 ? GetConstant(arg0) : 0.0,
+                             arg_count > 1 ? GetConstant(arg1) : 0.0,
+                             arg_count > 2 ? GetConstant(arg2) : 0.0));
+  }
+
+  CompiledExpression::Instruction instruction{op, NewRegister(false, 0.0)};
+  for (u32 i = 0; i < 3; ++i)
+    instruction.args[i] = i < arg_count ? args[i] : 0;
+  m_result.m_program.push_back(instruction);
+  return instruction.dest;
+}
+
+ExpressionCompiler::Checkpoint ExpressionCompiler::Save() const
+{
+  return {m_result.m_program.size(), m_result.m_register_count, m_call_count};
+}
+
+bool ExpressionCompiler::HasCallsSince(const Checkpoint& checkpoint) const
+{
+  return m_call_count != checkpoint.call_count;
+}
+
+void ExpressionCompiler::Restore(const Checkpoint& checkpoint)
+{
+  m_result.m_program.resize(checkpoint.instruction_count);
+  m_result.m_register_count = checkpoint.register_count;
+  m_result.m_constants.resize(checkpoint.register_count);
+  m_is_constant.resize(checkpoint.register_count);
+  m_call_count = checkpoint.call_count;
+}
+}  // namespace ciface::ExpressionParser
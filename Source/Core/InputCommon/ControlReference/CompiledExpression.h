@@ -0,0 +1,109 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "InputCommon/ControllerInterface/Device.h"
+
+namespace ciface::ExpressionParser
+{
+class Expression;
+
+enum class Opcode : u8
+{
+  // Reads an input, clamping off negative values like ControlExpression
+  Input,
+  Variable,
+  // Evaluates an expression that can't be compiled, e.g. because it has state
+  Call,
+
+  Not,
+  Minus,
+  Sin,
+  Deadzone,
+  Select,
+
+  And,
+  Or,
+  Add,
+  Sub,
+  Mul,
+  Div,
+  Mod,
+  LessThan,
+  GreaterThan,
+  Xor,
+};
+
+// A flat program that computes the value of an expression tree. Every instruction writes a new
+// register. Registers that hold constants are initialized when the program is compiled, so
+// constant subexpressions and unbound controls cost nothing when the program runs.
+class CompiledExpression
+{
+public:
+  ControlState GetValue() const;
+
+  size_t GetInstructionCount() const { return m_program.size(); }
+
+private:
+  friend class ExpressionCompiler;
+
+  struct Instruction
+  {
+    Opcode op;
+    u32 dest;
+    u32 args[3];
+    union
+    {
+      const Core::Device::Input* input;
+      const ControlState* variable;
+      const Expression* expression;
+    };
+  };
+
+  std::vector<Instruction> m_program;
+  std::vector<ControlState> m_constants;
+  u32 m_register_count = 0;
+  u32 m_result = 0;
+};
+
+class ExpressionCompiler
+{
+public:
+  struct Checkpoint
+  {
+    size_t instruction_count;
+    u32 register_count;
+    size_t call_count;
+  };
+
+  // The expression must have been bound with UpdateReferences, and must outlive the program
+  static CompiledExpression Compile(const Expression& expression);
+
+  u32 Constant(ControlState value);
+  u32 Input(const Core::Device::Input* input);
+  u32 Variable(const ControlState* variable);
+  u32 Call(const Expression& expression);
+  u32 Op(Opcode op, u32 arg0, u32 arg1 = 0, u32 arg2 = 0);
+
+  bool IsConstant(u32 reg) const { return m_is_constant[reg]; }
+  ControlState GetConstant(u32 reg) const { return m_result.m_constants[reg]; }
+
+  // Allows compiling subexpressions speculatively, e.g. the branches of an if that are only
+  // evaluated eagerly if that has no side effects
+  Checkpoint Save() const;
+  bool HasCallsSince(const Checkpoint& checkpoint) const;
+  void Restore(const Checkpoint& checkpoint);
+
+private:
+  u32 NewRegister(bool is_constant, ControlState value);
+
+  CompiledExpression m_result;
+  std::vector<bool> m_is_constant;
+  size_t m_call_count = 0;
+};
+}  // namespace ciface::ExpressionParser
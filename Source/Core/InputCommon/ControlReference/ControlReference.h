@@ -6,7 +6,9 @@
 
 #include <cmath>
 #include <memory>
+#include <optional>
 
+#include "InputCommon/ControlReference/CompiledExpression.h"
 #include "InputCommon/ControlReference/ExpressionParser.h"
 #include "InputCommon/ControllerInterface/Device.h"
 
@@ -46,6 +48,8 @@ protected:
   ControlReference();
   std::string m_expression;
   std::unique_ptr<ciface::ExpressionParser::Expression> m_parsed_expression;
+  // Compiled from m_parsed_expression once it is bound, which makes polling inputs cheaper
+  std::optional<ciface::ExpressionParser::CompiledExpression> m_compiled_expression;
   ciface::ExpressionParser::ParseStatus m_parse_status;
 };
 
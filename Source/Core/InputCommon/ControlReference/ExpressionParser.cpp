@@ -14,6 +14,7 @@
 #include "Common/Common.h"
 #include "Common/StringUtil.h"
 
+#include "InputCommon/ControlReference/CompiledExpression.h"
 #include "InputCommon/ControlReference/ExpressionParser.h"
 #include "InputCommon/ControlReference/FunctionExpression.h"
 
@@ -189,6 +190,11 @@ ParseStatus Lexer::Tokenize(std::vector<Token>& tokens)
   return ParseStatus::Successful;
 }
 
+u32 Expression::Compile(ExpressionCompiler& compiler) const
+{
+  return compiler.Call(*this);
+}
+
 class ControlExpression : public Expression
 {
 public:
@@ -221,6 +227,7 @@ public:
     input = env.FindInput(qualifier);
     output = env.FindOutput(qualifier);
   }
+  u32 Compile(ExpressionCompiler& compiler) const override { return compiler.Input(input); }
 
 private:
   ControlQualifier qualifier;
@@ -310,6 +317,48 @@ public:
     lhs->UpdateReferences(env);
     rhs->UpdateReferences(env);
   }
+
+  u32 Compile(ExpressionCompiler& compiler) const override
+  {
+    switch (op)
+    {
+    case TOK_AND:
+      return CompileOp(compiler, Opcode::And);
+    case TOK_OR:
+      return CompileOp(compiler, Opcode::Or);
+    case TOK_ADD:
+      return CompileOp(compiler, Opcode::Add);
+    case TOK_SUB:
+      return CompileOp(compiler, Opcode::Sub);
+    case TOK_MUL:
+      return CompileOp(compiler, Opcode::Mul);
+    case TOK_DIV:
+      return CompileOp(compiler, Opcode::Div);
+    case TOK_MOD:
+      return CompileOp(compiler, Opcode::Mod);
+    case TOK_LTHAN:
+      return CompileOp(compiler, Opcode::LessThan);
+    case TOK_GTHAN:
+      return CompileOp(compiler, Opcode::GreaterThan);
+    case TOK_XOR:
+      return CompileOp(compiler, Opcode::Xor);
+    case TOK_COMMA:
+    {
+      lhs->Compile(compiler);
+      return rhs->Compile(compiler);
+    }
+    default:
+      return compiler.Call(*this);
+    }
+  }
+
+private:
+  u32 CompileOp(ExpressionCompiler& compiler, Opcode opcode) const
+  {
+    const u32 lhs_reg = lhs->Compile(compiler);
+    const u32 rhs_reg = rhs->Compile(compiler);
+    return compiler.Op(opcode, lhs_reg, rhs_reg);
+  }
 };
 
 class LiteralExpression : public Expression
@@ -340,6 +389,8 @@ public:
 
   std::string GetName() const override { return ValueToString(m_value); }
 
+  u32 Compile(ExpressionCompiler& compiler) const override { return compiler.Constant(m_value); }
+
 private:
   const ControlState m_value{};
 };
@@ -369,6 +420,11 @@ public:
     m_value_ptr = env.GetVariablePtr(m_name);
   }
 
+  u32 Compile(ExpressionCompiler& compiler) const override
+  {
+    return compiler.Variable(m_value_ptr);
+  }
+
 protected:
   const std::string m_name;
   ControlState* m_value_ptr{};
@@ -393,6 +449,10 @@ public:
     m_lhs->UpdateReferences(env);
     m_rhs->UpdateReferences(env);
   }
+  u32 Compile(ExpressionCompiler& compiler) const override
+  {
+    return GetActiveChild()->Compile(compiler);
+  }
 
 private:
   const std::unique_ptr<Expression>& GetActiveChild() const
@@ -13,6 +13,8 @@
 
 namespace ciface::ExpressionParser
 {
+class ExpressionCompiler;
+
 enum TokenType
 {
   TOK_WHITESPACE,
@@ -166,6 +168,9 @@ public:
   virtual void SetValue(ControlState state) = 0;
   virtual int CountNumControls() const = 0;
   virtual void UpdateReferences(ControlEnvironment& finder) = 0;
+  // Adds the instructions that compute the value, and returns the register that holds it.
+  // Expressions that aren't compiled are called as a whole.
+  virtual u32 Compile(ExpressionCompiler& compiler) const;
 };
 
 class ParseResult
@@ -8,6 +8,8 @@
 #include <chrono>
 #include <cmath>
 
+#include "InputCommon/ControlReference/CompiledExpression.h"
+
 namespace ciface::ExpressionParser
 {
 using Clock = std::chrono::steady_clock;
@@ -68,6 +70,11 @@ private:
 
   ControlState GetValue() const override { return 1.0 - GetArg(0).GetValue(); }
   void SetValue(ControlState value) override { GetArg(0).SetValue(1.0 - value); }
+
+  u32 Compile(ExpressionCompiler& compiler) const override
+  {
+    return compiler.Op(Opcode::Not, GetArg(0).Compile(compiler));
+  }
 };
 
 // usage: sin(expression)
@@ -84,6 +91,11 @@ private:
   }
 
   ControlState GetValue() const override { return std::sin(GetArg(0).GetValue()); }
+
+  u32 Compile(ExpressionCompiler& compiler) const override
+  {
+    return compiler.Op(Opcode::Sin, GetArg(0).Compile(compiler));
+  }
 };
 
 // usage: timer(seconds)
@@ -147,6 +159,29 @@ private:
     return (GetArg(0).GetValue() > CONDITION_THRESHOLD) ? GetArg(1).GetValue() :
                                                           GetArg(2).GetValue();
   }
+
+  u32 Compile(ExpressionCompiler& compiler) const override
+  {
+    const ExpressionCompiler::Checkpoint start = compiler.Save();
+    const u32 condition = GetArg(0).Compile(compiler);
+    if (compiler.IsConstant(condition))
+    {
+      const bool is_true = compiler.GetConstant(condition) > CONDITION_THRESHOLD;
+      return GetArg(is_true ? 1 : 2).Compile(compiler);
+    }
+
+    // Both branches are computed, which is only the same if neither of them has side effects
+    const ExpressionCompiler::Checkpoint branches = compiler.Save();
+    const u32 if_true = GetArg(1).Compile(compiler);
+    const u32 if_false = GetArg(2).Compile(compiler);
+    if (compiler.HasCallsSince(branches))
+    {
+      compiler.Restore(start);
+      return compiler.Call(*this);
+    }
+
+    return compiler.Op(Opcode::Select, condition, if_true, if_false);
+  }
 };
 
 // usage: minus(expression)
@@ -167,6 +202,11 @@ private:
     // Subtraction for clarity:
     return 0.0 - GetArg(0).GetValue();
   }
+
+  u32 Compile(ExpressionCompiler& compiler) const override
+  {
+    return compiler.Op(Opcode::Minus, GetArg(0).Compile(compiler));
+  }
 };
 
 // usage: deadzone(input, amount)
@@ -187,6 +227,13 @@ class DeadzoneExpression : public FunctionExpression
     const ControlState deadzone = GetArg(1).GetValue();
     return std::copysign(std::max(0.0, std::abs(val) - deadzone) / (1.0 - deadzone), val);
   }
+
+  u32 Compile(ExpressionCompiler& compiler) const override
+  {
+    const u32 val = GetArg(0).Compile(compiler);
+    const u32 deadzone = GetArg(1).Compile(compiler);
+    return compiler.Op(Opcode::Deadzone, val, deadzone);
+  }
 };
 
 // usage: smooth(input, seconds_up, seconds_down = seconds_up)
@@ -3,23 +3,29 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cerrno>
+#include <cinttypes>
 #include <cstring>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 
 #include <fcntl.h>
 #include <libudev.h>
+#include <sys/epoll.h>
 #include <sys/eventfd.h>
 #include <unistd.h>
 
 #include "Common/Assert.h"
+#include "Common/CommonFuncs.h"
 #include "Common/Flag.h"
 #include "Common/Logging/Log.h"
 #include "Common/MathUtil.h"
 #include "Common/ScopeGuard.h"
 #include "Common/StringUtil.h"
 #include "Common/Thread.h"
+#include "Common/Timer.h"
 #include "InputCommon/ControllerInterface/ControllerInterface.h"
 #include "InputCommon/ControllerInterface/evdev/evdev.h"
 
@@ -28,25 +34,27 @@ namespace ciface::evdev
 class Input : public Core::Device::Input
 {
 public:
-  Input(u16 code, libevdev* dev) : m_code(code), m_dev(dev) {}
+  Input(u16 code, libevdev* dev, const NodeState& state)
+      : m_code(code), m_dev(dev), m_state(state)
+  {
+  }
 
 protected:
   const u16 m_code;
   libevdev* const m_dev;
+  const NodeState& m_state;
 };
 
 class Button : public Input
 {
 public:
-  Button(u8 index, u16 code, libevdev* dev) : Input(code, dev), m_index(index) {}
-
-  ControlState GetState() const final override
+  Button(u8 index, u16 code, libevdev* dev, const NodeState& state)
+      : Input(code, dev, state), m_index(index)
   {
-    int value = 0;
-    libevdev_fetch_event_value(m_dev, EV_KEY, m_code, &value);
-    return value;
   }
 
+  ControlState GetState() const final override { return m_state.GetKey(m_code); }
+
 protected:
   std::optional<std::string> GetEventCodeName() const
   {
@@ -110,10 +118,7 @@ public:
 
   ControlState GetState() const final override
   {
-    int value = 0;
-    libevdev_fetch_event_value(m_dev, EV_ABS, m_code, &value);
-
-    return (value - m_base) / m_range;
+    return (m_state.axes[m_code] - m_base) / m_range;
   }
 
 protected:
@@ -124,7 +129,8 @@ protected:
 class Axis : public AnalogInput
 {
 public:
-  Axis(u8 index, u16 code, bool upper, libevdev* dev) : AnalogInput(code, dev), m_index(index)
+  Axis(u8 index, u16 code, bool upper, libevdev* dev, const NodeState& state)
+      : AnalogInput(code, dev, state), m_index(index)
   {
     const int min = libevdev_get_abs_minimum(m_dev, m_code);
     const int max = libevdev_get_abs_maximum(m_dev, m_code);
@@ -148,7 +154,8 @@ private:
 class MotionDataInput final : public AnalogInput
 {
 public:
-  MotionDataInput(u16 code, ControlState resolution_scale, libevdev* dev) : AnalogInput(code, dev)
+  MotionDataInput(u16 code, ControlState resolution_scale, libevdev* dev, const NodeState& state)
+      : AnalogInput(code, dev, state)
   {
     auto* const info = libevdev_get_abs_info(m_dev, m_code);
 
@@ -199,6 +206,16 @@ static std::thread s_hotplug_thread;
 static Common::Flag s_hotplug_thread_running;
 static int s_wakeup_eventfd;
 
+static std::thread s_input_thread;
+static Common::Flag s_input_thread_running;
+static int s_input_epoll_fd = -1;
+static int s_input_wakeup_eventfd;
+
+// The nodes the input thread reads, by file descriptor. Devices hold the mutex while removing
+// their nodes, so a node is never freed while the input thread reads it.
+static std::mutex s_input_nodes_mutex;
+static std::map<int, evdevDevice::Node*> s_input_nodes;
+
 // There is no easy way to get the device name from only a dev node
 // during a device removed event, since libevdev can't work on removed devices;
 // sysfs is not stable, so this is probably the easiest way to get a name for a node.
@@ -228,7 +245,7 @@ static void AddDeviceNode(const char* devnode)
   // Unfortunately udev gives us no way to filter out the non event device interfaces.
   // So we open it and see if it works with evdev ioctls or not.
 
-  // The device file will be read on one of the main threads, so we open in non-blocking mode.
+  // The input thread reads all device files, so we open in non-blocking mode.
   const int fd = open(devnode, O_RDWR | O_NONBLOCK);
   if (fd == -1)
   {
@@ -250,6 +267,7 @@ static void AddDeviceNode(const char* devnode)
     NOTICE_LOG(SERIALINTERFACE, "evdev combining devices with unique id: %s", uniq);
 
     evdev_device->AddNode(devnode, fd, dev);
+    evdev_device->StartReadingLastNode();
 
     // Remove and re-add device as naming and inputs may have changed.
     // This will also give it the correct index and invoke device change callbacks.
@@ -265,11 +283,17 @@ static void AddDeviceNode(const char* devnode)
 
     const bool was_interesting = evdev_device->AddNode(devnode, fd, dev);
 
-    if (was_interesting)
-      g_controller_interface.AddDevice(evdev_device);
+    // Nodes of devices that aren't added (keyboards, mice, the power button...) are closed
+    // again when evdev_device goes out of scope, so they are never read or remembered.
+    if (!was_interesting)
+      return;
+
+    evdev_device->StartReadingLastNode();
+    g_controller_interface.AddDevice(evdev_device);
   }
 
-  s_devnode_objects.emplace(devnode, std::move(evdev_device));
+  // The devnode may still have an entry from a device that was unplugged before.
+  s_devnode_objects.insert_or_assign(devnode, std::move(evdev_device));
 }
 
 static void HotplugThreadFunc()
@@ -315,9 +339,13 @@ static void HotplugThreadFunc()
     {
       std::shared_ptr<evdevDevice> ptr;
 
+      // Forget the devnode, as the kernel reuses it for the next device that is plugged in.
       const auto it = s_devnode_objects.find(devnode);
       if (it != s_devnode_objects.end())
+      {
         ptr = it->second.lock();
+        s_devnode_objects.erase(it);
+      }
 
       // If we don't recognize this device, ptr will be null and no device will be removed.
 
@@ -364,8 +392,112 @@ static void StopHotplugThread()
   close(s_wakeup_eventfd);
 }
 
+static void InputThreadFunc()
+{
+  Common::SetCurrentThreadName("evdev Input Thread");
+  NOTICE_LOG(SERIALINTERFACE, "evdev input thread started");
+
+  std::array<epoll_event, 16> events;
+  while (s_input_thread_running.IsSet())
+  {
+    const int count = epoll_wait(s_input_epoll_fd, events.data(), int(events.size()), -1);
+
+    std::lock_guard lk(s_input_nodes_mutex);
+    for (int i = 0; i < count; ++i)
+    {
+      // The wakeup eventfd isn't a node, so it is skipped here.
+      const auto it = s_input_nodes.find(events[i].data.fd);
+      if (it == s_input_nodes.end())
+        continue;
+
+      if (!it->second->ReadEvents())
+      {
+        // The node was most likely unplugged. Stop polling it, as it would always be ready;
+        // the hotplug thread removes the device.
+        epoll_ctl(s_input_epoll_fd, EPOLL_CTL_DEL, it->first, nullptr);
+        s_input_nodes.erase(it);
+      }
+    }
+  }
+  NOTICE_LOG(SERIALINTERFACE, "evdev input thread stopped");
+}
+
+static void StartInputThread()
+{
+  // Mark the thread as running.
+  if (!s_input_thread_running.TestAndSet())
+  {
+    // It was already running.
+    return;
+  }
+
+  s_input_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  ASSERT_MSG(PAD, s_input_epoll_fd != -1, "Couldn't create epoll instance.");
+  s_input_wakeup_eventfd = eventfd(0, 0);
+  ASSERT_MSG(PAD, s_input_wakeup_eventfd != -1, "Couldn't create eventfd.");
+
+  epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = s_input_wakeup_eventfd;
+  epoll_ctl(s_input_epoll_fd, EPOLL_CTL_ADD, s_input_wakeup_eventfd, &event);
+
+  s_input_thread = std::thread(InputThreadFunc);
+}
+
+static void StopInputThread()
+{
+  // Tell the input thread to stop.
+  if (!s_input_thread_running.TestAndClear())
+  {
+    // It wasn't running, we're done.
+    return;
+  }
+
+  // Write something to efd so that epoll_wait() stops blocking.
+  const uint64_t value = 1;
+  static_cast<void>(write(s_input_wakeup_eventfd, &value, sizeof(uint64_t)));
+
+  s_input_thread.join();
+
+  std::lock_guard lk(s_input_nodes_mutex);
+  s_input_nodes.clear();
+  close(s_input_epoll_fd);
+  s_input_epoll_fd = -1;
+  close(s_input_wakeup_eventfd);
+}
+
+static void AddInputNode(evdevDevice::Node* node)
+{
+  std::lock_guard lk(s_input_nodes_mutex);
+  if (s_input_epoll_fd == -1)
+    return;
+
+  epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = node->fd;
+  if (epoll_ctl(s_input_epoll_fd, EPOLL_CTL_ADD, node->fd, &event) != 0)
+  {
+    ERROR_LOG(SERIALINTERFACE, "evdev couldn't poll %s: %s", node->devnode.c_str(),
+              LastStrerrorString().c_str());
+    return;
+  }
+
+  s_input_nodes.emplace(node->fd, node);
+}
+
+static void RemoveInputNode(const evdevDevice::Node& node)
+{
+  std::lock_guard lk(s_input_nodes_mutex);
+
+  // The input thread may have already removed it.
+  if (s_input_nodes.erase(node.fd) != 0)
+    epoll_ctl(s_input_epoll_fd, EPOLL_CTL_DEL, node.fd, nullptr);
+}
+
 void Init()
 {
+  // Start reading before the hotplug thread can add devices.
+  StartInputThread();
   StartHotplugThread();
 }
 
@@ -404,11 +536,37 @@ void PopulateDevices()
 void Shutdown()
 {
   StopHotplugThread();
+  StopInputThread();
 }
 
 bool evdevDevice::AddNode(std::string devnode, int fd, libevdev* dev)
 {
-  m_nodes.emplace_back(Node{std::move(devnode), fd, dev});
+  // Event timestamps can then be compared with Common::Timer::GetTimeUs.
+  libevdev_set_clock_id(dev, CLOCK_MONOTONIC);
+
+  auto node = std::make_unique<Node>();
+  node->devnode = std::move(devnode);
+  node->fd = fd;
+  node->device = dev;
+
+  // Start out with the state libevdev read when opening the node.
+  NodeState& initial_state = node->pending_state;
+  initial_state = {};
+  initial_state.timestamp_us = Common::Timer::GetTimeUs();
+  for (int key = 0; key != KEY_CNT; ++key)
+  {
+    if (libevdev_get_event_value(dev, EV_KEY, key) != 0)
+      initial_state.keys[key / 64] |= u64(1) << (key % 64);
+  }
+  for (int axis = 0; axis != ABS_CNT; ++axis)
+    initial_state.axes[axis] = libevdev_get_event_value(dev, EV_ABS, axis);
+
+  node->published_state.Store(initial_state);
+  node->state = initial_state;
+
+  // The inputs read the state of this node, which only UpdateInput changes.
+  const NodeState& state = node->state;
+  m_nodes.push_back(std::move(node));
 
   // Take on the alphabetically first name.
   const auto potential_new_name = StripSpaces(libevdev_get_name(dev));
@@ -433,15 +591,15 @@ bool evdevDevice::AddNode(std::string devnode, int fd, libevdev* dev)
       {
         // This node will probably be combined with another with regular buttons.
         // We don't want to match "Button 0" names here as it will name clash.
-        AddInput(new NamedButtonWithNoBackwardsCompat(num_buttons, key, dev));
+        AddInput(new NamedButtonWithNoBackwardsCompat(num_buttons, key, dev, state));
       }
       else if (has_sensible_button_names)
       {
-        AddInput(new NamedButton(num_buttons, key, dev));
+        AddInput(new NamedButton(num_buttons, key, dev, state));
       }
       else
       {
-        AddInput(new NumberedButton(num_buttons, key, dev));
+        AddInput(new NumberedButton(num_buttons, key, dev, state));
       }
 
       ++num_buttons;
@@ -454,14 +612,14 @@ bool evdevDevice::AddNode(std::string devnode, int fd, libevdev* dev)
   {
     // If INPUT_PROP_ACCELEROMETER is set then X,Y,Z,RX,RY,RZ contain motion data.
 
-    auto add_motion_inputs = [&num_axis, dev, this](int first_code, double scale) {
+    auto add_motion_inputs = [&num_axis, dev, &state, this](int first_code, double scale) {
       for (int i = 0; i != 3; ++i)
       {
         const int code = first_code + i;
         if (libevdev_has_event_code(dev, EV_ABS, code))
         {
-          AddInput(new MotionDataInput(code, scale * -1, dev));
-          AddInput(new MotionDataInput(code, scale, dev));
+          AddInput(new MotionDataInput(code, scale * -1, dev, state));
+          AddInput(new MotionDataInput(code, scale, dev, state));
 
           ++num_axis;
         }
@@ -481,11 +639,11 @@ bool evdevDevice::AddNode(std::string devnode, int fd, libevdev* dev)
 
   if (is_pointing_device)
   {
-    auto add_cursor_input = [&num_axis, dev, this](int code) {
+    auto add_cursor_input = [&num_axis, dev, &state, this](int code) {
       if (libevdev_has_event_code(dev, EV_ABS, code))
       {
-        AddInput(new CursorInput(num_axis, code, false, dev));
-        AddInput(new CursorInput(num_axis, code, true, dev));
+        AddInput(new CursorInput(num_axis, code, false, dev, state));
+        AddInput(new CursorInput(num_axis, code, true, dev, state));
 
         ++num_axis;
       }
@@ -505,7 +663,8 @@ bool evdevDevice::AddNode(std::string devnode, int fd, libevdev* dev)
   {
     if (libevdev_has_event_code(dev, EV_ABS, axis))
     {
-      AddAnalogInputs(new Axis(num_axis, axis, false, dev), new Axis(num_axis, axis, true, dev));
+      AddAnalogInputs(new Axis(num_axis, axis, false, dev, state),
+                      new Axis(num_axis, axis, true, dev, state));
       ++num_axis;
     }
   }
@@ -575,12 +734,17 @@ bool evdevDevice::AddNode(std::string devnode, int fd, libevdev* dev)
   // want to use.
 }
 
+void evdevDevice::StartReadingLastNode()
+{
+  AddInputNode(m_nodes.back().get());
+}
+
 const char* evdevDevice::GetUniqueID() const
 {
   if (m_nodes.empty())
     return nullptr;
 
-  const auto uniq = libevdev_get_uniq(m_nodes.front().device);
+  const auto uniq = libevdev_get_uniq(m_nodes.front()->device);
 
   // Some devices (e.g. Mayflash adapter) return an empty string which is not very unique.
   if (uniq && std::strlen(uniq) == 0)
@@ -591,38 +755,98 @@ const char* evdevDevice::GetUniqueID() const
 
 evdevDevice::~evdevDevice()
 {
+  if (m_latency_samples != 0)
+  {
+    INFO_LOG(SERIALINTERFACE,
+             "evdev %s: average input latency %" PRIu64 " us, max latency %" PRIu64 " us",
+             m_name.c_str(), m_total_latency_us / m_latency_samples, m_max_latency_us);
+  }
+
   for (auto& node : m_nodes)
   {
-    s_devnode_objects.erase(node.devnode);
-    libevdev_free(node.device);
-    close(node.fd);
+    RemoveInputNode(*node);
+    s_devnode_objects.erase(node->devnode);
+    libevdev_free(node->device);
+    close(node->fd);
   }
 }
 
-void evdevDevice::UpdateInput()
+bool evdevDevice::Node::ReadEvents()
 {
-  // Run through all evdev events
-  // libevdev will keep track of the actual controller state internally which can be queried
-  // later with libevdev_fetch_event_value()
-  for (auto& node : m_nodes)
+  // After dropped events libevdev returns LIBEVDEV_READ_STATUS_SYNC, and the events that bring
+  // its state up to date must then be read with LIBEVDEV_READ_FLAG_SYNC
+  unsigned int flags = LIBEVDEV_READ_FLAG_NORMAL;
+  while (true)
   {
-    int rc = LIBEVDEV_READ_STATUS_SUCCESS;
-    while (rc >= 0)
+    input_event ev;
+    const int rc = libevdev_next_event(device, flags, &ev);
+    if (rc == -EAGAIN)
     {
-      input_event ev;
-      if (LIBEVDEV_READ_STATUS_SYNC == rc)
-        rc = libevdev_next_event(node.device, LIBEVDEV_READ_FLAG_SYNC, &ev);
-      else
-        rc = libevdev_next_event(node.device, LIBEVDEV_READ_FLAG_NORMAL, &ev);
+      if (flags == LIBEVDEV_READ_FLAG_NORMAL)
+        return true;
+
+      // Done syncing, read what came in since.
+      flags = LIBEVDEV_READ_FLAG_NORMAL;
+      continue;
+    }
+
+    if (rc < 0)
+      return false;
+
+    if (rc == LIBEVDEV_READ_STATUS_SYNC)
+      flags = LIBEVDEV_READ_FLAG_SYNC;
+
+    switch (ev.type)
+    {
+    case EV_KEY:
+      if (ev.code < KEY_CNT)
+      {
+        const u64 bit = u64(1) << (ev.code % 64);
+        if (ev.value != 0)
+          pending_state.keys[ev.code / 64] |= bit;
+        else
+          pending_state.keys[ev.code / 64] &= ~bit;
+      }
+      break;
+    case EV_ABS:
+      if (ev.code < ABS_CNT)
+        pending_state.axes[ev.code] = ev.value;
+      break;
+    case EV_SYN:
+      // Devices send a report after each set of changes, e.g. both axes of a stick.
+      if (ev.code == SYN_REPORT)
+      {
+        pending_state.timestamp_us = u64(ev.time.tv_sec) * 1000000 + u64(ev.time.tv_usec);
+        published_state.Store(pending_state);
+      }
+      break;
     }
   }
 }
 
+void evdevDevice::UpdateInput()
+{
+  // The input thread has already read the events, so this only takes its latest snapshots.
+  const u64 now = Common::Timer::GetTimeUs();
+  for (auto& node : m_nodes)
+  {
+    const u64 previous_timestamp = node->state.timestamp_us;
+    node->state = node->published_state.Load();
+    if (node->state.timestamp_us == previous_timestamp)
+      continue;
+
+    const u64 latency = now > node->state.timestamp_us ? now - node->state.timestamp_us : 0;
+    ++m_latency_samples;
+    m_total_latency_us += latency;
+    m_max_latency_us = std::max(m_max_latency_us, latency);
+  }
+}
+
 bool evdevDevice::IsValid() const
 {
   for (auto& node : m_nodes)
   {
-    const int current_fd = libevdev_get_fd(node.device);
+    const int current_fd = libevdev_get_fd(node->device);
 
     if (current_fd == -1)
       return false;
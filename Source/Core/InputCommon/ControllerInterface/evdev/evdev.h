@@ -4,10 +4,14 @@
 
 #pragma once
 
+#include <array>
 #include <libevdev/libevdev.h>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "Common/CommonTypes.h"
+#include "Common/SeqLock.h"
 #include "InputCommon/ControllerInterface/ControllerInterface.h"
 
 namespace ciface::evdev
@@ -16,6 +20,17 @@ void Init();
 void PopulateDevices();
 void Shutdown();
 
+// The values of a device node after an EV_SYN report
+struct NodeState
+{
+  bool GetKey(u16 code) const { return (keys[code / 64] >> (code % 64)) & 1; }
+
+  // When the kernel received the report, on the same clock as Common::Timer::GetTimeUs
+  u64 timestamp_us;
+  std::array<u64, (KEY_CNT + 63) / 64> keys;
+  std::array<s32, ABS_CNT> axes;
+};
+
 class evdevDevice : public Core::Device
 {
 private:
@@ -73,6 +88,24 @@ private:
   };
 
 public:
+  struct Node
+  {
+    // Reads the pending events on the input thread.
+    // Returns false once the node can't be read anymore, e.g. because it was unplugged.
+    bool ReadEvents();
+
+    std::string devnode;
+    int fd;
+    libevdev* device;
+
+    // Only used by the input thread
+    NodeState pending_state;
+    Common::SeqLock<NodeState> published_state;
+
+    // The snapshot taken by the last UpdateInput, which the inputs read
+    NodeState state;
+  };
+
   void UpdateInput() override;
   bool IsValid() const override;
 
@@ -81,6 +114,10 @@ public:
   // Return true if node was "interesting".
   bool AddNode(std::string devnode, int fd, libevdev* dev);
 
+  // Has the input thread read the node added last. Nodes of devices that are never added to
+  // the ControllerInterface aren't read.
+  void StartReadingLastNode();
+
   const char* GetUniqueID() const;
 
   std::string GetName() const override { return m_name; }
@@ -89,13 +126,11 @@ public:
 private:
   std::string m_name;
 
-  struct Node
-  {
-    std::string devnode;
-    int fd;
-    libevdev* device;
-  };
+  std::vector<std::unique_ptr<Node>> m_nodes;
 
-  std::vector<Node> m_nodes;
+  // Time from the kernel receiving an event to UpdateInput picking it up
+  u64 m_latency_samples = 0;
+  u64 m_total_latency_us = 0;
+  u64 m_max_latency_us = 0;
 };
 }  // namespace ciface::evdev
@@ -5,7 +5,9 @@
 #include "UICommon/GameFileCache.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <cstring>
 #include <functional>
 #include <list>
 #include <memory>
@@ -20,6 +22,8 @@
 #include "Common/File.h"
 #include "Common/FileSearch.h"
 #include "Common/FileUtil.h"
+#include "Common/MappedFile.h"
+#include "Common/ParallelFor.h"
 
 #include "DiscIO/DirectoryBlob.h"
 
@@ -27,7 +31,7 @@
 
 namespace UICommon
 {
-static constexpr u32 CACHE_REVISION = 16;  // Last changed in PR 8313
+static constexpr u32 CACHE_REVISION = 17;  // Last changed when entries got a size index
 
 std::vector<std::string> FindAllGamePaths(const std::vector<std::string>& directories_to_scan,
                                           bool recursive_scan)
@@ -64,25 +68,69 @@ void GameFileCache::Clear(DeleteOnDisk delete_on_disk)
     File::Delete(m_path);
 
   m_cached_files.clear();
+  m_path_index.clear();
+}
+
+void GameFileCache::RebuildPathIndex()
+{
+  m_path_index.clear();
+  m_path_index.reserve(m_cached_files.size());
+  for (size_t i = 0; i < m_cached_files.size(); ++i)
+    m_path_index.emplace(m_cached_files[i]->GetFilePath(), i);
 }
 
 std::shared_ptr<const GameFile> GameFileCache::AddOrGet(const std::string& path,
                                                         bool* cache_changed)
 {
-  auto it = std::find_if(
-      m_cached_files.begin(), m_cached_files.end(),
-      [&path](const std::shared_ptr<GameFile>& file) { return file->GetFilePath() == path; });
-  const bool found = it != m_cached_files.cend();
-  if (!found)
+  return AddOrGet(std::vector<std::string>{path}, cache_changed).front();
+}
+
+std::vector<std::shared_ptr<const GameFile>>
+GameFileCache::AddOrGet(const std::vector<std::string>& paths, bool* cache_changed)
+{
+  // Look up or load every file, then check its additional metadata. Only the slow parts run in
+  // parallel, the cache itself is only modified on this thread.
+  std::vector<std::shared_ptr<GameFile>> files(paths.size());
+  std::vector<bool> found(paths.size());
+  for (size_t i = 0; i < paths.size(); ++i)
   {
-    std::shared_ptr<UICommon::GameFile> game = std::make_shared<GameFile>(path);
-    if (!game->IsValid())
-      return nullptr;
-    m_cached_files.emplace_back(std::move(game));
+    const auto it = m_path_index.find(paths[i]);
+    found[i] = it != m_path_index.end();
+    if (found[i])
+      files[i] = m_cached_files[it->second];
+  }
+
+  std::vector<char> metadata_updated(paths.size());
+  Common::ParallelFor(paths.size(), [&](size_t i) {
+    if (!found[i])
+    {
+      files[i] = std::make_shared<GameFile>(paths[i]);
+      if (!files[i]->IsValid())
+      {
+        files[i].reset();
+        return;
+      }
+    }
+    metadata_updated[i] = UpdateAdditionalMetadata(&files[i]);
+  });
+
+  std::vector<std::shared_ptr<const GameFile>> result(paths.size());
+  for (size_t i = 0; i < paths.size(); ++i)
+  {
+    if (!files[i])
+      continue;
+
+    const auto [it, inserted] = m_path_index.try_emplace(paths[i], m_cached_files.size());
+    if (inserted)
+      m_cached_files.push_back(files[i]);
+    else
+      m_cached_files[it->second] = files[i];
+
+    if (inserted || metadata_updated[i])
+      *cache_changed = true;
+
+    result[i] = std::move(files[i]);
   }
-  std::shared_ptr<GameFile>& result = found ? *it : m_cached_files.back();
-  if (UpdateAdditionalMetadata(&result) || !found)
-    *cache_changed = true;
 
   return result;
 }
@@ -132,9 +180,14 @@ bool GameFileCache::Update(
 
   // Now that the previous loop has run, game_paths only contains paths that
   // aren't in m_cached_files, so we simply add all of them to m_cached_files.
-  for (const std::string& path : game_paths)
+  // Opening the files is what takes time, so that is done in parallel.
+  const std::vector<std::string> new_paths(game_paths.begin(), game_paths.end());
+  std::vector<std::shared_ptr<GameFile>> new_files(new_paths.size());
+  Common::ParallelFor(new_paths.size(),
+                      [&](size_t i) { new_files[i] = std::make_shared<GameFile>(new_paths[i]); });
+
+  for (std::shared_ptr<GameFile>& file : new_files)
   {
-    auto file = std::make_shared<GameFile>(path);
     if (file->IsValid())
     {
       if (game_added_to_cache)
@@ -145,20 +198,26 @@ bool GameFileCache::Update(
     }
   }
 
+  RebuildPathIndex();
   return cache_changed;
 }
 
 bool GameFileCache::UpdateAdditionalMetadata(
     std::function<void(const std::shared_ptr<const GameFile>&)> game_updated)
 {
-  bool cache_changed = false;
+  // Checking for changes reads several files per game, so check all games in parallel.
+  // UpdateAdditionalMetadata only replaces the pointer in its own slot.
+  std::vector<char> updated(m_cached_files.size());
+  Common::ParallelFor(m_cached_files.size(), [&](size_t i) {
+    updated[i] = UpdateAdditionalMetadata(&m_cached_files[i]);
+  });
 
-  for (std::shared_ptr<GameFile>& file : m_cached_files)
+  bool cache_changed = false;
+  for (size_t i = 0; i < m_cached_files.size(); ++i)
   {
-    const bool updated = UpdateAdditionalMetadata(&file);
-    cache_changed |= updated;
-    if (game_updated && updated)
-      game_updated(file);
+    cache_changed |= updated[i] != 0;
+    if (game_updated && updated[i])
+      game_updated(m_cached_files[i]);
   }
 
   return cache_changed;
@@ -213,69 +272,124 @@ bool GameFileCache::Save()
 
 bool GameFileCache::SyncCacheFile(bool save)
 {
-  const char* open_mode = save ? "wb" : "rb";
-  File::IOFile f(m_path, open_mode);
-  if (!f)
-    return false;
   bool success = false;
   if (save)
   {
-    // Measure the size of the buffer.
-    u8* ptr = nullptr;
-    PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
-    DoState(&p);
-    const size_t buffer_size = reinterpret_cast<size_t>(ptr);
-
-    // Then actually do the write.
-    std::vector<u8> buffer(buffer_size);
-    ptr = &buffer[0];
-    p.SetMode(PointerWrap::MODE_WRITE);
-    DoState(&p, buffer_size);
-    if (f.WriteBytes(buffer.data(), buffer.size()))
-      success = true;
+    const std::vector<u8> buffer = WriteCacheFile();
+    File::IOFile f(m_path, "wb");
+    success = f.WriteBytes(buffer.data(), buffer.size());
   }
   else
   {
-    std::vector<u8> buffer(f.GetSize());
-    if (!buffer.empty() && f.ReadBytes(buffer.data(), buffer.size()))
-    {
-      u8* ptr = buffer.data();
-      PointerWrap p(&ptr, PointerWrap::MODE_READ);
-      DoState(&p, buffer.size());
-      if (p.GetMode() == PointerWrap::MODE_READ)
-        success = true;
-    }
+    // The cache is memory mapped, so only the parts of it that are decoded are read from disk.
+    File::MappedFile mapping;
+    if (!mapping.Open(m_path))
+      return false;
+    success = mapping.GetData() && ReadCacheFile(mapping.GetData(), mapping.GetSize());
   }
+
   if (!success)
   {
     // If some file operation failed, try to delete the probably-corrupted cache
-    f.Close();
     File::Delete(m_path);
+    if (!save)
+      Clear(DeleteOnDisk::No);
   }
   return success;
 }
 
-void GameFileCache::DoState(PointerWrap* p, u64 size)
+// Cache file format:
+// header{
+// u32 revision;
+// u32 num_entries;
+//}
+// u64 entry_size[num_entries];
+// serialized GameFile entries, back to back
+//
+// Each entry is serialized separately, so that entries can be decoded and encoded in parallel.
+
+bool GameFileCache::ReadCacheFile(const u8* data, size_t size)
 {
-  struct
-  {
-    u32 revision;
-    u64 expected_size;
-  } header = {CACHE_REVISION, size};
-  p->Do(header);
-  if (p->GetMode() == PointerWrap::MODE_READ)
+  u32 header[2];
+  if (size < sizeof(header))
+    return false;
+  std::memcpy(header, data, sizeof(header));
+  const u32 revision = header[0];
+  const u32 num_entries = header[1];
+  if (revision != CACHE_REVISION || (size - sizeof(header)) / sizeof(u64) < num_entries)
+    return false;
+
+  std::vector<size_t> offsets(num_entries + 1);
+  offsets[0] = sizeof(header) + num_entries * sizeof(u64);
+  for (u32 i = 0; i < num_entries; ++i)
   {
-    if (header.revision != CACHE_REVISION || header.expected_size != size)
-    {
-      p->SetMode(PointerWrap::MODE_MEASURE);
-      return;
-    }
+    u64 entry_size;
+    std::memcpy(&entry_size, data + sizeof(header) + i * sizeof(u64), sizeof(entry_size));
+    if (entry_size > size - offsets[i])
+      return false;
+    offsets[i + 1] = offsets[i] + static_cast<size_t>(entry_size);
   }
-  p->DoEachElement(m_cached_files, [](PointerWrap& state, std::shared_ptr<GameFile>& elem) {
-    if (state.GetMode() == PointerWrap::MODE_READ)
-      elem = std::make_shared<GameFile>();
-    elem->DoState(state);
+  if (offsets[num_entries] != size)
+    return false;
+
+  // PointerWrap needs a writable pointer, but never writes in MODE_READ.
+  u8* const base = const_cast<u8*>(data);
+  std::vector<std::shared_ptr<GameFile>> files(num_entries);
+  std::atomic<bool> success{true};
+  Common::ParallelFor(num_entries, [&](size_t i) {
+    u8* ptr = base + offsets[i];
+    PointerWrap p(&ptr, PointerWrap::MODE_READ);
+    files[i] = std::make_shared<GameFile>();
+    files[i]->DoState(p);
+    if (p.GetMode() != PointerWrap::MODE_READ || ptr != base + offsets[i + 1])
+      success = false;
+  });
+  if (!success)
+    return false;
+
+  m_cached_files = std::move(files);
+  RebuildPathIndex();
+  return true;
+}
+
+std::vector<u8> GameFileCache::WriteCacheFile() const
+{
+  std::vector<std::vector<u8>> entries(m_cached_files.size());
+  Common::ParallelFor(m_cached_files.size(), [&](size_t i) {
+    // Measure the size of the buffer.
+    u8* ptr = nullptr;
+    PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
+    m_cached_files[i]->DoState(p);
+    entries[i].resize(reinterpret_cast<size_t>(ptr));
+
+    // Then actually do the write.
+    ptr = entries[i].data();
+    p.SetMode(PointerWrap::MODE_WRITE);
+    m_cached_files[i]->DoState(p);
   });
+
+  const u32 header[2] = {CACHE_REVISION, static_cast<u32>(entries.size())};
+  size_t size = sizeof(header) + entries.size() * sizeof(u64);
+  for (const std::vector<u8>& entry : entries)
+    size += entry.size();
+
+  std::vector<u8> buffer(size);
+  u8* ptr = buffer.data();
+  std::memcpy(ptr, header, sizeof(header));
+  ptr += sizeof(header);
+  for (const std::vector<u8>& entry : entries)
+  {
+    const u64 entry_size = entry.size();
+    std::memcpy(ptr, &entry_size, sizeof(entry_size));
+    ptr += sizeof(entry_size);
+  }
+  for (const std::vector<u8>& entry : entries)
+  {
+    std::copy(entry.begin(), entry.end(), ptr);
+    ptr += entry.size();
+  }
+
+  return buffer;
 }
 
 }  // namespace UICommon
@@ -8,12 +8,11 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "Common/CommonTypes.h"
 
-class PointerWrap;
-
 namespace UICommon
 {
 class GameFile;
@@ -40,6 +39,10 @@ public:
 
   // Returns nullptr if the file is invalid.
   std::shared_ptr<const GameFile> AddOrGet(const std::string& path, bool* cache_changed);
+  // Same as above, but loads the files that aren't cached yet in parallel.
+  // Returns one entry for each path, which is nullptr if the file is invalid.
+  std::vector<std::shared_ptr<const GameFile>> AddOrGet(const std::vector<std::string>& paths,
+                                                        bool* cache_changed);
 
   // These functions return true if the call modified the cache.
   bool Update(const std::vector<std::string>& all_game_paths,
@@ -52,13 +55,17 @@ public:
   bool Save();
 
 private:
-  bool UpdateAdditionalMetadata(std::shared_ptr<GameFile>* game_file);
+  static bool UpdateAdditionalMetadata(std::shared_ptr<GameFile>* game_file);
+  void RebuildPathIndex();
 
   bool SyncCacheFile(bool save);
-  void DoState(PointerWrap* p, u64 size = 0);
+  bool ReadCacheFile(const u8* data, size_t size);
+  std::vector<u8> WriteCacheFile() const;
 
   std::string m_path;
   std::vector<std::shared_ptr<GameFile>> m_cached_files;
+  // File path -> index in m_cached_files
+  std::unordered_map<std::string, size_t> m_path_index;
 };
 
 }  // namespace UICommon
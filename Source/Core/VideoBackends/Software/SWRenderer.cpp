@@ -35,7 +35,7 @@ SWRenderer::SWRenderer(std::unique_ptr<SWOGLWindow> window)
 
 bool SWRenderer::IsHeadless() const
 {
-  return m_window->IsHeadless();
+  return !m_window || m_window->IsHeadless();
 }
 
 std::unique_ptr<AbstractTexture> SWRenderer::CreateTexture(const TextureConfig& config)
@@ -92,9 +92,14 @@ bool VideoSoftware::Initialize(const WindowSystemInfo& wsi)
 {
   InitializeShared();
 
-  std::unique_ptr<SWOGLWindow> window = SWOGLWindow::Create(wsi);
-  if (!window)
-    return false;
+  // Nothing is presented without a window, so there's no need for an OpenGL context either.
+  std::unique_ptr<SWOGLWindow> window;
+  if (wsi.type != WindowSystemType::Headless)
+  {
+    window = SWOGLWindow::Create(wsi);
+    if (!window)
+      return false;
+  }
 
   Clipper::Init();
   Rasterizer::Init();
@@ -3,9 +3,13 @@
 // Refer to the license.txt file included.
 
 #include "VideoCommon/AsyncShaderCompiler.h"
+
+#include <algorithm>
 #include <thread>
+
 #include "Common/Assert.h"
 #include "Common/Logging/Log.h"
+#include "Common/Timer.h"
 
 namespace VideoCommon
 {
@@ -25,13 +29,32 @@ void AsyncShaderCompiler::QueueWorkItem(WorkItemPtr item, u32 priority)
   // If no worker threads are available, compile synchronously.
   if (!HasWorkerThreads())
   {
+    const ShaderCompileType type = item->GetType();
+    const u64 start_time = Common::Timer::GetTimeUs();
     item->Compile();
+    const u64 end_time = Common::Timer::GetTimeUs();
+
+    std::lock_guard<std::mutex> guard(m_completed_work_lock);
+    RecordCompileTimes(type, 0, end_time - start_time);
     m_completed_work.push_back(std::move(item));
   }
   else
   {
+    const u32 lane = std::min(priority, NUM_PRIORITY_LANES - 1);
+    WorkerQueue& queue = *m_worker_queues[m_next_worker_queue];
+    m_next_worker_queue = (m_next_worker_queue + 1) % m_worker_queues.size();
+
+    // Count the item before it is visible to the workers, as one of them could take it and
+    // decrement the counts right away.
+    m_pending_lane_items[lane]++;
+    m_pending_items++;
+    {
+      std::lock_guard<std::mutex> guard(queue.lock);
+      queue.lanes[lane].push_back({std::move(item), Common::Timer::GetTimeUs()});
+    }
+
+    // Any worker can pick the item up, not just the owner of the queue.
     std::lock_guard<std::mutex> guard(m_pending_work_lock);
-    m_pending_work.emplace(priority, std::move(item));
     m_worker_thread_wake.notify_one();
   }
 }
@@ -51,10 +74,20 @@ void AsyncShaderCompiler::RetrieveWorkItems()
   }
 }
 
+AsyncShaderCompiler::CompileTimes AsyncShaderCompiler::GetCompileTimes()
+{
+  std::lock_guard<std::mutex> guard(m_completed_work_lock);
+  return m_compile_times;
+}
+
 bool AsyncShaderCompiler::HasPendingWork()
 {
-  std::lock_guard<std::mutex> guard(m_pending_work_lock);
-  return !m_pending_work.empty() || m_busy_workers.load() != 0;
+  return m_pending_items.load() != 0 || m_busy_workers.load() != 0;
+}
+
+size_t AsyncShaderCompiler::GetPendingWorkItemCount(u32 priority) const
+{
+  return m_pending_lane_items[std::min(priority, NUM_PRIORITY_LANES - 1)].load();
 }
 
 bool AsyncShaderCompiler::HasCompletedWork()
@@ -89,23 +122,14 @@ void AsyncShaderCompiler::WaitUntilCompletion(
   // Grab the number of pending items. We use this to work out how many are left.
   size_t total_items = 0;
   {
-    // Safe to hold both locks here, since nowhere else does.
-    std::lock_guard<std::mutex> pending_guard(m_pending_work_lock);
     std::lock_guard<std::mutex> completed_guard(m_completed_work_lock);
-    total_items = m_completed_work.size() + m_pending_work.size() + m_busy_workers.load() + 1;
+    total_items = m_completed_work.size() + m_pending_items.load() + m_busy_workers.load() + 1;
   }
 
   // Update progress while the compiles complete.
-  for (;;)
+  while (HasPendingWork())
   {
-    size_t remaining_items;
-    {
-      std::lock_guard<std::mutex> pending_guard(m_pending_work_lock);
-      if (m_pending_work.empty() && !m_busy_workers.load())
-        break;
-      remaining_items = m_pending_work.size();
-    }
-
+    const size_t remaining_items = m_pending_items.load();
     progress_callback(total_items - remaining_items, total_items);
     std::this_thread::sleep_for(CHECK_INTERVAL);
   }
@@ -116,6 +140,7 @@ bool AsyncShaderCompiler::StartWorkerThreads(u32 num_worker_threads)
   if (num_worker_threads == 0)
     return true;
 
+  CreateWorkerQueues(num_worker_threads);
   for (u32 i = 0; i < num_worker_threads; i++)
   {
     void* thread_param = nullptr;
@@ -127,7 +152,8 @@ bool AsyncShaderCompiler::StartWorkerThreads(u32 num_worker_threads)
 
     m_worker_thread_start_result.store(false);
 
-    std::thread thr(&AsyncShaderCompiler::WorkerThreadEntryPoint, this, thread_param);
+    std::thread thr(&AsyncShaderCompiler::WorkerThreadEntryPoint, this, thread_param,
+                    static_cast<size_t>(i));
     m_init_event.Wait();
 
     if (!m_worker_thread_start_result.load())
@@ -157,6 +183,11 @@ bool AsyncShaderCompiler::HasWorkerThreads() const
   return !m_worker_threads.empty();
 }
 
+size_t AsyncShaderCompiler::GetWorkerThreadCount() const
+{
+  return m_worker_threads.size();
+}
+
 void AsyncShaderCompiler::StopWorkerThreads()
 {
   if (!HasWorkerThreads())
@@ -190,7 +221,29 @@ void AsyncShaderCompiler::WorkerThreadExit(void* param)
 {
 }
 
-void AsyncShaderCompiler::WorkerThreadEntryPoint(void* param)
+void AsyncShaderCompiler::CreateWorkerQueues(size_t num_queues)
+{
+  // Carry over any work which was left when the previous workers were stopped.
+  std::vector<std::unique_ptr<WorkerQueue>> old_queues = std::move(m_worker_queues);
+  m_worker_queues.clear();
+  for (size_t i = 0; i < num_queues; i++)
+    m_worker_queues.push_back(std::make_unique<WorkerQueue>());
+
+  m_next_worker_queue = 0;
+  for (auto& old_queue : old_queues)
+  {
+    for (size_t lane = 0; lane < NUM_PRIORITY_LANES; lane++)
+    {
+      for (PendingWorkItem& item : old_queue->lanes[lane])
+      {
+        m_worker_queues[m_next_worker_queue]->lanes[lane].push_back(std::move(item));
+        m_next_worker_queue = (m_next_worker_queue + 1) % num_queues;
+      }
+    }
+  }
+}
+
+void AsyncShaderCompiler::WorkerThreadEntryPoint(void* param, size_t worker_index)
 {
   // Initialize worker thread with backend-specific method.
   if (!WorkerThreadInitWorkerThread(param))
@@ -204,36 +257,88 @@ void AsyncShaderCompiler::WorkerThreadEntryPoint(void* param)
   m_worker_thread_start_result.store(true);
   m_init_event.Set();
 
-  WorkerThreadRun();
+  WorkerThreadRun(worker_index);
 
   WorkerThreadExit(param);
 }
 
-void AsyncShaderCompiler::WorkerThreadRun()
+void AsyncShaderCompiler::WorkerThreadRun(size_t worker_index)
 {
-  std::unique_lock<std::mutex> pending_lock(m_pending_work_lock);
   while (!m_exit_flag.IsSet())
   {
-    m_worker_thread_wake.wait(pending_lock);
+    PendingWorkItem pending;
+    if (!TakeWorkItem(worker_index, &pending))
+    {
+      std::unique_lock<std::mutex> pending_lock(m_pending_work_lock);
+      m_worker_thread_wake.wait(pending_lock, [this] {
+        return m_exit_flag.IsSet() || m_pending_items.load() != 0;
+      });
+      continue;
+    }
+
+    const ShaderCompileType type = pending.item->GetType();
+    const u64 start_time = Common::Timer::GetTimeUs();
+    const bool compiled = pending.item->Compile();
+    const u64 end_time = Common::Timer::GetTimeUs();
 
-    while (!m_pending_work.empty() && !m_exit_flag.IsSet())
     {
-      m_busy_workers++;
-      auto iter = m_pending_work.begin();
-      WorkItemPtr item(std::move(iter->second));
-      m_pending_work.erase(iter);
-      pending_lock.unlock();
+      std::lock_guard<std::mutex> completed_guard(m_completed_work_lock);
+      RecordCompileTimes(type, start_time - pending.queue_time_us, end_time - start_time);
+      if (compiled)
+        m_completed_work.push_back(std::move(pending.item));
+    }
+
+    m_busy_workers--;
+  }
+}
 
-      if (item->Compile())
+bool AsyncShaderCompiler::TakeWorkItem(size_t worker_index, PendingWorkItem* out_item)
+{
+  // Lanes take precedence over queue ownership, so that urgent work in another worker's queue
+  // is stolen before our own speculative work is started.
+  const size_t num_queues = m_worker_queues.size();
+  for (size_t lane = 0; lane < NUM_PRIORITY_LANES; lane++)
+  {
+    for (size_t i = 0; i < num_queues; i++)
+    {
+      WorkerQueue& queue = *m_worker_queues[(worker_index + i) % num_queues];
+      std::lock_guard<std::mutex> guard(queue.lock);
+      std::deque<PendingWorkItem>& items = queue.lanes[lane];
+      if (items.empty())
+        continue;
+
+      // Our own queue is processed in order, steals take the most recently queued item.
+      if (i == 0)
+      {
+        *out_item = std::move(items.front());
+        items.pop_front();
+      }
+      else
       {
-        std::lock_guard<std::mutex> completed_guard(m_completed_work_lock);
-        m_completed_work.push_back(std::move(item));
+        *out_item = std::move(items.back());
+        items.pop_back();
       }
 
-      pending_lock.lock();
-      m_busy_workers--;
+      // Mark ourselves busy first, so HasPendingWork() never sees the item missing.
+      m_busy_workers++;
+      m_pending_lane_items[lane]--;
+      m_pending_items--;
+      return true;
     }
   }
+
+  return false;
+}
+
+void AsyncShaderCompiler::RecordCompileTimes(ShaderCompileType type, u64 queue_wait_us,
+                                             u64 compile_us)
+{
+  Statistics::ShaderCompileTimes& times = m_compile_times[static_cast<size_t>(type)];
+  const float compile_ms = compile_us / 1000.0f;
+  times.num_compiles++;
+  times.total_queue_wait_ms += queue_wait_us / 1000.0f;
+  times.total_compile_ms += compile_ms;
+  times.max_compile_ms = std::max(times.max_compile_ms, compile_ms);
 }
 
 }  // namespace VideoCommon
@@ -4,11 +4,12 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
+#include <cstddef>
 #include <deque>
 #include <functional>
-#include <map>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -18,6 +19,7 @@
 #include "Common/CommonTypes.h"
 #include "Common/Event.h"
 #include "Common/Flag.h"
+#include "VideoCommon/Statistics.h"
 
 namespace VideoCommon
 {
@@ -30,9 +32,13 @@ public:
     virtual ~WorkItem() = default;
     virtual bool Compile() = 0;
     virtual void Retrieve() = 0;
+
+    // Used to group the compile times in the statistics.
+    virtual ShaderCompileType GetType() const = 0;
   };
 
   using WorkItemPtr = std::unique_ptr<WorkItem>;
+  using CompileTimes = std::array<Statistics::ShaderCompileTimes, NUM_SHADER_COMPILE_TYPES>;
 
   AsyncShaderCompiler();
   virtual ~AsyncShaderCompiler();
@@ -43,13 +49,24 @@ public:
     return std::make_unique<T>(std::forward<Params>(params)...);
   }
 
+  // Work items are queued in priority lanes. Workers always pick from the lowest non-empty lane,
+  // so items which are needed for the current frame can skip ahead of speculative compiles.
+  static constexpr u32 NUM_PRIORITY_LANES = 4;
+
   // Queues a new work item to the compiler threads. The lower the priority, the sooner
-  // this work item will be compiled, relative to the other work items.
+  // this work item will be compiled, relative to the other work items. Priorities past the
+  // last lane are placed in the last lane.
   void QueueWorkItem(WorkItemPtr item, u32 priority);
   void RetrieveWorkItems();
   bool HasPendingWork();
+
+  // Returns the number of work items with the given priority which are waiting for a worker.
+  size_t GetPendingWorkItemCount(u32 priority) const;
   bool HasCompletedWork();
 
+  // Returns the times of all compiles since the compiler was created, by shader type.
+  CompileTimes GetCompileTimes();
+
   // Simpler version without progress updates.
   void WaitUntilCompletion();
 
@@ -60,6 +77,7 @@ public:
   bool StartWorkerThreads(u32 num_worker_threads);
   bool ResizeWorkerThreads(u32 num_worker_threads);
   bool HasWorkerThreads() const;
+  size_t GetWorkerThreadCount() const;
   void StopWorkerThreads();
 
 protected:
@@ -68,8 +86,28 @@ protected:
   virtual void WorkerThreadExit(void* param);
 
 private:
-  void WorkerThreadEntryPoint(void* param);
-  void WorkerThreadRun();
+  struct PendingWorkItem
+  {
+    WorkItemPtr item;
+    u64 queue_time_us;
+  };
+
+  // Every worker has its own queue, which new work items are distributed to round-robin.
+  // Workers which run out of work steal from the other queues, so a few slow compiles which
+  // end up in the same queue don't hold up the rest.
+  struct WorkerQueue
+  {
+    std::mutex lock;
+    std::array<std::deque<PendingWorkItem>, NUM_PRIORITY_LANES> lanes;
+  };
+
+  void WorkerThreadEntryPoint(void* param, size_t worker_index);
+  void WorkerThreadRun(size_t worker_index);
+  bool TakeWorkItem(size_t worker_index, PendingWorkItem* out_item);
+  void CreateWorkerQueues(size_t num_queues);
+
+  // Must be called with m_completed_work_lock held.
+  void RecordCompileTimes(ShaderCompileType type, u64 queue_wait_us, u64 compile_us);
 
   Common::Flag m_exit_flag;
   Common::Event m_init_event;
@@ -77,14 +115,21 @@ private:
   std::vector<std::thread> m_worker_threads;
   std::atomic_bool m_worker_thread_start_result{false};
 
-  // A multimap is used to store the work items. We can't use a priority_queue here, because
-  // there's no way to obtain a non-const reference, which we need for the unique_ptr.
-  std::multimap<u32, WorkItemPtr> m_pending_work;
+  // Only resized while there are no worker threads.
+  std::vector<std::unique_ptr<WorkerQueue>> m_worker_queues;
+  size_t m_next_worker_queue = 0;
+
+  // Items are counted after they are added to a queue, and before they are removed.
+  std::atomic_size_t m_pending_items{0};
+  std::array<std::atomic_size_t, NUM_PRIORITY_LANES> m_pending_lane_items{};
+  std::atomic_size_t m_busy_workers{0};
+
+  // Only used to put idle workers to sleep.
   std::mutex m_pending_work_lock;
   std::condition_variable m_worker_thread_wake;
-  std::atomic_size_t m_busy_workers{0};
 
   std::deque<WorkItemPtr> m_completed_work;
+  CompileTimes m_compile_times{};
   std::mutex m_completed_work_lock;
 };
 
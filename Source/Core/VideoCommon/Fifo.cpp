@@ -401,6 +401,25 @@ void FlushGpu()
   s_gpu_mainloop.Wait();
 }
 
+void PauseGpu(bool pause)
+{
+  if (!pause)
+  {
+    EmulatorState(true);
+    return;
+  }
+
+  SyncGPU(SyncGPUReason::Other);
+  EmulatorState(false);
+
+  const SConfig& param = SConfig::GetInstance();
+  if (!param.bCPUThread || s_use_deterministic_gpu_thread)
+    return;
+
+  // The GPU thread still handles async requests while paused, such as saving its state
+  s_gpu_mainloop.Wait();
+}
+
 void GpuMaySleep()
 {
   s_gpu_mainloop.AllowSleep();
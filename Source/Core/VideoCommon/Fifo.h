@@ -37,6 +37,10 @@ void PushFifoAuxBuffer(const void* ptr, size_t size);
 void* PopFifoAuxBuffer(size_t size);
 
 void FlushGpu();
+// Stops the GPU thread from processing the FIFO and waits until it is idle, or resumes it.
+// Unlike PauseAndLock, this is meant for the CPU thread, e.g. to save or load a state in the
+// middle of emulation.
+void PauseGpu(bool pause);
 void RunGpu();
 void GpuMaySleep();
 void RunGpuLoop();
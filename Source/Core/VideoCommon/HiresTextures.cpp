@@ -5,12 +5,18 @@
 #include "VideoCommon/HiresTextures.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <deque>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <string_view>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include <xxhash.h>
@@ -21,7 +27,6 @@
 #include "Common/File.h"
 #include "Common/FileSearch.h"
 #include "Common/FileUtil.h"
-#include "Common/Flag.h"
 #include "Common/Image.h"
 #include "Common/Logging/Log.h"
 #include "Common/MemoryUtil.h"
@@ -29,9 +34,10 @@
 #include "Common/Swap.h"
 #include "Common/Thread.h"
 #include "Common/Timer.h"
-#include "Core/Config/GraphicsSettings.h"
 #include "Core/ConfigManager.h"
 #include "VideoCommon/OnScreenDisplay.h"
+#include "VideoCommon/TexturePack.h"
+#include "VideoCommon/TextureUsageHistory.h"
 #include "VideoCommon/VideoConfig.h"
 
 struct DiskTexture
@@ -40,14 +46,88 @@ struct DiskTexture
   bool has_arbitrary_mipmaps;
 };
 
+struct CachedTexture
+{
+  std::shared_ptr<HiresTexture> texture;
+  size_t size;
+  std::list<std::string>::iterator lru_iter;
+};
+
+struct LoadRequest
+{
+  std::string base_filename;
+  u32 width;
+  u32 height;
+};
+
 constexpr std::string_view s_format_prefix{"tex1_"};
 
+// Budget for loaded textures when the whole pack isn't being cached. Textures which haven't been
+// used for the longest time are dropped first when this is exceeded.
+constexpr size_t STREAMING_BUDGET = size_t(1024) * 1024 * 1024;
+
 static std::unordered_map<std::string, DiskTexture> s_textureMap;
-static std::unordered_map<std::string, std::shared_ptr<HiresTexture>> s_textureCache;
+// Loose files take precedence over textures in packs, so that packs can be patched.
+static std::vector<std::unique_ptr<TexturePack>> s_texturePacks;
+
+// Everything below is protected by s_textureCacheMutex. s_textureMap is only modified while the
+// loader threads are stopped.
+static std::unordered_map<std::string, CachedTexture> s_textureCache;
+static std::list<std::string> s_textureCacheLRU;  // Most recently used first
+static size_t s_textureCacheSize = 0;
+static size_t s_textureCacheBudget = 0;
 static std::mutex s_textureCacheMutex;
-static Common::Flag s_textureCacheAbortLoading;
 
-static std::thread s_prefetcher;
+static std::condition_variable s_loadRequested;
+static std::deque<LoadRequest> s_demandQueue;
+static std::deque<LoadRequest> s_preloadQueue;
+static std::unordered_set<std::string> s_pendingLoads;  // Queued or being loaded on demand
+static std::unordered_set<std::string> s_failedLoads;
+static std::atomic<u32> s_loadGeneration{0};
+static bool s_stopLoaders = false;
+static std::vector<std::thread> s_loaders;
+
+static u32 s_preloadsInFlight = 0;
+static size_t s_preloadedSize = 0;
+static u32 s_preloadStartTime = 0;
+
+// Textures used by the current game, in the order they were first used. Used for preloading the
+// next time the game is started.
+static std::string s_usageHistoryGameID;
+static TextureUsageHistory s_usageHistory;
+
+static size_t GetTextureSize(const HiresTexture& texture)
+{
+  size_t size = 0;
+  for (const HiresTexture::Level& level : texture.m_levels)
+    size += level.data.size();
+  return size;
+}
+
+static size_t GetMaxTextureMemory()
+{
+  const size_t sys_mem = Common::MemPhysical();
+  const size_t recommended_min_mem = 2 * size_t(1024 * 1024 * 1024);
+  // keep 2GB memory for system stability if system RAM is 4GB+ - use half of memory in other cases
+  return (sys_mem / 2 < recommended_min_mem) ? (sys_mem / 2) : (sys_mem - recommended_min_mem);
+}
+
+// Drops least recently used textures until the cache fits in the budget, except for keep.
+static void EvictTextures(const std::string& keep = "")
+{
+  auto iter = s_textureCacheLRU.end();
+  while (s_textureCacheSize > s_textureCacheBudget && iter != s_textureCacheLRU.begin())
+  {
+    --iter;
+    if (*iter == keep)
+      continue;
+
+    auto cache_iter = s_textureCache.find(*iter);
+    s_textureCacheSize -= cache_iter->second.size;
+    s_textureCache.erase(cache_iter);
+    iter = s_textureCacheLRU.erase(iter);
+  }
+}
 
 void HiresTexture::Init()
 {
@@ -56,165 +136,262 @@ void HiresTexture::Init()
 
 void HiresTexture::Shutdown()
 {
-  if (s_prefetcher.joinable())
-  {
-    s_textureCacheAbortLoading.Set();
-    s_prefetcher.join();
-  }
+  StopLoaders();
+  SaveUsageHistory();
 
   s_textureMap.clear();
+  s_texturePacks.clear();
   s_textureCache.clear();
+  s_textureCacheLRU.clear();
+  s_textureCacheSize = 0;
+  s_failedLoads.clear();
+  s_usageHistoryGameID.clear();
+  s_usageHistory.Clear();
 }
 
 void HiresTexture::Update()
 {
-  if (s_prefetcher.joinable())
-  {
-    s_textureCacheAbortLoading.Set();
-    s_prefetcher.join();
-  }
+  StopLoaders();
+  s_failedLoads.clear();
 
+  s_texturePacks.clear();
   if (!g_ActiveConfig.bHiresTextures)
   {
     s_textureMap.clear();
     s_textureCache.clear();
+    s_textureCacheLRU.clear();
+    s_textureCacheSize = 0;
     return;
   }
 
-  if (!g_ActiveConfig.bCacheHiresTextures)
-  {
-    s_textureCache.clear();
-  }
-
   const std::string& game_id = SConfig::GetInstance().GetGameID();
   const std::set<std::string> texture_directories = GetTextureDirectories(game_id);
-  const std::vector<std::string> extensions{".png", ".dds"};
 
+  std::vector<std::string> pack_paths;
   for (const auto& texture_directory : texture_directories)
+    FindTextures(texture_directory, &s_textureMap, &pack_paths);
+
+  for (const std::string& path : pack_paths)
   {
-    const auto texture_paths =
-        Common::DoFileSearch({texture_directory}, extensions, /*recursive*/ true);
+    auto pack = std::make_unique<TexturePack>();
+    if (pack->Open(path))
+      s_texturePacks.push_back(std::move(pack));
+  }
 
-    bool failed_insert = false;
-    for (auto& path : texture_paths)
+  // remove cached but deleted textures
+  auto iter = s_textureCacheLRU.begin();
+  while (iter != s_textureCacheLRU.end())
+  {
+    if (!HasTexture(*iter))
     {
-      std::string filename;
-      SplitPath(path, nullptr, &filename, nullptr);
-
-      if (filename.substr(0, s_format_prefix.length()) == s_format_prefix)
-      {
-        const size_t arb_index = filename.rfind("_arb");
-        const bool has_arbitrary_mipmaps = arb_index != std::string::npos;
-        if (has_arbitrary_mipmaps)
-          filename.erase(arb_index, 4);
-
-        const auto [it, inserted] =
-            s_textureMap.try_emplace(filename, DiskTexture{path, has_arbitrary_mipmaps});
-        if (!inserted)
-        {
-          failed_insert = true;
-        }
-      }
+      auto cache_iter = s_textureCache.find(*iter);
+      s_textureCacheSize -= cache_iter->second.size;
+      s_textureCache.erase(cache_iter);
+      iter = s_textureCacheLRU.erase(iter);
     }
-
-    if (failed_insert)
+    else
     {
-      ERROR_LOG(VIDEO, "One or more textures at path '%s' were already inserted",
-                texture_directory.c_str());
+      iter++;
     }
   }
 
+  const size_t max_mem = GetMaxTextureMemory();
+  s_textureCacheBudget =
+      g_ActiveConfig.bCacheHiresTextures ? max_mem : std::min(max_mem, STREAMING_BUDGET);
+  EvictTextures();
+
+  if (game_id != s_usageHistoryGameID)
+  {
+    SaveUsageHistory();
+    LoadUsageHistory(game_id);
+  }
+
+  QueuePreloads();
+  StartLoaders();
+}
+
+void HiresTexture::StartLoaders()
+{
+  s_stopLoaders = false;
+
+  const u32 num_loaders = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+  for (u32 i = 0; i < num_loaders; i++)
+    s_loaders.emplace_back(LoaderThread);
+}
+
+void HiresTexture::StopLoaders()
+{
+  {
+    std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+    s_stopLoaders = true;
+  }
+  s_loadRequested.notify_all();
+
+  for (std::thread& loader : s_loaders)
+    loader.join();
+  s_loaders.clear();
+
+  // Anyone waiting for a texture will have to request it again.
+  s_demandQueue.clear();
+  s_preloadQueue.clear();
+  s_pendingLoads.clear();
+  s_preloadsInFlight = 0;
+  s_loadGeneration++;
+}
+
+// Preloads the textures the game used last time, in the order it used them. When caching is
+// enabled, everything else in the pack is preloaded afterwards.
+void HiresTexture::QueuePreloads()
+{
+  std::unordered_set<std::string> queued;
+  for (const std::string& base_filename : s_usageHistory.GetTextures())
+  {
+    if (HasTexture(base_filename) && queued.insert(base_filename).second)
+      s_preloadQueue.push_back({base_filename, 0, 0});
+  }
+
   if (g_ActiveConfig.bCacheHiresTextures)
   {
-    // remove cached but deleted textures
-    auto iter = s_textureCache.begin();
-    while (iter != s_textureCache.end())
+    for (const auto& entry : s_textureMap)
     {
-      if (s_textureMap.find(iter->first) == s_textureMap.end())
-      {
-        iter = s_textureCache.erase(iter);
-      }
-      else
+      const std::string& base_filename = entry.first;
+      if (base_filename.find("_mip") == std::string::npos && queued.insert(base_filename).second)
+        s_preloadQueue.push_back({base_filename, 0, 0});
+    }
+
+    for (const auto& pack : s_texturePacks)
+    {
+      for (u32 i = 0; i < pack->GetTextureCount(); i++)
       {
-        iter++;
+        std::string base_filename(pack->GetTextureName(i));
+        if (queued.insert(base_filename).second)
+          s_preloadQueue.push_back({std::move(base_filename), 0, 0});
       }
     }
-
-    s_textureCacheAbortLoading.Clear();
-    s_prefetcher = std::thread(Prefetch);
   }
+
+  s_preloadedSize = 0;
+  s_preloadStartTime = Common::Timer::GetTimeMs();
 }
 
-void HiresTexture::Prefetch()
+void HiresTexture::LoaderThread()
 {
-  Common::SetCurrentThreadName("Prefetcher");
+  Common::SetCurrentThreadName("Custom Texture Loader");
 
-  size_t size_sum = 0;
-  const size_t sys_mem = Common::MemPhysical();
-  const size_t recommended_min_mem = 2 * size_t(1024 * 1024 * 1024);
-  // keep 2GB memory for system stability if system RAM is 4GB+ - use half of memory in other cases
-  const size_t max_mem =
-      (sys_mem / 2 < recommended_min_mem) ? (sys_mem / 2) : (sys_mem - recommended_min_mem);
-
-  const u32 start_time = Common::Timer::GetTimeMs();
-  for (const auto& entry : s_textureMap)
+  std::unique_lock<std::mutex> lk(s_textureCacheMutex);
+  while (true)
   {
-    const std::string& base_filename = entry.first;
+    s_loadRequested.wait(lk, [] {
+      return s_stopLoaders || !s_demandQueue.empty() || !s_preloadQueue.empty();
+    });
+    if (s_stopLoaders)
+      return;
 
-    if (base_filename.find("_mip") == std::string::npos)
-    {
-      std::unique_lock<std::mutex> lk(s_textureCacheMutex);
+    // Textures which are needed right now go first.
+    const bool preload = s_demandQueue.empty();
+    std::deque<LoadRequest>& queue = preload ? s_preloadQueue : s_demandQueue;
+    const LoadRequest request = std::move(queue.front());
+    queue.pop_front();
 
-      auto iter = s_textureCache.find(base_filename);
-      if (iter == s_textureCache.end())
+    if (preload)
+    {
+      if (s_textureCache.count(request.base_filename) ||
+          s_pendingLoads.count(request.base_filename) ||
+          s_failedLoads.count(request.base_filename))
       {
-        // unlock while loading a texture. This may result in a race condition where
-        // we'll load a texture twice, but it reduces the stuttering a lot.
-        lk.unlock();
-        std::unique_ptr<HiresTexture> texture = Load(base_filename, 0, 0);
-        lk.lock();
-        if (texture)
-        {
-          std::shared_ptr<HiresTexture> ptr(std::move(texture));
-          iter = s_textureCache.insert(iter, std::make_pair(base_filename, ptr));
-        }
+        continue;
       }
-      if (iter != s_textureCache.end())
+
+      // Preloads never evict anything, so stop once the budget is used up.
+      if (s_textureCacheSize >= s_textureCacheBudget)
       {
-        for (const Level& l : iter->second->m_levels)
-          size_sum += l.data.size();
+        s_preloadQueue.clear();
+        OSD::AddMessage(fmt::format("Custom Textures preloading stopped after {:.1f} MB, "
+                                    "memory budget reached",
+                                    s_preloadedSize / (1024.0 * 1024.0)),
+                        10000);
+        continue;
       }
+
+      s_preloadsInFlight++;
     }
 
-    if (s_textureCacheAbortLoading.IsSet())
-    {
+    // A texture requested while it is being preloaded will be picked up by IsLoadPending().
+    s_pendingLoads.insert(request.base_filename);
+
+    lk.unlock();
+    std::unique_ptr<HiresTexture> texture =
+        Load(request.base_filename, request.width, request.height);
+    lk.lock();
+
+    if (s_stopLoaders)
       return;
-    }
 
-    if (size_sum > max_mem)
+    s_pendingLoads.erase(request.base_filename);
+    if (texture)
+    {
+      const size_t size = GetTextureSize(*texture);
+      s_textureCacheLRU.push_front(request.base_filename);
+      s_textureCache[request.base_filename] =
+          CachedTexture{std::move(texture), size, s_textureCacheLRU.begin()};
+      s_textureCacheSize += size;
+      if (preload)
+        s_preloadedSize += size;
+      else
+        EvictTextures(request.base_filename);
+    }
+    else
     {
-      Config::SetCurrent(Config::GFX_HIRES_TEXTURES, false);
+      s_failedLoads.insert(request.base_filename);
+    }
+    s_loadGeneration++;
 
-      OSD::AddMessage(
-          fmt::format(
-              "Custom Textures prefetching after {:.1f} MB aborted, not enough RAM available",
-              size_sum / (1024.0 * 1024.0)),
-          10000);
-      return;
+    if (preload && --s_preloadsInFlight == 0 && s_preloadQueue.empty() && s_preloadedSize != 0)
+    {
+      const u32 stop_time = Common::Timer::GetTimeMs();
+      OSD::AddMessage(fmt::format("Custom Textures loaded, {:.1f} MB in {:.1f}s",
+                                  s_preloadedSize / (1024.0 * 1024.0),
+                                  (stop_time - s_preloadStartTime) / 1000.0),
+                      10000);
     }
   }
+}
 
-  const u32 stop_time = Common::Timer::GetTimeMs();
-  OSD::AddMessage(fmt::format("Custom Textures loaded, {:.1f} MB in {:.1f}s",
-                              size_sum / (1024.0 * 1024.0), (stop_time - start_time) / 1000.0),
-                  10000);
+std::string HiresTexture::GetUsageHistoryFilename(const std::string& game_id)
+{
+  return File::GetUserPath(D_CACHE_IDX) + "HiresTextures" DIR_SEP + game_id + ".txt";
+}
+
+void HiresTexture::LoadUsageHistory(const std::string& game_id)
+{
+  s_usageHistoryGameID = game_id;
+  s_usageHistory.Clear();
+  if (game_id.empty())
+    return;
+
+  // Textures that were removed from the packs since are dropped from the history.
+  std::string contents;
+  if (File::ReadFileToString(GetUsageHistoryFilename(game_id), contents))
+    s_usageHistory.Load(contents, HasTexture);
+}
+
+void HiresTexture::SaveUsageHistory()
+{
+  if (s_usageHistoryGameID.empty() || s_usageHistory.GetTextures().empty())
+    return;
+
+  const std::string contents = s_usageHistory.Serialize();
+  const std::string filename = GetUsageHistoryFilename(s_usageHistoryGameID);
+  File::CreateFullPath(filename);
+  if (!File::WriteStringToFile(filename, contents))
+    ERROR_LOG(VIDEO, "Failed to write custom texture usage history to %s", filename.c_str());
 }
 
 std::string HiresTexture::GenBaseName(const u8* texture, size_t texture_size, const u8* tlut,
                                       size_t tlut_size, u32 width, u32 height, TextureFormat format,
                                       bool has_mipmaps, bool dump)
 {
-  if (!dump && s_textureMap.empty())
+  if (!dump && s_textureMap.empty() && s_texturePacks.empty())
     return "";
 
   // checking for min/max on paletted textures
@@ -274,12 +451,12 @@ std::string HiresTexture::GenBaseName(const u8* texture, size_t texture_size, co
   if (!dump)
   {
     const std::string texture_name = fmt::format("{}_${}", base_name, format_name);
-    if (s_textureMap.find(texture_name) != s_textureMap.end())
+    if (HasTexture(texture_name))
       return texture_name;
   }
 
   // else generate the complete texture
-  if (dump || s_textureMap.find(full_name) != s_textureMap.end())
+  if (dump || HasTexture(full_name))
     return full_name;
 
   return "";
@@ -303,35 +480,78 @@ u32 HiresTexture::CalculateMipCount(u32 width, u32 height)
 std::shared_ptr<HiresTexture> HiresTexture::Search(const u8* texture, size_t texture_size,
                                                    const u8* tlut, size_t tlut_size, u32 width,
                                                    u32 height, TextureFormat format,
-                                                   bool has_mipmaps)
+                                                   bool has_mipmaps, std::string* pending_name)
 {
   std::string base_filename =
       GenBaseName(texture, texture_size, tlut, tlut_size, width, height, format, has_mipmaps);
+  if (base_filename.empty())
+    return nullptr;
 
   std::lock_guard<std::mutex> lk(s_textureCacheMutex);
 
+  // Textures that aren't in the packs are never loaded, so they aren't worth recording.
+  if (!s_usageHistory.Contains(base_filename) && HasTexture(base_filename))
+    s_usageHistory.Add(base_filename);
+
   auto iter = s_textureCache.find(base_filename);
   if (iter != s_textureCache.end())
   {
-    return iter->second;
+    s_textureCacheLRU.splice(s_textureCacheLRU.begin(), s_textureCacheLRU, iter->second.lru_iter);
+    return iter->second.texture;
   }
 
-  std::shared_ptr<HiresTexture> ptr(Load(base_filename, width, height));
+  if (s_failedLoads.count(base_filename))
+    return nullptr;
 
-  if (ptr && g_ActiveConfig.bCacheHiresTextures)
+  if (!s_pendingLoads.count(base_filename))
   {
-    s_textureCache[base_filename] = ptr;
+    s_pendingLoads.insert(base_filename);
+    s_demandQueue.push_back({base_filename, width, height});
+    s_loadRequested.notify_one();
   }
 
-  return ptr;
+  if (pending_name)
+    *pending_name = std::move(base_filename);
+  return nullptr;
+}
+
+u32 HiresTexture::GetLoadGeneration()
+{
+  return s_loadGeneration.load();
+}
+
+bool HiresTexture::IsLoadPending(const std::string& base_filename)
+{
+  std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+  return s_pendingLoads.count(base_filename) != 0;
 }
 
 std::unique_ptr<HiresTexture> HiresTexture::Load(const std::string& base_filename, u32 width,
                                                  u32 height)
+{
+  const auto filename_iter = s_textureMap.find(base_filename);
+  if (filename_iter != s_textureMap.end())
+  {
+    return Validate(LoadFromFiles(s_textureMap, base_filename), filename_iter->second.path, width,
+                    height);
+  }
+
+  for (const auto& pack : s_texturePacks)
+  {
+    if (pack->Contains(base_filename))
+      return Validate(LoadFromPack(*pack, base_filename), pack->GetFilename(), width, height);
+  }
+
+  return nullptr;
+}
+
+std::unique_ptr<HiresTexture>
+HiresTexture::LoadFromFiles(const std::unordered_map<std::string, DiskTexture>& texture_map,
+                            const std::string& base_filename)
 {
   // We need to have a level 0 custom texture to even consider loading.
-  auto filename_iter = s_textureMap.find(base_filename);
-  if (filename_iter == s_textureMap.end())
+  auto filename_iter = texture_map.find(base_filename);
+  if (filename_iter == texture_map.end())
     return nullptr;
 
   // Try to load level 0 (and any mipmaps) from a DDS file.
@@ -349,8 +569,8 @@ std::unique_ptr<HiresTexture> HiresTexture::Load(const std::string& base_filenam
     if (mip_level != 0)
       filename += fmt::format("_mip{}", mip_level);
 
-    filename_iter = s_textureMap.find(filename);
-    if (filename_iter == s_textureMap.end())
+    filename_iter = texture_map.find(filename);
+    if (filename_iter == texture_map.end())
       break;
 
     // Try loading DDS textures first, that way we maintain compression of DXT formats.
@@ -377,6 +597,41 @@ std::unique_ptr<HiresTexture> HiresTexture::Load(const std::string& base_filenam
   if (ret->m_levels.empty())
     return nullptr;
 
+  return ret;
+}
+
+std::unique_ptr<HiresTexture> HiresTexture::LoadFromPack(const TexturePack& pack,
+                                                         const std::string& base_filename)
+{
+  std::unique_ptr<HiresTexture> ret = std::unique_ptr<HiresTexture>(new HiresTexture());
+  if (!pack.ReadTexture(base_filename, &ret->m_levels, &ret->m_has_arbitrary_mipmaps) ||
+      ret->m_levels.empty())
+  {
+    return nullptr;
+  }
+
+  // Block compressed levels are stored as they are, so the backend has to support them.
+  const AbstractTextureFormat format = ret->m_levels[0].format;
+  const bool supported = format == AbstractTextureFormat::RGBA8 ||
+                         (format == AbstractTextureFormat::BPTC ?
+                              g_ActiveConfig.backend_info.bSupportsBPTCTextures :
+                              g_ActiveConfig.backend_info.bSupportsST3CTextures);
+  if (!supported)
+  {
+    ERROR_LOG(VIDEO, "Custom texture %s in %s uses a compressed format that is not supported",
+              base_filename.c_str(), pack.GetFilename().c_str());
+    return nullptr;
+  }
+
+  return ret;
+}
+
+std::unique_ptr<HiresTexture> HiresTexture::Validate(std::unique_ptr<HiresTexture> ret,
+                                                     const std::string& path, u32 width, u32 height)
+{
+  if (!ret)
+    return nullptr;
+
   // Verify that the aspect ratio of the texture hasn't changed, as this could have side-effects.
   const Level& first_mip = ret->m_levels[0];
   if (first_mip.width * height != first_mip.height * width)
@@ -384,7 +639,7 @@ std::unique_ptr<HiresTexture> HiresTexture::Load(const std::string& base_filenam
     ERROR_LOG(VIDEO,
               "Invalid custom texture size %ux%u for texture %s. The aspect differs "
               "from the native size %ux%u.",
-              first_mip.width, first_mip.height, first_mip_file.path.c_str(), width, height);
+              first_mip.width, first_mip.height, path.c_str(), width, height);
   }
 
   // Same deal if the custom texture isn't a multiple of the native size.
@@ -393,7 +648,7 @@ std::unique_ptr<HiresTexture> HiresTexture::Load(const std::string& base_filenam
     ERROR_LOG(VIDEO,
               "Invalid custom texture size %ux%u for texture %s. Please use an integer "
               "upscaling factor based on the native size %ux%u.",
-              first_mip.width, first_mip.height, first_mip_file.path.c_str(), width, height);
+              first_mip.width, first_mip.height, path.c_str(), width, height);
   }
 
   // Verify that each mip level is the correct size (divide by 2 each time).
@@ -412,14 +667,14 @@ std::unique_ptr<HiresTexture> HiresTexture::Load(const std::string& base_filenam
 
       ERROR_LOG(VIDEO,
                 "Invalid custom texture size %dx%d for texture %s. Mipmap level %u must be %dx%d.",
-                level.width, level.height, first_mip_file.path.c_str(), mip_level,
-                current_mip_width, current_mip_height);
+                level.width, level.height, path.c_str(), mip_level, current_mip_width,
+                current_mip_height);
     }
     else
     {
       // It is invalid to have more than a single 1x1 mipmap.
       ERROR_LOG(VIDEO, "Custom texture %s has too many 1x1 mipmaps. Skipping extra levels.",
-                first_mip_file.path.c_str());
+                path.c_str());
     }
 
     // Drop this mip level and any others after it.
@@ -431,8 +686,7 @@ std::unique_ptr<HiresTexture> HiresTexture::Load(const std::string& base_filenam
   if (std::any_of(ret->m_levels.begin(), ret->m_levels.end(),
                   [&ret](const Level& l) { return l.format != ret->m_levels[0].format; }))
   {
-    ERROR_LOG(VIDEO, "Custom texture %s has inconsistent formats across mip levels.",
-              first_mip_file.path.c_str());
+    ERROR_LOG(VIDEO, "Custom texture %s has inconsistent formats across mip levels.", path.c_str());
 
     return nullptr;
   }
@@ -454,6 +708,98 @@ bool HiresTexture::LoadTexture(Level& level, const std::vector<u8>& buffer)
   return true;
 }
 
+void HiresTexture::FindTextures(const std::string& directory,
+                                std::unordered_map<std::string, DiskTexture>* texture_map,
+                                std::vector<std::string>* pack_paths)
+{
+  const std::vector<std::string> extensions{".png", ".dds", ".dtp"};
+  const auto texture_paths = Common::DoFileSearch({directory}, extensions, /*recursive*/ true);
+
+  bool failed_insert = false;
+  for (auto& path : texture_paths)
+  {
+    std::string filename;
+    std::string extension;
+    SplitPath(path, nullptr, &filename, &extension);
+
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](char c) { return static_cast<char>(std::tolower(static_cast<u8>(c))); });
+    if (extension == ".dtp")
+    {
+      if (pack_paths)
+        pack_paths->push_back(path);
+    }
+    else if (filename.substr(0, s_format_prefix.length()) == s_format_prefix)
+    {
+      const size_t arb_index = filename.rfind("_arb");
+      const bool has_arbitrary_mipmaps = arb_index != std::string::npos;
+      if (has_arbitrary_mipmaps)
+        filename.erase(arb_index, 4);
+
+      const auto [it, inserted] =
+          texture_map->try_emplace(filename, DiskTexture{path, has_arbitrary_mipmaps});
+      if (!inserted)
+      {
+        failed_insert = true;
+      }
+    }
+  }
+
+  if (failed_insert)
+  {
+    ERROR_LOG(VIDEO, "One or more textures at path '%s' were already inserted", directory.c_str());
+  }
+}
+
+bool HiresTexture::HasTexture(const std::string& base_filename)
+{
+  if (s_textureMap.find(base_filename) != s_textureMap.end())
+    return true;
+
+  return std::any_of(s_texturePacks.begin(), s_texturePacks.end(),
+                     [&base_filename](const auto& pack) { return pack->Contains(base_filename); });
+}
+
+bool HiresTexture::WriteTexturePack(const std::string& directory, const std::string& pack_filename,
+                                    u32* num_textures)
+{
+  *num_textures = 0;
+
+  std::unordered_map<std::string, DiskTexture> texture_map;
+  FindTextures(directory, &texture_map, nullptr);
+
+  // Mip levels are stored together with their base texture.
+  std::vector<std::string> base_filenames;
+  for (const auto& entry : texture_map)
+  {
+    if (entry.first.find("_mip") == std::string::npos)
+      base_filenames.push_back(entry.first);
+  }
+  std::sort(base_filenames.begin(), base_filenames.end());
+
+  TexturePackWriter writer;
+  if (!writer.Open(pack_filename))
+    return false;
+
+  for (const std::string& base_filename : base_filenames)
+  {
+    const std::unique_ptr<HiresTexture> texture =
+        Validate(LoadFromFiles(texture_map, base_filename), texture_map[base_filename].path, 0, 0);
+    if (!texture)
+    {
+      ERROR_LOG(VIDEO, "Skipping custom texture %s", base_filename.c_str());
+      continue;
+    }
+
+    if (!writer.AddTexture(base_filename, texture->m_levels, texture->m_has_arbitrary_mipmaps))
+      return false;
+
+    (*num_textures)++;
+  }
+
+  return writer.Finish();
+}
+
 std::set<std::string> HiresTexture::GetTextureDirectories(const std::string& game_id)
 {
   std::set<std::string> result;
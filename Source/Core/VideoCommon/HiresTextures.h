@@ -7,12 +7,15 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "Common/CommonTypes.h"
 #include "VideoCommon/TextureConfig.h"
 
 enum class TextureFormat;
+struct DiskTexture;
+class TexturePack;
 
 class HiresTexture
 {
@@ -21,9 +24,17 @@ public:
   static void Update();
   static void Shutdown();
 
+  // Returns the custom texture if it is already loaded. Otherwise, the texture is queued for
+  // loading on a worker thread, nullptr is returned and the name of the texture is written to
+  // pending_name, so the caller can check for it with IsLoadPending() and pick it up later.
   static std::shared_ptr<HiresTexture> Search(const u8* texture, size_t texture_size,
                                               const u8* tlut, size_t tlut_size, u32 width,
-                                              u32 height, TextureFormat format, bool has_mipmaps);
+                                              u32 height, TextureFormat format, bool has_mipmaps,
+                                              std::string* pending_name = nullptr);
+
+  // Incremented every time a queued load finishes or is cancelled.
+  static u32 GetLoadGeneration();
+  static bool IsLoadPending(const std::string& base_filename);
 
   static std::string GenBaseName(const u8* texture, size_t texture_size, const u8* tlut,
                                  size_t tlut_size, u32 width, u32 height, TextureFormat format,
@@ -31,6 +42,10 @@ public:
 
   static u32 CalculateMipCount(u32 width, u32 height);
 
+  // Packs all custom textures found in directory into a single texture pack file.
+  static bool WriteTexturePack(const std::string& directory, const std::string& pack_filename,
+                               u32* num_textures);
+
   ~HiresTexture();
 
   AbstractTextureFormat GetFormat() const;
@@ -49,12 +64,30 @@ public:
 private:
   static std::unique_ptr<HiresTexture> Load(const std::string& base_filename, u32 width,
                                             u32 height);
+  static std::unique_ptr<HiresTexture>
+  LoadFromFiles(const std::unordered_map<std::string, DiskTexture>& texture_map,
+                const std::string& base_filename);
+  static std::unique_ptr<HiresTexture> LoadFromPack(const TexturePack& pack,
+                                                    const std::string& base_filename);
+  static std::unique_ptr<HiresTexture> Validate(std::unique_ptr<HiresTexture> ret,
+                                                const std::string& path, u32 width, u32 height);
   static bool LoadDDSTexture(HiresTexture* tex, const std::string& filename);
   static bool LoadDDSTexture(Level& level, const std::string& filename, u32 mip_level);
   static bool LoadTexture(Level& level, const std::vector<u8>& buffer);
-  static void Prefetch();
+  static void StartLoaders();
+  static void StopLoaders();
+  static void LoaderThread();
+  static void QueuePreloads();
+
+  static std::string GetUsageHistoryFilename(const std::string& game_id);
+  static void LoadUsageHistory(const std::string& game_id);
+  static void SaveUsageHistory();
 
   static std::set<std::string> GetTextureDirectories(const std::string& game_id);
+  static void FindTextures(const std::string& directory,
+                           std::unordered_map<std::string, DiskTexture>* texture_map,
+                           std::vector<std::string>* pack_paths);
+  static bool HasTexture(const std::string& base_filename);
 
   HiresTexture() {}
   bool m_has_arbitrary_mipmaps;
@@ -91,6 +91,7 @@ void ShaderCache::Reload()
 void ShaderCache::RetrieveAsyncShaders()
 {
   m_async_shader_compiler->RetrieveWorkItems();
+  g_stats.shader_compile_times = m_async_shader_compiler->GetCompileTimes();
 }
 
 void ShaderCache::Shutdown()
@@ -136,6 +137,34 @@ std::optional<const AbstractPipeline*> ShaderCache::GetPipelineForUidAsync(const
   return {};
 }
 
+std::optional<const AbstractPipeline*>
+ShaderCache::GetSpecializedUberPipelineForUidAsync(const GXUberPipelineUid& uid)
+{
+  GXUberPipelineUid specialized_uid = uid;
+  specialized_uid.ps_uid = UberShader::GetSpecializedPixelShaderUid(uid.ps_uid);
+
+  auto it = m_gx_uber_pipeline_cache.find(specialized_uid);
+  if (it != m_gx_uber_pipeline_cache.end())
+  {
+    // Fall back to the generic ubershader if this one failed to compile.
+    if (!it->second.second && it->second.first)
+      return it->second.first.get();
+    else
+      return {};
+  }
+
+  // The specialized shaders are lagging behind when there are more on demand compiles waiting
+  // than there are workers to pick them up.
+  if (m_async_shader_compiler->GetPendingWorkItemCount(COMPILE_PRIORITY_ONDEMAND_PIPELINE) <=
+      m_async_shader_compiler->GetWorkerThreadCount())
+  {
+    return {};
+  }
+
+  QueueUberPipelineCompile(specialized_uid, COMPILE_PRIORITY_SPECIALIZED_UBERSHADER_PIPELINE);
+  return {};
+}
+
 const AbstractPipeline* ShaderCache::GetUberPipelineForUid(const GXUberPipelineUid& uid)
 {
   auto it = m_gx_uber_pipeline_cache.find(uid);
@@ -842,6 +871,8 @@ void ShaderCache::QueueVertexShaderCompile(const VertexShaderUid& uid, u32 prior
 
     void Retrieve() override { shader_cache->InsertVertexShader(uid, std::move(shader)); }
 
+    ShaderCompileType GetType() const override { return ShaderCompileType::VertexShader; }
+
   private:
     ShaderCache* shader_cache;
     std::unique_ptr<AbstractShader> shader;
@@ -871,6 +902,8 @@ void ShaderCache::QueueVertexUberShaderCompile(const UberShader::VertexShaderUid
 
     void Retrieve() override { shader_cache->InsertVertexUberShader(uid, std::move(shader)); }
 
+    ShaderCompileType GetType() const override { return ShaderCompileType::VertexUberShader; }
+
   private:
     ShaderCache* shader_cache;
     std::unique_ptr<AbstractShader> shader;
@@ -900,6 +933,8 @@ void ShaderCache::QueuePixelShaderCompile(const PixelShaderUid& uid, u32 priorit
 
     void Retrieve() override { shader_cache->InsertPixelShader(uid, std::move(shader)); }
 
+    ShaderCompileType GetType() const override { return ShaderCompileType::PixelShader; }
+
   private:
     ShaderCache* shader_cache;
     std::unique_ptr<AbstractShader> shader;
@@ -929,6 +964,8 @@ void ShaderCache::QueuePixelUberShaderCompile(const UberShader::PixelShaderUid&
 
     void Retrieve() override { shader_cache->InsertPixelUberShader(uid, std::move(shader)); }
 
+    ShaderCompileType GetType() const override { return ShaderCompileType::PixelUberShader; }
+
   private:
     ShaderCache* shader_cache;
     std::unique_ptr<AbstractShader> shader;
@@ -996,6 +1033,8 @@ void ShaderCache::QueuePipelineCompile(const GXPipelineUid& uid, u32 priority)
       }
     }
 
+    ShaderCompileType GetType() const override { return ShaderCompileType::Pipeline; }
+
   private:
     ShaderCache* shader_cache;
     std::unique_ptr<AbstractPipeline> pipeline;
@@ -1069,6 +1108,8 @@ void ShaderCache::QueueUberPipelineCompile(const GXUberPipelineUid& uid, u32 pri
       }
     }
 
+    ShaderCompileType GetType() const override { return ShaderCompileType::UberPipeline; }
+
   private:
     ShaderCache* shader_cache;
     std::unique_ptr<AbstractPipeline> UberPipeline;
@@ -69,6 +69,12 @@ public:
   // The optional will be empty if this pipeline is now background compiling.
   std::optional<const AbstractPipeline*> GetPipelineForUidAsync(const GXPipelineUid& uid);
 
+  // Accesses the partially specialized ubershader pipeline for the current state, which is
+  // faster to run than the generic ubershader. It is only compiled while the specialized shaders
+  // are lagging behind, the optional will be empty until it is ready.
+  std::optional<const AbstractPipeline*>
+  GetSpecializedUberPipelineForUidAsync(const GXUberPipelineUid& uid);
+
   // Shared shaders
   const AbstractShader* GetScreenQuadVertexShader() const
   {
@@ -179,15 +185,19 @@ private:
   template <typename T, typename Y>
   void ClearPipelineCache(T& cache, Y& disk_cache);
 
-  // Priorities for compiling. The lower the value, the sooner the pipeline is compiled.
-  // The shader cache is compiled last, as it is the least likely to be required. On demand
-  // shaders are always compiled before pending ubershaders, as we want to use the ubershader
-  // for as few frames as possible, otherwise we risk framerate drops.
+  // Priorities for compiling. The lower the value, the sooner the pipeline is compiled. Each
+  // priority is a separate lane in the async compiler. On demand pipelines are needed to draw
+  // the current frame, while the others are speculative precompiles. Partially specialized
+  // ubershaders are only requested when the on demand pipelines are backed up. The shader cache
+  // is compiled last, as it is the least likely to be required. On demand shaders are always
+  // compiled before pending ubershaders, as we want to use the ubershader for as few frames as
+  // possible, otherwise we risk framerate drops.
   enum : u32
   {
-    COMPILE_PRIORITY_ONDEMAND_PIPELINE = 100,
-    COMPILE_PRIORITY_UBERSHADER_PIPELINE = 200,
-    COMPILE_PRIORITY_SHADERCACHE_PIPELINE = 300
+    COMPILE_PRIORITY_ONDEMAND_PIPELINE = 0,
+    COMPILE_PRIORITY_SPECIALIZED_UBERSHADER_PIPELINE = 1,
+    COMPILE_PRIORITY_UBERSHADER_PIPELINE = 2,
+    COMPILE_PRIORITY_SHADERCACHE_PIPELINE = 3
   };
 
   // Configuration bits.
@@ -4,6 +4,7 @@
 
 #include "VideoCommon/Statistics.h"
 
+#include <array>
 #include <utility>
 
 #include <imgui.h>
@@ -87,6 +88,20 @@ void Statistics::Display() const
   draw_statistic("EFB peeks:", "%d", this_frame.num_efb_peeks);
   draw_statistic("EFB pokes:", "%d", this_frame.num_efb_pokes);
 
+  static constexpr std::array<const char*, NUM_SHADER_COMPILE_TYPES> compile_type_names = {
+      {"vshader compiles", "pshader compiles", "uber vshader compiles", "uber pshader compiles",
+       "pipeline compiles", "uber pipeline compiles"}};
+  for (size_t i = 0; i < NUM_SHADER_COMPILE_TYPES; i++)
+  {
+    const ShaderCompileTimes& times = shader_compile_times[i];
+    if (times.num_compiles == 0)
+      continue;
+
+    draw_statistic(compile_type_names[i], "%d, wait %.2f ms, compile %.2f ms (max %.2f ms)",
+                   times.num_compiles, times.total_queue_wait_ms / times.num_compiles,
+                   times.total_compile_ms / times.num_compiles, times.max_compile_ms);
+  }
+
   ImGui::Columns(1);
 
   ImGui::End();
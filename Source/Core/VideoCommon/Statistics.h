@@ -5,6 +5,18 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
+
+enum class ShaderCompileType
+{
+  VertexShader,
+  PixelShader,
+  VertexUberShader,
+  PixelUberShader,
+  Pipeline,
+  UberPipeline
+};
+constexpr size_t NUM_SHADER_COMPILE_TYPES = 6;
 
 struct Statistics
 {
@@ -19,6 +31,17 @@ struct Statistics
 
   int num_vertex_loaders;
 
+  // Accumulated since the shader cache was created. The queue wait is the time between
+  // queueing a compile and a worker thread starting it.
+  struct ShaderCompileTimes
+  {
+    int num_compiles;
+    float total_queue_wait_ms;
+    float total_compile_ms;
+    float max_compile_ms;
+  };
+  std::array<ShaderCompileTimes, NUM_SHADER_COMPILE_TYPES> shader_compile_times;
+
   std::array<float, 6> proj;
   std::array<float, 16> gproj;
   std::array<float, 16> g2proj;
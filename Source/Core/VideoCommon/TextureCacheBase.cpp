@@ -1413,6 +1413,13 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
           entry->native_levels >= tex_levels && entry->native_width == nativeW &&
           entry->native_height == nativeH)
       {
+        // Replace the native texture once its custom texture has been loaded.
+        if (IsCustomTextureReady(entry))
+        {
+          iter = InvalidateTexture(iter);
+          continue;
+        }
+
         entry = DoPartialTextureUpdates(iter->second, &texMem[tlutaddr], tlutfmt);
         entry->texture->FinishedRendering();
         return entry;
@@ -1464,6 +1471,7 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
   // textures cause unnecessary slowdowns
   // Example: Tales of Symphonia (GC) uses over 500 small textures in menus, but only around 70
   // different ones
+  TexAddrCache::iterator replaced_entry = textures_by_address.end();
   if (textureCacheSafetyColorSampleSize == 0 ||
       std::max(texture_size, palette_size) <= (u32)textureCacheSafetyColorSampleSize * 8)
   {
@@ -1476,6 +1484,12 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
       if (entry->format == full_format && entry->native_levels >= tex_levels &&
           entry->native_width == nativeW && entry->native_height == nativeH)
       {
+        if (IsCustomTextureReady(entry))
+        {
+          replaced_entry = GetTexCacheIter(entry);
+          break;
+        }
+
         entry = DoPartialTextureUpdates(hash_iter->second, &texMem[tlutaddr], tlutfmt);
         entry->texture->FinishedRendering();
         return entry;
@@ -1488,14 +1502,22 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
   if (temp_frameCount != 0x7fffffff)
   {
     // pool this texture and make a new one later
+    if (oldest_entry == replaced_entry)
+      replaced_entry = textures_by_address.end();
     InvalidateTexture(oldest_entry);
   }
 
+  // Drop the duplicate whose custom texture has finished loading, it is recreated below.
+  if (replaced_entry != textures_by_address.end())
+    InvalidateTexture(replaced_entry);
+
   std::shared_ptr<HiresTexture> hires_tex;
+  std::string pending_hires_tex;
+  const u32 hires_load_generation = HiresTexture::GetLoadGeneration();
   if (g_ActiveConfig.bHiresTextures)
   {
     hires_tex = HiresTexture::Search(src_data, texture_size, &texMem[tlutaddr], palette_size, width,
-                                     height, texformat, use_mipmaps);
+                                     height, texformat, use_mipmaps, &pending_hires_tex);
 
     if (hires_tex)
     {
@@ -1598,6 +1620,8 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
   entry->SetDimensions(nativeW, nativeH, tex_levels);
   entry->SetHashes(base_hash, full_hash);
   entry->is_custom_tex = hires_tex != nullptr;
+  entry->pending_custom_tex = std::move(pending_hires_tex);
+  entry->custom_tex_load_generation = hires_load_generation;
   entry->memory_stride = entry->BytesPerRow();
   entry->SetNotCopy();
 
@@ -2521,6 +2545,24 @@ TextureCacheBase::GetTexCacheIter(TextureCacheBase::TCacheEntry* entry)
   return textures_by_address.end();
 }
 
+bool TextureCacheBase::IsCustomTextureReady(TCacheEntry* entry)
+{
+  if (entry->pending_custom_tex.empty())
+    return false;
+
+  // Only look up the texture when a load has finished since the last check.
+  const u32 load_generation = HiresTexture::GetLoadGeneration();
+  if (entry->custom_tex_load_generation == load_generation)
+    return false;
+  entry->custom_tex_load_generation = load_generation;
+
+  if (HiresTexture::IsLoadPending(entry->pending_custom_tex))
+    return false;
+
+  entry->pending_custom_tex.clear();
+  return true;
+}
+
 std::pair<TextureCacheBase::TexAddrCache::iterator, TextureCacheBase::TexAddrCache::iterator>
 TextureCacheBase::FindOverlappingTextures(u32 addr, u32 size_in_bytes)
 {
@@ -97,6 +97,10 @@ public:
     u32 memory_stride;
     bool is_efb_copy;
     bool is_custom_tex;
+    // Custom texture which was still loading when this entry was created. Once it has finished,
+    // the entry is recreated with it.
+    std::string pending_custom_tex;
+    u32 custom_tex_load_generation = 0;
     bool may_have_overlapping_textures = true;
     bool tmem_only = false;           // indicates that this texture only exists in the tmem cache
     bool has_arbitrary_mips = false;  // indicates that the mips in this texture are arbitrary
@@ -300,6 +304,7 @@ private:
   std::optional<TexPoolEntry> AllocateTexture(const TextureConfig& config);
   TexPool::iterator FindMatchingTextureFromPool(const TextureConfig& config);
   TexAddrCache::iterator GetTexCacheIter(TCacheEntry* entry);
+  bool IsCustomTextureReady(TCacheEntry* entry);
 
   // Return all possible overlapping textures. As addr+size of the textures is not
   // indexed, this may return false positives.
@@ -0,0 +1,289 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/TexturePack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <xxhash.h>
+#include <zlib.h>
+
+#include "Common/Align.h"
+#include "Common/CommonTypes.h"
+#include "Common/Logging/Log.h"
+#include "VideoCommon/AbstractTexture.h"
+#include "VideoCommon/TextureConfig.h"
+
+static bool IsValidLevelFormat(u8 format)
+{
+  switch (static_cast<AbstractTextureFormat>(format))
+  {
+  case AbstractTextureFormat::RGBA8:
+  case AbstractTextureFormat::DXT1:
+  case AbstractTextureFormat::DXT3:
+  case AbstractTextureFormat::DXT5:
+  case AbstractTextureFormat::BPTC:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Returns the number of bytes a level with these dimensions takes up when it is uploaded.
+static u64 GetLevelDataSize(AbstractTextureFormat format, u32 height, u32 row_length)
+{
+  const u32 block_size = AbstractTexture::GetBlockSizeForFormat(format);
+  const u64 blocks_high = std::max(Common::AlignUp(height, block_size) / block_size, 1u);
+  return AbstractTexture::CalculateStrideForFormat(format, row_length) * blocks_high;
+}
+
+u64 TexturePack::HashName(std::string_view name)
+{
+  return XXH64(name.data(), name.size(), 0);
+}
+
+bool TexturePack::Open(const std::string& filename)
+{
+  m_filename = filename;
+  m_levels = nullptr;
+  m_textures = nullptr;
+  m_header = {};
+
+  if (!m_mapping.Open(filename) || m_mapping.GetSize() < sizeof(Header))
+    return false;
+
+  const u8* const data = m_mapping.GetData();
+  const u64 size = m_mapping.GetSize();
+  Header header;
+  std::memcpy(&header, data, sizeof(Header));
+  if (header.magic != MAGIC || header.version != VERSION)
+  {
+    ERROR_LOG(VIDEO, "Texture pack %s has an unsupported format", filename.c_str());
+    m_mapping.Close();
+    return false;
+  }
+
+  // Make sure that both tables fit in the file, so that lookups only have to check the offsets
+  // stored inside them.
+  if (header.names_offset > header.levels_offset || header.levels_offset > size ||
+      (size - header.levels_offset) / sizeof(LevelEntry) < header.num_levels ||
+      header.textures_offset > size ||
+      (size - header.textures_offset) / sizeof(TextureEntry) < header.num_textures)
+  {
+    ERROR_LOG(VIDEO, "Texture pack %s is truncated or corrupted", filename.c_str());
+    m_mapping.Close();
+    return false;
+  }
+
+  m_header = header;
+  m_levels = reinterpret_cast<const LevelEntry*>(data + header.levels_offset);
+  m_textures = reinterpret_cast<const TextureEntry*>(data + header.textures_offset);
+  return true;
+}
+
+std::string_view TexturePack::GetTextureName(u32 index) const
+{
+  if (index >= m_header.num_textures)
+    return {};
+
+  const TextureEntry& entry = m_textures[index];
+  const u64 names_size = m_header.levels_offset - m_header.names_offset;
+  if (entry.name_offset > names_size || entry.name_length > names_size - entry.name_offset)
+    return {};
+
+  return std::string_view(
+      reinterpret_cast<const char*>(m_mapping.GetData() + m_header.names_offset) +
+          entry.name_offset,
+      entry.name_length);
+}
+
+const TexturePack::TextureEntry* TexturePack::FindTexture(std::string_view name) const
+{
+  if (!m_textures)
+    return nullptr;
+
+  const u64 hash = HashName(name);
+  const TextureEntry* const end = m_textures + m_header.num_textures;
+  const TextureEntry* entry = std::lower_bound(
+      m_textures, end, hash,
+      [](const TextureEntry& texture, u64 value) { return texture.name_hash < value; });
+
+  for (; entry != end && entry->name_hash == hash; ++entry)
+  {
+    if (GetTextureName(static_cast<u32>(entry - m_textures)) == name)
+      return entry;
+  }
+
+  return nullptr;
+}
+
+bool TexturePack::Contains(std::string_view name) const
+{
+  return FindTexture(name) != nullptr;
+}
+
+bool TexturePack::ReadLevel(const LevelEntry& entry, HiresTexture::Level* level) const
+{
+  const u64 size = m_mapping.GetSize();
+  if (!IsValidLevelFormat(entry.format) || entry.offset > size ||
+      entry.stored_size > size - entry.offset)
+  {
+    return false;
+  }
+
+  // The size is trusted by the upload, so it has to match the dimensions of the level.
+  const AbstractTextureFormat format = static_cast<AbstractTextureFormat>(entry.format);
+  if (entry.row_length < entry.width ||
+      entry.size != GetLevelDataSize(format, entry.height, entry.row_length))
+  {
+    return false;
+  }
+
+  const u8* const src = m_mapping.GetData() + entry.offset;
+  level->width = entry.width;
+  level->height = entry.height;
+  level->row_length = entry.row_length;
+  level->format = format;
+  level->data.resize(entry.size);
+
+  switch (entry.compression)
+  {
+  case Compression::None:
+    if (entry.stored_size != entry.size)
+      return false;
+    std::memcpy(level->data.data(), src, entry.size);
+    return true;
+
+  case Compression::Zlib:
+  {
+    uLongf dest_size = static_cast<uLongf>(entry.size);
+    return uncompress(level->data.data(), &dest_size, src, static_cast<uLong>(entry.stored_size)) ==
+               Z_OK &&
+           dest_size == entry.size;
+  }
+
+  default:
+    return false;
+  }
+}
+
+bool TexturePack::ReadTexture(std::string_view name, std::vector<HiresTexture::Level>* levels,
+                              bool* has_arbitrary_mipmaps) const
+{
+  const TextureEntry* entry = FindTexture(name);
+  if (!entry)
+    return false;
+
+  if (entry->first_level > m_header.num_levels ||
+      entry->num_levels > m_header.num_levels - entry->first_level)
+  {
+    return false;
+  }
+
+  levels->resize(entry->num_levels);
+  for (u32 i = 0; i < entry->num_levels; i++)
+  {
+    if (!ReadLevel(m_levels[entry->first_level + i], &(*levels)[i]))
+    {
+      ERROR_LOG(VIDEO, "Texture %.*s in texture pack %s is corrupted",
+                static_cast<int>(name.size()), name.data(), m_filename.c_str());
+      levels->clear();
+      return false;
+    }
+  }
+
+  *has_arbitrary_mipmaps = (entry->flags & TEXTURE_FLAG_ARBITRARY_MIPMAPS) != 0;
+  return true;
+}
+
+bool TexturePackWriter::Open(const std::string& filename)
+{
+  m_names.clear();
+  m_levels.clear();
+  m_textures.clear();
+
+  // The header is written by Finish(), once the offsets of the tables are known.
+  const TexturePack::Header header{};
+  m_data_end = sizeof(header);
+  return m_file.Open(filename, "wb") && m_file.WriteBytes(&header, sizeof(header));
+}
+
+bool TexturePackWriter::AddTexture(std::string_view name,
+                                   const std::vector<HiresTexture::Level>& levels,
+                                   bool has_arbitrary_mipmaps)
+{
+  TexturePack::TextureEntry texture{};
+  texture.name_hash = TexturePack::HashName(name);
+  texture.name_offset = static_cast<u32>(m_names.size());
+  texture.name_length = static_cast<u32>(name.size());
+  texture.first_level = static_cast<u32>(m_levels.size());
+  texture.num_levels = static_cast<u32>(levels.size());
+  texture.flags = has_arbitrary_mipmaps ? TexturePack::TEXTURE_FLAG_ARBITRARY_MIPMAPS : 0;
+
+  for (const HiresTexture::Level& level : levels)
+  {
+    TexturePack::LevelEntry entry{};
+    entry.offset = m_data_end;
+    entry.size = level.data.size();
+    entry.width = level.width;
+    entry.height = level.height;
+    entry.row_length = level.row_length;
+    entry.format = static_cast<u8>(level.format);
+
+    // Only keep the compressed data if it is noticeably smaller, block compressed formats
+    // usually don't get much out of it and are faster to load as they are.
+    uLongf compressed_size = compressBound(static_cast<uLong>(level.data.size()));
+    m_compress_buffer.resize(compressed_size);
+    const bool compressed =
+        compress(m_compress_buffer.data(), &compressed_size, level.data.data(),
+                 static_cast<uLong>(level.data.size())) == Z_OK &&
+        compressed_size < level.data.size() - level.data.size() / 8;
+
+    const u8* data = compressed ? m_compress_buffer.data() : level.data.data();
+    entry.stored_size = compressed ? compressed_size : level.data.size();
+    entry.compression =
+        compressed ? TexturePack::Compression::Zlib : TexturePack::Compression::None;
+    if (!m_file.WriteBytes(data, entry.stored_size))
+      return false;
+
+    m_data_end += entry.stored_size;
+    m_levels.push_back(entry);
+  }
+
+  m_names.append(name);
+  m_textures.push_back(texture);
+  return true;
+}
+
+bool TexturePackWriter::Finish()
+{
+  std::sort(m_textures.begin(), m_textures.end(),
+            [](const TexturePack::TextureEntry& a, const TexturePack::TextureEntry& b) {
+              return a.name_hash < b.name_hash;
+            });
+
+  TexturePack::Header header{};
+  header.magic = TexturePack::MAGIC;
+  header.version = TexturePack::VERSION;
+  header.num_textures = static_cast<u32>(m_textures.size());
+  header.num_levels = static_cast<u32>(m_levels.size());
+  header.names_offset = m_data_end;
+
+  // Keep the tables 8-byte aligned.
+  const std::vector<u8> padding((8 - (m_data_end + m_names.size()) % 8) % 8);
+  header.levels_offset = m_data_end + m_names.size() + padding.size();
+  header.textures_offset = header.levels_offset + m_levels.size() * sizeof(m_levels[0]);
+
+  const bool success =
+      m_file.WriteBytes(m_names.data(), m_names.size()) &&
+      m_file.WriteBytes(padding.data(), padding.size()) &&
+      m_file.WriteBytes(m_levels.data(), m_levels.size() * sizeof(m_levels[0])) &&
+      m_file.WriteBytes(m_textures.data(), m_textures.size() * sizeof(m_textures[0])) &&
+      m_file.Seek(0, SEEK_SET) && m_file.WriteBytes(&header, sizeof(header));
+  return m_file.Close() && success;
+}
@@ -0,0 +1,140 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/MappedFile.h"
+#include "VideoCommon/HiresTextures.h"
+
+// A texture pack stores a whole set of custom textures in a single file, so that large packs
+// don't have to be found and read file by file.
+//
+// On disk format (all values little endian):
+// header{
+// u32 'DTPK';
+// u32 version;
+// u32 num_textures;
+// u32 num_levels;
+// u64 names_offset;
+// u64 levels_offset;
+// u64 textures_offset;
+//}
+// level data, optionally zlib compressed, one blob per mip level
+// texture names, not null-terminated
+// level{ u64 offset; u64 stored_size; u64 size; u32 width; u32 height; u32 row_length;
+//        u8 format; u8 compression; u16 padding; }[num_levels]
+// texture{ u64 name_hash; u32 name_offset; u32 name_length; u32 first_level; u32 num_levels;
+//          u32 flags; u32 padding; }[num_textures], sorted by name_hash
+//
+// Mip levels are stored exactly as they are uploaded, either as raw RGBA8 or as one of the
+// block compressed formats, so loading a texture only needs a copy out of the mapping (and
+// inflating the data for compressed levels).
+class TexturePack
+{
+public:
+  TexturePack() = default;
+  TexturePack(const TexturePack&) = delete;
+  TexturePack& operator=(const TexturePack&) = delete;
+
+  bool Open(const std::string& filename);
+
+  const std::string& GetFilename() const { return m_filename; }
+  u32 GetTextureCount() const { return m_header.num_textures; }
+  std::string_view GetTextureName(u32 index) const;
+  bool Contains(std::string_view name) const;
+
+  // Reads all mip levels of a texture. Returns false if the texture isn't in the pack or its
+  // data is corrupted.
+  bool ReadTexture(std::string_view name, std::vector<HiresTexture::Level>* levels,
+                   bool* has_arbitrary_mipmaps) const;
+
+  static constexpr u32 MAGIC = 0x4B505444;  // "DTPK"
+  static constexpr u32 VERSION = 1;
+
+  enum class Compression : u8
+  {
+    None = 0,
+    Zlib = 1,
+  };
+
+  enum TextureFlags : u32
+  {
+    TEXTURE_FLAG_ARBITRARY_MIPMAPS = 1,
+  };
+
+#pragma pack(push, 1)
+  struct Header
+  {
+    u32 magic;
+    u32 version;
+    u32 num_textures;
+    u32 num_levels;
+    u64 names_offset;
+    u64 levels_offset;
+    u64 textures_offset;
+  };
+
+  struct LevelEntry
+  {
+    u64 offset;
+    u64 stored_size;
+    u64 size;
+    u32 width;
+    u32 height;
+    u32 row_length;
+    u8 format;
+    Compression compression;
+    u16 padding;
+  };
+
+  struct TextureEntry
+  {
+    u64 name_hash;
+    u32 name_offset;
+    u32 name_length;
+    u32 first_level;
+    u32 num_levels;
+    u32 flags;
+    u32 padding;
+  };
+#pragma pack(pop)
+
+  static u64 HashName(std::string_view name);
+
+private:
+  const TextureEntry* FindTexture(std::string_view name) const;
+  bool ReadLevel(const LevelEntry& entry, HiresTexture::Level* level) const;
+
+  std::string m_filename;
+  File::MappedFile m_mapping;
+  Header m_header{};
+  const LevelEntry* m_levels = nullptr;
+  const TextureEntry* m_textures = nullptr;
+};
+
+// Writes a texture pack. Level data is written out as textures are added, only the table of
+// contents is kept in memory until Finish() is called.
+class TexturePackWriter
+{
+public:
+  bool Open(const std::string& filename);
+  bool AddTexture(std::string_view name, const std::vector<HiresTexture::Level>& levels,
+                  bool has_arbitrary_mipmaps);
+  bool Finish();
+
+private:
+  File::IOFile m_file;
+  u64 m_data_end = 0;
+  std::string m_names;
+  std::vector<TexturePack::LevelEntry> m_levels;
+  std::vector<TexturePack::TextureEntry> m_textures;
+  std::vector<u8> m_compress_buffer;
+};
@@ -0,0 +1,47 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/TextureUsageHistory.h"
+
+#include "Common/StringUtil.h"
+
+void TextureUsageHistory::Load(const std::string& contents,
+                               const std::function<bool(const std::string&)>& keep)
+{
+  Clear();
+  for (const std::string& line : SplitString(contents, '\n'))
+  {
+    const std::string base_filename(StripSpaces(line));
+    if (!base_filename.empty() && keep(base_filename))
+      Add(base_filename);
+  }
+}
+
+std::string TextureUsageHistory::Serialize() const
+{
+  std::string contents;
+  for (const std::string& base_filename : m_textures)
+    contents += base_filename + '\n';
+  return contents;
+}
+
+bool TextureUsageHistory::Add(const std::string& base_filename)
+{
+  if (m_textures.size() >= MAX_SIZE || !m_texture_set.insert(base_filename).second)
+    return false;
+
+  m_textures.push_back(base_filename);
+  return true;
+}
+
+bool TextureUsageHistory::Contains(const std::string& base_filename) const
+{
+  return m_texture_set.count(base_filename) != 0;
+}
+
+void TextureUsageHistory::Clear()
+{
+  m_textures.clear();
+  m_texture_set.clear();
+}
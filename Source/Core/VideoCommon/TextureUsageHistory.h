@@ -0,0 +1,34 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// The custom textures a game used, in the order they were first used, so that they can be
+// preloaded the next time the game starts.
+class TextureUsageHistory
+{
+public:
+  // Only textures of the loaded packs are recorded, so this is only reached by huge packs.
+  static constexpr size_t MAX_SIZE = 65536;
+
+  // Reads a history written by Serialize, dropping the textures that keep returns false for.
+  void Load(const std::string& contents, const std::function<bool(const std::string&)>& keep);
+  std::string Serialize() const;
+
+  // Returns false if the texture was already recorded or the history is full.
+  bool Add(const std::string& base_filename);
+  bool Contains(const std::string& base_filename) const;
+  void Clear();
+
+  const std::vector<std::string>& GetTextures() const { return m_textures; }
+
+private:
+  std::vector<std::string> m_textures;
+  std::unordered_set<std::string> m_texture_set;
+};
@@ -3,6 +3,10 @@
 // Refer to the license.txt file included.
 
 #include "VideoCommon/UberShaderPixel.h"
+
+#include <string>
+
+#include "Common/StringUtil.h"
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/DriverDetails.h"
 #include "VideoCommon/NativeVertexFormat.h"
@@ -30,6 +34,33 @@ PixelShaderUid GetPixelShaderUid()
   return out;
 }
 
+PixelShaderUid GetSpecializedPixelShaderUid(const PixelShaderUid& uid)
+{
+  PixelShaderUid out = uid;
+
+  pixel_ubershader_uid_data* const uid_data = out.GetUidData();
+  uid_data->specialized = 1;
+  uid_data->num_tev_stages = bpmem.genMode.numtevstages;
+
+  // Matches the fog and alpha test uniforms set by PixelShaderManager.
+  if (!g_ActiveConfig.bDisableFog)
+  {
+    uid_data->fog_fsel = bpmem.fog.c_proj_fsel.fsel;
+    uid_data->fog_proj = bpmem.fog.c_proj_fsel.proj;
+    uid_data->fog_RangeBaseEnabled = bpmem.fogRange.Base.Enabled;
+  }
+
+  if (bpmem.alpha_test.TestResult() != AlphaTest::PASS)
+  {
+    uid_data->alpha_test_enabled = 1;
+    uid_data->alpha_test_comp0 = bpmem.alpha_test.comp0;
+    uid_data->alpha_test_comp1 = bpmem.alpha_test.comp1;
+    uid_data->alpha_test_logic = bpmem.alpha_test.logic;
+  }
+
+  return out;
+}
+
 void ClearUnusedPixelShaderUidBits(APIType ApiType, const ShaderHostConfig& host_config,
                                    PixelShaderUid* uid)
 {
@@ -40,6 +71,13 @@ void ClearUnusedPixelShaderUidBits(APIType ApiType, const ShaderHostConfig& host
   // uint output when logic op is not supported (i.e. driver/device does not support D3D11.1).
   if (ApiType != APIType::D3D || !host_config.backend_logic_op)
     uid_data->uint_output = 0;
+
+  // The fog parameters are irrelevant when fog is disabled.
+  if (uid_data->fog_fsel == 0)
+  {
+    uid_data->fog_proj = 0;
+    uid_data->fog_RangeBaseEnabled = 0;
+  }
 }
 
 ShaderCode GenPixelShader(APIType ApiType, const ShaderHostConfig& host_config,
@@ -55,10 +93,17 @@ ShaderCode GenPixelShader(APIType ApiType, const ShaderHostConfig& host_config,
   const bool per_pixel_depth = uid_data->per_pixel_depth != 0;
   const bool bounding_box = host_config.bounding_box;
   const u32 numTexgen = uid_data->num_texgens;
+  const bool specialized = uid_data->specialized != 0;
   ShaderCode out;
 
-  out.Write("// Pixel UberShader for %u texgens%s%s\n", numTexgen,
-            early_depth ? ", early-depth" : "", per_pixel_depth ? ", per-pixel depth" : "");
+  // Partially specialized shaders use constants in place of some of the uniforms.
+  const auto baked = [specialized](u32 value, const std::string& uniform_expr) {
+    return specialized ? StringFromFormat("%uu", value) : uniform_expr;
+  };
+
+  out.Write("// Pixel UberShader for %u texgens%s%s%s\n", numTexgen,
+            early_depth ? ", early-depth" : "", per_pixel_depth ? ", per-pixel depth" : "",
+            specialized ? ", partially specialized" : "");
   WritePixelShaderCommonHeader(out, ApiType, numTexgen, host_config, bounding_box);
   WriteUberShaderCommonHeader(out, ApiType, host_config);
   if (per_pixel_lighting)
@@ -758,7 +803,9 @@ ShaderCode GenPixelShader(APIType ApiType, const ShaderHostConfig& host_config,
   }
 
   out.Write("  uint num_stages = %s;\n\n",
-            BitfieldExtract("bpmem_genmode", bpmem.genMode.numtevstages).c_str());
+            baked(uid_data->num_tev_stages,
+                  BitfieldExtract("bpmem_genmode", bpmem.genMode.numtevstages))
+                .c_str());
 
   out.Write("  // Main tev loop\n");
   if (ApiType == APIType::D3D)
@@ -1119,28 +1166,38 @@ ShaderCode GenPixelShader(APIType ApiType, const ShaderHostConfig& host_config,
       out.Write("  depth = float(zbuffer_zCoord) / 16777216.0;\n");
   }
 
-  out.Write("  // Alpha Test\n"
-            "  if (bpmem_alphaTest != 0u) {\n"
-            "    bool comp0 = alphaCompare(TevResult.a, " I_ALPHA ".r, %s);\n",
-            BitfieldExtract("bpmem_alphaTest", AlphaTest().comp0).c_str());
-  out.Write("    bool comp1 = alphaCompare(TevResult.a, " I_ALPHA ".g, %s);\n",
-            BitfieldExtract("bpmem_alphaTest", AlphaTest().comp1).c_str());
-  out.Write("\n"
-            "    // These if statements are written weirdly to work around intel and qualcom bugs "
-            "with handling booleans.\n"
-            "    switch (%s) {\n",
-            BitfieldExtract("bpmem_alphaTest", AlphaTest().logic).c_str());
-  out.Write("    case 0u: // AND\n"
-            "      if (comp0 && comp1) break; else discard; break;\n"
-            "    case 1u: // OR\n"
-            "      if (comp0 || comp1) break; else discard; break;\n"
-            "    case 2u: // XOR\n"
-            "      if (comp0 != comp1) break; else discard; break;\n"
-            "    case 3u: // XNOR\n"
-            "      if (comp0 == comp1) break; else discard; break;\n"
-            "    }\n"
-            "  }\n"
-            "\n");
+  if (!specialized || uid_data->alpha_test_enabled)
+  {
+    out.Write("  // Alpha Test\n"
+              "  if (%s) {\n"
+              "    bool comp0 = alphaCompare(TevResult.a, " I_ALPHA ".r, %s);\n",
+              specialized ? "true" : "bpmem_alphaTest != 0u",
+              baked(uid_data->alpha_test_comp0,
+                    BitfieldExtract("bpmem_alphaTest", AlphaTest().comp0))
+                  .c_str());
+    out.Write("    bool comp1 = alphaCompare(TevResult.a, " I_ALPHA ".g, %s);\n",
+              baked(uid_data->alpha_test_comp1,
+                    BitfieldExtract("bpmem_alphaTest", AlphaTest().comp1))
+                  .c_str());
+    out.Write("\n"
+              "    // These if statements are written weirdly to work around intel and qualcom "
+              "bugs with handling booleans.\n"
+              "    switch (%s) {\n",
+              baked(uid_data->alpha_test_logic,
+                    BitfieldExtract("bpmem_alphaTest", AlphaTest().logic))
+                  .c_str());
+    out.Write("    case 0u: // AND\n"
+              "      if (comp0 && comp1) break; else discard; break;\n"
+              "    case 1u: // OR\n"
+              "      if (comp0 || comp1) break; else discard; break;\n"
+              "    case 2u: // XOR\n"
+              "      if (comp0 != comp1) break; else discard; break;\n"
+              "    case 3u: // XNOR\n"
+              "      if (comp0 == comp1) break; else discard; break;\n"
+              "    }\n"
+              "  }\n"
+              "\n");
+  }
 
   // =========
   // Dithering
@@ -1159,63 +1216,71 @@ ShaderCode GenPixelShader(APIType ApiType, const ShaderHostConfig& host_config,
 
   // FIXME: Fog is implemented the same as ShaderGen, but ShaderGen's fog is all hacks.
   //        Should be fixed point, and should not make guesses about Range-Based adjustments.
-  out.Write("  // Fog\n"
-            "  uint fog_function = %s;\n",
-            BitfieldExtract("bpmem_fogParam3", FogParam3().fsel).c_str());
-  out.Write("  if (fog_function != 0u) {\n"
-            "    // TODO: This all needs to be converted from float to fixed point\n"
-            "    float ze;\n"
-            "    if (%s == 0u) {\n",
-            BitfieldExtract("bpmem_fogParam3", FogParam3().proj).c_str());
-  out.Write("      // perspective\n"
-            "      // ze = A/(B - (Zs >> B_SHF)\n"
-            "      ze = (" I_FOGF ".x * 16777216.0) / float(" I_FOGI ".y - (zCoord >> " I_FOGI
-            ".w));\n"
-            "    } else {\n"
-            "      // orthographic\n"
-            "      // ze = a*Zs    (here, no B_SHF)\n"
-            "      ze = " I_FOGF ".z * float(zCoord) / 16777216.0;\n"
-            "    }\n"
-            "\n"
-            "    if (bool(%s)) {\n",
-            BitfieldExtract("bpmem_fogRangeBase", FogRangeParams::RangeBase().Enabled).c_str());
-  out.Write("      // x_adjust = sqrt((x-center)^2 + k^2)/k\n"
-            "      // ze *= x_adjust\n"
-            "      float offset = (2.0 * (rawpos.x / " I_FOGF ".w)) - 1.0 - " I_FOGF ".z;\n"
-            "      float floatindex = clamp(9.0 - abs(offset) * 9.0, 0.0, 9.0);\n"
-            "      uint indexlower = uint(floatindex);\n"
-            "      uint indexupper = indexlower + 1u;\n"
-            "      float klower = " I_FOGRANGE "[indexlower >> 2u][indexlower & 3u];\n"
-            "      float kupper = " I_FOGRANGE "[indexupper >> 2u][indexupper & 3u];\n"
-            "      float k = lerp(klower, kupper, frac(floatindex));\n"
-            "      float x_adjust = sqrt(offset * offset + k * k) / k;\n"
-            "      ze *= x_adjust;\n"
-            "    }\n"
-            "\n"
-            "    float fog = clamp(ze - " I_FOGF ".y, 0.0, 1.0);\n"
-            "\n"
-            "    if (fog_function > 3u) {\n"
-            "      switch (fog_function) {\n"
-            "      case 4u:\n"
-            "        fog = 1.0 - exp2(-8.0 * fog);\n"
-            "        break;\n"
-            "      case 5u:\n"
-            "        fog = 1.0 - exp2(-8.0 * fog * fog);\n"
-            "        break;\n"
-            "      case 6u:\n"
-            "        fog = exp2(-8.0 * (1.0 - fog));\n"
-            "        break;\n"
-            "      case 7u:\n"
-            "        fog = 1.0 - fog;\n"
-            "        fog = exp2(-8.0 * fog * fog);\n"
-            "        break;\n"
-            "      }\n"
-            "    }\n"
-            "\n"
-            "    int ifog = iround(fog * 256.0);\n"
-            "    TevResult.rgb = (TevResult.rgb * (256 - ifog) + " I_FOGCOLOR ".rgb * ifog) >> 8;\n"
-            "  }\n"
-            "\n");
+  if (!specialized || uid_data->fog_fsel != 0)
+  {
+    out.Write("  // Fog\n"
+              "  uint fog_function = %s;\n",
+              baked(uid_data->fog_fsel, BitfieldExtract("bpmem_fogParam3", FogParam3().fsel))
+                  .c_str());
+    out.Write("  if (fog_function != 0u) {\n"
+              "    // TODO: This all needs to be converted from float to fixed point\n"
+              "    float ze;\n"
+              "    if (%s == 0u) {\n",
+              baked(uid_data->fog_proj, BitfieldExtract("bpmem_fogParam3", FogParam3().proj))
+                  .c_str());
+    out.Write("      // perspective\n"
+              "      // ze = A/(B - (Zs >> B_SHF)\n"
+              "      ze = (" I_FOGF ".x * 16777216.0) / float(" I_FOGI ".y - (zCoord >> " I_FOGI
+              ".w));\n"
+              "    } else {\n"
+              "      // orthographic\n"
+              "      // ze = a*Zs    (here, no B_SHF)\n"
+              "      ze = " I_FOGF ".z * float(zCoord) / 16777216.0;\n"
+              "    }\n"
+              "\n"
+              "    if (bool(%s)) {\n",
+              baked(uid_data->fog_RangeBaseEnabled,
+                    BitfieldExtract("bpmem_fogRangeBase", FogRangeParams::RangeBase().Enabled))
+                  .c_str());
+    out.Write("      // x_adjust = sqrt((x-center)^2 + k^2)/k\n"
+              "      // ze *= x_adjust\n"
+              "      float offset = (2.0 * (rawpos.x / " I_FOGF ".w)) - 1.0 - " I_FOGF ".z;\n"
+              "      float floatindex = clamp(9.0 - abs(offset) * 9.0, 0.0, 9.0);\n"
+              "      uint indexlower = uint(floatindex);\n"
+              "      uint indexupper = indexlower + 1u;\n"
+              "      float klower = " I_FOGRANGE "[indexlower >> 2u][indexlower & 3u];\n"
+              "      float kupper = " I_FOGRANGE "[indexupper >> 2u][indexupper & 3u];\n"
+              "      float k = lerp(klower, kupper, frac(floatindex));\n"
+              "      float x_adjust = sqrt(offset * offset + k * k) / k;\n"
+              "      ze *= x_adjust;\n"
+              "    }\n"
+              "\n"
+              "    float fog = clamp(ze - " I_FOGF ".y, 0.0, 1.0);\n"
+              "\n"
+              "    if (fog_function > 3u) {\n"
+              "      switch (fog_function) {\n"
+              "      case 4u:\n"
+              "        fog = 1.0 - exp2(-8.0 * fog);\n"
+              "        break;\n"
+              "      case 5u:\n"
+              "        fog = 1.0 - exp2(-8.0 * fog * fog);\n"
+              "        break;\n"
+              "      case 6u:\n"
+              "        fog = exp2(-8.0 * (1.0 - fog));\n"
+              "        break;\n"
+              "      case 7u:\n"
+              "        fog = 1.0 - fog;\n"
+              "        fog = exp2(-8.0 * fog * fog);\n"
+              "        break;\n"
+              "      }\n"
+              "    }\n"
+              "\n"
+              "    int ifog = iround(fog * 256.0);\n"
+              "    TevResult.rgb = (TevResult.rgb * (256 - ifog) + " I_FOGCOLOR
+              ".rgb * ifog) >> 8;\n"
+              "  }\n"
+              "\n");
+  }
 
   // D3D requires that the shader outputs be uint when writing to a uint render target for logic op.
   if (ApiType == APIType::D3D && uid_data->uint_output)
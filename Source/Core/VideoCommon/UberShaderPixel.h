@@ -17,6 +17,19 @@ struct pixel_ubershader_uid_data
   u32 per_pixel_depth : 1;
   u32 uint_output : 1;
 
+  // Partially specialized ubershaders bake the state below into the shader, instead of reading
+  // it from the uniform buffer. This state is the most costly at runtime, and there are few
+  // enough combinations to share each shader between many specialized shaders.
+  u32 specialized : 1;
+  u32 num_tev_stages : 4;  // stages - 1, like genMode.numtevstages
+  u32 fog_fsel : 3;
+  u32 fog_proj : 1;
+  u32 fog_RangeBaseEnabled : 1;
+  u32 alpha_test_enabled : 1;
+  u32 alpha_test_comp0 : 3;
+  u32 alpha_test_comp1 : 3;
+  u32 alpha_test_logic : 2;
+
   u32 NumValues() const { return sizeof(pixel_ubershader_uid_data); }
 };
 #pragma pack()
@@ -25,9 +38,13 @@ using PixelShaderUid = ShaderUid<pixel_ubershader_uid_data>;
 
 PixelShaderUid GetPixelShaderUid();
 
+// Returns the UID of the partially specialized ubershader for the current state.
+PixelShaderUid GetSpecializedPixelShaderUid(const PixelShaderUid& uid);
+
 ShaderCode GenPixelShader(APIType ApiType, const ShaderHostConfig& host_config,
                           const pixel_ubershader_uid_data* uid_data);
 
+// Only enumerates the generic ubershaders.
 void EnumeratePixelShaderUids(const std::function<void(const PixelShaderUid&)>& callback);
 void ClearUnusedPixelShaderUidBits(APIType ApiType, const ShaderHostConfig& host_config,
                                    PixelShaderUid* uid);
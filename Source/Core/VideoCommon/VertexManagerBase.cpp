@@ -703,9 +703,15 @@ void VertexManagerBase::UpdatePipelineObject()
 
     if (g_ActiveConfig.iShaderCompilationMode == ShaderCompilationMode::AsynchronousUberShaders)
     {
-      // Specialized shaders not ready, use the ubershaders.
-      m_current_pipeline_object =
-          g_shader_cache->GetUberPipelineForUid(m_current_uber_pipeline_config);
+      // Specialized shaders not ready, use the ubershaders. Prefer the partially specialized
+      // ubershaders, which are only compiled when the specialized shaders are lagging behind.
+      auto uber_res =
+          g_shader_cache->GetSpecializedUberPipelineForUidAsync(m_current_uber_pipeline_config);
+      if (uber_res)
+        m_current_pipeline_object = *uber_res;
+      else
+        m_current_pipeline_object =
+            g_shader_cache->GetUberPipelineForUid(m_current_uber_pipeline_config);
     }
     else
     {
@@ -0,0 +1,193 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <OptionParser.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/StringUtil.h"
+#include "Core/IOS/FS/FileSystem.h"
+#include "Core/IOS/IOS.h"
+#include "UICommon/UICommon.h"
+
+// Replays requests like those of a game that saves while polling the NAND usage against the IOS
+// host file system, and reports how long they took. Every run starts from a NAND in a new
+// temporary user directory, which is filled with the files of other titles first.
+
+namespace
+{
+using namespace IOS::HLE::FS;
+
+constexpr Modes MODES{Mode::ReadWrite, Mode::ReadWrite, Mode::None};
+constexpr u32 WRITE_SIZE = 0x1000;
+constexpr u32 WRITES_PER_FILE = 4;
+constexpr u32 TEMP_FILE_COUNT = 8;
+
+struct TraceOptions
+{
+  int titles;
+  int files_per_title;
+  int iterations;
+};
+
+std::string GetDataDirectory(int title)
+{
+  return StringFromFormat("/title/00010000/%08x/data", 0x10000000 + title);
+}
+
+bool Succeeded(ResultCode code, const char* request, const std::string& path)
+{
+  if (code == ResultCode::Success)
+    return true;
+
+  fprintf(stderr, "%s %s failed with %d\n", request, path.c_str(), static_cast<int>(code));
+  return false;
+}
+
+bool CreateTitles(FileSystem& fs, const TraceOptions& options)
+{
+  for (int title = 0; title < options.titles; ++title)
+  {
+    const std::string directory = GetDataDirectory(title);
+    if (!Succeeded(fs.CreateFullPath(0, 0, directory + '/', 0, MODES), "CreateFullPath",
+                   directory))
+    {
+      return false;
+    }
+
+    for (int file = 0; file < options.files_per_title; ++file)
+    {
+      const std::string path = StringFromFormat("%s/file%d", directory.c_str(), file);
+      if (!Succeeded(fs.CreateFile(0, 0, path, 0, MODES), "CreateFile", path))
+        return false;
+    }
+  }
+  return true;
+}
+
+// Each iteration polls the usage of all titles and of the save directory, then saves a file the
+// way games do: it is created and written in /tmp, and then moved into the save directory.
+bool ReplayTrace(FileSystem& fs, const TraceOptions& options)
+{
+  const std::string save_directory = GetDataDirectory(options.titles);
+  if (!Succeeded(fs.CreateFullPath(0, 0, save_directory + '/', 0, MODES), "CreateFullPath",
+                 save_directory))
+  {
+    return false;
+  }
+
+  const std::vector<u8> data(WRITE_SIZE, 0xa5);
+  for (int i = 0; i < options.iterations; ++i)
+  {
+    if (!fs.GetDirectoryStats("/title") || !fs.GetDirectoryStats(save_directory))
+    {
+      fprintf(stderr, "GetDirectoryStats failed\n");
+      return false;
+    }
+
+    const int index = i % TEMP_FILE_COUNT;
+    const std::string temp_path = StringFromFormat("/tmp/save%d", index);
+    const std::string save_path = StringFromFormat("%s/save%d", save_directory.c_str(), index);
+    if (!Succeeded(fs.CreateFile(0, 0, temp_path, 0, MODES), "CreateFile", temp_path))
+      return false;
+
+    {
+      const Result<FileHandle> file = fs.OpenFile(0, 0, temp_path, Mode::Write);
+      if (!file)
+        return Succeeded(file.Error(), "OpenFile", temp_path);
+
+      for (u32 j = 0; j < WRITES_PER_FILE; ++j)
+      {
+        if (!file->Write(data.data(), data.size()))
+        {
+          fprintf(stderr, "Write %s failed\n", temp_path.c_str());
+          return false;
+        }
+      }
+    }
+
+    if (!Succeeded(fs.SetMetadata(0, temp_path, 0, 0, 1, MODES), "SetMetadata", temp_path) ||
+        !Succeeded(fs.Rename(0, 0, temp_path, save_path), "Rename", temp_path))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  optparse::OptionParser parser;
+  parser.usage("usage: %prog [options]...");
+  parser.set_defaults("titles", "20");
+  parser.set_defaults("files", "50");
+  parser.set_defaults("iterations", "300");
+  parser.set_defaults("runs", "5");
+  parser.add_option("-t", "--titles")
+      .action("store")
+      .type("int")
+      .help("How many other titles have save data on the NAND [default: %default]");
+  parser.add_option("-f", "--files")
+      .action("store")
+      .type("int")
+      .help("How many files each of these titles has [default: %default]");
+  parser.add_option("-i", "--iterations")
+      .action("store")
+      .type("int")
+      .help("How many files are saved in each run [default: %default]");
+  parser.add_option("-r", "--runs")
+      .action("store")
+      .type("int")
+      .help("How many times to replay and time the whole trace [default: %default]");
+
+  const optparse::Values& values = parser.parse_args(argc, argv);
+  if (!parser.args().empty())
+  {
+    parser.print_help();
+    return 1;
+  }
+
+  const TraceOptions options{std::max(0, static_cast<int>(values.get("titles"))),
+                             std::max(0, static_cast<int>(values.get("files"))),
+                             std::max(0, static_cast<int>(values.get("iterations")))};
+  const int runs = std::max(1, static_cast<int>(values.get("runs")));
+
+  std::vector<double> times_ms;
+  for (int run = 0; run < runs; ++run)
+  {
+    const std::string user_directory = File::CreateTempDir();
+    UICommon::SetUserDirectory(user_directory);
+
+    std::shared_ptr<FileSystem> fs = IOS::HLE::Kernel{}.GetFS();
+    bool succeeded = CreateTitles(*fs, options);
+
+    // Shutting down is timed too, as that is when changes that were kept in memory are written.
+    const auto start = std::chrono::steady_clock::now();
+    succeeded = succeeded && ReplayTrace(*fs, options);
+    fs.reset();
+    const std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    File::DeleteDirRecursively(user_directory);
+    if (!succeeded)
+      return 1;
+
+    times_ms.push_back(elapsed.count());
+    printf("Run %d: %.2f ms\n", run + 1, elapsed.count());
+  }
+
+  std::sort(times_ms.begin(), times_ms.end());
+  printf("%d titles with %d files, %d saves: min %.2f ms, median %.2f ms, max %.2f ms\n",
+         options.titles, options.files_per_title, options.iterations, times_ms.front(),
+         times_ms[times_ms.size() / 2], times_ms.back());
+  return 0;
+}
@@ -0,0 +1,687 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <OptionParser.h>
+#include <xxhash.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Common/StringUtil.h"
+#include "Common/Swap.h"
+#include "Common/WindowSystemInfo.h"
+#include "Core/Config/GraphicsSettings.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/FifoPlayer/FifoAnalyzer.h"
+#include "Core/FifoPlayer/FifoDataFile.h"
+#include "Core/HW/Memmap.h"
+#include "UICommon/CommandLineParse.h"
+#include "UICommon/UICommon.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/CPMemory.h"
+#include "VideoCommon/DataReader.h"
+#include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/Statistics.h"
+#include "VideoCommon/TextureCacheBase.h"
+#include "VideoCommon/TextureDecoder.h"
+#include "VideoCommon/VertexManagerBase.h"
+#include "VideoCommon/VideoBackendBase.h"
+#include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/XFMemory.h"
+
+// Replays a FIFO log straight into the opcode decoder of a video backend, without emulating the
+// CPU, the gather pipe or the command processor, and reports how long each frame took. This
+// measures the CPU cost of VideoCommon and the backend on its own, in a reproducible way.
+//
+// For regression testing, it can also hash what each frame copies to the XFB, and split a log
+// into segments that start from a snapshot of the state at their first frame. Each segment is a
+// regular FIFO log, so the segments of a long log can be replayed by separate processes.
+
+namespace
+{
+struct FrameResult
+{
+  u32 opcodes = 0;
+  u32 vertices = 0;
+  u32 draw_calls = 0;
+  std::vector<double> times_ms;
+  // Offsets right after the commands that copy the EFB to the XFB
+  std::vector<u32> xfb_copies;
+  u64 xfb_hash = 0;
+};
+
+class CommandWriter
+{
+public:
+  void Write8(u8 value) { m_data.push_back(value); }
+  void Write32(u32 value)
+  {
+    const u32 swapped = Common::swap32(value);
+    const u8* bytes = reinterpret_cast<const u8*>(&swapped);
+    m_data.insert(m_data.end(), bytes, bytes + sizeof(swapped));
+  }
+
+  std::vector<u8>& GetData() { return m_data; }
+
+private:
+  std::vector<u8> m_data;
+};
+
+// Same registers as FifoPlayer::ShouldLoadBP, which would trigger work or interrupts.
+bool ShouldLoadBP(u8 address)
+{
+  switch (address)
+  {
+  case BPMEM_SETDRAWDONE:
+  case BPMEM_PE_TOKEN_ID:
+  case BPMEM_PE_TOKEN_INT_ID:
+  case BPMEM_TRIGGER_EFB_COPY:
+  case BPMEM_LOADTLUT1:
+  case BPMEM_PRELOAD_MODE:
+  case BPMEM_PERF1:
+    return false;
+  default:
+    return true;
+  }
+}
+
+// Builds the commands that FifoPlayer::LoadRegisters pushes through the gather pipe.
+std::vector<u8> BuildRegisterCommands(FifoDataFile& file)
+{
+  CommandWriter writer;
+
+  const u32* regs = file.GetBPMem();
+  for (int i = 0; i < FifoDataFile::BP_MEM_SIZE; ++i)
+  {
+    if (!ShouldLoadBP(i))
+      continue;
+    writer.Write8(OpcodeDecoder::GX_LOAD_BP_REG);
+    writer.Write32((i << 24) | (regs[i] & 0x00ffffff));
+  }
+
+  const auto load_cp_reg = [&writer, &file](u8 reg) {
+    writer.Write8(OpcodeDecoder::GX_LOAD_CP_REG);
+    writer.Write8(reg);
+    writer.Write32(file.GetCPMem()[reg]);
+  };
+  load_cp_reg(0x30);
+  load_cp_reg(0x40);
+  load_cp_reg(0x50);
+  load_cp_reg(0x60);
+  for (int i = 0; i < 8; ++i)
+  {
+    load_cp_reg(0x70 + i);
+    load_cp_reg(0x80 + i);
+    load_cp_reg(0x90 + i);
+  }
+  for (int i = 0; i < 16; ++i)
+  {
+    load_cp_reg(0xa0 + i);
+    load_cp_reg(0xb0 + i);
+  }
+
+  regs = file.GetXFMem();
+  for (int i = 0; i < FifoDataFile::XF_MEM_SIZE; i += 16)
+  {
+    writer.Write8(OpcodeDecoder::GX_LOAD_XF_REG);
+    writer.Write32(0x000f0000 | (i & 0xffff));
+    for (int j = 0; j < 16; ++j)
+      writer.Write32(regs[i + j]);
+  }
+
+  regs = file.GetXFRegs();
+  for (int i = 0; i < FifoDataFile::XF_REGS_SIZE; ++i)
+  {
+    writer.Write8(OpcodeDecoder::GX_LOAD_XF_REG);
+    writer.Write32((i & 0x0fff) | 0x1000);
+    writer.Write32(regs[i]);
+  }
+
+  return std::move(writer.GetData());
+}
+
+bool IsXFBCopy(const u8* command, u32 size)
+{
+  if (size != 5 || command[0] != OpcodeDecoder::GX_LOAD_BP_REG)
+    return false;
+
+  const u32 value = Common::swap32(command + 1);
+  if (value >> 24 != BPMEM_TRIGGER_EFB_COPY)
+    return false;
+
+  UPE_Copy copy;
+  copy.Hex = value & 0xffffff;
+  return copy.copy_to_xfb != 0;
+}
+
+// Counts the commands in each frame, not including the ones in display lists, and finds the
+// copies to the XFB.
+void AnalyzeFrames(FifoDataFile& file, std::vector<FrameResult>* results)
+{
+  const u32* cp_mem = file.GetCPMem();
+  FifoAnalyzer::LoadCPReg(0x50, cp_mem[0x50], FifoAnalyzer::s_CpMem);
+  FifoAnalyzer::LoadCPReg(0x60, cp_mem[0x60], FifoAnalyzer::s_CpMem);
+  for (int i = 0; i < 8; ++i)
+  {
+    FifoAnalyzer::LoadCPReg(0x70 + i, cp_mem[0x70 + i], FifoAnalyzer::s_CpMem);
+    FifoAnalyzer::LoadCPReg(0x80 + i, cp_mem[0x80 + i], FifoAnalyzer::s_CpMem);
+    FifoAnalyzer::LoadCPReg(0x90 + i, cp_mem[0x90 + i], FifoAnalyzer::s_CpMem);
+  }
+
+  for (u32 frame_index = 0; frame_index < file.GetFrameCount(); ++frame_index)
+  {
+    const auto frame = file.GetFrame(frame_index);
+    const std::vector<u8>& data = frame->fifoData;
+    FrameResult& result = (*results)[frame_index];
+    u32 opcodes = 0;
+    size_t position = 0;
+    while (position < data.size())
+    {
+      const u32 size =
+          FifoAnalyzer::AnalyzeCommand(&data[position], FifoAnalyzer::DecodeMode::Playback);
+      if (size == 0)
+        break;
+      if (IsXFBCopy(&data[position], size))
+        result.xfb_copies.push_back(static_cast<u32>(position + size));
+      position += size;
+      ++opcodes;
+    }
+    result.opcodes = opcodes;
+  }
+}
+
+const u8* RunCommands(const u8* start, const u8* end)
+{
+  // The decoder only reads from the buffer.
+  u32 cycles;
+  return OpcodeDecoder::Run(DataReader(const_cast<u8*>(start), const_cast<u8*>(end)), &cycles,
+                            false);
+}
+
+void WriteMemory(const MemoryUpdate& update)
+{
+  u8* mem;
+  if (update.address & 0x10000000)
+    mem = &Memory::m_pEXRAM[update.address & Memory::EXRAM_MASK];
+  else
+    mem = &Memory::m_pRAM[update.address & Memory::RAM_MASK];
+
+  std::copy(update.data.begin(), update.data.end(), mem);
+}
+
+// Runs the FIFO data of a frame, applying the memory updates at the points they were recorded.
+// on_xfb_copy is called right after each of the given XFB copies.
+void ReplayFrame(const FifoFrameInfo& frame, const std::vector<u32>& xfb_copies,
+                 const std::function<void()>& on_xfb_copy)
+{
+  const u8* const data = frame.fifoData.data();
+  const u8* const end = data + frame.fifoData.size();
+  const u8* position = data;
+  auto update = frame.memoryUpdates.begin();
+  auto copy = xfb_copies.begin();
+  while (update != frame.memoryUpdates.end() || copy != xfb_copies.end())
+  {
+    const bool is_update = update != frame.memoryUpdates.end() &&
+                           (copy == xfb_copies.end() || update->fifoPosition <= *copy);
+    const u32 offset = is_update ? update->fifoPosition : *copy;
+    const u8* const stop = data + std::min<size_t>(offset, end - data);
+    // A command that is cut off by an update continues with the next part.
+    if (position < stop)
+      position = RunCommands(position, stop);
+
+    if (is_update)
+    {
+      WriteMemory(*update++);
+    }
+    else
+    {
+      on_xfb_copy();
+      ++copy;
+    }
+  }
+  if (position < end)
+    RunCommands(position, end);
+}
+
+const u8* GetMemoryRange(u32 address, u32 size)
+{
+  const bool is_exram = (address & 0x10000000) != 0;
+  const u32 offset = address & (is_exram ? Memory::EXRAM_MASK : Memory::RAM_MASK);
+  const u32 memory_size = is_exram ? Memory::EXRAM_SIZE : Memory::RAM_SIZE;
+  if ((is_exram && !Memory::m_pEXRAM) || offset > memory_size || size > memory_size - offset)
+    return nullptr;
+
+  return (is_exram ? Memory::m_pEXRAM : Memory::m_pRAM) + offset;
+}
+
+// Hashes the data that the XFB copy that was just run wrote to RAM, chained onto hash.
+u64 HashXFBCopy(u64 hash)
+{
+  g_texture_cache->FlushEFBCopies();
+
+  // Same as the XFB copy in BPStructs.
+  const u32 address = bpmem.copyTexDest << 5;
+  const u32 stride = bpmem.copyMipMapStrideChannels << 5;
+  const float y_scale = bpmem.triggerEFBCopy.scale_invert ?
+                            256.0f / static_cast<float>(bpmem.dispcopyyscale) :
+                            static_cast<float>(bpmem.dispcopyyscale) / 256.0f;
+  const u32 height = static_cast<u32>(1.0f + bpmem.copyTexSrcWH.y * y_scale);
+
+  const u8* const data = GetMemoryRange(address, stride * height);
+  if (!data)
+    return XXH64(&address, sizeof(address), hash);
+
+  return XXH64(data, stride * height, hash);
+}
+
+// The video state that FifoPlayer loads before the first frame of a log
+std::unique_ptr<FifoDataFile> CaptureState(bool is_wii)
+{
+  auto state = std::make_unique<FifoDataFile>();
+  state->SetIsWii(is_wii);
+
+  std::memcpy(state->GetBPMem(), &bpmem, FifoDataFile::BP_MEM_SIZE * sizeof(u32));
+
+  std::fill_n(state->GetCPMem(), FifoDataFile::CP_MEM_SIZE, 0);
+  FillCPMemoryArray(state->GetCPMem());
+
+  const u32* const xf = reinterpret_cast<const u32*>(&xfmem);
+  std::copy_n(xf, FifoDataFile::XF_MEM_SIZE, state->GetXFMem());
+  std::copy_n(xf + FifoDataFile::XF_MEM_SIZE, FifoDataFile::XF_REGS_SIZE, state->GetXFRegs());
+
+  std::memcpy(state->GetTexMem(), texMem, FifoDataFile::TEX_MEM_SIZE);
+  return state;
+}
+
+// Splits a log into logs of consecutive frames that can be replayed on their own. Each one starts
+// with the video state at its first frame, and with memory updates that restore all the memory
+// that earlier frames have written. EFB contents and EFB copies that only exist in the texture
+// cache aren't part of that state.
+class SegmentWriter
+{
+public:
+  SegmentWriter(std::string path_prefix, u32 frame_count, u32 segment_count, bool is_wii)
+      : m_path_prefix(std::move(path_prefix)), m_frame_count(frame_count),
+        m_segment_count(segment_count), m_is_wii(is_wii)
+  {
+  }
+
+  // Must be called right before each frame is replayed.
+  bool AddFrame(u32 frame_index, const FifoFrameInfo& frame)
+  {
+    if (frame_index == GetSegmentStart(m_segment))
+    {
+      if (m_writer && !FinishSegment())
+        return false;
+
+      if (!StartSegment(frame_index))
+        return false;
+
+      FifoFrameInfo first_frame = frame;
+      std::vector<MemoryUpdate> updates = CaptureMemory();
+      updates.insert(updates.end(), std::make_move_iterator(first_frame.memoryUpdates.begin()),
+                     std::make_move_iterator(first_frame.memoryUpdates.end()));
+      first_frame.memoryUpdates = std::move(updates);
+      m_writer->AddFrame(std::move(first_frame));
+    }
+    else
+    {
+      m_writer->AddFrame(frame);
+    }
+
+    for (const MemoryUpdate& update : frame.memoryUpdates)
+      AddWrittenRange(update.address, static_cast<u32>(update.data.size()));
+
+    return true;
+  }
+
+  bool Finish() { return !m_writer || FinishSegment(); }
+
+private:
+  u32 GetSegmentStart(u32 segment) const
+  {
+    return static_cast<u32>(u64(m_frame_count) * segment / m_segment_count);
+  }
+
+  bool StartSegment(u32 frame_index)
+  {
+    m_path = StringFromFormat("%s_%06u.dff", m_path_prefix.c_str(), frame_index);
+    m_writer = std::make_unique<FifoDataFileWriter>(m_path);
+    if (!m_writer->IsOpen())
+    {
+      fprintf(stderr, "Failed to open %s for writing\n", m_path.c_str());
+      return false;
+    }
+
+    m_state = CaptureState(m_is_wii);
+    ++m_segment;
+    return true;
+  }
+
+  bool FinishSegment()
+  {
+    const bool written = m_writer->Finish(*m_state);
+    m_writer.reset();
+    if (!written)
+      fprintf(stderr, "Failed to write %s\n", m_path.c_str());
+    else
+      printf("wrote %s\n", m_path.c_str());
+    return written;
+  }
+
+  void AddWrittenRange(u32 address, u32 size)
+  {
+    u32 end = address + size;
+
+    // Merge with the ranges that overlap or touch the new one.
+    auto it = m_written_ranges.upper_bound(address);
+    if (it != m_written_ranges.begin() && std::prev(it)->second >= address)
+      --it;
+    while (it != m_written_ranges.end() && it->first <= end)
+    {
+      address = std::min(address, it->first);
+      end = std::max(end, it->second);
+      it = m_written_ranges.erase(it);
+    }
+    m_written_ranges.emplace(address, end);
+  }
+
+  std::vector<MemoryUpdate> CaptureMemory() const
+  {
+    std::vector<MemoryUpdate> updates;
+    for (const auto& [start, end] : m_written_ranges)
+    {
+      const u8* const data = GetMemoryRange(start, end - start);
+      if (!data)
+        continue;
+
+      MemoryUpdate& update = updates.emplace_back();
+      update.fifoPosition = 0;
+      update.address = start;
+      update.data.assign(data, data + (end - start));
+      update.type = MemoryUpdate::TEXTURE_MAP;
+    }
+    return updates;
+  }
+
+  std::string m_path_prefix;
+  u32 m_frame_count;
+  u32 m_segment_count;
+  bool m_is_wii;
+
+  u32 m_segment = 0;
+  std::string m_path;
+  std::unique_ptr<FifoDataFileWriter> m_writer;
+  std::unique_ptr<FifoDataFile> m_state;
+  // Start and end of the memory that memory updates have written so far
+  std::map<u32, u32> m_written_ranges;
+};
+
+double GetPercentile(const std::vector<double>& sorted_times, double percentile)
+{
+  if (sorted_times.empty())
+    return 0.0;
+
+  const size_t rank = static_cast<size_t>(std::ceil(percentile / 100.0 * sorted_times.size()));
+  return sorted_times[std::clamp<size_t>(rank, 1, sorted_times.size()) - 1];
+}
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  auto parser = CommandLineParse::CreateParser(CommandLineParse::ParserOptions::OmitGUIOptions);
+  parser->usage("usage: %prog [options]... FIFO_LOG");
+  parser->set_defaults("video_backend", "Null");
+  parser->set_defaults("iterations", "10");
+  parser->add_option("-i", "--iterations")
+      .action("store")
+      .type("int")
+      .help("How many times to replay and time the whole log [default: %default]");
+  parser->add_option("-f", "--per_frame")
+      .action("store_true")
+      .help("Print the timings of every frame of the log");
+  parser->add_option("--hash")
+      .action("store_true")
+      .help("Print a hash of what every frame copies to the XFB, from a pass that isn't timed");
+  parser->add_option("-s", "--split")
+      .action("store")
+      .type("int")
+      .metavar("<segments>")
+      .help("Split the log into this many logs that can be replayed on their own");
+  parser->add_option("-o", "--output")
+      .action("store")
+      .metavar("<directory>")
+      .help("Where to write the split logs [default: the directory of the log]");
+
+  optparse::Values& options = CommandLineParse::ParseArguments(parser.get(), argc, argv);
+  const std::vector<std::string> args = parser->args();
+  if (args.size() != 1)
+  {
+    parser->print_help();
+    return 1;
+  }
+
+  const bool hash_frames = options.get("hash");
+  const int segment_count = options.is_set("split") ? static_cast<int>(options.get("split")) : 0;
+  // Hashing and splitting can be done without timing anything
+  const int min_iterations = hash_frames || segment_count > 0 ? 0 : 1;
+  const int iterations = std::max(min_iterations, static_cast<int>(options.get("iterations")));
+
+  std::string user_directory;
+  if (options.is_set("user"))
+    user_directory = static_cast<const char*>(options.get("user"));
+  UICommon::SetUserDirectory(user_directory);
+  UICommon::Init();
+
+  const std::unique_ptr<FifoDataFile> file = FifoDataFile::Load(args.front(), false);
+  if (!file || file->GetFrameCount() == 0)
+  {
+    fprintf(stderr, "Failed to load %s\n", args.front().c_str());
+    UICommon::Shutdown();
+    return 1;
+  }
+
+  // UICommon::Init activates the backend from the configuration files, not the command line.
+  const std::string backend_name = static_cast<const char*>(options.get("video_backend"));
+  VideoBackendBase::ActivateBackend(backend_name);
+  if (!g_video_backend || g_video_backend->GetName() != backend_name)
+  {
+    fprintf(stderr, "Unknown video backend %s\n", backend_name.c_str());
+    UICommon::Shutdown();
+    return 1;
+  }
+
+  std::unique_ptr<SegmentWriter> segment_writer;
+  if (segment_count > 0)
+  {
+    std::string directory, name;
+    SplitPath(args.front(), &directory, &name, nullptr);
+    if (options.is_set("output"))
+      directory = static_cast<const char*>(options.get("output"));
+    if (directory.empty())
+      directory = "./";
+    else if (directory.back() != '/')
+      directory += '/';
+
+    File::CreateFullPath(directory);
+    segment_writer = std::make_unique<SegmentWriter>(
+        directory + name, file->GetFrameCount(),
+        std::min<u32>(segment_count, file->GetFrameCount()), file->GetIsWii());
+  }
+
+  SConfig::GetInstance().bWii = file->GetIsWii();
+  // Run everything on this thread, like single core mode. Token and finish interrupts get
+  // scheduled, but nothing handles them as there is no emulated CPU.
+  SConfig::GetInstance().bCPUThread = false;
+  Core::DeclareAsCPUThread();
+  Memory::Init();
+
+  g_video_backend->InitBackendInfo();
+  g_Config.Refresh();
+  if (!g_video_backend->Initialize(WindowSystemInfo{}))
+  {
+    fprintf(stderr, "Failed to initialize the %s video backend without a window\n",
+            backend_name.c_str());
+    Memory::Shutdown();
+    UICommon::Shutdown();
+    return 1;
+  }
+
+  std::vector<FrameResult> results(file->GetFrameCount());
+  AnalyzeFrames(*file, &results);
+  const std::vector<u8> register_commands = BuildRegisterCommands(*file);
+
+  int frame_count = 0;
+  // Every pass starts from the state the log was recorded with.
+  const auto start_pass = [&file, &register_commands] {
+    std::memcpy(texMem, file->GetTexMem(), FifoDataFile::TEX_MEM_SIZE);
+    RunCommands(register_commands.data(), register_commands.data() + register_commands.size());
+    g_vertex_manager->Flush();
+  };
+
+  // Hashing and splitting happen in a pass of their own, which isn't timed.
+  bool segments_written = true;
+  if (hash_frames || segment_writer)
+  {
+    // XFB copies normally only go to the texture cache. Hashing needs them in RAM, which is more
+    // work, so that is only enabled for this pass.
+    const bool skip_xfb_copy_to_ram = Config::Get(Config::GFX_HACK_SKIP_XFB_COPY_TO_RAM);
+    if (hash_frames)
+    {
+      Config::SetCurrent(Config::GFX_HACK_SKIP_XFB_COPY_TO_RAM, false);
+      g_Config.Refresh();
+      UpdateActiveConfig();
+    }
+
+    start_pass();
+    for (u32 frame_index = 0; frame_index < file->GetFrameCount(); ++frame_index)
+    {
+      FrameResult& result = results[frame_index];
+      const auto frame = file->GetFrame(frame_index);
+      if (segment_writer && !segment_writer->AddFrame(frame_index, *frame))
+      {
+        segments_written = false;
+        break;
+      }
+
+      if (hash_frames)
+      {
+        ReplayFrame(*frame, result.xfb_copies,
+                    [&result] { result.xfb_hash = HashXFBCopy(result.xfb_hash); });
+      }
+      else
+      {
+        ReplayFrame(*frame, {}, {});
+      }
+      g_vertex_manager->Flush();
+      g_texture_cache->Cleanup(++frame_count);
+    }
+
+    if (segment_writer)
+      segments_written = segments_written && segment_writer->Finish();
+
+    if (hash_frames)
+    {
+      Config::SetCurrent(Config::GFX_HACK_SKIP_XFB_COPY_TO_RAM, skip_xfb_copy_to_ram);
+      g_Config.Refresh();
+      UpdateActiveConfig();
+    }
+  }
+
+  for (int iteration = 0; segments_written && iteration < iterations; ++iteration)
+  {
+    start_pass();
+    for (u32 frame_index = 0; frame_index < file->GetFrameCount(); ++frame_index)
+    {
+      FrameResult& result = results[frame_index];
+      g_stats.ResetFrame();
+
+      // Streamed logs decompress frames as they are read, which shouldn't count as replay time.
+      const auto frame = file->GetFrame(frame_index);
+
+      const auto start = std::chrono::steady_clock::now();
+      ReplayFrame(*frame, {}, {});
+      g_vertex_manager->Flush();
+      const auto end = std::chrono::steady_clock::now();
+
+      result.times_ms.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+      result.vertices = g_stats.this_frame.num_prims + g_stats.this_frame.num_dl_prims;
+      result.draw_calls = g_stats.this_frame.num_draw_calls;
+
+      // What the renderer does at the end of each frame, to keep the texture cache in check.
+      g_texture_cache->Cleanup(++frame_count);
+    }
+  }
+
+  g_video_backend->Shutdown();
+  Memory::Shutdown();
+  UICommon::Shutdown();
+
+  if (!segments_written)
+    return 1;
+
+  if (hash_frames)
+  {
+    printf("XFB hashes, from the untimed pass:\n");
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+      if (results[i].xfb_copies.empty())
+        printf("frame %6zu: no XFB copy\n", i);
+      else
+        printf("frame %6zu: %016llx\n", i, static_cast<unsigned long long>(results[i].xfb_hash));
+    }
+  }
+
+  if (iterations == 0)
+    return 0;
+
+  std::vector<double> all_times;
+  u64 total_opcodes = 0;
+  u64 total_vertices = 0;
+  if (options.get("per_frame"))
+    printf("%6s %10s %10s %10s %10s %10s\n", "frame", "opcodes", "vertices", "draws", "mean ms",
+           "min ms");
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    const FrameResult& result = results[i];
+    all_times.insert(all_times.end(), result.times_ms.begin(), result.times_ms.end());
+    total_opcodes += result.opcodes;
+    total_vertices += result.vertices;
+
+    if (options.get("per_frame"))
+    {
+      const double total_ms = std::accumulate(result.times_ms.begin(), result.times_ms.end(), 0.0);
+      const double min_ms = *std::min_element(result.times_ms.begin(), result.times_ms.end());
+      printf("%6zu %10u %10u %10u %10.3f %10.3f\n", i, result.opcodes, result.vertices,
+             result.draw_calls, total_ms / result.times_ms.size(), min_ms);
+    }
+  }
+
+  std::sort(all_times.begin(), all_times.end());
+  const double total_ms = std::accumulate(all_times.begin(), all_times.end(), 0.0);
+  printf("%s: %u frames, %d iterations, %s backend\n", args.front().c_str(),
+         file->GetFrameCount(), iterations, backend_name.c_str());
+  printf("per log pass: %llu opcodes, %llu vertices\n",
+         static_cast<unsigned long long>(total_opcodes),
+         static_cast<unsigned long long>(total_vertices));
+  printf("frame time: mean %.3f ms, p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+         total_ms / all_times.size(), GetPercentile(all_times, 50), GetPercentile(all_times, 90),
+         GetPercentile(all_times, 99), all_times.back());
+  printf("total: %.3f ms, %.1f frames/s\n", total_ms, all_times.size() * 1000.0 / total_ms);
+  return 0;
+}
@@ -0,0 +1,215 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <OptionParser.h>
+
+#include "Common/CommonTypes.h"
+#include "InputCommon/ControlReference/CompiledExpression.h"
+#include "InputCommon/ControlReference/ExpressionParser.h"
+#include "InputCommon/ControllerInterface/Device.h"
+
+// Polls hundreds of input mappings, like those of 4 Wii Remotes with Nunchuks, and reports how
+// long a poll of all of them takes when the expression trees are evaluated and when the programs
+// compiled from them are run. The inputs come from a fake device, so only the cost of evaluating
+// the mappings is measured.
+
+namespace
+{
+using namespace ciface::ExpressionParser;
+
+class BenchInput final : public ciface::Core::Device::Input
+{
+public:
+  explicit BenchInput(std::string name) : m_name(std::move(name)) {}
+  std::string GetName() const override { return m_name; }
+  ControlState GetState() const override { return value; }
+
+  ControlState value = 0.0;
+
+private:
+  std::string m_name;
+};
+
+class BenchDevice final : public ciface::Core::Device
+{
+public:
+  explicit BenchDevice(const std::vector<std::string>& input_names)
+  {
+    for (const std::string& name : input_names)
+    {
+      m_bench_inputs.push_back(new BenchInput(name));
+      AddInput(m_bench_inputs.back());
+    }
+  }
+
+  std::string GetName() const override { return "Bench"; }
+  std::string GetSource() const override { return "Bench"; }
+
+  void SetInputs(u32 seed)
+  {
+    static constexpr ControlState values[] = {0.0, 1.0, 0.25, 0.75, 0.5};
+    for (BenchInput* input : m_bench_inputs)
+    {
+      input->value = values[seed % 5];
+      seed = seed / 5 + 3;
+    }
+  }
+
+private:
+  std::vector<BenchInput*> m_bench_inputs;
+};
+
+class BenchDeviceContainer final : public ciface::Core::DeviceContainer
+{
+public:
+  explicit BenchDeviceContainer(std::shared_ptr<ciface::Core::Device> device)
+  {
+    device->SetId(0);
+    m_devices.push_back(std::move(device));
+  }
+};
+
+// Mostly single buttons and sticks, which is what the default mappings are
+const std::vector<std::string> SIMPLE_MAPPINGS = {
+    "A",
+    "`B` | `C`",
+    "A & !Shift",
+    "if(Shift, B, C)",
+    "deadzone(`Axis X+` - `Axis X-`, 0.15) * 1.2",
+    "(`Axis X+` | A) - (`Axis X-` | B)",
+    "A ^ B",
+    "smooth(`Axis X+`, 0.1)",
+    "B * 0.5 + C * 0.5",
+    "if(Shift & !A, `Axis X+` * 2, `Axis X-` / 2)",
+};
+
+// Hand-written mappings that combine several inputs, with constants to fold
+const std::vector<std::string> COMPLEX_MAPPINGS = {
+    "deadzone((`Axis X+` - `Axis X-`) * (1 + 0.5 * 0.2), 0.1 + 0.05) * 1.5 + (A | B) * C",
+    "(A + B + C + Shift) / 4 + deadzone(`Axis X+` * 2 * 0.5, 0.15) - `Axis X-` * 0.25 * 4",
+    "if(Shift & !A, (`Axis X+` - `Axis X-`) * 0.5 + 0.5, (B | C) * (1 / 3))",
+    "sin(`Axis X+` * 3.14159 / 2) * (1 - Shift) + (A ^ B ^ C) * 0.75",
+    "(A < 0.5) * B + (A > 0.5) * C + deadzone(`Axis X-` - `Axis X+`, 0.2 * 0.5)",
+};
+
+struct PollTimes
+{
+  double tree_us;
+  double compiled_us;
+};
+
+PollTimes MeasurePolls(const std::vector<std::string>& mappings, u32 mapping_count,
+                       u32 poll_count)
+{
+  const auto device = std::make_shared<BenchDevice>(
+      std::vector<std::string>{"A", "B", "C", "Axis X-", "Axis X+", "Shift"});
+  BenchDeviceContainer container(device);
+  ciface::Core::DeviceQualifier qualifier;
+  qualifier.FromDevice(device.get());
+
+  // The trees and the programs get their own copies, so that functions with state are evaluated
+  // the same number of times in both.
+  ControlEnvironment::VariableContainer tree_variables;
+  ControlEnvironment::VariableContainer compiled_variables;
+  ControlEnvironment tree_environment(container, qualifier, tree_variables);
+  ControlEnvironment compiled_environment(container, qualifier, compiled_variables);
+
+  std::vector<std::unique_ptr<Expression>> trees;
+  std::vector<std::unique_ptr<Expression>> compiled_trees;
+  std::vector<CompiledExpression> programs;
+  for (u32 i = 0; i < mapping_count; ++i)
+  {
+    const std::string& mapping = mappings[i % mappings.size()];
+    trees.push_back(ParseExpression(mapping).expr);
+    trees.back()->UpdateReferences(tree_environment);
+    compiled_trees.push_back(ParseExpression(mapping).expr);
+    compiled_trees.back()->UpdateReferences(compiled_environment);
+    programs.push_back(ExpressionCompiler::Compile(*compiled_trees.back()));
+  }
+
+  const auto measure = [&](const auto& poll) {
+    // Keeps the compiler from dropping the polls
+    volatile ControlState sum = 0.0;
+    const auto start = std::chrono::steady_clock::now();
+    for (u32 i = 0; i < poll_count; ++i)
+    {
+      device->SetInputs(i);
+      for (u32 j = 0; j < mapping_count; ++j)
+        sum = sum + poll(j);
+    }
+    const std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / poll_count;
+  };
+
+  PollTimes times;
+  times.tree_us = measure([&](u32 j) { return trees[j]->GetValue(); });
+  times.compiled_us = measure([&](u32 j) { return programs[j].GetValue(); });
+  return times;
+}
+
+void RunBenchmark(const char* name, const std::vector<std::string>& mappings, u32 mapping_count,
+                  u32 poll_count, int runs)
+{
+  std::vector<double> tree_us;
+  std::vector<double> compiled_us;
+  for (int run = 0; run < runs; ++run)
+  {
+    const PollTimes times = MeasurePolls(mappings, mapping_count, poll_count);
+    tree_us.push_back(times.tree_us);
+    compiled_us.push_back(times.compiled_us);
+  }
+
+  std::sort(tree_us.begin(), tree_us.end());
+  std::sort(compiled_us.begin(), compiled_us.end());
+  printf("%u %s mappings: median %.2f us per poll as trees, %.2f us compiled "
+         "(min %.2f us, %.2f us)\n",
+         mapping_count, name, tree_us[tree_us.size() / 2], compiled_us[compiled_us.size() / 2],
+         tree_us.front(), compiled_us.front());
+}
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  optparse::OptionParser parser;
+  parser.usage("usage: %prog [options]...");
+  parser.set_defaults("mappings", "480");
+  parser.set_defaults("polls", "2000");
+  parser.set_defaults("runs", "9");
+  parser.add_option("-m", "--mappings")
+      .action("store")
+      .type("int")
+      .help("How many mappings are polled [default: %default]");
+  parser.add_option("-p", "--polls")
+      .action("store")
+      .type("int")
+      .help("How many times all mappings are polled in each run [default: %default]");
+  parser.add_option("-r", "--runs")
+      .action("store")
+      .type("int")
+      .help("How many times to repeat the measurement [default: %default]");
+
+  const optparse::Values& values = parser.parse_args(argc, argv);
+  if (!parser.args().empty())
+  {
+    parser.print_help();
+    return 1;
+  }
+
+  const u32 mapping_count = std::max(1, static_cast<int>(values.get("mappings")));
+  const u32 poll_count = std::max(1, static_cast<int>(values.get("polls")));
+  const int runs = std::max(1, static_cast<int>(values.get("runs")));
+
+  RunBenchmark("simple", SIMPLE_MAPPINGS, mapping_count, poll_count, runs);
+  RunBenchmark("complex", COMPLEX_MAPPINGS, mapping_count, poll_count, runs);
+  return 0;
+}
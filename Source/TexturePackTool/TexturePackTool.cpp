@@ -0,0 +1,48 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstdio>
+#include <string>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "VideoCommon/HiresTextures.h"
+#include "VideoCommon/VideoConfig.h"
+
+// Converts a directory of loose custom textures (as found in Load/Textures/<game id>) into a
+// single texture pack file, which Dolphin picks up when it is placed in the texture directory.
+int main(int argc, const char* argv[])
+{
+  if (argc != 3)
+  {
+    printf("USAGE: TexturePackTool <TEXTURE DIRECTORY> <OUTPUT FILE>\n");
+    printf("Packs all PNG and DDS custom textures in the directory into a .dtp texture pack.\n");
+    printf("Compressed DDS textures are stored as they are, so the pack only works with video "
+           "backends that support their formats.\n");
+    return 1;
+  }
+
+  const std::string directory = argv[1];
+  const std::string pack_filename = argv[2];
+  if (!File::IsDirectory(directory))
+  {
+    printf("%s is not a directory\n", directory.c_str());
+    return 1;
+  }
+
+  // Keep block compressed DDS textures as they are instead of skipping them.
+  g_ActiveConfig.backend_info.bSupportsST3CTextures = true;
+  g_ActiveConfig.backend_info.bSupportsBPTCTextures = true;
+
+  u32 num_textures = 0;
+  if (!HiresTexture::WriteTexturePack(directory, pack_filename, &num_textures))
+  {
+    printf("Failed to write %s\n", pack_filename.c_str());
+    File::Delete(pack_filename);
+    return 1;
+  }
+
+  printf("Packed %u textures into %s\n", num_textures, pack_filename.c_str());
+  return 0;
+}
@@ -0,0 +1,115 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "Common/Crypto/AES.h"
+
+namespace
+{
+constexpr std::array<u8, 16> KEY{{0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a,
+                                  0x0b, 0x0c, 0x0d, 0x0e, 0x0f}};
+
+std::vector<u8> MakeData(size_t size, u8 seed)
+{
+  std::vector<u8> data(size);
+  for (size_t i = 0; i < size; ++i)
+    data[i] = static_cast<u8>(i * 13 + i / 7 + seed);
+  return data;
+}
+
+// Runs every test without and, if the CPU supports them, with the AES instructions.
+class AESTest : public testing::TestWithParam<bool>
+{
+protected:
+  void SetUp() override
+  {
+    cpu_info.bAES = cpu_info.bAES && GetParam();
+  }
+  void TearDown() override { cpu_info = CPUInfo(); }
+};
+}  // namespace
+
+TEST_P(AESTest, KnownAnswer)
+{
+  // FIPS-197 appendix C.1
+  constexpr std::array<u8, 16> plaintext{{0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88,
+                                          0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff}};
+  constexpr std::array<u8, 16> ciphertext{{0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8,
+                                           0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a}};
+  constexpr std::array<u8, 16> iv{};
+
+  std::array<u8, 16> result;
+  Common::AES::CreateContext(KEY.data(), Common::AES::Mode::Encrypt)
+      ->Crypt(iv.data(), plaintext.data(), result.data(), result.size());
+  EXPECT_EQ(ciphertext, result);
+
+  Common::AES::CreateContext(KEY.data(), Common::AES::Mode::Decrypt)
+      ->Crypt(iv.data(), ciphertext.data(), result.data(), result.size());
+  EXPECT_EQ(plaintext, result);
+}
+
+TEST_P(AESTest, MatchesReferenceCBC)
+{
+  const std::vector<u8> iv = MakeData(16, 1);
+  const auto encrypt = Common::AES::CreateContext(KEY.data(), Common::AES::Mode::Encrypt);
+  const auto decrypt = Common::AES::CreateContext(KEY.data(), Common::AES::Mode::Decrypt);
+
+  // Sizes that are and aren't a multiple of the number of blocks done at once.
+  for (size_t size : {16u, 48u, 128u, 208u, 0x7C00u})
+  {
+    const std::vector<u8> plaintext = MakeData(size, static_cast<u8>(size));
+    std::vector<u8> iv_copy = iv;
+    const std::vector<u8> expected =
+        Common::AES::Encrypt(KEY.data(), iv_copy.data(), plaintext.data(), size);
+
+    std::vector<u8> ciphertext(size);
+    encrypt->Crypt(iv.data(), plaintext.data(), ciphertext.data(), size);
+    EXPECT_EQ(expected, ciphertext) << "size " << size;
+
+    // In place
+    std::vector<u8> buffer = ciphertext;
+    decrypt->Crypt(iv.data(), buffer.data(), buffer.data(), size);
+    EXPECT_EQ(plaintext, buffer) << "size " << size;
+  }
+}
+
+TEST_P(AESTest, CryptBatch)
+{
+  constexpr size_t STREAMS = 11;
+  constexpr size_t SIZE = 0x400;
+
+  std::vector<std::vector<u8>> ivs, plaintexts, ciphertexts(STREAMS, std::vector<u8>(SIZE));
+  std::vector<Common::AES::Stream> streams;
+  for (size_t i = 0; i < STREAMS; ++i)
+  {
+    ivs.push_back(MakeData(16, static_cast<u8>(i * 3)));
+    plaintexts.push_back(MakeData(SIZE, static_cast<u8>(i)));
+    streams.push_back({ivs[i].data(), plaintexts[i].data(), ciphertexts[i].data()});
+  }
+
+  Common::AES::CreateContext(KEY.data(), Common::AES::Mode::Encrypt)
+      ->CryptBatch(streams.data(), streams.size(), SIZE);
+
+  const auto decrypt = Common::AES::CreateContext(KEY.data(), Common::AES::Mode::Decrypt);
+  for (size_t i = 0; i < STREAMS; ++i)
+  {
+    std::vector<u8> iv_copy = ivs[i];
+    EXPECT_EQ(Common::AES::Encrypt(KEY.data(), iv_copy.data(), plaintexts[i].data(), SIZE),
+              ciphertexts[i])
+        << "stream " << i;
+
+    std::vector<u8> decrypted(SIZE);
+    decrypt->Crypt(ivs[i].data(), ciphertexts[i].data(), decrypted.data(), SIZE);
+    EXPECT_EQ(plaintexts[i], decrypted) << "stream " << i;
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(AESInstructions, AESTest, testing::Values(false, true));
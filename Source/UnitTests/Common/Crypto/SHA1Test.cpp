@@ -0,0 +1,65 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <mbedtls/sha1.h>
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "Common/Crypto/SHA1.h"
+
+namespace
+{
+// Runs every test without and, if the CPU supports them, with the SHA instructions.
+class SHA1Test : public testing::TestWithParam<bool>
+{
+protected:
+  void SetUp() override
+  {
+    cpu_info.bSHA1 = cpu_info.bSHA1 && GetParam();
+  }
+  void TearDown() override { cpu_info = CPUInfo(); }
+};
+
+Common::SHA1::Digest Hash(const std::string& str)
+{
+  return Common::SHA1::CalculateDigest(reinterpret_cast<const u8*>(str.data()), str.size());
+}
+}  // namespace
+
+TEST_P(SHA1Test, KnownAnswer)
+{
+  EXPECT_EQ((Common::SHA1::Digest{{0xda, 0x39, 0xa3, 0xee, 0x5e, 0x6b, 0x4b, 0x0d, 0x32, 0x55,
+                                   0xbf, 0xef, 0x95, 0x60, 0x18, 0x90, 0xaf, 0xd8, 0x07, 0x09}}),
+            Hash(""));
+  EXPECT_EQ((Common::SHA1::Digest{{0xa9, 0x99, 0x3e, 0x36, 0x47, 0x06, 0x81, 0x6a, 0xba, 0x3e,
+                                   0x25, 0x71, 0x78, 0x50, 0xc2, 0x6c, 0x9c, 0xd0, 0xd8, 0x9d}}),
+            Hash("abc"));
+}
+
+TEST_P(SHA1Test, MatchesReference)
+{
+  std::vector<u8> data(0x400);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<u8>(i * 31 + i / 5);
+
+  // Covers every padding case, as well as the size of the hashes on Wii discs.
+  std::vector<size_t> sizes;
+  for (size_t size = 0; size <= 200; ++size)
+    sizes.push_back(size);
+  sizes.push_back(0x26C);
+  sizes.push_back(0x400);
+
+  for (size_t size : sizes)
+  {
+    Common::SHA1::Digest expected;
+    mbedtls_sha1_ret(data.data(), size, expected.data());
+    EXPECT_EQ(expected, Common::SHA1::CalculateDigest(data.data(), size)) << "size " << size;
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(SHAInstructions, SHA1Test, testing::Values(false, true));
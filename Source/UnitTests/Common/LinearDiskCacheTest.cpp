@@ -0,0 +1,207 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Common/LinearDiskCache.h"
+
+namespace
+{
+class MapReader : public LinearDiskCacheReader<u32, u8>
+{
+public:
+  void Read(const u32& key, const u8* value, u32 value_size) override
+  {
+    EXPECT_EQ(0u, entries.count(key));
+    entries[key].assign(value, value + value_size);
+  }
+
+  std::map<u32, std::vector<u8>> entries;
+};
+
+std::vector<u8> MakeValue(u32 key, u32 generation)
+{
+  std::vector<u8> value;
+  for (u32 i = 0; i < key % 7 + generation; ++i)
+    value.push_back(static_cast<u8>(key * 31 + generation * 7 + i));
+  return value;
+}
+}  // namespace
+
+class LinearDiskCacheTest : public testing::Test
+{
+protected:
+  LinearDiskCacheTest() : m_dir(File::CreateTempDir()), m_path(m_dir + "/cache.bin") {}
+  ~LinearDiskCacheTest() override { File::DeleteDirRecursively(m_dir); }
+
+  void Append(LinearDiskCache<u32, u8>& cache, u32 key, u32 generation)
+  {
+    const std::vector<u8> value = MakeValue(key, generation);
+    cache.Append(key, value.data(), static_cast<u32>(value.size()));
+  }
+
+  std::string m_dir;
+  std::string m_path;
+};
+
+TEST_F(LinearDiskCacheTest, ReadsBackAppendedEntries)
+{
+  {
+    LinearDiskCache<u32, u8> cache;
+    MapReader reader;
+    EXPECT_EQ(0u, cache.OpenAndRead(m_path, reader));
+    for (u32 key = 0; key < 20; ++key)
+      Append(cache, key, 0);
+  }
+
+  LinearDiskCache<u32, u8> cache;
+  MapReader reader;
+  EXPECT_EQ(20u, cache.OpenAndRead(m_path, reader));
+  ASSERT_EQ(20u, reader.entries.size());
+  for (u32 key = 0; key < 20; ++key)
+    EXPECT_EQ(MakeValue(key, 0), reader.entries[key]);
+}
+
+TEST_F(LinearDiskCacheTest, LatestEntryWins)
+{
+  {
+    LinearDiskCache<u32, u8> cache;
+    MapReader reader;
+    cache.OpenAndRead(m_path, reader);
+    Append(cache, 1, 0);
+    Append(cache, 2, 0);
+    Append(cache, 1, 1);
+  }
+
+  LinearDiskCache<u32, u8> cache;
+  MapReader reader;
+  EXPECT_EQ(2u, cache.OpenAndRead(m_path, reader));
+  EXPECT_EQ(MakeValue(1, 1), reader.entries[1]);
+  EXPECT_EQ(MakeValue(2, 0), reader.entries[2]);
+}
+
+TEST_F(LinearDiskCacheTest, DropsTornAppend)
+{
+  {
+    LinearDiskCache<u32, u8> cache;
+    MapReader reader;
+    cache.OpenAndRead(m_path, reader);
+    Append(cache, 1, 0);
+    Append(cache, 2, 3);
+  }
+
+  // Simulate a crash in the middle of the last append.
+  {
+    File::IOFile file(m_path, "r+b");
+    ASSERT_TRUE(file.Resize(file.GetSize() - 2));
+  }
+
+  {
+    LinearDiskCache<u32, u8> cache;
+    MapReader reader;
+    EXPECT_EQ(1u, cache.OpenAndRead(m_path, reader));
+    EXPECT_EQ(MakeValue(1, 0), reader.entries[1]);
+    Append(cache, 3, 0);
+  }
+
+  LinearDiskCache<u32, u8> cache;
+  MapReader reader;
+  EXPECT_EQ(2u, cache.OpenAndRead(m_path, reader));
+  EXPECT_EQ(MakeValue(1, 0), reader.entries[1]);
+  EXPECT_EQ(MakeValue(3, 0), reader.entries[3]);
+}
+
+TEST_F(LinearDiskCacheTest, DropsCorruptedValue)
+{
+  {
+    LinearDiskCache<u32, u8> cache;
+    MapReader reader;
+    cache.OpenAndRead(m_path, reader);
+    Append(cache, 1, 0);
+    Append(cache, 2, 3);
+  }
+
+  // Flip a bit in the middle of the last value, which leaves its size and key intact.
+  {
+    File::IOFile file(m_path, "r+b");
+    const u64 offset = file.GetSize() - sizeof(u32) - MakeValue(2, 3).size() / 2;
+    u8 byte;
+    ASSERT_TRUE(file.Seek(offset, SEEK_SET) && file.ReadBytes(&byte, 1));
+    byte ^= 0x10;
+    ASSERT_TRUE(file.Seek(offset, SEEK_SET) && file.WriteBytes(&byte, 1));
+  }
+
+  LinearDiskCache<u32, u8> cache;
+  MapReader reader;
+  EXPECT_EQ(1u, cache.OpenAndRead(m_path, reader));
+  EXPECT_EQ(MakeValue(1, 0), reader.entries[1]);
+  EXPECT_EQ(0u, reader.entries.count(2));
+}
+
+TEST_F(LinearDiskCacheTest, KeepsEntriesAfterCorruptedValue)
+{
+  {
+    LinearDiskCache<u32, u8> cache;
+    MapReader reader;
+    cache.OpenAndRead(m_path, reader);
+    Append(cache, 1, 3);
+    Append(cache, 2, 0);
+  }
+
+  // Only the value checksum covers the value, so the entries after it can still be found.
+  {
+    File::IOFile file(m_path, "r+b");
+    const u64 second_entry_size = 4 * sizeof(u32) + MakeValue(2, 0).size();
+    const u64 offset = file.GetSize() - second_entry_size - sizeof(u32) - 1;
+    u8 byte;
+    ASSERT_TRUE(file.Seek(offset, SEEK_SET) && file.ReadBytes(&byte, 1));
+    byte ^= 0x10;
+    ASSERT_TRUE(file.Seek(offset, SEEK_SET) && file.WriteBytes(&byte, 1));
+  }
+
+  LinearDiskCache<u32, u8> cache;
+  MapReader reader;
+  EXPECT_EQ(1u, cache.OpenAndRead(m_path, reader));
+  EXPECT_EQ(0u, reader.entries.count(1));
+  EXPECT_EQ(MakeValue(2, 0), reader.entries[2]);
+}
+
+TEST_F(LinearDiskCacheTest, CompactsStaleEntries)
+{
+  {
+    LinearDiskCache<u32, u8> cache;
+    MapReader reader;
+    cache.OpenAndRead(m_path, reader);
+    for (u32 generation = 0; generation < 40; ++generation)
+    {
+      for (u32 key = 0; key < 10; ++key)
+        Append(cache, key, generation);
+    }
+  }
+  const u64 size_before = File::GetSize(m_path);
+
+  {
+    LinearDiskCache<u32, u8> cache;
+    MapReader reader;
+    EXPECT_EQ(10u, cache.OpenAndRead(m_path, reader));
+    // Entries appended while compacting must survive.
+    Append(cache, 10, 0);
+  }
+  EXPECT_LT(File::GetSize(m_path), size_before / 10);
+  EXPECT_FALSE(File::Exists(m_path + ".compact"));
+
+  LinearDiskCache<u32, u8> cache;
+  MapReader reader;
+  EXPECT_EQ(11u, cache.OpenAndRead(m_path, reader));
+  for (u32 key = 0; key < 10; ++key)
+    EXPECT_EQ(MakeValue(key, 39), reader.entries[key]);
+  EXPECT_EQ(MakeValue(10, 0), reader.entries[10]);
+}
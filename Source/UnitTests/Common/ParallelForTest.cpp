@@ -0,0 +1,47 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/ParallelFor.h"
+
+TEST(ParallelFor, CallsEveryIndexOnce)
+{
+  for (size_t count : {0, 1, 2, 1000})
+  {
+    std::vector<std::atomic<int>> calls(count);
+    Common::ParallelFor(count, [&calls](size_t i) { ++calls[i]; });
+    for (const std::atomic<int>& call : calls)
+      EXPECT_EQ(call.load(), 1);
+  }
+}
+
+TEST(ParallelFor, ConcurrentCallers)
+{
+  constexpr size_t NUM_CALLERS = 4;
+  constexpr size_t COUNT = 500;
+
+  std::vector<std::vector<std::atomic<int>>> calls(NUM_CALLERS);
+  std::vector<std::thread> callers;
+  for (size_t caller = 0; caller < NUM_CALLERS; ++caller)
+  {
+    calls[caller] = std::vector<std::atomic<int>>(COUNT);
+    callers.emplace_back([&calls, caller] {
+      Common::ParallelFor(COUNT, [&calls, caller](size_t i) { ++calls[caller][i]; });
+    });
+  }
+  for (std::thread& thread : callers)
+    thread.join();
+
+  for (const std::vector<std::atomic<int>>& caller_calls : calls)
+  {
+    for (const std::atomic<int>& call : caller_calls)
+      EXPECT_EQ(call.load(), 1);
+  }
+}
@@ -0,0 +1,76 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <atomic>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/SeqLock.h"
+
+namespace
+{
+// Odd sized, so that the last word is only partially used
+struct Snapshot
+{
+  u64 sequence;
+  std::array<u32, 9> values;
+};
+}  // namespace
+
+TEST(SeqLock, Simple)
+{
+  Common::SeqLock<Snapshot> lock;
+  EXPECT_EQ(lock.Load().sequence, 0u);
+
+  Snapshot snapshot{};
+  snapshot.sequence = 7;
+  snapshot.values[8] = 42;
+  lock.Store(snapshot);
+
+  const Snapshot loaded = lock.Load();
+  EXPECT_EQ(loaded.sequence, 7u);
+  EXPECT_EQ(loaded.values[8], 42u);
+}
+
+TEST(SeqLock, ReadersNeverSeeTornValues)
+{
+  constexpr u64 WRITE_COUNT = 200000;
+  Common::SeqLock<Snapshot> lock;
+  std::atomic<bool> done{false};
+
+  std::thread writer([&] {
+    Snapshot snapshot{};
+    for (u64 i = 1; i <= WRITE_COUNT; ++i)
+    {
+      snapshot.sequence = i;
+      snapshot.values.fill(static_cast<u32>(i));
+      lock.Store(snapshot);
+    }
+    done.store(true);
+  });
+
+  u64 last_sequence = 0;
+  u32 torn_reads = 0;
+  u32 reordered_reads = 0;
+  while (!done.load())
+  {
+    const Snapshot snapshot = lock.Load();
+    for (u32 value : snapshot.values)
+    {
+      if (value != static_cast<u32>(snapshot.sequence))
+        ++torn_reads;
+    }
+    if (snapshot.sequence < last_sequence)
+      ++reordered_reads;
+    last_sequence = snapshot.sequence;
+  }
+  writer.join();
+
+  EXPECT_EQ(torn_reads, 0u);
+  EXPECT_EQ(reordered_reads, 0u);
+  EXPECT_EQ(lock.Load().sequence, WRITE_COUNT);
+}
@@ -0,0 +1,161 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/HW/DSPHLE/UCodes/AXMixer.h"
+
+using namespace DSP::HLE;
+
+namespace
+{
+// Per-sample reference implementations, as used by AX before the block kernels.
+s16 ReferenceScale(s16 sample, u16 volume)
+{
+  s64 scaled = sample;
+  scaled *= volume;
+  scaled >>= 15;
+  return static_cast<s16>(std::clamp(static_cast<s32>(scaled), -32767, 32767));
+}
+
+u32 ReferenceResample(const s16* input, s16* output, u32 count, u32 curr_pos, u32 ratio)
+{
+  s16 temp[4];
+  u32 idx = 0;
+  u32 read_samples_count = 0;
+
+  for (u32 i = 0; i < 4; ++i)
+    temp[idx++ & 3] = input[read_samples_count++];
+
+  for (u32 i = 0; i < count; ++i)
+  {
+    curr_pos += ratio;
+    while (curr_pos >= 0x10000)
+    {
+      temp[idx++ & 3] = input[read_samples_count++];
+      curr_pos -= 0x10000;
+    }
+
+    u16 curr_frac = curr_pos & 0xFFFF;
+    u16 inv_curr_frac = -curr_frac;
+
+    if (curr_frac)
+    {
+      s32 s0 = temp[idx++ & 3];
+      s32 s1 = temp[idx++ & 3];
+      output[i] = ((s0 * inv_curr_frac) + (s1 * curr_frac)) >> 16;
+      idx += 2;
+    }
+    else
+    {
+      output[i] = temp[idx++ & 3];
+      idx += 3;
+    }
+  }
+
+  return curr_pos;
+}
+
+template <size_t N>
+std::array<s16, N> RandomSamples(std::mt19937& rng)
+{
+  std::uniform_int_distribution<int> dist(-32768, 32767);
+  std::array<s16, N> samples;
+  for (s16& sample : samples)
+    sample = static_cast<s16>(dist(rng));
+  // Make sure the extremes are covered.
+  samples[0] = -32768;
+  samples[1] = 32767;
+  return samples;
+}
+}  // namespace
+
+TEST(AXMixer, ApplyVolumeMatchesReference)
+{
+  std::mt19937 rng(1234);
+  const std::array<u16, 5> volumes{{0, 0x7FFF, 0x8000, 0xFFFF, 0x1234}};
+  const std::array<u16, 4> deltas{{0, 1, 0xFFFF, 0x0800}};
+
+  for (u32 count : {32u, 96u, 13u})
+  {
+    for (u16 start_volume : volumes)
+    {
+      for (u16 delta : deltas)
+      {
+        const auto input = RandomSamples<96>(rng);
+        auto samples = input;
+        u16 volume = start_volume;
+        AXMixer::ApplyVolume(samples.data(), count, volume, delta);
+
+        u16 expected_volume = start_volume;
+        for (u32 i = 0; i < count; ++i)
+        {
+          EXPECT_EQ(ReferenceScale(input[i], expected_volume), samples[i]);
+          expected_volume += delta;
+        }
+        EXPECT_EQ(expected_volume, volume);
+      }
+    }
+  }
+}
+
+TEST(AXMixer, MixAddMatchesReference)
+{
+  std::mt19937 rng(5678);
+  for (u32 count : {32u, 96u, 18u, 6u})
+  {
+    const auto input = RandomSamples<96>(rng);
+    std::array<int, 96> out;
+    std::array<int, 96> expected_out;
+    for (u32 i = 0; i < out.size(); ++i)
+      out[i] = expected_out[i] = static_cast<int>(i * 1000) - 48000;
+
+    u16 volume = 0xF000;
+    const s16 last = AXMixer::MixAdd(out.data(), input.data(), count, volume, 0x0123);
+
+    u16 expected_volume = 0xF000;
+    s16 expected_last = 0;
+    for (u32 i = 0; i < count; ++i)
+    {
+      expected_last = ReferenceScale(input[i], expected_volume);
+      expected_out[i] += expected_last;
+      expected_volume += 0x0123;
+    }
+
+    EXPECT_EQ(expected_out, out);
+    EXPECT_EQ(expected_volume, volume);
+    EXPECT_EQ(expected_last, last);
+  }
+}
+
+TEST(AXMixer, ResampleLinearMatchesReference)
+{
+  std::mt19937 rng(91011);
+  const std::array<u32, 7> ratios{{0x10000, 0x8000, 0x1234, 0x18000, 0x2ABCD, 0x55555, 0x3FFFF}};
+
+  for (u32 ratio : ratios)
+  {
+    for (u32 start_pos : {0u, 0x4000u, 0xFFFFu})
+    {
+      const u32 count = 96;
+      const u32 needed = AXMixer::GetRequiredInputSamples(count, start_pos, ratio);
+      ASSERT_LE(needed + 4, 4 + 96 * 6u);
+
+      const auto input = RandomSamples<4 + 96 * 6>(rng);
+      std::array<s16, 96> output;
+      std::array<s16, 96> expected;
+      const u32 pos = AXMixer::ResampleLinear(input.data(), output.data(), count, start_pos, ratio);
+      const u32 expected_pos =
+          ReferenceResample(input.data(), expected.data(), count, start_pos, ratio);
+
+      EXPECT_EQ(expected, output);
+      EXPECT_EQ(expected_pos, pos);
+    }
+  }
+}
@@ -0,0 +1,103 @@
+// Copyright 2019 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/DSP/DSPAnalyzer.h"
+#include "Core/DSP/DSPCore.h"
+#include "Core/DSP/DSPTables.h"
+
+class DSPAnalyzerTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    DSP::InitInstructionTable();
+    m_iram.fill(0);
+    m_irom.fill(0);
+    DSP::g_dsp.iram = m_iram.data();
+    DSP::g_dsp.irom = m_irom.data();
+  }
+
+  void TearDown() override
+  {
+    DSP::g_dsp.iram = nullptr;
+    DSP::g_dsp.irom = nullptr;
+  }
+
+  void LoadCode(u16 address, const std::vector<u16>& code)
+  {
+    std::copy(code.begin(), code.end(), m_iram.begin() + address);
+    DSP::Analyzer::Analyze();
+  }
+
+  bool IsIdleSkip(u16 address) const
+  {
+    return (DSP::Analyzer::GetCodeFlags(address) & DSP::Analyzer::CODE_IDLE_SKIP) != 0;
+  }
+
+private:
+  std::array<u16, DSP::DSP_IRAM_SIZE> m_iram;
+  std::array<u16, DSP::DSP_IROM_SIZE> m_irom;
+};
+
+TEST_F(DSPAnalyzerTest, MailboxPollingLoop)
+{
+  LoadCode(0x0010, {
+                       0x00de, 0xfffc,  // LR    $AC0.M, @DMBH
+                       0x02a0, 0x8000,  // ANDF  $AC0.M, #0x8000
+                       0x029c, 0x0010,  // JLNZ  0x0010
+                   });
+  EXPECT_TRUE(IsIdleSkip(0x0010));
+}
+
+TEST_F(DSPAnalyzerTest, MailboxLowReadIsNotIdle)
+{
+  // Reading the low half acknowledges the mail, so this is not a pure poll.
+  LoadCode(0x0010, {
+                       0x00de, 0xfffd,  // LR    $AC0.M, @DMBL
+                       0x02a0, 0x8000,  // ANDF  $AC0.M, #0x8000
+                       0x029c, 0x0010,  // JLNZ  0x0010
+                   });
+  EXPECT_FALSE(IsIdleSkip(0x0010));
+}
+
+TEST_F(DSPAnalyzerTest, LoopWithSideEffectsIsNotIdle)
+{
+  LoadCode(0x0010, {
+                       0x00de, 0xfffc,  // LR    $AC0.M, @DMBH
+                       0x7600,          // INC   $AC0
+                       0x02a0, 0x8000,  // ANDF  $AC0.M, #0x8000
+                       0x029c, 0x0010,  // JLNZ  0x0010
+                   });
+  EXPECT_FALSE(IsIdleSkip(0x0010));
+}
+
+TEST_F(DSPAnalyzerTest, AcceleratorReadAfterPollIsNotIdle)
+{
+  // Reading the accelerator advances its stream, even after a mailbox poll.
+  LoadCode(0x0010, {
+                       0x00de, 0xfffc,  // LR    $AC0.M, @DMBH
+                       0x00df, 0xffdd,  // LR    $AC1.M, @ACDAT
+                       0x02a0, 0x8000,  // ANDF  $AC0.M, #0x8000
+                       0x029c, 0x0010,  // JLNZ  0x0010
+                   });
+  EXPECT_FALSE(IsIdleSkip(0x0010));
+}
+
+TEST_F(DSPAnalyzerTest, ShortAcceleratorReadAfterPollIsNotIdle)
+{
+  LoadCode(0x0010, {
+                       0x00de, 0xfffc,  // LR    $AC0.M, @DMBH
+                       0x27dd,          // LRS   $AC1.M, @ACDAT
+                       0x02a0, 0x8000,  // ANDF  $AC0.M, #0x8000
+                       0x029c, 0x0010,  // JLNZ  0x0010
+                   });
+  EXPECT_FALSE(IsIdleSkip(0x0010));
+}
@@ -0,0 +1,155 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/HW/DVD/DVDReadCache.h"
+#include "DiscIO/Volume.h"
+
+using DVDThread::ReadCache;
+
+namespace
+{
+constexpr u64 BLOCK_SIZE = ReadCache::BLOCK_SIZE;
+constexpr u64 DISC_SIZE = 64 * BLOCK_SIZE + 100;
+
+u8 GetDiscByte(u64 offset, const DiscIO::Partition& partition)
+{
+  return static_cast<u8>(offset * 7 + offset / 251 + partition.offset);
+}
+}  // namespace
+
+class DVDReadCacheTest : public testing::Test
+{
+protected:
+  DVDReadCacheTest()
+      : m_cache([this](u64 offset, u64 length, u8* buffer, const DiscIO::Partition& partition) {
+          m_disc_reads.emplace_back(offset, length);
+          if (offset > DISC_SIZE || length > DISC_SIZE - offset)
+            return false;
+          for (u64 i = 0; i < length; ++i)
+            buffer[i] = GetDiscByte(offset + i, partition);
+          return true;
+        })
+  {
+    m_cache.SetCapacity(16 * BLOCK_SIZE);
+  }
+
+  void ExpectRead(u64 offset, u64 length, const DiscIO::Partition& partition = {})
+  {
+    std::vector<u8> buffer(length);
+    ASSERT_TRUE(m_cache.Read(offset, length, buffer.data(), partition));
+    for (u64 i = 0; i < length; ++i)
+      ASSERT_EQ(GetDiscByte(offset + i, partition), buffer[i]) << "at offset " << offset + i;
+  }
+
+  ReadCache m_cache;
+  std::vector<std::pair<u64, u64>> m_disc_reads;
+};
+
+TEST_F(DVDReadCacheTest, CachesReads)
+{
+  ExpectRead(100, 3 * BLOCK_SIZE);
+  ASSERT_EQ(1u, m_disc_reads.size());
+  EXPECT_EQ(0u, m_disc_reads[0].first);
+  EXPECT_EQ(4 * BLOCK_SIZE, m_disc_reads[0].second);
+
+  ExpectRead(BLOCK_SIZE + 5, 1000);
+  ExpectRead(0, 4 * BLOCK_SIZE);
+  EXPECT_EQ(1u, m_disc_reads.size());
+
+  // Partitions are cached separately.
+  ExpectRead(100, 1000, DiscIO::Partition(0x50000));
+  EXPECT_EQ(2u, m_disc_reads.size());
+}
+
+TEST_F(DVDReadCacheTest, FetchReadsMissingBlocksInOneGo)
+{
+  ExpectRead(2 * BLOCK_SIZE, 10);
+  m_disc_reads.clear();
+
+  m_cache.Fetch(0, 6 * BLOCK_SIZE, {});
+  ASSERT_EQ(2u, m_disc_reads.size());
+  EXPECT_EQ(std::make_pair(u64(0), 2 * BLOCK_SIZE), m_disc_reads[0]);
+  EXPECT_EQ(std::make_pair(3 * BLOCK_SIZE, 3 * BLOCK_SIZE), m_disc_reads[1]);
+
+  ExpectRead(1000, 5 * BLOCK_SIZE);
+  EXPECT_EQ(2u, m_disc_reads.size());
+}
+
+TEST_F(DVDReadCacheTest, EvictsLeastRecentlyUsedBlocks)
+{
+  for (u64 block = 0; block < 16; ++block)
+    ExpectRead(block * BLOCK_SIZE, 1);
+  ExpectRead(0, 1);
+  ExpectRead(16 * BLOCK_SIZE, 1);
+  m_disc_reads.clear();
+
+  ExpectRead(0, 1);
+  EXPECT_TRUE(m_disc_reads.empty());
+  ExpectRead(BLOCK_SIZE, 1);
+  EXPECT_EQ(1u, m_disc_reads.size());
+}
+
+TEST_F(DVDReadCacheTest, ReadsAheadOfSequentialReads)
+{
+  ExpectRead(0, 0x800);
+  EXPECT_FALSE(m_cache.ReadAhead());
+  ExpectRead(0x800, 0x800);
+  ExpectRead(0x1000, 0x800);
+
+  u64 prefetched = 0;
+  m_disc_reads.clear();
+  while (m_cache.ReadAhead())
+  {
+    ASSERT_FALSE(m_disc_reads.empty());
+    prefetched += m_disc_reads.back().second;
+  }
+  EXPECT_GT(prefetched, 0u);
+  EXPECT_LE(prefetched, 4 * BLOCK_SIZE);
+
+  m_disc_reads.clear();
+  ExpectRead(0x1800, prefetched);
+  EXPECT_TRUE(m_disc_reads.empty());
+
+  // A seek stops reading ahead.
+  ExpectRead(40 * BLOCK_SIZE, 0x800);
+  EXPECT_FALSE(m_cache.ReadAhead());
+}
+
+TEST_F(DVDReadCacheTest, HandlesEndOfDisc)
+{
+  ExpectRead(DISC_SIZE - 200, 200);
+  ExpectRead(DISC_SIZE - 200, 200);
+
+  std::vector<u8> buffer(200);
+  EXPECT_FALSE(m_cache.Read(DISC_SIZE - 100, buffer.size(), buffer.data(), {}));
+
+  // Reading ahead stops at the end of the disc.
+  ExpectRead(60 * BLOCK_SIZE, BLOCK_SIZE);
+  ExpectRead(61 * BLOCK_SIZE, BLOCK_SIZE);
+  ExpectRead(62 * BLOCK_SIZE, BLOCK_SIZE);
+  while (m_cache.ReadAhead())
+  {
+  }
+  ExpectRead(63 * BLOCK_SIZE, BLOCK_SIZE);
+}
+
+TEST_F(DVDReadCacheTest, ZeroCapacityDisablesCache)
+{
+  m_cache.SetCapacity(0);
+  ExpectRead(100, 1000);
+  ExpectRead(100, 1000);
+  ExpectRead(1100, 1000);
+  ExpectRead(2100, 1000);
+  EXPECT_FALSE(m_cache.ReadAhead());
+  ASSERT_EQ(4u, m_disc_reads.size());
+  EXPECT_EQ(std::make_pair(u64(100), u64(1000)), m_disc_reads[0]);
+}
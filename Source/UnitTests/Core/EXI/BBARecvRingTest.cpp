@@ -0,0 +1,251 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/EXI/BBA-TAP/RecvRing.h"
+#include "Core/HW/EXI/EXI_DeviceEthernet.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "UICommon/UICommon.h"
+
+using ExpansionInterface::BBA_RECV_RING_FRAMES;
+using ExpansionInterface::BBARecvRing;
+
+namespace
+{
+bool WriteFrame(BBARecvRing& ring, u32 sequence)
+{
+  u8* const buffer = ring.BeginWrite();
+  if (!buffer)
+    return false;
+
+  std::memcpy(buffer, &sequence, sizeof(sequence));
+  ring.EndWrite(sizeof(sequence) + sequence % 64);
+  return true;
+}
+
+u32 ReadFrame(BBARecvRing& ring)
+{
+  const BBARecvRing::Frame* const frame = ring.Front();
+  EXPECT_NE(frame, nullptr);
+  if (!frame)
+    return 0;
+
+  u32 sequence;
+  std::memcpy(&sequence, frame->data.data(), sizeof(sequence));
+  EXPECT_EQ(frame->length, sizeof(sequence) + sequence % 64);
+  ring.Pop();
+  return sequence;
+}
+}  // namespace
+
+TEST(BBARecvRing, FramesComeOutInOrder)
+{
+  auto ring = std::make_unique<BBARecvRing>();
+  EXPECT_EQ(ring->Front(), nullptr);
+
+  // Go around the ring a few times
+  u32 written = 0;
+  u32 read = 0;
+  for (int i = 0; i < 10; ++i)
+  {
+    for (u32 j = 0; j < BBA_RECV_RING_FRAMES / 2 + 3; ++j)
+      EXPECT_TRUE(WriteFrame(*ring, written++));
+    while (ring->Front())
+      EXPECT_EQ(ReadFrame(*ring), read++);
+  }
+
+  EXPECT_EQ(read, written);
+  EXPECT_EQ(ring->GetStats().frames, read);
+  EXPECT_EQ(ring->GetStats().dropped, 0u);
+}
+
+TEST(BBARecvRing, FullRingDropsFrames)
+{
+  auto ring = std::make_unique<BBARecvRing>();
+  for (u32 i = 0; i < BBA_RECV_RING_FRAMES; ++i)
+    EXPECT_TRUE(WriteFrame(*ring, i));
+
+  EXPECT_FALSE(WriteFrame(*ring, BBA_RECV_RING_FRAMES));
+  ring->Drop();
+  EXPECT_EQ(ring->GetStats().dropped, 1u);
+
+  EXPECT_EQ(ReadFrame(*ring), 0u);
+  EXPECT_TRUE(WriteFrame(*ring, BBA_RECV_RING_FRAMES));
+  for (u32 i = 1; i <= BBA_RECV_RING_FRAMES; ++i)
+    EXPECT_EQ(ReadFrame(*ring), i);
+  EXPECT_EQ(ring->Front(), nullptr);
+}
+
+// Stands in for the TAP device, so the ring can be exercised without a network interface
+TEST(BBARecvRing, ReadThreadStandIn)
+{
+  constexpr u32 FRAME_COUNT = 200000;
+  auto ring = std::make_unique<BBARecvRing>();
+
+  std::thread read_thread([&ring] {
+    for (u32 i = 0; i < FRAME_COUNT; ++i)
+    {
+      while (!WriteFrame(*ring, i))
+        std::this_thread::yield();
+    }
+  });
+
+  for (u32 i = 0; i < FRAME_COUNT; ++i)
+  {
+    while (!ring->Front())
+      std::this_thread::yield();
+    EXPECT_EQ(ReadFrame(*ring), i);
+  }
+  read_thread.join();
+
+  const ExpansionInterface::BBARecvStats stats = ring->GetStats();
+  EXPECT_EQ(stats.frames, FRAME_COUNT);
+  EXPECT_EQ(stats.dropped, 0u);
+  EXPECT_LE(stats.total_latency_us / stats.frames, stats.max_latency_us);
+}
+
+namespace ExpansionInterface
+{
+// Hands frames to the BBA the way the read thread does, and checks what ends up in the receive
+// buffer that the game reads from.
+class BBARecvTest : public testing::Test
+{
+protected:
+  static constexpr u32 FRAME_LENGTH = 300;  // Takes up two pages along with its descriptor
+
+  BBARecvTest() : m_profile_path(File::CreateTempDir())
+  {
+    Core::DeclareAsCPUThread();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    SConfig::Init();
+    SConfig::GetInstance().m_bba_mac = "00:09:bf:01:02:03";
+    PowerPC::Init(PowerPC::CPUCore::Interpreter);
+    CoreTiming::Init();
+    CEXIETHERNET::Init();
+
+    // Receive into pages 1 to 15, accepting frames for any address
+    m_bba = std::make_unique<CEXIETHERNET>();
+    SetPagePointer(BBA_BP, 1);
+    SetPagePointer(BBA_RHBP, BBA_NUM_PAGES);
+    SetPagePointer(BBA_RRP, 1);
+    SetPagePointer(BBA_RWP, 1);
+    m_bba->mBbaMem[BBA_NCRB] = NCRB_PR;
+    m_bba->readEnabled.Set();
+  }
+
+  ~BBARecvTest() override
+  {
+    m_bba.reset();
+    CEXIETHERNET::Shutdown();
+    CoreTiming::Shutdown();
+    PowerPC::Shutdown();
+    SConfig::Shutdown();
+    Config::Shutdown();
+    Core::UndeclareAsCPUThread();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+  void SetPagePointer(int index, u16 page)
+  {
+    m_bba->mBbaMem[index] = static_cast<u8>(page);
+    m_bba->mBbaMem[index + 1] = static_cast<u8>(page >> 8);
+  }
+
+  u16 GetPagePointer(int index) const { return m_bba->page_ptr(index); }
+
+  void QueueFrame(u8 seed)
+  {
+    u8* const buffer = m_bba->mRecvRing.BeginWrite();
+    ASSERT_NE(buffer, nullptr);
+    for (u32 i = 0; i < FRAME_LENGTH; ++i)
+      buffer[i] = static_cast<u8>(seed + i);
+    m_bba->mRecvRing.EndWrite(FRAME_LENGTH);
+  }
+
+  void StopReceive() { m_bba->readEnabled.Clear(); }
+  void RecvFrames() { m_bba->RecvFrames(); }
+  bool HasQueuedFrames() const { return m_bba->mRecvRing.Front() != nullptr; }
+
+  // Checks the descriptor and the data of the frame that starts at page. The data wraps around
+  // to the start of the receive buffer.
+  void ExpectFrame(u16 page, u8 seed, u16 next_page) const
+  {
+    u32 descriptor;
+    std::memcpy(&descriptor, &m_bba->mBbaMem[page * BBA_PAGE_SIZE], sizeof(descriptor));
+    EXPECT_EQ(descriptor & 0xfff, next_page);
+    EXPECT_EQ((descriptor >> 12) & 0xfff, FRAME_LENGTH + 4);
+
+    const u32 begin = GetPagePointer(BBA_BP) * BBA_PAGE_SIZE;
+    const u32 end = GetPagePointer(BBA_RHBP) * BBA_PAGE_SIZE;
+    u32 offset = page * BBA_PAGE_SIZE + 4;
+    for (u32 i = 0; i < FRAME_LENGTH; ++i, ++offset)
+    {
+      if (offset == end)
+        offset = begin;
+      ASSERT_EQ(m_bba->mBbaMem[offset], static_cast<u8>(seed + i)) << "at byte " << i;
+    }
+  }
+
+private:
+  std::string m_profile_path;
+  std::unique_ptr<CEXIETHERNET> m_bba;
+};
+
+TEST_F(BBARecvTest, QueuedFramesAreDrained)
+{
+  for (u8 i = 0; i < 3; ++i)
+    QueueFrame(i);
+  RecvFrames();
+
+  EXPECT_FALSE(HasQueuedFrames());
+  EXPECT_EQ(GetPagePointer(BBA_RWP), 7);
+  ExpectFrame(1, 0, 3);
+  ExpectFrame(3, 1, 5);
+  ExpectFrame(5, 2, 7);
+}
+
+TEST_F(BBARecvTest, FullBufferKeepsFramesUntilThereIsRoom)
+{
+  // Seven frames fill 14 of the 15 pages, which leaves no room for the eighth.
+  for (u8 i = 0; i < 8; ++i)
+    QueueFrame(i);
+  RecvFrames();
+
+  EXPECT_TRUE(HasQueuedFrames());
+  EXPECT_EQ(GetPagePointer(BBA_RWP), 15);
+  for (u8 i = 0; i < 7; ++i)
+    ExpectFrame(1 + i * 2, i, 3 + i * 2);
+
+  // The game has read the first two frames, so the last one can wrap around into their pages.
+  SetPagePointer(BBA_RRP, 5);
+  RecvFrames();
+
+  EXPECT_FALSE(HasQueuedFrames());
+  EXPECT_EQ(GetPagePointer(BBA_RWP), 2);
+  ExpectFrame(15, 7, 2);
+}
+
+TEST_F(BBARecvTest, FramesAreDiscardedWhileReceiveIsStopped)
+{
+  StopReceive();
+  QueueFrame(0);
+  RecvFrames();
+
+  EXPECT_FALSE(HasQueuedFrames());
+  EXPECT_EQ(GetPagePointer(BBA_RWP), 1);
+}
+}  // namespace ExpansionInterface
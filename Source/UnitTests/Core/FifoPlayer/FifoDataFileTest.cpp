@@ -0,0 +1,149 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Core/FifoPlayer/FifoDataFile.h"
+
+class FifoDataFileTest : public testing::Test
+{
+protected:
+  FifoDataFileTest() : m_temp_dir{File::CreateTempDir()} {}
+  ~FifoDataFileTest() override { File::DeleteDirRecursively(m_temp_dir); }
+
+  std::string GetPath(const std::string& name) const { return m_temp_dir + "/" + name; }
+
+  static FifoFrameInfo MakeFrame(u32 index, const std::vector<u8>& texture)
+  {
+    FifoFrameInfo frame;
+    frame.fifoStart = 0x00200000;
+    frame.fifoEnd = 0x00300000 + index;
+    frame.fifoData.resize(0x1000 + index);
+    std::iota(frame.fifoData.begin(), frame.fifoData.end(), static_cast<u8>(index));
+
+    MemoryUpdate update;
+    update.fifoPosition = 0x10;
+    update.address = 0x00400000;
+    update.data = texture;
+    update.type = MemoryUpdate::TEXTURE_MAP;
+    frame.memoryUpdates.push_back(update);
+
+    update.fifoPosition = 0x20;
+    update.address = 0x10000000 + index;
+    update.data = std::vector<u8>(16, static_cast<u8>(index));
+    update.type = MemoryUpdate::VERTEX_STREAM;
+    frame.memoryUpdates.push_back(update);
+
+    return frame;
+  }
+
+private:
+  std::string m_temp_dir;
+};
+
+TEST_F(FifoDataFileTest, SaveAndLoad)
+{
+  std::vector<u8> texture(0x10000);
+  std::iota(texture.begin(), texture.end(), u8(0));
+
+  FifoDataFile file;
+  file.SetIsWii(true);
+  file.GetBPMem()[0x10] = 0x12345678;
+  file.GetTexMem()[FifoDataFile::TEX_MEM_SIZE - 1] = 0xab;
+  for (u32 i = 0; i < 8; ++i)
+    file.AddFrame(MakeFrame(i, texture));
+
+  const std::string path = GetPath("test.dff");
+  ASSERT_TRUE(file.Save(path));
+
+  const std::unique_ptr<FifoDataFile> loaded = FifoDataFile::Load(path, false);
+  ASSERT_NE(loaded, nullptr);
+  EXPECT_TRUE(loaded->GetIsWii());
+  EXPECT_EQ(loaded->GetBPMem()[0x10], 0x12345678u);
+  EXPECT_EQ(loaded->GetTexMem()[FifoDataFile::TEX_MEM_SIZE - 1], 0xab);
+  EXPECT_EQ(loaded->GetFifoDataSize(), file.GetFifoDataSize());
+  EXPECT_EQ(loaded->GetMemoryUpdatesSize(), file.GetMemoryUpdatesSize());
+  ASSERT_EQ(loaded->GetFrameCount(), 8u);
+
+  // Read the frames out of order, so that they don't all come from the frame cache
+  for (u32 i : {5u, 0u, 7u, 1u, 6u, 2u, 4u, 3u, 0u})
+  {
+    const auto expected = file.GetFrame(i);
+    const auto frame = loaded->GetFrame(i);
+    EXPECT_EQ(frame->fifoStart, expected->fifoStart);
+    EXPECT_EQ(frame->fifoEnd, expected->fifoEnd);
+    EXPECT_EQ(frame->fifoData, expected->fifoData);
+    ASSERT_EQ(frame->memoryUpdates.size(), expected->memoryUpdates.size());
+    for (size_t j = 0; j < frame->memoryUpdates.size(); ++j)
+    {
+      EXPECT_EQ(frame->memoryUpdates[j].fifoPosition, expected->memoryUpdates[j].fifoPosition);
+      EXPECT_EQ(frame->memoryUpdates[j].address, expected->memoryUpdates[j].address);
+      EXPECT_EQ(frame->memoryUpdates[j].type, expected->memoryUpdates[j].type);
+      EXPECT_EQ(frame->memoryUpdates[j].data, expected->memoryUpdates[j].data);
+    }
+  }
+}
+
+TEST_F(FifoDataFileTest, RepeatedMemoryIsStoredOnce)
+{
+  // Random data doesn't compress, so the size of the file shows how often it was stored
+  std::vector<u8> texture(0x40000);
+  u32 state = 1;
+  for (u8& byte : texture)
+  {
+    state = state * 1103515245 + 12345;
+    byte = static_cast<u8>(state >> 16);
+  }
+
+  const std::string path = GetPath("writer.dff");
+  FifoDataFileWriter writer(path);
+  ASSERT_TRUE(writer.IsOpen());
+  for (u32 i = 0; i < 16; ++i)
+    writer.AddFrame(MakeFrame(i, texture));
+  ASSERT_TRUE(writer.Finish(FifoDataFile{}));
+
+  EXPECT_LT(File::GetSize(path), FifoDataFile::TEX_MEM_SIZE + 2 * texture.size());
+
+  const std::unique_ptr<FifoDataFile> loaded = FifoDataFile::Load(path, false);
+  ASSERT_NE(loaded, nullptr);
+  ASSERT_EQ(loaded->GetFrameCount(), 16u);
+  EXPECT_EQ(loaded->GetMemoryUpdatesSize(), 16 * (texture.size() + 16));
+  EXPECT_EQ(loaded->GetFrame(15)->memoryUpdates[0].data, texture);
+}
+
+TEST_F(FifoDataFileTest, SaveStreamedFileOverItself)
+{
+  std::vector<u8> texture(0x10000);
+  std::iota(texture.begin(), texture.end(), u8(0));
+
+  FifoDataFile file;
+  for (u32 i = 0; i < 4; ++i)
+    file.AddFrame(MakeFrame(i, texture));
+
+  const std::string path = GetPath("streamed.dff");
+  ASSERT_TRUE(file.Save(path));
+
+  // The loaded file reads its frames from the file that it replaces
+  const std::unique_ptr<FifoDataFile> streamed = FifoDataFile::Load(path, false);
+  ASSERT_NE(streamed, nullptr);
+  ASSERT_TRUE(streamed->Save(path));
+  EXPECT_FALSE(File::Exists(path + ".tmp"));
+
+  const std::unique_ptr<FifoDataFile> loaded = FifoDataFile::Load(path, false);
+  ASSERT_NE(loaded, nullptr);
+  ASSERT_EQ(loaded->GetFrameCount(), 4u);
+  for (u32 i = 0; i < 4; ++i)
+  {
+    EXPECT_EQ(loaded->GetFrame(i)->fifoData, file.GetFrame(i)->fifoData);
+    EXPECT_EQ(loaded->GetFrame(i)->memoryUpdates[0].data, texture);
+  }
+}
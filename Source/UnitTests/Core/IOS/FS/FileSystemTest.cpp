@@ -452,3 +452,95 @@ TEST_F(FileSystemTest, CreateFullPath)
   EXPECT_EQ(m_fs->CreateFullPath(Uid{0x1000}, Gid{1}, "/shared2/wc24/mbox/Readme.txt", 0, modes),
             ResultCode::Success);
 }
+
+// Replays the kind of requests a game makes when it saves: creating and writing files in its data
+// directory, renaming temporary files over the real ones, deleting files and polling the usage of
+// the directory in between. The usage has to match what a freshly created file system, which
+// has to look at all files, reports.
+TEST_F(FileSystemTest, DirectoryStatsFollowChanges)
+{
+  const std::string data_dir = "/title/00010000/534d4e45/data";
+  ASSERT_EQ(m_fs->CreateFullPath(Uid{0}, Gid{0}, data_dir + "/", 0, modes), ResultCode::Success);
+
+  const auto check_stats = [this](const std::string& path) {
+    const Result<DirectoryStats> stats = m_fs->GetDirectoryStats(path);
+    const Result<DirectoryStats> expected = MakeFileSystem()->GetDirectoryStats(path);
+    ASSERT_TRUE(stats.Succeeded());
+    ASSERT_TRUE(expected.Succeeded());
+    EXPECT_EQ(stats->used_clusters, expected->used_clusters) << path;
+    EXPECT_EQ(stats->used_inodes, expected->used_inodes) << path;
+  };
+
+  const auto write_file = [this](const std::string& path, size_t size) {
+    const Result<FileHandle> file = m_fs->OpenFile(Uid{0}, Gid{0}, path, Mode::Write);
+    ASSERT_TRUE(file.Succeeded());
+    const std::vector<u8> data(size, 0xA5);
+    for (size_t offset = 0; offset < size; offset += 0x1000)
+    {
+      const size_t chunk_size = std::min<size_t>(0x1000, size - offset);
+      ASSERT_TRUE(file->Write(data.data() + offset, chunk_size).Succeeded());
+    }
+  };
+
+  for (int i = 0; i < 20; ++i)
+  {
+    const std::string name = data_dir + "/save" + std::to_string(i % 4);
+    const std::string temp_name = "/tmp/save" + std::to_string(i % 4);
+    check_stats(data_dir);
+    check_stats("/title");
+
+    ASSERT_EQ(m_fs->CreateFile(Uid{0}, Gid{0}, temp_name, 0, modes), ResultCode::Success);
+    write_file(temp_name, 0x3000 + i * 0x1800);
+    check_stats("/tmp");
+    ASSERT_EQ(m_fs->Rename(Uid{0}, Gid{0}, temp_name, name), ResultCode::Success);
+    check_stats(data_dir);
+    check_stats("/tmp");
+
+    if (i % 5 == 4)
+    {
+      ASSERT_EQ(m_fs->CreateDirectory(Uid{0}, Gid{0}, data_dir + "/sub", 0, modes),
+                ResultCode::Success);
+      ASSERT_EQ(m_fs->CreateFile(Uid{0}, Gid{0}, data_dir + "/sub/f", 0, modes),
+                ResultCode::Success);
+      write_file(data_dir + "/sub/f", 0x9000);
+      check_stats("/title");
+      ASSERT_EQ(m_fs->Delete(Uid{0}, Gid{0}, data_dir + "/sub"), ResultCode::Success);
+      ASSERT_EQ(m_fs->Delete(Uid{0}, Gid{0}, name), ResultCode::Success);
+    }
+    check_stats("/");
+  }
+}
+
+TEST_F(FileSystemTest, MetadataIsPersisted)
+{
+  constexpr u8 ArbitraryAttribute = 0x42;
+  const Modes other_modes{Mode::Read, Mode::ReadWrite, Mode::Read};
+
+  ASSERT_EQ(m_fs->CreateDirectory(Uid{0}, Gid{0}, "/tmp/d", ArbitraryAttribute, modes),
+            ResultCode::Success);
+  ASSERT_EQ(m_fs->CreateFile(Uid{0}, Gid{0}, "/tmp/d/f", 0, modes), ResultCode::Success);
+  ASSERT_EQ(m_fs->SetMetadata(Uid{0}, "/tmp/d/f", Uid{0x1000}, Gid{1}, 0, other_modes),
+            ResultCode::Success);
+  ASSERT_EQ(m_fs->Rename(Uid{0}, Gid{0}, "/tmp/d", "/tmp/e"), ResultCode::Success);
+  ASSERT_EQ(m_fs->CreateFile(Uid{0}, Gid{0}, "/tmp/g", 0, modes), ResultCode::Success);
+  ASSERT_EQ(m_fs->Delete(Uid{0}, Gid{0}, "/tmp/g"), ResultCode::Success);
+
+  const auto check_metadata = [&](FileSystem* fs) {
+    const Result<Metadata> dir = fs->GetMetadata(Uid{0}, Gid{0}, "/tmp/e");
+    ASSERT_TRUE(dir.Succeeded());
+    EXPECT_EQ(dir->attribute, ArbitraryAttribute);
+    EXPECT_EQ(dir->modes, modes);
+
+    const Result<Metadata> file = fs->GetMetadata(Uid{0}, Gid{0}, "/tmp/e/f");
+    ASSERT_TRUE(file.Succeeded());
+    EXPECT_EQ(file->uid, Uid{0x1000});
+    EXPECT_EQ(file->gid, Gid{1});
+    EXPECT_EQ(file->modes, other_modes);
+  };
+
+  // While this file system is still around, another one has to see the same metadata.
+  check_metadata(MakeFileSystem().get());
+
+  m_fs.reset();
+  check_metadata(MakeFileSystem().get());
+}
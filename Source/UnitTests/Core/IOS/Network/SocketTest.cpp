@@ -0,0 +1,172 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/Memmap.h"
+#include "Core/IOS/IOS.h"
+#include "Core/IOS/Network/IP/Top.h"
+#include "Core/IOS/Network/Socket.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "UICommon/UICommon.h"
+
+namespace
+{
+constexpr u32 REQUEST_ADDRESS = 0x00010000;
+constexpr u32 VECTORS_ADDRESS = 0x00010040;
+constexpr u32 IN_BUFFER_ADDRESS = 0x00010080;
+constexpr u32 OUT_BUFFER_ADDRESS = 0x00010100;
+constexpr u32 OUT_BUFFER_SIZE = 0x40;
+
+constexpr s32 WII_AF_INET = 2;
+constexpr s32 WII_SOCK_DGRAM = 2;
+
+constexpr char DATAGRAM[] = "ready";
+}  // namespace
+
+class SocketTest : public testing::Test
+{
+protected:
+  SocketTest() : m_profile_path(File::CreateTempDir())
+  {
+    Core::DeclareAsCPUThread();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    SConfig::Init();
+    PowerPC::Init(PowerPC::CPUCore::Interpreter);
+    CoreTiming::Init();
+    Memory::Init();
+    IOS::HLE::Init();
+
+    m_wii_fd = IOS::HLE::WiiSockMan::GetInstance().NewSocket(WII_AF_INET, WII_SOCK_DGRAM, 0);
+
+    // Bind the socket to a free port on the host, so that datagrams can be sent to it.
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    const s32 host_fd = IOS::HLE::WiiSockMan::GetInstance().GetHostSocket(m_wii_fd);
+    socklen_t address_size = sizeof(address);
+    if (bind(host_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0 &&
+        getsockname(host_fd, reinterpret_cast<sockaddr*>(&address), &address_size) == 0)
+    {
+      m_address = address;
+    }
+
+    m_sender_fd = socket(AF_INET, SOCK_DGRAM, 0);
+  }
+
+  ~SocketTest() override
+  {
+    close(m_sender_fd);
+    IOS::HLE::WiiSockMan::GetInstance().Clean();
+    IOS::HLE::Shutdown();
+    Memory::Shutdown();
+    CoreTiming::Shutdown();
+    PowerPC::Shutdown();
+    SConfig::Shutdown();
+    Config::Shutdown();
+    Core::UndeclareAsCPUThread();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+  // Queues a blocking recv on the socket, like a game waiting for a datagram would.
+  void QueueReceive()
+  {
+    Memory::Write_U32(IOS::HLE::IPC_CMD_IOCTLV, REQUEST_ADDRESS);
+    Memory::Write_U32(m_wii_fd, REQUEST_ADDRESS + 0x08);
+    Memory::Write_U32(IOS::HLE::IOCTLV_SO_RECVFROM, REQUEST_ADDRESS + 0x0c);
+    Memory::Write_U32(1, REQUEST_ADDRESS + 0x10);
+    Memory::Write_U32(1, REQUEST_ADDRESS + 0x14);
+    Memory::Write_U32(VECTORS_ADDRESS, REQUEST_ADDRESS + 0x18);
+
+    Memory::Write_U32(IN_BUFFER_ADDRESS, VECTORS_ADDRESS);
+    Memory::Write_U32(8, VECTORS_ADDRESS + 0x04);
+    Memory::Write_U32(OUT_BUFFER_ADDRESS, VECTORS_ADDRESS + 0x08);
+    Memory::Write_U32(OUT_BUFFER_SIZE, VECTORS_ADDRESS + 0x0c);
+
+    Memory::Write_U32(m_wii_fd, IN_BUFFER_ADDRESS);
+    Memory::Write_U32(0, IN_BUFFER_ADDRESS + 0x04);
+
+    IOS::HLE::WiiSockMan::GetInstance().DoSock(m_wii_fd, IOS::HLE::Request{REQUEST_ADDRESS},
+                                               IOS::HLE::IOCTLV_SO_RECVFROM);
+  }
+
+  void SendDatagram()
+  {
+    ASSERT_EQ(sendto(m_sender_fd, DATAGRAM, sizeof(DATAGRAM), 0,
+                     reinterpret_cast<const sockaddr*>(&m_address), sizeof(m_address)),
+              static_cast<ssize_t>(sizeof(DATAGRAM)));
+  }
+
+  bool WasReplied() const
+  {
+    return Memory::Read_U32(REQUEST_ADDRESS) == static_cast<u32>(IOS::HLE::IPC_REPLY);
+  }
+
+  // The datagram may take a moment to arrive, even over the loopback interface.
+  bool UpdateUntilReplied() const
+  {
+    for (int i = 0; i < 1000 && !WasReplied(); ++i)
+    {
+      IOS::HLE::WiiSockMan::GetInstance().Update();
+      if (!WasReplied())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return WasReplied();
+  }
+
+  s32 m_wii_fd = -1;
+  int m_sender_fd = -1;
+  sockaddr_in m_address{};
+
+private:
+  std::string m_profile_path;
+};
+
+TEST_F(SocketTest, PendingReceiveCompletesOnceDataArrives)
+{
+  ASSERT_GE(m_wii_fd, 0);
+  ASSERT_NE(m_address.sin_port, 0);
+
+  QueueReceive();
+  for (int i = 0; i < 10; ++i)
+    IOS::HLE::WiiSockMan::GetInstance().Update();
+  EXPECT_FALSE(WasReplied());
+
+  // Nothing else is queued, so only the readiness notification can complete the receive.
+  SendDatagram();
+  ASSERT_TRUE(UpdateUntilReplied());
+  EXPECT_EQ(Memory::Read_U32(REQUEST_ADDRESS + 4), sizeof(DATAGRAM));
+  EXPECT_EQ(Memory::GetString(OUT_BUFFER_ADDRESS), DATAGRAM);
+}
+
+TEST_F(SocketTest, ReceiveQueuedAfterDataArrivedCompletes)
+{
+  ASSERT_GE(m_wii_fd, 0);
+  ASSERT_NE(m_address.sin_port, 0);
+
+  // The notification for this datagram comes while nothing is pending on the socket.
+  SendDatagram();
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  IOS::HLE::WiiSockMan::GetInstance().Update();
+
+  QueueReceive();
+  ASSERT_TRUE(UpdateUntilReplied());
+  EXPECT_EQ(Memory::Read_U32(REQUEST_ADDRESS + 4), sizeof(DATAGRAM));
+}
@@ -138,3 +138,36 @@ TEST_F(MappingTest, ReadWriteComplex)
   EXPECT_TRUE(read_called);
   EXPECT_TRUE(write_called);
 }
+
+TEST_F(MappingTest, ReadWriteComplexFunction)
+{
+  struct Context
+  {
+    u16 value = 0;
+    int reads = 0;
+    int writes = 0;
+  } context;
+
+  const auto read = [](void* ctx, u32 addr) -> u16 {
+    EXPECT_EQ(0x0C001234u, addr);
+    Context* c = static_cast<Context*>(ctx);
+    ++c->reads;
+    return c->value;
+  };
+  const auto write = [](void* ctx, u32 addr, u16 val) {
+    EXPECT_EQ(0x0C001234u, addr);
+    Context* c = static_cast<Context*>(ctx);
+    ++c->writes;
+    c->value = val;
+  };
+
+  m_mapping->Register(0x0C001234, MMIO::ComplexRead<u16>(read, &context),
+                      MMIO::ComplexWrite<u16>(write, &context));
+
+  m_mapping->Write(0x0C001234, (u16)0xbeef);
+  u16 val = m_mapping->Read<u16>(0x0C001234);
+  EXPECT_EQ(0xbeef, val);
+
+  EXPECT_EQ(1, context.reads);
+  EXPECT_EQ(1, context.writes);
+}
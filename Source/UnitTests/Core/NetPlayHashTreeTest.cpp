@@ -0,0 +1,112 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/NetPlayHashTree.h"
+
+namespace
+{
+class MemoryHashTreeTest : public testing::Test
+{
+protected:
+  MemoryHashTreeTest() : m_ram(0x123000), m_registers(0x80)
+  {
+    std::iota(m_ram.begin(), m_ram.end(), u8(0));
+    std::iota(m_registers.begin(), m_registers.end(), u8(0x40));
+  }
+
+  std::vector<NetPlay::HashTreeRegion> GetRegions() const
+  {
+    return {{"Registers", 0, m_registers.data(), m_registers.size()},
+            {"RAM", 0x80000000, m_ram.data(), m_ram.size()}};
+  }
+
+  // Walks down both trees like the server does, and returns the leaves that differ
+  static std::vector<u32> FindDifferingLeaves(const NetPlay::MemoryHashTree& a,
+                                              const NetPlay::MemoryHashTree& b)
+  {
+    std::vector<u32> nodes{0};
+    for (size_t level = a.GetLevelCount() - 1; level > 0; --level)
+    {
+      std::vector<u32> children;
+      for (const u32 node : nodes)
+      {
+        const auto a_children = a.GetChildren(level, node);
+        const auto b_children = b.GetChildren(level, node);
+        EXPECT_TRUE(a_children && b_children);
+        for (size_t i = 0; i < a_children->size(); ++i)
+        {
+          if ((*a_children)[i] != (*b_children)[i])
+            children.push_back(static_cast<u32>(node * NetPlay::HASH_TREE_FANOUT + i));
+        }
+      }
+      nodes = std::move(children);
+    }
+    return nodes;
+  }
+
+  std::vector<u8> m_ram;
+  std::vector<u8> m_registers;
+};
+}  // namespace
+
+TEST_F(MemoryHashTreeTest, SameMemorySameRoot)
+{
+  NetPlay::MemoryHashTree a;
+  NetPlay::MemoryHashTree b;
+  a.Build(GetRegions());
+  b.Build(GetRegions());
+
+  // 1 leaf for the registers and 0x123 for the RAM, 19 nodes above them, 2 above those and a root
+  EXPECT_EQ(a.GetLevelCount(), 4u);
+  EXPECT_EQ(a.GetRoot(), b.GetRoot());
+  EXPECT_TRUE(FindDifferingLeaves(a, b).empty());
+  EXPECT_FALSE(a.GetChildren(0, 0));
+  EXPECT_FALSE(a.GetChildren(3, 1));
+}
+
+TEST_F(MemoryHashTreeTest, FindsDifferingPages)
+{
+  NetPlay::MemoryHashTree a;
+  a.Build(GetRegions());
+
+  m_ram[0x5010] ^= 1;
+  m_ram[0x7ff0] ^= 1;
+  m_ram[0x122fff] ^= 1;
+  m_registers[3] ^= 1;
+
+  NetPlay::MemoryHashTree b;
+  b.Build(GetRegions());
+  EXPECT_NE(a.GetRoot(), b.GetRoot());
+
+  const std::vector<u32> leaves = FindDifferingLeaves(a, b);
+  EXPECT_EQ(leaves, (std::vector<u32>{0, 6, 8, 0x123}));
+
+  // Adjacent pages are merged, and regions of a single page are described by their name
+  EXPECT_EQ(b.DescribeLeaves(leaves),
+            (std::vector<std::string>{"Registers", "RAM 80005000-80005fff",
+                                      "RAM 80007000-80007fff", "RAM 80122000-80122fff"}));
+  EXPECT_EQ(b.DescribeLeaves({7, 6, 0x123}),
+            (std::vector<std::string>{"RAM 80005000-80006fff", "RAM 80122000-80122fff"}));
+}
+
+TEST_F(MemoryHashTreeTest, RebuildReusesTree)
+{
+  NetPlay::MemoryHashTree tree;
+  tree.Build(GetRegions());
+  const u64 root = tree.GetRoot();
+
+  tree.Build({{"Registers", 0, m_registers.data(), m_registers.size()}});
+  EXPECT_EQ(tree.GetLevelCount(), 1u);
+  EXPECT_EQ(tree.DescribeLeaves({0}), std::vector<std::string>{"Registers"});
+
+  tree.Build(GetRegions());
+  EXPECT_EQ(tree.GetRoot(), root);
+}
@@ -0,0 +1,123 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/NetPlayRollback.h"
+#include "InputCommon/GCPadStatus.h"
+
+namespace
+{
+GCPadStatus MakeInput(u16 button)
+{
+  GCPadStatus status{};
+  status.button = button;
+  status.stickX = GCPadStatus::MAIN_STICK_CENTER_X;
+  status.stickY = GCPadStatus::MAIN_STICK_CENTER_Y;
+  status.substickX = GCPadStatus::C_STICK_CENTER_X;
+  status.substickY = GCPadStatus::C_STICK_CENTER_Y;
+  return status;
+}
+
+u16 ConsumeButton(NetPlay::RollbackPadHistory& history, bool expect_predicted)
+{
+  bool predicted;
+  const GCPadStatus status = history.Consume(&predicted);
+  EXPECT_EQ(predicted, expect_predicted);
+  return status.button;
+}
+}  // namespace
+
+TEST(NetPlayRollback, ConfirmedInputsAreUsedInOrder)
+{
+  NetPlay::RollbackPadHistory history;
+  EXPECT_FALSE(history.HasInput());
+  EXPECT_FALSE(history.AddInput(MakeInput(1)));
+  EXPECT_FALSE(history.AddInput(MakeInput(2)));
+
+  EXPECT_TRUE(history.HasInput());
+  EXPECT_EQ(ConsumeButton(history, false), 1);
+  EXPECT_EQ(ConsumeButton(history, false), 2);
+  EXPECT_FALSE(history.HasInput());
+  EXPECT_EQ(history.GetConsumedCount(), 2u);
+  EXPECT_EQ(history.GetConfirmedCount(), 2u);
+}
+
+TEST(NetPlayRollback, PredictionsRepeatTheLastInput)
+{
+  NetPlay::RollbackPadHistory history;
+  EXPECT_EQ(ConsumeButton(history, true), 0);
+
+  EXPECT_FALSE(history.AddInput(MakeInput(0)));
+  EXPECT_FALSE(history.AddInput(MakeInput(3)));
+  EXPECT_EQ(ConsumeButton(history, false), 3);
+  EXPECT_EQ(ConsumeButton(history, true), 3);
+  EXPECT_EQ(ConsumeButton(history, true), 3);
+
+  // The first prediction was right, the second one wasn't
+  EXPECT_FALSE(history.AddInput(MakeInput(3)));
+  EXPECT_TRUE(history.AddInput(MakeInput(4)));
+  EXPECT_EQ(history.GetConfirmedCount(), 4u);
+}
+
+TEST(NetPlayRollback, RewindReplaysActualInputs)
+{
+  NetPlay::RollbackPadHistory history;
+  history.AddInput(MakeInput(1));
+  EXPECT_EQ(ConsumeButton(history, false), 1);
+  EXPECT_EQ(ConsumeButton(history, true), 1);
+  EXPECT_EQ(ConsumeButton(history, true), 1);
+  EXPECT_EQ(ConsumeButton(history, true), 1);
+
+  EXPECT_TRUE(history.AddInput(MakeInput(2)));
+
+  // Roll back to before the mispredicted poll. The predictions for the polls after it are
+  // dropped, as they are made again.
+  history.Rewind(1);
+  EXPECT_EQ(history.GetConsumedCount(), 1u);
+  EXPECT_EQ(ConsumeButton(history, false), 2);
+  EXPECT_EQ(ConsumeButton(history, true), 2);
+
+  // Only the new prediction is checked
+  EXPECT_FALSE(history.AddInput(MakeInput(2)));
+  EXPECT_FALSE(history.AddInput(MakeInput(5)));
+}
+
+TEST(NetPlayRollback, RewindKeepsEarlierPredictions)
+{
+  NetPlay::RollbackPadHistory history;
+  EXPECT_EQ(ConsumeButton(history, true), 0);
+  EXPECT_EQ(ConsumeButton(history, true), 0);
+  EXPECT_EQ(ConsumeButton(history, true), 0);
+
+  // Another pad was mispredicted at the third poll, so the first two predictions were used by
+  // the state that is loaded and still need to be checked
+  history.Rewind(2);
+  EXPECT_FALSE(history.AddInput(MakeInput(0)));
+  EXPECT_TRUE(history.AddInput(MakeInput(6)));
+  EXPECT_FALSE(history.AddInput(MakeInput(7)));
+}
+
+TEST(NetPlayRollback, ForgetKeepsPollNumbers)
+{
+  NetPlay::RollbackPadHistory history;
+  for (u16 i = 0; i < 10; ++i)
+    history.AddInput(MakeInput(i));
+  for (u16 i = 0; i < 6; ++i)
+    EXPECT_EQ(ConsumeButton(history, false), i);
+
+  history.Forget(4);
+  EXPECT_EQ(history.GetConfirmedCount(), 10u);
+
+  history.Rewind(4);
+  EXPECT_EQ(ConsumeButton(history, false), 4);
+
+  // Inputs that aren't confirmed yet can't be forgotten
+  history.Forget(20);
+  EXPECT_EQ(history.GetConfirmedCount(), 10u);
+  history.AddInput(MakeInput(10));
+  history.Rewind(10);
+  EXPECT_EQ(ConsumeButton(history, false), 10);
+}
@@ -0,0 +1,133 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <optional>
+#include <vector>
+
+#include <SFML/Network/Packet.hpp>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/NetPlaySaveTransfer.h"
+
+namespace
+{
+// Random data doesn't compress, so the size of a packet shows how much of it was sent
+std::vector<u8> MakeRandomSave(size_t size, u32 seed)
+{
+  std::vector<u8> data(size);
+  u32 state = seed;
+  for (u8& byte : data)
+  {
+    state = state * 1103515245 + 12345;
+    byte = static_cast<u8>(state >> 16);
+  }
+  return data;
+}
+
+std::optional<std::vector<u8>> RoundTrip(const std::vector<u8>& data,
+                                         const NetPlay::SaveBlockStore& client_blocks,
+                                         size_t* packet_size)
+{
+  sf::Packet packet;
+  NetPlay::CompressBufferIntoPacket(data, packet, client_blocks.GetHashes());
+  *packet_size = packet.getDataSize();
+  return NetPlay::DecompressPacketIntoBuffer(packet, client_blocks);
+}
+}  // namespace
+
+TEST(NetPlaySaveTransfer, RoundTripWithoutLocalSaves)
+{
+  std::vector<u8> data = MakeRandomSave(0x12345, 1);
+  data.resize(0x40000, 0xff);
+
+  size_t packet_size;
+  const auto result = RoundTrip(data, NetPlay::SaveBlockStore{}, &packet_size);
+  ASSERT_TRUE(result);
+  EXPECT_EQ(*result, data);
+  EXPECT_LT(packet_size, 0x14000u);
+}
+
+TEST(NetPlaySaveTransfer, EmptySave)
+{
+  size_t packet_size;
+  const auto result = RoundTrip({}, NetPlay::SaveBlockStore{}, &packet_size);
+  ASSERT_TRUE(result);
+  EXPECT_TRUE(result->empty());
+}
+
+TEST(NetPlaySaveTransfer, IdenticalSaveIsOnlyReferenced)
+{
+  const std::vector<u8> data = MakeRandomSave(0x20000, 2);
+
+  NetPlay::SaveBlockStore client_blocks;
+  client_blocks.AddBuffer(data);
+
+  size_t packet_size;
+  const auto result = RoundTrip(data, client_blocks, &packet_size);
+  ASSERT_TRUE(result);
+  EXPECT_EQ(*result, data);
+  EXPECT_LT(packet_size, 64u);
+}
+
+TEST(NetPlaySaveTransfer, SimilarSaveOnlySendsChangedBlocks)
+{
+  const std::vector<u8> old_data = MakeRandomSave(0x20000, 3);
+  std::vector<u8> data = old_data;
+  data[3 * NetPlay::SAVE_BLOCK_SIZE + 5] ^= 0xff;
+  data.resize(data.size() + 0x123, 0x42);
+
+  NetPlay::SaveBlockStore client_blocks;
+  client_blocks.AddBuffer(old_data);
+
+  size_t packet_size;
+  const auto result = RoundTrip(data, client_blocks, &packet_size);
+  ASSERT_TRUE(result);
+  EXPECT_EQ(*result, data);
+  EXPECT_LT(packet_size, 2 * NetPlay::SAVE_BLOCK_SIZE);
+}
+
+TEST(NetPlaySaveTransfer, MissingLocalBlocksFail)
+{
+  const std::vector<u8> data = MakeRandomSave(0x8000, 4);
+
+  NetPlay::SaveBlockStore server_view;
+  server_view.AddBuffer(data);
+
+  sf::Packet packet;
+  NetPlay::CompressBufferIntoPacket(data, packet, server_view.GetHashes());
+  EXPECT_FALSE(NetPlay::DecompressPacketIntoBuffer(packet, NetPlay::SaveBlockStore{}));
+}
+
+TEST(NetPlaySaveTransfer, SaveDataPacket)
+{
+  const std::vector<u8> first = MakeRandomSave(0x3000, 5);
+  const std::vector<u8> second = MakeRandomSave(0x5000, 6);
+
+  NetPlay::SaveDataPacket save_packet;
+  save_packet << u8{1};
+  save_packet.AddBuffer(first);
+  save_packet << u32{2} << u8{3};
+  save_packet.AddBuffer(second);
+  save_packet << u8{4};
+
+  NetPlay::SaveBlockStore client_blocks;
+  client_blocks.AddBuffer(second);
+
+  sf::Packet packet = save_packet.Encode(client_blocks.GetHashes());
+  EXPECT_LT(packet.getDataSize(), first.size() + 0x100);
+
+  u8 value8;
+  u32 value32;
+  packet >> value8;
+  EXPECT_EQ(value8, 1);
+  EXPECT_EQ(NetPlay::DecompressPacketIntoBuffer(packet, client_blocks), first);
+  packet >> value32 >> value8;
+  EXPECT_EQ(value32, 2u);
+  EXPECT_EQ(value8, 3);
+  EXPECT_EQ(NetPlay::DecompressPacketIntoBuffer(packet, client_blocks), second);
+  packet >> value8;
+  EXPECT_EQ(value8, 4);
+  EXPECT_TRUE(packet.endOfPacket());
+}
@@ -0,0 +1,160 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
+#include "Core/PowerPC/PPCAnalyst.h"
+#include "UICommon/UICommon.h"
+
+namespace
+{
+constexpr u32 BLOCK_ADDRESS = 0x80003000;
+
+// cmpwi crfD, rA, 0
+constexpr u32 Cmpwi(u32 crf, u32 ra)
+{
+  return 0x2C000000 | (crf << 23) | (ra << 16);
+}
+
+// bc BO, BI, +8
+constexpr u32 Bc(u32 bo, u32 bi)
+{
+  return 0x40000008 | (bo << 21) | (bi << 16);
+}
+
+// mcrf crfD, crfS
+constexpr u32 Mcrf(u32 crfd, u32 crfs)
+{
+  return 0x4C000000 | (crfd << 23) | (crfs << 18);
+}
+
+// crand crbD, crbA, crbB
+constexpr u32 Crand(u32 crbd, u32 crba, u32 crbb)
+{
+  return 0x4C000000 | (crbd << 21) | (crba << 16) | (crbb << 11) | (257 << 1);
+}
+
+constexpr u32 BO_BRANCH_IF_FALSE = 4;
+constexpr u32 CR_EQ = 2;
+constexpr u32 BLR = 0x4E800020;
+}  // namespace
+
+class PPCAnalystTest : public testing::Test
+{
+protected:
+  PPCAnalystTest() : m_profile_path(File::CreateTempDir())
+  {
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    SConfig::Init();
+    Memory::Init();
+    // Fills in the instruction tables that the analyzer looks instructions up in
+    Interpreter::getInstance()->Init();
+  }
+  ~PPCAnalystTest() override
+  {
+    Memory::Shutdown();
+    SConfig::Shutdown();
+    Config::Shutdown();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+  // Analyzes a block made of the given instructions
+  const std::vector<PPCAnalyst::CodeOp>& Analyze(const std::vector<u32>& instructions)
+  {
+    for (size_t i = 0; i < instructions.size(); ++i)
+      Memory::Write_U32(instructions[i], BLOCK_ADDRESS + static_cast<u32>(i * 4));
+
+    m_block.m_stats = &m_stats;
+    m_block.m_gpa = &m_gpa;
+    m_block.m_fpa = &m_fpa;
+    m_buffer.resize(instructions.size());
+    m_analyzer.Analyze(BLOCK_ADDRESS, &m_block, &m_buffer, m_buffer.size());
+    EXPECT_EQ(m_block.m_num_instructions, instructions.size());
+    return m_buffer;
+  }
+
+  PPCAnalyst::PPCAnalyzer m_analyzer;
+
+private:
+  std::string m_profile_path;
+  PPCAnalyst::CodeBlock m_block;
+  PPCAnalyst::BlockStats m_stats;
+  PPCAnalyst::BlockRegStats m_gpa;
+  PPCAnalyst::BlockRegStats m_fpa;
+  PPCAnalyst::CodeBuffer m_buffer;
+};
+
+TEST_F(PPCAnalystTest, RedefinedCRFieldIsNotWanted)
+{
+  const auto& code = Analyze({Cmpwi(1, 3), Cmpwi(1, 4), Bc(BO_BRANCH_IF_FALSE, 4 + CR_EQ)});
+
+  EXPECT_TRUE(code[0].crOut[1]);
+  EXPECT_FALSE(code[0].wantsCR[1]);
+  EXPECT_TRUE(code[1].wantsCR[1]);
+  EXPECT_TRUE(code[2].crIn[1]);
+  EXPECT_FALSE(code[0].skip);
+}
+
+TEST_F(PPCAnalystTest, RedefinedCompareIsDeadCode)
+{
+  m_analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_DEAD_CODE_ELIMINATION);
+  const auto& code = Analyze({Cmpwi(1, 3), Cmpwi(1, 4), Bc(BO_BRANCH_IF_FALSE, 4 + CR_EQ)});
+
+  EXPECT_TRUE(code[0].isDead);
+  EXPECT_TRUE(code[0].skip);
+  EXPECT_FALSE(code[1].isDead);
+}
+
+TEST_F(PPCAnalystTest, CRFieldIsWantedAcrossBlockExits)
+{
+  m_analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CONDITIONAL_CONTINUE);
+  m_analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_DEAD_CODE_ELIMINATION);
+  // The branch can leave the block, so cr1 is wanted even though it is redefined after it.
+  const auto& code = Analyze({Cmpwi(1, 3), Bc(BO_BRANCH_IF_FALSE, CR_EQ), Cmpwi(1, 4), BLR});
+
+  EXPECT_TRUE(code[0].wantsCR[1]);
+  EXPECT_FALSE(code[0].skip);
+  // Nothing in the block reads cr1 after the second compare, but the next block might.
+  EXPECT_TRUE(code[2].wantsCR[1]);
+  EXPECT_FALSE(code[2].skip);
+}
+
+TEST_F(PPCAnalystTest, McrfReadsItsSourceField)
+{
+  const auto& code = Analyze({Cmpwi(1, 3), Mcrf(0, 1), Cmpwi(1, 4), BLR});
+
+  EXPECT_TRUE(code[1].crIn[1]);
+  EXPECT_FALSE(code[1].crIn[0]);
+  EXPECT_TRUE(code[1].crOut[0]);
+  EXPECT_TRUE(code[0].wantsCR[1]);
+  // The second compare overwrites cr1 before anything else reads it
+  EXPECT_FALSE(code[1].wantsCR[1]);
+}
+
+TEST_F(PPCAnalystTest, CRLogicReadsAllItsFields)
+{
+  // crand cr2[eq], cr1[eq], cr3[eq]
+  const auto& code = Analyze({Cmpwi(1, 3), Cmpwi(3, 4), Crand(8 + CR_EQ, 4 + CR_EQ, 12 + CR_EQ),
+                              Cmpwi(1, 5), Cmpwi(3, 5), BLR});
+
+  // Only one bit of the destination field is written, so the field is read as well.
+  EXPECT_TRUE(code[2].crIn[1]);
+  EXPECT_TRUE(code[2].crIn[2]);
+  EXPECT_TRUE(code[2].crIn[3]);
+  EXPECT_TRUE(code[2].crOut[2]);
+  EXPECT_TRUE(code[0].wantsCR[1]);
+  EXPECT_TRUE(code[1].wantsCR[3]);
+  EXPECT_FALSE(code[2].wantsCR[1]);
+  EXPECT_FALSE(code[2].wantsCR[3]);
+}
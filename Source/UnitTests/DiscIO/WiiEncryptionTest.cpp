@@ -0,0 +1,156 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Crypto/AES.h"
+#include "Common/Crypto/SHA1.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/VolumeWii.h"
+#include "DiscIO/WiiEncryptionCache.h"
+
+using DiscIO::VolumeWii;
+
+namespace
+{
+constexpr u64 PARTITION_DATA_OFFSET = 0x50000;
+// Ends in the middle of a block, to cover the zero padding at the end of the partition
+constexpr u64 PARTITION_DATA_SIZE =
+    5 * VolumeWii::GROUP_DATA_SIZE + 3 * VolumeWii::BLOCK_DATA_SIZE / 2;
+constexpr std::array<u8, VolumeWii::AES_KEY_SIZE> KEY = {0x01, 0x23, 0x45, 0x67, 0x89, 0xAB,
+                                                         0xCD, 0xEF, 0xFE, 0xDC, 0xBA, 0x98,
+                                                         0x76, 0x54, 0x32, 0x10};
+
+u8 GetDecryptedByte(u64 offset)
+{
+  return static_cast<u8>(offset * 13 + offset / 509);
+}
+
+class DecryptedBlob final : public DiscIO::BlobReader
+{
+public:
+  DiscIO::BlobType GetBlobType() const override { return DiscIO::BlobType::DIRECTORY; }
+  u64 GetRawSize() const override { return 0; }
+  u64 GetDataSize() const override { return 0; }
+  bool IsDataSizeAccurate() const override { return false; }
+  bool Read(u64 offset, u64 size, u8* out_ptr) override { return false; }
+
+  bool SupportsReadWiiDecrypted() const override { return true; }
+  bool ReadWiiDecrypted(u64 offset, u64 size, u8* out_ptr, u64 partition_data_offset) override
+  {
+    if (partition_data_offset != PARTITION_DATA_OFFSET || offset + size > PARTITION_DATA_SIZE)
+      return false;
+    for (u64 i = 0; i < size; ++i)
+      out_ptr[i] = GetDecryptedByte(offset + i);
+    return true;
+  }
+};
+
+std::vector<u8> EncryptGroupsOneByOne(u64 first_group, u64 count)
+{
+  DecryptedBlob blob;
+  std::vector<u8> result(count * VolumeWii::GROUP_TOTAL_SIZE);
+  for (u64 i = 0; i < count; ++i)
+  {
+    auto group = std::make_unique<std::array<u8, VolumeWii::GROUP_TOTAL_SIZE>>();
+    EXPECT_TRUE(VolumeWii::EncryptGroup((first_group + i) * VolumeWii::GROUP_DATA_SIZE,
+                                        PARTITION_DATA_OFFSET, PARTITION_DATA_SIZE, KEY, &blob,
+                                        group.get()));
+    std::memcpy(result.data() + i * VolumeWii::GROUP_TOTAL_SIZE, group->data(), group->size());
+  }
+  return result;
+}
+}  // namespace
+
+TEST(WiiEncryption, BlocksDecryptAndMatchHashes)
+{
+  DecryptedBlob blob;
+  auto group = std::make_unique<std::array<u8, VolumeWii::GROUP_TOTAL_SIZE>>();
+  ASSERT_TRUE(VolumeWii::EncryptGroup(VolumeWii::GROUP_DATA_SIZE, PARTITION_DATA_OFFSET,
+                                      PARTITION_DATA_SIZE, KEY, &blob, group.get()));
+
+  const auto aes = Common::AES::CreateContext(KEY.data(), Common::AES::Mode::Decrypt);
+  for (u64 block = 0; block < VolumeWii::BLOCKS_PER_GROUP; block += 9)
+  {
+    const u8* encrypted = group->data() + block * VolumeWii::BLOCK_TOTAL_SIZE;
+
+    VolumeWii::HashBlock hashes;
+    const u8 zero_iv[16] = {};
+    aes->Crypt(zero_iv, encrypted, reinterpret_cast<u8*>(&hashes), sizeof(hashes));
+
+    std::vector<u8> data(VolumeWii::BLOCK_DATA_SIZE);
+    aes->Crypt(encrypted + 0x3D0, encrypted + VolumeWii::BLOCK_HEADER_SIZE, data.data(),
+               data.size());
+
+    const u64 data_offset = VolumeWii::GROUP_DATA_SIZE + block * VolumeWii::BLOCK_DATA_SIZE;
+    for (u64 i = 0; i < data.size(); ++i)
+      ASSERT_EQ(GetDecryptedByte(data_offset + i), data[i]) << "block " << block;
+
+    for (u64 i = 0; i < 31; ++i)
+    {
+      const Common::SHA1::Digest h0 = Common::SHA1::CalculateDigest(data.data() + i * 0x400, 0x400);
+      EXPECT_EQ(0, std::memcmp(h0.data(), hashes.h0[i], h0.size()));
+    }
+
+    const Common::SHA1::Digest h1 = Common::SHA1::CalculateDigest(
+        reinterpret_cast<const u8*>(hashes.h0), sizeof(hashes.h0));
+    EXPECT_EQ(0, std::memcmp(h1.data(), hashes.h1[block % 8], h1.size()));
+
+    const Common::SHA1::Digest h2 = Common::SHA1::CalculateDigest(
+        reinterpret_cast<const u8*>(hashes.h1), sizeof(hashes.h1));
+    EXPECT_EQ(0, std::memcmp(h2.data(), hashes.h2[block / 8], h2.size()));
+  }
+}
+
+TEST(WiiEncryption, EncryptGroupsMatchesEncryptGroup)
+{
+  // Includes the last group, which is only partially inside the partition data
+  const std::vector<u8> expected = EncryptGroupsOneByOne(3, 3);
+
+  DecryptedBlob blob;
+  std::vector<u8> result(expected.size());
+  u8* const out[] = {result.data(), result.data() + VolumeWii::GROUP_TOTAL_SIZE,
+                     result.data() + 2 * VolumeWii::GROUP_TOTAL_SIZE};
+  ASSERT_TRUE(VolumeWii::EncryptGroups(3 * VolumeWii::GROUP_DATA_SIZE, 3, PARTITION_DATA_OFFSET,
+                                       PARTITION_DATA_SIZE, KEY, &blob, out));
+  EXPECT_TRUE(expected == result);
+}
+
+TEST(WiiEncryption, EncryptGroupsFailsOnReadError)
+{
+  DecryptedBlob blob;
+  std::vector<u8> result(VolumeWii::GROUP_TOTAL_SIZE);
+  u8* const out = result.data();
+  EXPECT_FALSE(VolumeWii::EncryptGroups(0, 1, PARTITION_DATA_OFFSET + 1, PARTITION_DATA_SIZE, KEY,
+                                        &blob, &out));
+}
+
+TEST(WiiEncryption, CacheHandlesUnalignedReads)
+{
+  const std::vector<u8> expected = EncryptGroupsOneByOne(0, 6);
+
+  DecryptedBlob blob;
+  DiscIO::WiiEncryptionCache cache(&blob);
+
+  const auto check_read = [&](u64 offset, u64 size) {
+    std::vector<u8> buffer(size);
+    ASSERT_TRUE(cache.EncryptGroups(offset, size, buffer.data(), PARTITION_DATA_OFFSET,
+                                    PARTITION_DATA_SIZE, KEY));
+    EXPECT_EQ(0, std::memcmp(expected.data() + offset, buffer.data(), size))
+        << "offset " << offset << " size " << size;
+  };
+
+  // Partial group, then a read that starts in the cached group and spans several others
+  check_read(VolumeWii::GROUP_TOTAL_SIZE + 0x1234, 0x100);
+  check_read(VolumeWii::GROUP_TOTAL_SIZE + 0x5000, 3 * VolumeWii::GROUP_TOTAL_SIZE);
+  // Whole groups only, and a read that ends exactly at the end of the data
+  check_read(0, 2 * VolumeWii::GROUP_TOTAL_SIZE);
+  check_read(7, expected.size() - 7);
+}
@@ -0,0 +1,174 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "InputCommon/ControlReference/CompiledExpression.h"
+#include "InputCommon/ControlReference/ExpressionParser.h"
+#include "InputCommon/ControllerInterface/Device.h"
+
+using namespace ciface::ExpressionParser;
+
+namespace
+{
+class TestInput final : public ciface::Core::Device::Input
+{
+public:
+  explicit TestInput(std::string name) : m_name(std::move(name)) {}
+  std::string GetName() const override { return m_name; }
+  ControlState GetState() const override { return value; }
+
+  ControlState value = 0.0;
+
+private:
+  std::string m_name;
+};
+
+class TestDevice final : public ciface::Core::Device
+{
+public:
+  explicit TestDevice(const std::vector<std::string>& input_names)
+  {
+    for (const std::string& name : input_names)
+    {
+      m_test_inputs.push_back(new TestInput(name));
+      AddInput(m_test_inputs.back());
+    }
+  }
+
+  std::string GetName() const override { return "Test"; }
+  std::string GetSource() const override { return "Test"; }
+
+  std::vector<TestInput*> m_test_inputs;
+};
+
+class TestDeviceContainer final : public ciface::Core::DeviceContainer
+{
+public:
+  explicit TestDeviceContainer(std::shared_ptr<ciface::Core::Device> device)
+  {
+    device->SetId(0);
+    m_devices.push_back(std::move(device));
+  }
+};
+
+class ExpressionCompilerTest : public testing::Test
+{
+protected:
+  ExpressionCompilerTest()
+      : m_device(std::make_shared<TestDevice>(
+            std::vector<std::string>{"A", "B", "C", "Axis X-", "Axis X+", "Shift"})),
+        m_container(m_device)
+  {
+    m_qualifier.FromDevice(m_device.get());
+  }
+
+  std::unique_ptr<Expression> Parse(const std::string& str)
+  {
+    return Parse(str, m_variables);
+  }
+
+  std::unique_ptr<Expression> Parse(const std::string& str,
+                                    ControlEnvironment::VariableContainer& variables)
+  {
+    ParseResult result = ParseExpression(str);
+    EXPECT_EQ(result.status, ParseStatus::Successful) << str;
+
+    ControlEnvironment env(m_container, m_qualifier, variables);
+    result.expr->UpdateReferences(env);
+    return std::move(result.expr);
+  }
+
+  void SetInputs(u32 seed)
+  {
+    // Cover 0, 1 and values in between, which matter for the thresholds
+    static constexpr ControlState values[] = {0.0, 1.0, 0.25, 0.75, 0.5};
+    for (TestInput* input : m_device->m_test_inputs)
+    {
+      input->value = values[seed % 5];
+      seed = seed / 5 + 3;
+    }
+  }
+
+  // Evaluates a tree and the program compiled from a separate copy of it, so that expressions
+  // with state get the same inputs in the same order on both sides
+  void ExpectSameValues(const std::string& str)
+  {
+    ControlEnvironment::VariableContainer tree_variables;
+    ControlEnvironment::VariableContainer compiled_variables;
+    const std::unique_ptr<Expression> tree = Parse(str, tree_variables);
+    const std::unique_ptr<Expression> compiled_tree = Parse(str, compiled_variables);
+    const CompiledExpression compiled = ExpressionCompiler::Compile(*compiled_tree);
+
+    for (u32 i = 0; i < 200; ++i)
+    {
+      SetInputs(i);
+      const ControlState expected = tree->GetValue();
+      const ControlState actual = compiled.GetValue();
+      if (std::isnan(expected))
+        EXPECT_TRUE(std::isnan(actual)) << str << " with inputs " << i;
+      else
+        EXPECT_DOUBLE_EQ(actual, expected) << str << " with inputs " << i;
+    }
+  }
+
+  std::shared_ptr<TestDevice> m_device;
+  TestDeviceContainer m_container;
+  ciface::Core::DeviceQualifier m_qualifier;
+  ControlEnvironment::VariableContainer m_variables;
+};
+}  // namespace
+
+TEST_F(ExpressionCompilerTest, MatchesTree)
+{
+  ExpectSameValues("A");
+  ExpectSameValues("`Axis X-`");
+  ExpectSameValues("A & B | !C");
+  ExpectSameValues("A + B * 0.5 - C / 2");
+  ExpectSameValues("A / (B - C)");
+  ExpectSameValues("A % B");
+  ExpectSameValues("A ^ B ^ C");
+  ExpectSameValues("A < B, B > C");
+  ExpectSameValues("-A + minus(B)");
+  ExpectSameValues("sin(A * 3)");
+  ExpectSameValues("deadzone(`Axis X+` - `Axis X-`, 0.2)");
+  ExpectSameValues("if(Shift, A, B + C)");
+  ExpectSameValues("if(Shift, toggle(A), B)");
+  ExpectSameValues("toggle(A, B) | C");
+  ExpectSameValues("$x = A + $x, $x % 3");
+  ExpectSameValues("Missing | A");
+}
+
+TEST_F(ExpressionCompilerTest, FoldsConstants)
+{
+  const CompiledExpression constant = ExpressionCompiler::Compile(*Parse("1 + 2 * sin(0)"));
+  EXPECT_EQ(constant.GetInstructionCount(), 0u);
+  EXPECT_DOUBLE_EQ(constant.GetValue(), 1.0);
+
+  // Controls that aren't bound are always 0
+  const CompiledExpression unbound = ExpressionCompiler::Compile(*Parse("`Missing` * 2 + A"));
+  EXPECT_EQ(unbound.GetInstructionCount(), 2u);
+
+  // Only the input and the addition are left
+  const CompiledExpression partial = ExpressionCompiler::Compile(*Parse("A + 2 * 3"));
+  EXPECT_EQ(partial.GetInstructionCount(), 2u);
+
+  // The other branch isn't needed, even though it has state
+  const CompiledExpression branch = ExpressionCompiler::Compile(*Parse("if(1, A, toggle(B))"));
+  EXPECT_EQ(branch.GetInstructionCount(), 1u);
+}
+
+TEST_F(ExpressionCompilerTest, CallsBranchesWithState)
+{
+  // The toggle must only see B while Shift is held, so the if is evaluated as a whole
+  const std::unique_ptr<Expression> tree = Parse("if(Shift, toggle(B), C) + A");
+  const CompiledExpression compiled = ExpressionCompiler::Compile(*tree);
+  EXPECT_EQ(compiled.GetInstructionCount(), 3u);
+}
@@ -0,0 +1,153 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/Config/Config.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigLoaders/BaseConfigLoader.h"
+#include "Core/ConfigManager.h"
+#include "UICommon/GameFile.h"
+#include "UICommon/GameFileCache.h"
+#include "UICommon/UICommon.h"
+
+namespace
+{
+std::vector<std::string> GetPaths(const UICommon::GameFileCache& cache)
+{
+  std::vector<std::string> paths;
+  cache.ForEach([&paths](const std::shared_ptr<const UICommon::GameFile>& game) {
+    paths.push_back(game->GetFilePath());
+  });
+  std::sort(paths.begin(), paths.end());
+  return paths;
+}
+}  // namespace
+
+class GameFileCacheTest : public testing::Test
+{
+protected:
+  GameFileCacheTest() : m_profile_path(File::CreateTempDir()), m_dir(File::CreateTempDir())
+  {
+    // Checking for additional metadata reads the config and the user directory.
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    Config::AddLayer(ConfigLoaders::GenerateBaseConfigLoader());
+    SConfig::Init();
+
+    // Any file with a DOL extension is listed, which is enough to exercise the cache.
+    for (int i = 0; i < 50; ++i)
+    {
+      const std::string path = m_dir + "/game" + std::to_string(i) + ".dol";
+      File::WriteStringToFile(path, std::string(i + 1, 'x'));
+      m_game_paths.push_back(path);
+    }
+    std::sort(m_game_paths.begin(), m_game_paths.end());
+  }
+  ~GameFileCacheTest() override
+  {
+    SConfig::Shutdown();
+    Config::Shutdown();
+    File::DeleteDirRecursively(m_dir);
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+  std::string m_profile_path;
+  std::string m_dir;
+  std::vector<std::string> m_game_paths;
+};
+
+TEST_F(GameFileCacheTest, UpdateAddsAndRemovesGames)
+{
+  UICommon::GameFileCache cache(m_dir + "/gamelist.cache");
+
+  std::vector<std::string> added;
+  EXPECT_TRUE(cache.Update(m_game_paths, [&added](const auto& game) {
+    added.push_back(game->GetFilePath());
+  }));
+  std::sort(added.begin(), added.end());
+  EXPECT_EQ(m_game_paths, added);
+  EXPECT_EQ(m_game_paths, GetPaths(cache));
+
+  std::vector<std::string> remaining = m_game_paths;
+  const std::string removed_path = remaining.back();
+  remaining.pop_back();
+  std::vector<std::string> removed;
+  EXPECT_TRUE(cache.Update(remaining, {}, [&removed](const std::string& path) {
+    removed.push_back(path);
+  }));
+  EXPECT_EQ(std::vector<std::string>{removed_path}, removed);
+  EXPECT_EQ(remaining, GetPaths(cache));
+
+  EXPECT_FALSE(cache.Update(remaining));
+}
+
+TEST_F(GameFileCacheTest, AddOrGetReusesCachedGames)
+{
+  UICommon::GameFileCache cache(m_dir + "/gamelist.cache");
+  const std::vector<std::string> first_half(m_game_paths.begin(), m_game_paths.begin() + 25);
+  cache.Update(first_half);
+
+  std::shared_ptr<const UICommon::GameFile> cached_game;
+  cache.ForEach([&](const auto& game) {
+    if (game->GetFilePath() == m_game_paths[0])
+      cached_game = game;
+  });
+
+  std::vector<std::string> paths = m_game_paths;
+  paths.push_back(m_dir + "/missing.iso");
+  bool cache_changed = false;
+  const auto games = cache.AddOrGet(paths, &cache_changed);
+  EXPECT_TRUE(cache_changed);
+  ASSERT_EQ(paths.size(), games.size());
+  for (size_t i = 0; i < m_game_paths.size(); ++i)
+  {
+    ASSERT_NE(nullptr, games[i]);
+    EXPECT_EQ(m_game_paths[i], games[i]->GetFilePath());
+  }
+  EXPECT_EQ(nullptr, games.back());
+  EXPECT_EQ(cached_game, games[0]);
+  EXPECT_EQ(m_game_paths.size(), cache.GetSize());
+
+  cache_changed = false;
+  EXPECT_EQ(games[10], cache.AddOrGet(m_game_paths[10], &cache_changed));
+  EXPECT_FALSE(cache_changed);
+}
+
+TEST_F(GameFileCacheTest, SavesAndLoadsCacheFile)
+{
+  const std::string cache_path = m_dir + "/gamelist.cache";
+  {
+    UICommon::GameFileCache cache(cache_path);
+    cache.Update(m_game_paths);
+    EXPECT_TRUE(cache.Save());
+  }
+
+  UICommon::GameFileCache cache(cache_path);
+  ASSERT_TRUE(cache.Load());
+  EXPECT_EQ(m_game_paths, GetPaths(cache));
+  cache.ForEach([](const auto& game) {
+    EXPECT_EQ(game->GetFilePath().size() - game->GetFileName().size(),
+              game->GetFilePath().rfind(game->GetFileName()));
+  });
+
+  // Everything is already cached, so nothing should change.
+  EXPECT_FALSE(cache.Update(m_game_paths));
+
+  // A truncated cache file is rejected and deleted.
+  {
+    File::IOFile file(cache_path, "r+b");
+    ASSERT_TRUE(file.Resize(file.GetSize() - 1));
+  }
+  UICommon::GameFileCache truncated(cache_path);
+  EXPECT_FALSE(truncated.Load());
+  EXPECT_EQ(0u, truncated.GetSize());
+  EXPECT_FALSE(File::Exists(cache_path));
+}
@@ -0,0 +1,121 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Event.h"
+#include "VideoCommon/AsyncShaderCompiler.h"
+#include "VideoCommon/Statistics.h"
+
+using VideoCommon::AsyncShaderCompiler;
+
+namespace
+{
+struct CompileLog
+{
+  std::mutex lock;
+  std::vector<int> compiled;
+  std::atomic<int> retrieved{0};
+};
+
+class LoggingWorkItem final : public AsyncShaderCompiler::WorkItem
+{
+public:
+  LoggingWorkItem(CompileLog* log_, int id_, Common::Event* started_ = nullptr,
+                  Common::Event* release_ = nullptr)
+      : log(log_), id(id_), started(started_), release(release_)
+  {
+  }
+
+  bool Compile() override
+  {
+    if (started)
+      started->Set();
+    if (release)
+      release->Wait();
+
+    std::lock_guard<std::mutex> guard(log->lock);
+    log->compiled.push_back(id);
+    return true;
+  }
+
+  void Retrieve() override { log->retrieved++; }
+
+  ShaderCompileType GetType() const override { return ShaderCompileType::Pipeline; }
+
+private:
+  CompileLog* log;
+  int id;
+  Common::Event* started;
+  Common::Event* release;
+};
+}  // namespace
+
+TEST(AsyncShaderCompiler, CompilesSynchronouslyWithoutWorkers)
+{
+  AsyncShaderCompiler compiler;
+  CompileLog log;
+  compiler.QueueWorkItem(AsyncShaderCompiler::CreateWorkItem<LoggingWorkItem>(&log, 1), 0);
+
+  EXPECT_FALSE(compiler.HasPendingWork());
+  EXPECT_TRUE(compiler.HasCompletedWork());
+  compiler.RetrieveWorkItems();
+  EXPECT_EQ(1, log.retrieved.load());
+}
+
+TEST(AsyncShaderCompiler, CompletesAllItemsAcrossWorkers)
+{
+  AsyncShaderCompiler compiler;
+  ASSERT_TRUE(compiler.StartWorkerThreads(4));
+
+  CompileLog log;
+  constexpr int NUM_ITEMS = 200;
+  for (int i = 0; i < NUM_ITEMS; i++)
+  {
+    compiler.QueueWorkItem(AsyncShaderCompiler::CreateWorkItem<LoggingWorkItem>(&log, i),
+                           static_cast<u32>(i % 4));
+  }
+
+  compiler.WaitUntilCompletion();
+  compiler.RetrieveWorkItems();
+  compiler.StopWorkerThreads();
+
+  EXPECT_EQ(NUM_ITEMS, log.retrieved.load());
+  EXPECT_EQ(static_cast<size_t>(NUM_ITEMS), log.compiled.size());
+
+  const AsyncShaderCompiler::CompileTimes times = compiler.GetCompileTimes();
+  EXPECT_EQ(NUM_ITEMS, times[static_cast<size_t>(ShaderCompileType::Pipeline)].num_compiles);
+  EXPECT_EQ(0, times[static_cast<size_t>(ShaderCompileType::VertexShader)].num_compiles);
+}
+
+TEST(AsyncShaderCompiler, UrgentLaneSkipsAheadOfSpeculativeWork)
+{
+  AsyncShaderCompiler compiler;
+  ASSERT_TRUE(compiler.StartWorkerThreads(1));
+
+  // Keep the only worker busy while the rest of the work is queued.
+  CompileLog log;
+  Common::Event started;
+  Common::Event release;
+  compiler.QueueWorkItem(
+      AsyncShaderCompiler::CreateWorkItem<LoggingWorkItem>(&log, -1, &started, &release), 0);
+  started.Wait();
+
+  for (int i = 0; i < 5; i++)
+    compiler.QueueWorkItem(AsyncShaderCompiler::CreateWorkItem<LoggingWorkItem>(&log, 100 + i), 2);
+  for (int i = 0; i < 5; i++)
+    compiler.QueueWorkItem(AsyncShaderCompiler::CreateWorkItem<LoggingWorkItem>(&log, i), 0);
+  release.Set();
+
+  compiler.WaitUntilCompletion();
+  compiler.StopWorkerThreads();
+
+  const std::vector<int> expected{-1, 0, 1, 2, 3, 4, 100, 101, 102, 103, 104};
+  EXPECT_EQ(expected, log.compiled);
+}
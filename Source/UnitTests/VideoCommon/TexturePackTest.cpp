@@ -0,0 +1,148 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "VideoCommon/HiresTextures.h"
+#include "VideoCommon/TexturePack.h"
+
+namespace
+{
+HiresTexture::Level MakeLevel(u32 width, u32 height, AbstractTextureFormat format, bool random)
+{
+  HiresTexture::Level level;
+  level.width = width;
+  level.height = height;
+  level.row_length = width;
+  level.format = format;
+  level.data.resize(format == AbstractTextureFormat::RGBA8 ? width * height * 4 :
+                                                             width * height / 2);
+
+  std::mt19937 rng(width * 31 + height);
+  for (size_t i = 0; i < level.data.size(); i++)
+    level.data[i] = random ? static_cast<u8>(rng()) : static_cast<u8>(i / 64);
+  return level;
+}
+
+void ExpectSameLevels(const std::vector<HiresTexture::Level>& expected,
+                      const std::vector<HiresTexture::Level>& actual)
+{
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); i++)
+  {
+    EXPECT_EQ(expected[i].width, actual[i].width);
+    EXPECT_EQ(expected[i].height, actual[i].height);
+    EXPECT_EQ(expected[i].row_length, actual[i].row_length);
+    EXPECT_EQ(expected[i].format, actual[i].format);
+    EXPECT_EQ(expected[i].data, actual[i].data);
+  }
+}
+}  // namespace
+
+class TexturePackTest : public testing::Test
+{
+protected:
+  TexturePackTest() : m_dir(File::CreateTempDir()), m_path(m_dir + "/pack.dtp") {}
+  ~TexturePackTest() override { File::DeleteDirRecursively(m_dir); }
+
+  std::string m_dir;
+  std::string m_path;
+};
+
+TEST_F(TexturePackTest, ReadsBackTextures)
+{
+  const std::vector<HiresTexture::Level> smooth{
+      MakeLevel(64, 32, AbstractTextureFormat::RGBA8, false),
+      MakeLevel(32, 16, AbstractTextureFormat::RGBA8, false)};
+  const std::vector<HiresTexture::Level> noise{
+      MakeLevel(16, 16, AbstractTextureFormat::RGBA8, true)};
+  const std::vector<HiresTexture::Level> compressed{
+      MakeLevel(128, 128, AbstractTextureFormat::DXT1, true),
+      MakeLevel(64, 64, AbstractTextureFormat::DXT1, true)};
+
+  {
+    TexturePackWriter writer;
+    ASSERT_TRUE(writer.Open(m_path));
+    ASSERT_TRUE(writer.AddTexture("tex1_32x16_0000000000000001_14", smooth, false));
+    ASSERT_TRUE(writer.AddTexture("tex1_16x16_0000000000000002_14", noise, false));
+    ASSERT_TRUE(writer.AddTexture("tex1_32x32_m_0000000000000003_14", compressed, true));
+    ASSERT_TRUE(writer.Finish());
+  }
+
+  TexturePack pack;
+  ASSERT_TRUE(pack.Open(m_path));
+  EXPECT_EQ(3u, pack.GetTextureCount());
+  EXPECT_FALSE(pack.Contains("tex1_16x16_0000000000000004_14"));
+
+  std::vector<HiresTexture::Level> levels;
+  bool has_arbitrary_mipmaps = true;
+  ASSERT_TRUE(pack.ReadTexture("tex1_32x16_0000000000000001_14", &levels, &has_arbitrary_mipmaps));
+  ExpectSameLevels(smooth, levels);
+  EXPECT_FALSE(has_arbitrary_mipmaps);
+
+  ASSERT_TRUE(pack.ReadTexture("tex1_16x16_0000000000000002_14", &levels, &has_arbitrary_mipmaps));
+  ExpectSameLevels(noise, levels);
+
+  ASSERT_TRUE(
+      pack.ReadTexture("tex1_32x32_m_0000000000000003_14", &levels, &has_arbitrary_mipmaps));
+  ExpectSameLevels(compressed, levels);
+  EXPECT_TRUE(has_arbitrary_mipmaps);
+
+  // The smooth texture is compressible, so the pack has to be smaller than the raw data.
+  size_t raw_size = 0;
+  for (const auto* texture : {&smooth, &noise, &compressed})
+  {
+    for (const HiresTexture::Level& level : *texture)
+      raw_size += level.data.size();
+  }
+  EXPECT_LT(File::GetSize(m_path), raw_size);
+}
+
+TEST_F(TexturePackTest, RejectsTruncatedPack)
+{
+  {
+    TexturePackWriter writer;
+    ASSERT_TRUE(writer.Open(m_path));
+    ASSERT_TRUE(writer.AddTexture("tex1_16x16_0000000000000002_14",
+                                  {MakeLevel(16, 16, AbstractTextureFormat::RGBA8, true)}, false));
+    ASSERT_TRUE(writer.Finish());
+  }
+
+  {
+    File::IOFile file(m_path, "r+b");
+    ASSERT_TRUE(file.Resize(file.GetSize() - 8));
+  }
+
+  TexturePack pack;
+  EXPECT_FALSE(pack.Open(m_path));
+  EXPECT_FALSE(pack.Contains("tex1_16x16_0000000000000002_14"));
+}
+
+TEST_F(TexturePackTest, RejectsLevelWithWrongSize)
+{
+  HiresTexture::Level level = MakeLevel(16, 16, AbstractTextureFormat::RGBA8, true);
+  level.data.resize(level.data.size() / 2);
+  {
+    TexturePackWriter writer;
+    ASSERT_TRUE(writer.Open(m_path));
+    ASSERT_TRUE(writer.AddTexture("tex1_16x16_0000000000000002_14", {level}, false));
+    ASSERT_TRUE(writer.Finish());
+  }
+
+  TexturePack pack;
+  ASSERT_TRUE(pack.Open(m_path));
+  EXPECT_EQ("tex1_16x16_0000000000000002_14", pack.GetTextureName(0));
+  EXPECT_TRUE(pack.GetTextureName(1).empty());
+
+  std::vector<HiresTexture::Level> levels;
+  bool has_arbitrary_mipmaps;
+  EXPECT_FALSE(pack.ReadTexture("tex1_16x16_0000000000000002_14", &levels, &has_arbitrary_mipmaps));
+}
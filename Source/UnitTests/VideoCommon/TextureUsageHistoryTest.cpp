@@ -0,0 +1,55 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "VideoCommon/TextureUsageHistory.h"
+
+TEST(TextureUsageHistory, KeepsOrderOfFirstUse)
+{
+  TextureUsageHistory history;
+  EXPECT_TRUE(history.Add("tex1_8x8_0000000000000002_14"));
+  EXPECT_TRUE(history.Add("tex1_8x8_0000000000000001_14"));
+  EXPECT_FALSE(history.Add("tex1_8x8_0000000000000002_14"));
+
+  const std::vector<std::string> expected{"tex1_8x8_0000000000000002_14",
+                                          "tex1_8x8_0000000000000001_14"};
+  EXPECT_EQ(history.GetTextures(), expected);
+  EXPECT_TRUE(history.Contains("tex1_8x8_0000000000000001_14"));
+  EXPECT_FALSE(history.Contains("tex1_8x8_0000000000000003_14"));
+}
+
+TEST(TextureUsageHistory, IsBounded)
+{
+  TextureUsageHistory history;
+  for (size_t i = 0; i < TextureUsageHistory::MAX_SIZE; ++i)
+    ASSERT_TRUE(history.Add(std::to_string(i)));
+
+  EXPECT_FALSE(history.Add("one too many"));
+  EXPECT_FALSE(history.Contains("one too many"));
+  EXPECT_EQ(history.GetTextures().size(), TextureUsageHistory::MAX_SIZE);
+}
+
+TEST(TextureUsageHistory, LoadDropsTexturesThatAreGone)
+{
+  TextureUsageHistory written;
+  written.Add("tex1_8x8_0000000000000003_14");
+  written.Add("removed");
+  written.Add("tex1_8x8_0000000000000001_14");
+
+  // Blank lines, stray spaces and duplicates from hand-edited files are ignored too
+  const std::string contents = written.Serialize() + "\n  tex1_8x8_0000000000000003_14 \n";
+
+  TextureUsageHistory history;
+  history.Add("from another game");
+  history.Load(contents, [](const std::string& name) { return name != "removed"; });
+
+  const std::vector<std::string> expected{"tex1_8x8_0000000000000003_14",
+                                          "tex1_8x8_0000000000000001_14"};
+  EXPECT_EQ(history.GetTextures(), expected);
+  EXPECT_FALSE(history.Contains("from another game"));
+}
@@ -0,0 +1,131 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/ShaderGenCommon.h"
+#include "VideoCommon/UberShaderPixel.h"
+#include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/XFMemory.h"
+
+class UberShaderPixelTest : public testing::Test
+{
+protected:
+  UberShaderPixelTest()
+  {
+    std::memset(static_cast<void*>(&bpmem), 0, sizeof(bpmem));
+    std::memset(static_cast<void*>(&xfmem), 0, sizeof(xfmem));
+    g_ActiveConfig.bDisableFog = false;
+
+    // Two stages, exponential fog and an alpha test that depends on the pixel
+    bpmem.genMode.numtevstages = 1;
+    bpmem.fog.c_proj_fsel.fsel = 4;
+    bpmem.alpha_test.comp0 = AlphaTest::GREATER;
+    bpmem.alpha_test.comp1 = AlphaTest::LESS;
+    bpmem.alpha_test.logic = AlphaTest::AND;
+  }
+
+  static UberShader::PixelShaderUid GetUid()
+  {
+    return UberShader::GetSpecializedPixelShaderUid(UberShader::GetPixelShaderUid());
+  }
+};
+
+TEST_F(UberShaderPixelTest, SameStateGivesSameUid)
+{
+  const UberShader::PixelShaderUid uid = GetUid();
+  EXPECT_EQ(uid, GetUid());
+  EXPECT_NE(uid, UberShader::GetPixelShaderUid());
+
+  ShaderHostConfig host_config{};
+  const std::string code =
+      UberShader::GenPixelShader(APIType::OpenGL, host_config, uid.GetUidData()).GetBuffer();
+  EXPECT_EQ(code,
+            UberShader::GenPixelShader(APIType::OpenGL, host_config, GetUid().GetUidData())
+                .GetBuffer());
+  EXPECT_NE(code, UberShader::GenPixelShader(APIType::OpenGL, host_config,
+                                             UberShader::GetPixelShaderUid().GetUidData())
+                      .GetBuffer());
+}
+
+TEST_F(UberShaderPixelTest, UniformStateDoesNotChangeUid)
+{
+  const UberShader::PixelShaderUid uid = GetUid();
+
+  // These are read from the uniform buffer by specialized ubershaders as well
+  bpmem.alpha_test.ref0 = 0x40;
+  bpmem.alpha_test.ref1 = 0xc0;
+  bpmem.fog.color.hex = 0x123456;
+  bpmem.fog.a.hex = 0x12345;
+  bpmem.fog.b_magnitude = 0x100;
+  bpmem.fogRange.K[0].HEX = 0x123456;
+  bpmem.combiners[0].colorC.hex = 0x8f8f8f;
+  bpmem.combiners[1].alphaC.hex = 0x123450;
+  bpmem.tevorders[0].hex = 0x3c3c3c;
+  bpmem.tevksel[0].hex = 0x1f;
+
+  EXPECT_EQ(uid, GetUid());
+}
+
+TEST_F(UberShaderPixelTest, SpecializedStateChangesUid)
+{
+  const UberShader::PixelShaderUid uid = GetUid();
+
+  bpmem.genMode.numtevstages = 2;
+  EXPECT_NE(uid, GetUid());
+  bpmem.genMode.numtevstages = 1;
+
+  bpmem.fog.c_proj_fsel.fsel = 5;
+  EXPECT_NE(uid, GetUid());
+  bpmem.fog.c_proj_fsel.fsel = 4;
+
+  bpmem.alpha_test.comp1 = AlphaTest::EQUAL;
+  EXPECT_NE(uid, GetUid());
+  bpmem.alpha_test.comp1 = AlphaTest::LESS;
+
+  EXPECT_EQ(uid, GetUid());
+}
+
+TEST_F(UberShaderPixelTest, AlphaTestThatAlwaysPassesIsNotSpecialized)
+{
+  bpmem.alpha_test.comp0 = AlphaTest::ALWAYS;
+  bpmem.alpha_test.comp1 = AlphaTest::ALWAYS;
+  const UberShader::PixelShaderUid uid = GetUid();
+  EXPECT_EQ(uid.GetUidData()->alpha_test_enabled, 0u);
+
+  bpmem.alpha_test.logic = AlphaTest::OR;
+  bpmem.alpha_test.comp1 = AlphaTest::NEVER;
+  EXPECT_EQ(uid, GetUid());
+}
+
+TEST_F(UberShaderPixelTest, DisabledFogIsNotSpecialized)
+{
+  g_ActiveConfig.bDisableFog = true;
+  const UberShader::PixelShaderUid uid = GetUid();
+
+  bpmem.fog.c_proj_fsel.fsel = 5;
+  bpmem.fog.c_proj_fsel.proj = 1;
+  bpmem.fogRange.Base.Enabled = 1;
+  EXPECT_EQ(uid, GetUid());
+}
+
+TEST_F(UberShaderPixelTest, FogParametersAreClearedWithoutFog)
+{
+  bpmem.fog.c_proj_fsel.fsel = 0;
+  UberShader::PixelShaderUid uid = GetUid();
+
+  bpmem.fog.c_proj_fsel.proj = 1;
+  bpmem.fogRange.Base.Enabled = 1;
+  UberShader::PixelShaderUid other_uid = GetUid();
+  EXPECT_NE(uid, other_uid);
+
+  ShaderHostConfig host_config{};
+  UberShader::ClearUnusedPixelShaderUidBits(APIType::OpenGL, host_config, &uid);
+  UberShader::ClearUnusedPixelShaderUidBits(APIType::OpenGL, host_config, &other_uid);
+  EXPECT_EQ(uid, other_uid);
+}